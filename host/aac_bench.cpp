@@ -0,0 +1,126 @@
+/*
+ * aac_bench.cpp
+ *
+ * Cost of the SBR modes of AACDecoder (settings.AAC_SBR): the complex SBR (AAC_SBR_HQ) against the real valued low
+ * power SBR (AAC_SBR_LP, the former compile switch SBR_LOW_POWER), and the budget policy of AAC_SBR_AUTO.
+ *
+ *   usage: aac_bench [-n repeat] [-b budget] file ...
+ *
+ *   -n  decode every file n times per mode, the fastest run is reported, default 5
+ *   -b  settings.AAC_SBR_BUDGET for the AUTO run, % of the frame duration, default 0 (switches on every host)
+ *
+ * The HE-AAC corpus is corpus/aac_he48.aac and corpus/aac_hev2_24.aac of bench_corpus.txt (make_corpus.sh, needs
+ * libfdk_aac). LC files at 24 kHz or less are upsampled by the QMF banks of the SBR tool (implicit signalling), they
+ * run the analysis and synthesis of both modes without the HF generation.
+ *
+ * MCPS     million cycles per second of audio (TSC on x86, else million ns, 1000 = real time on one core), whole decode loop
+ * level    energy of the LP output relative to the HQ output, the envelope adjustment aims at the same energies
+ * SNR      HQ output / (LP output - HQ output), 'same' if the stream has no SBR or PS (stays HQ in both modes). The
+ *          core band below the crossover matches, the replicated bands do not: LP has no complex HF generation and
+ *          aliases at the band borders, with SBR the SNR says little about the quality.
+ * auto     the frame from which on the output of AAC_SBR_AUTO differs from the HQ output, '-' if it did not switch (no
+ *          SBR, PS, or within the budget). The policy averages the first 16 frames.
+ *
+ */
+
+#include "decoder_host.h"
+#include <cmath>
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+static inline uint64_t ticks() { return __rdtsc(); }
+static const char*     unit = "MCPS";
+#else
+static inline uint64_t ticks() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+static const char* unit = "M ns/s";
+#endif
+
+struct ModeResult {
+    std::vector<int32_t> pcm;
+    host::DecodeStats    stats;
+    double               mcps = 0;
+};
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+static bool decode(const std::vector<uint8_t>& data, host::codec_t codec, uint8_t mode, uint8_t budget, uint32_t repeat, ModeResult& r) {
+    Audio audio;
+    audio.settings.AAC_SBR = mode;
+    audio.settings.AAC_SBR_BUDGET = budget;
+    auto sink = [&](const int32_t* pcm, size_t frames, uint8_t) { r.pcm.insert(r.pcm.end(), pcm, pcm + frames * 2); };
+    if (!host::decodeBuffer(audio, codec, data, r.stats, sink) || !r.stats.frames) return false;
+    uint64_t best = UINT64_MAX;
+    for (uint32_t n = 0; mode != Audio::AAC_SBR_AUTO && n < repeat; n++) { // AUTO is checked, not timed
+        host::DecodeStats stats;
+        uint64_t          t0 = ticks();
+        host::decodeBuffer(audio, codec, data, stats);
+        best = std::min(best, ticks() - t0);
+    }
+    double seconds = (double)r.stats.samples / r.stats.sampleRate;
+    r.mcps = best == UINT64_MAX ? 0 : best / seconds / 1e6;
+    return true;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int main(int argc, char* argv[]) {
+    uint32_t repeat = 5;
+    uint8_t  budget = 0;
+    int      i = 1;
+
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            repeat = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc)
+            budget = std::min(std::max(0, atoi(argv[++i])), 255);
+        else {
+            printf("unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (i >= argc) {
+        printf("usage: %s [-n repeat] [-b budget] file ...\n", argv[0]);
+        return 2;
+    }
+
+    int failed = 0;
+    printf("%-32s %3s %6s %8s %10s %10s %8s %10s %10s  %s\n", "file", "ch", "rate", "frames", (std::string(unit) + " HQ").c_str(), (std::string(unit) + " LP").c_str(), "LP/HQ",
+           "level LP", "SNR LP", "auto");
+    for (; i < argc; i++) {
+        const char*          path = argv[i];
+        const char*          name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+        host::codec_t        codec = host::codecFromPath(path);
+        std::vector<uint8_t> data;
+        ModeResult           hq, lp, au;
+        if (codec != host::CODEC_AAC && codec != host::CODEC_M4A) {
+            printf("%-32.32s is not AAC\n", name);
+            failed++;
+            continue;
+        }
+        if (!host::readFile(path, data) || !decode(data, codec, Audio::AAC_SBR_HQ, budget, repeat, hq) || !decode(data, codec, Audio::AAC_SBR_LP, budget, repeat, lp) ||
+            !decode(data, codec, Audio::AAC_SBR_AUTO, budget, repeat, au)) {
+            printf("%-32.32s cannot be decoded\n", name);
+            failed++;
+            continue;
+        }
+        double sig = 0, err = 0, pow = 0;
+        size_t len = std::min(hq.pcm.size(), lp.pcm.size());
+        for (size_t k = 0; k < len; k++) {
+            double ref = hq.pcm[k], e = (double)lp.pcm[k] - ref;
+            sig += ref * ref;
+            err += e * e;
+            pow += (double)lp.pcm[k] * lp.pcm[k];
+        }
+        char snr[16] = "same";
+        if (err) snprintf(snr, sizeof(snr), "%.1f dB", 10 * log10(sig / err + 1e-30));
+        char   autoStr[48] = "-";
+        size_t diff = 0;
+        while (diff < std::min(au.pcm.size(), hq.pcm.size()) && au.pcm[diff] == hq.pcm[diff]) diff++;
+        if (diff < au.pcm.size()) snprintf(autoStr, sizeof(autoStr), "LP from frame %zu", diff / 2 * hq.stats.frames / std::max<size_t>(1, hq.pcm.size() / 2));
+        bool ok = hq.stats.samples == lp.stats.samples && hq.stats.sampleRate == lp.stats.sampleRate && au.pcm.size() == hq.pcm.size();
+        printf("%-32.32s %3u %6u %8u %10.1f %10.1f %8.2f %+7.2f dB %10s  %s%s\n", name, hq.stats.channels, hq.stats.sampleRate, hq.stats.frames, hq.mcps, lp.mcps, hq.mcps ? lp.mcps / hq.mcps : 0,
+               10 * log10((pow + 1e-30) / (sig + 1e-30)), snr, autoStr, ok ? "" : "  <-- length differs");
+        if (!ok) failed++;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,234 @@
+/*
+ * audiotask_sim.cpp
+ *
+ * Simulates the audio task on a virtual clock: the I2S DMA (DMA_DESC_NUM buffers of DMA_FRAME_NUM frames, auto clear)
+ * sends one buffer every DMA_FRAME_NUM / samplerate, the task refills it from SamplesBuff and lets the decoder run ahead.
+ * The decode time of every block is measured on the host and multiplied with the cpu factor.
+ *
+ *   usage: audiotask_sim [-k cpu factor] file [file ...]
+ *
+ *   -k  how much slower the target is than the host, e.g. 15 for an ESP32-S3 at 240MHz (default 1)
+ *
+ * Three strategies are compared, the first two with the work order of Audio::playAudioData() (playChunk, cacheSamples, decode):
+ *   poll   the former loop: vTaskDelay(1), one performAudioTask() per 1ms tick
+ *   event  audioTask(): woken by the on_sent callback (20ms timeout), performAudioTask() until it makes no progress
+ *   dual   setDualTask(true): outputTask() refills the DMA on the other core after every on_sent, audioTask() decodes
+ *          up to the high watermark of SamplesBuff (3/4) and waits for the output task, below the low watermark (1/4)
+ *          it waits only one tick
+ * Reported are wakeups per second (both tasks in dual mode), useful work units per wakeup, busy share (of one core)
+ * and DMA underruns while playing.
+ * All modes decode like Audio::decodeTarget(): straight into SamplesBuff if the largest frame of the codec fits in one
+ * piece (in place), via m_outBuff and cacheSamples() if it would wrap or SamplesBuff is below its low watermark, else
+ * the decoder waits. 'B/frame' is the PSRAM traffic per stereo frame between decoder and I2S (write + read of 8 bytes
+ * each): in place 16 (decoder -> SamplesBuff -> I2S), copied 32 (+ m_outBuff), 48 before the DSP ran in place in
+ * SamplesBuff (+ m_i2sWorkBuff).
+ *
+ */
+
+#include "decoder_host.h"
+#include <time.h>
+
+struct Block {
+    uint32_t frames;
+    uint64_t ns;
+};
+
+enum SimMode { POLL, EVENT, DUAL };
+
+struct SimResult {
+    uint64_t wakeups = 0;
+    uint64_t work = 0;
+    uint64_t busyNs = 0;
+    uint64_t underruns = 0;
+    uint64_t durationNs = 0;
+    uint64_t inPlace = 0; // frames decoded into SamplesBuff
+    uint64_t copied = 0;  // frames decoded into m_outBuff
+};
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+static SimResult simulate(const std::vector<Block>& blocks, uint32_t sampleRate, uint32_t maxFrames, double cpu, SimMode mode) {
+    const uint32_t descNum = 16, descFrames = 256;   // settings.DMA_DESC_NUM, settings.DMA_FRAME_NUM
+    const uint32_t samplesBuffFrames = 128 * 256 / 2; // SamplesBuff, 128 * DMA_FRAME_NUM words
+    const uint64_t period = (uint64_t)descFrames * 1000000000ULL / sampleRate;
+    const uint64_t tick = 1000000, timeout = 20000000;
+    const uint64_t roundNs = 2000 * cpu; // playChunk/cacheSamples bookkeeping per round
+    const uint32_t lowWater = samplesBuffFrames / 4, highWater = samplesBuffFrames * 3 / 4;
+
+    SimResult r;
+    uint64_t  t = 0, nextSent = period;
+    uint32_t  filled = 0;      // DMA buffers with audio, the rest sends zeros
+    uint32_t  notify = 0;      // pending task notifications
+    uint32_t  sb = 0;          // frames in SamplesBuff
+    uint32_t  valid = 0;       // m_validSamples, decoded but not cached
+    uint32_t  wpos = 0;        // write position in SamplesBuff
+    size_t    next = 0;        // next block to decode
+    bool      started = false; // the first audio reached the DMA
+
+    auto dma = [&](uint64_t until) { // on_sent events up to 'until'
+        while (nextSent <= until) {
+            if (filled)
+                filled--;
+            else if (started && (next < blocks.size() || valid || sb))
+                r.underruns++;
+            if (mode == DUAL) { // outputTask() on the other core: playChunk, then it wakes the decoder below the high watermark
+                while (filled < descNum && sb) {
+                    sb -= std::min(sb, descFrames);
+                    filled++;
+                    started = true;
+                    r.work++;
+                }
+                r.wakeups++;
+                r.busyNs += roundNs;
+                if (sb <= highWater) notify++;
+            } else {
+                notify++;
+            }
+            nextSent += period;
+        }
+    };
+    auto round = [&]() -> uint32_t { // performAudioTask() -> playAudioData(), returns work units
+        uint32_t work = 0;
+        while (mode != DUAL && filled < descNum && sb) { // playChunk
+            sb -= std::min(sb, descFrames);
+            filled++;
+            started = true;
+            work++;
+        }
+        if (valid) { // cacheSamples
+            uint32_t n = std::min(valid, samplesBuffFrames - sb);
+            sb += n;
+            valid -= n;
+            wpos = (wpos + n) % samplesBuffFrames;
+            if (n) work++;
+        } else if (next < blocks.size()) { // decode
+            uint32_t room = std::min(maxFrames, samplesBuffFrames - sb); // SamplesBuff.writeView()
+            uint32_t first = std::min(room, samplesBuffFrames - wpos);
+            if (first >= maxFrames) { // in place
+                sb += blocks[next].frames;
+                wpos = (wpos + blocks[next].frames) % samplesBuffFrames;
+                r.inPlace += blocks[next].frames;
+            } else if (room > first || sb < lowWater) { // the frame would wrap, or hurry
+                valid = blocks[next].frames;
+                r.copied += blocks[next].frames;
+            } else { // wait for room
+                t += roundNs;
+                r.busyNs += roundNs;
+                dma(t);
+                return work;
+            }
+            t += blocks[next].ns * cpu;
+            r.busyNs += blocks[next].ns * cpu;
+            next++;
+            work++;
+        }
+        t += roundNs;
+        r.busyNs += roundNs;
+        dma(t);
+        return work;
+    };
+
+    bool progress = false;
+    while (next < blocks.size() || valid || sb || filled) {
+        if (mode == DUAL) { // audioTask() as decoder, notified by the output task
+            uint64_t deadline = t + ((progress && sb < lowWater) ? tick : timeout);
+            while (!notify && nextSent <= deadline) {
+                t = std::max(t, nextSent);
+                dma(t);
+            }
+            if (!notify) t = std::max(t, deadline);
+            notify = 0;
+            r.wakeups++;
+            progress = false;
+            for (int i = 0; i < 16; i++) {
+                uint32_t w = round();
+                r.work += w;
+                if (!w) break;
+                progress = true;
+                if (sb > highWater) break;
+            }
+        } else if (mode == EVENT) { // wait for a notification or the timeout
+            if (!notify) {
+                uint64_t until = std::min(nextSent, t + timeout);
+                t = std::max(t, until);
+                dma(t);
+            }
+            notify = 0;
+            r.wakeups++;
+            for (int i = 0; i < 16; i++) {
+                uint32_t w = round();
+                r.work += w;
+                if (!w) break;
+            }
+        } else { // vTaskDelay(1)
+            t = (t / tick + 1) * tick;
+            dma(t);
+            notify = 0;
+            r.wakeups++;
+            r.work += round();
+        }
+    }
+    r.durationNs = t;
+    return r;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+static uint64_t nowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int main(int argc, char* argv[]) {
+    double cpu = 1;
+    int    i = 1;
+
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        if (!strcmp(argv[i], "-k") && i + 1 < argc)
+            cpu = std::max(0.01, atof(argv[++i]));
+        else {
+            printf("unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (i >= argc) {
+        printf("usage: %s [-k cpu factor] file [file ...]\n", argv[0]);
+        return 2;
+    }
+
+    Audio audio;
+    int   failed = 0;
+
+    printf("%-8s %-32s %-6s %10s %10s %8s %10s %9s %8s\n", "codec", "file", "mode", "wakeups/s", "work/wake", "busy %", "underruns", "in place", "B/frame");
+    for (; i < argc; i++) {
+        const char*          path = argv[i];
+        const char*          name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+        host::codec_t        codec = host::codecFromPath(path);
+        std::vector<uint8_t> data;
+        std::vector<Block>   blocks;
+        host::DecodeStats    stats;
+        if (codec == host::CODEC_NONE || !host::readFile(path, data)) {
+            printf("%-8s %-32s cannot be read\n", host::codecName(codec), name);
+            failed++;
+            continue;
+        }
+        uint64_t last = nowNs();
+        auto     sink = [&](const int32_t*, size_t frames, uint8_t) { // the time since the previous block is its decode time
+            uint64_t now = nowNs();
+            blocks.push_back({(uint32_t)frames, now - last});
+            last = now;
+        };
+        if (!host::decodeBuffer(audio, codec, data, stats, sink) || blocks.empty() || !stats.sampleRate) {
+            printf("%-8s %-32s no audio frames decoded\n", host::codecName(codec), name);
+            failed++;
+            continue;
+        }
+        uint32_t maxFrames = codec == host::CODEC_MP3 ? 1152 : 4608; // Audio::decodeTarget(), m_outbuffSize / 2
+        for (SimMode mode : {POLL, EVENT, DUAL}) {
+            SimResult r = simulate(blocks, stats.sampleRate, maxFrames, cpu, mode);
+            double    sec = r.durationNs / 1e9;
+            double    frames = r.inPlace + r.copied;
+            printf("%-8s %-32.32s %-6s %10.1f %10.2f %8.2f %10llu %8.1f%% %8.1f\n", host::codecName(codec), name, mode == DUAL ? "dual" : mode == EVENT ? "event" : "poll", r.wakeups / sec,
+                   (double)r.work / r.wakeups, 100.0 * r.busyNs / r.durationNs, (unsigned long long)r.underruns, 100.0 * r.inPlace / frames, (16.0 * r.inPlace + 32.0 * r.copied) / frames);
+        }
+    }
+    return failed ? 1 : 0;
+}
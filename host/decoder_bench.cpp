@@ -0,0 +1,125 @@
+/*
+ * decoder_bench.cpp
+ *
+ * Decode throughput per codec: µs per frame, realtime factor and the heap working set of the decoder.
+ *
+ *   usage: decoder_bench [-n repeat] [-c corpus.txt] [-o results.csv] [file ...]
+ *
+ *   -n  decode every file n times, the fastest run is reported (the working set is the same for every run)
+ *   -c  read the files from a corpus manifest, see bench_corpus.txt
+ *   -o  additionally write the results as CSV
+ *
+ * The realtime factor is audio duration / decode time, "load" is its reciprocal: the share of one core
+ * that the decoder needs to keep up with playback. The working set is the heap the decoder holds above
+ * the baseline taken before it was created: the peak, and the average over all decode() calls.
+ * Corpus entries whose file does not exist are listed as missing and do not count as failure,
+ * host/make_corpus.sh creates them where the encoders are installed.
+ *
+ */
+
+#include "decoder_host.h"
+#include <string>
+
+struct BenchItem {
+    std::string label;
+    std::string path;
+};
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// manifest: one "label  path" per line, '#' starts a comment, relative paths are relative to the manifest
+static bool readCorpus(const char* manifest, std::vector<BenchItem>& items) {
+    FILE* f = fopen(manifest, "r");
+    if (!f) return false;
+    std::string dir(manifest);
+    size_t      slash = dir.rfind('/');
+    dir = (slash == std::string::npos) ? "" : dir.substr(0, slash + 1);
+
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        char* hash = strchr(line, '#');
+        if (hash) *hash = 0;
+        char label[128], path[384];
+        if (sscanf(line, "%127s %383s", label, path) != 2) continue;
+        items.push_back({label, path[0] == '/' ? std::string(path) : dir + path});
+    }
+    fclose(f);
+    return true;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int main(int argc, char* argv[]) {
+    uint32_t               repeat = 1;
+    const char*            csvPath = nullptr;
+    std::vector<BenchItem> items;
+    int                    i = 1;
+
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            repeat = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+            csvPath = argv[++i];
+        else if (!strcmp(argv[i], "-c") && i + 1 < argc) {
+            if (!readCorpus(argv[++i], items)) {
+                printf("cannot read corpus %s\n", argv[i]);
+                return 2;
+            }
+        } else {
+            printf("unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    for (; i < argc; i++) {
+        const char* name = strrchr(argv[i], '/') ? strrchr(argv[i], '/') + 1 : argv[i];
+        items.push_back({name, argv[i]});
+    }
+    if (items.empty()) {
+        printf("usage: %s [-n repeat] [-c corpus.txt] [-o results.csv] [file ...]\n", argv[0]);
+        return 2;
+    }
+
+    FILE* csv = csvPath ? fopen(csvPath, "w") : nullptr;
+    if (csv) fprintf(csv, "label,codec,channels,rate,frames,us_per_frame,max_us_per_frame,x_realtime,load_percent,peak_ws_bytes,avg_ws_bytes,checksum\n");
+
+    Audio audio;
+    int   failed = 0, missing = 0;
+
+    printf("%-24s %-7s %2s %6s %7s %9s %9s %9s %7s %10s %10s\n", "label", "codec", "ch", "rate", "frames", "µs/frame", "max µs", "x-rt", "load %", "peak WS", "avg WS");
+    for (auto& it : items) {
+        host::codec_t        codec = host::codecFromPath(it.path.c_str());
+        std::vector<uint8_t> data;
+        if (codec == host::CODEC_NONE || !host::readFile(it.path.c_str(), data)) {
+            printf("%-24s %-7s missing (%s)\n", it.label.c_str(), host::codecName(codec), it.path.c_str());
+            missing++;
+            continue;
+        }
+
+        host::DecodeStats best;
+        bool              ok = true;
+        for (uint32_t r = 0; r < repeat && ok; r++) {
+            host::DecodeStats stats;
+            ok = host::decodeBuffer(audio, codec, data, stats);
+            if (r == 0 || stats.decodeNs < best.decodeNs) best = stats;
+        }
+        if (!ok || !best.frames || !best.sampleRate) {
+            printf("%-24s %-7s no audio frames decoded\n", it.label.c_str(), host::codecName(codec));
+            failed++;
+            continue;
+        }
+
+        double usFrame = best.decodeNs / 1e3 / best.frames;
+        double usMax = best.maxFrameNs / 1e3;
+        double audioSec = (double)best.samples / best.sampleRate;
+        double xrt = best.decodeNs ? audioSec * 1e9 / best.decodeNs : 0;
+        double load = xrt ? 100.0 / xrt : 0;
+        size_t wsPeak = best.heapPeak - best.heapBase;
+        size_t wsAvg = best.heapSamples ? (size_t)(best.heapSum / best.heapSamples) - best.heapBase : 0;
+
+        printf("%-24.24s %-7s %2u %6u %7u %9.1f %9.1f %9.1f %7.2f %10zu %10zu\n", it.label.c_str(), host::codecName(codec), best.channels, best.sampleRate, best.frames, usFrame, usMax,
+               xrt, load, wsPeak, wsAvg);
+        if (csv)
+            fprintf(csv, "%s,%s,%u,%u,%u,%.2f,%.2f,%.2f,%.3f,%zu,%zu,0x%016llx\n", it.label.c_str(), host::codecName(codec), best.channels, best.sampleRate, best.frames, usFrame, usMax, xrt,
+                    load, wsPeak, wsAvg, (unsigned long long)best.checksum);
+    }
+    if (csv) fclose(csv);
+    if (missing) printf("%d corpus file(s) missing, run host/make_corpus.sh\n", missing);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,334 @@
+/*
+ * decoder_host.cpp
+ *
+ */
+
+#include "decoder_host.h"
+#include "../src/aac_decoder/aac_decoder.h"
+#include "../src/flac_decoder/flac_decoder.h"
+#include "../src/mp3_decoder/mp3_decoder.h"
+#include "../src/opus_decoder/opus_decoder.h"
+#include "../src/vorbis_decoder/vorbis_decoder.h"
+#include "../src/wav_decoder/wav_decoder.h"
+#include <time.h>
+
+namespace host {
+
+// same block sizes as Audio::initializeDecoder()
+constexpr size_t m_frameSizeWav = 4096;
+constexpr size_t m_frameSizeMP3 = 18000;
+constexpr size_t m_frameSizeAAC = 18000;
+constexpr size_t m_frameSizeOgg = UINT16_MAX;
+constexpr size_t m_outbuffSize = 4608 * 2;
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+codec_t codecFromPath(const char* path) {
+    const char* ext = strrchr(path, '.');
+    if (!ext) return CODEC_NONE;
+    ext++;
+    if (!strcasecmp(ext, "wav")) return CODEC_WAV;
+    if (!strcasecmp(ext, "mp3")) return CODEC_MP3;
+    if (!strcasecmp(ext, "aac")) return CODEC_AAC;
+    if (!strcasecmp(ext, "m4a")) return CODEC_M4A;
+    if (!strcasecmp(ext, "flac")) return CODEC_FLAC;
+    if (!strcasecmp(ext, "opus")) return CODEC_OPUS;
+    if (!strcasecmp(ext, "ogg")) return CODEC_VORBIS;
+    return CODEC_NONE;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+const char* codecName(codec_t codec) {
+    static const char* names[8] = {"unknown", "WAV", "MP3", "AAC", "M4A", "FLAC", "OPUS", "VORBIS"};
+    return codec < 8 ? names[codec] : names[0];
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+std::unique_ptr<Decoder> createDecoder(Audio& audio, codec_t codec) {
+    switch (codec) {
+        case CODEC_WAV: return std::make_unique<WavDecoder>(audio);
+        case CODEC_MP3: return std::make_unique<MP3Decoder>(audio);
+        case CODEC_AAC: return std::make_unique<AACDecoder>(audio);
+        case CODEC_M4A: return std::make_unique<AACDecoder>(audio);
+        case CODEC_FLAC: return std::make_unique<FlacDecoder>(audio);
+        case CODEC_OPUS: return std::make_unique<OpusDecoder>(audio);
+        case CODEC_VORBIS: return std::make_unique<VorbisDecoder>(audio);
+        default: return nullptr;
+    }
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool readFile(const char* path, std::vector<uint8_t>& data) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data.resize(size > 0 ? size : 0);
+    size_t n = data.size() ? fread(data.data(), 1, data.size(), f) : 0;
+    fclose(f);
+    return n == data.size();
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// 📌📌📌  C O N T A I N E R   P R O L O G U E  📌📌📌
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+
+static uint32_t be32(const uint8_t* p) { return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3]; }
+static uint32_t le32(const uint8_t* p) { return (uint32_t)p[3] << 24 | (uint32_t)p[2] << 16 | (uint32_t)p[1] << 8 | p[0]; }
+static uint16_t le16(const uint8_t* p) { return (uint16_t)(p[1] << 8 | p[0]); }
+
+static size_t skipID3(const std::vector<uint8_t>& d) {
+    if (d.size() < 10 || memcmp(d.data(), "ID3", 3)) return 0;
+    size_t size = (d[6] & 0x7F) << 21 | (d[7] & 0x7F) << 14 | (d[8] & 0x7F) << 7 | (d[9] & 0x7F);
+    return 10 + size + ((d[5] & 0x10) ? 10 : 0); // footer
+}
+
+struct rawParams_t { // arguments of Decoder::setRawBlockParams()
+    bool     valid = false;
+    uint8_t  channels = 0;
+    uint32_t sampleRate = 0;
+    uint8_t  bps = 0;
+    uint32_t tsis = 0;
+};
+
+static bool parseWAV(const std::vector<uint8_t>& d, rawParams_t& rp, size_t& start, size_t& end) { // see Audio::read_WAV_Header()
+    if (d.size() < 12 || memcmp(d.data(), "RIFF", 4) || memcmp(d.data() + 8, "WAVE", 4)) return false;
+    size_t pos = 12;
+    bool   fmt = false;
+    while (pos + 8 <= d.size()) {
+        uint32_t cs = le32(&d[pos + 4]);
+        if (!memcmp(&d[pos], "fmt ", 4) && pos + 24 <= d.size()) {
+            rp.channels = le16(&d[pos + 10]);
+            rp.sampleRate = le32(&d[pos + 12]);
+            rp.bps = le16(&d[pos + 22]);
+            rp.valid = fmt = true;
+        }
+        if (!memcmp(&d[pos], "data", 4)) {
+            start = pos + 8;
+            end = std::min(d.size(), start + cs);
+            return fmt;
+        }
+        pos += 8 + cs + (cs & 1);
+    }
+    return false;
+}
+
+static bool parseFLAC(const std::vector<uint8_t>& d, rawParams_t& rp, size_t& start) { // see Audio::read_FLAC_Header()
+    size_t pos = skipID3(d);
+    if (pos + 4 > d.size() || memcmp(&d[pos], "fLaC", 4)) return false;
+    pos += 4;
+    bool last = false;
+    while (!last && pos + 4 <= d.size()) {
+        last = d[pos] & 0x80;
+        uint8_t  type = d[pos] & 0x7F;
+        uint32_t len = (uint32_t)d[pos + 1] << 16 | (uint32_t)d[pos + 2] << 8 | d[pos + 3];
+        if (type == 0 && pos + 4 + 18 <= d.size()) { // STREAMINFO
+            const uint8_t* s = &d[pos + 4];
+            rp.sampleRate = (uint32_t)s[10] << 12 | (uint32_t)s[11] << 4 | s[12] >> 4;
+            rp.channels = ((s[12] >> 1) & 0x07) + 1;
+            rp.bps = (((s[12] & 0x01) << 4) | (s[13] >> 4)) + 1;
+            rp.tsis = be32(&s[14]); // lower 32 bits of the 36 bit total samples
+            rp.valid = true;
+        }
+        pos += 4 + len;
+    }
+    start = pos;
+    return pos <= d.size();
+}
+
+static bool parseM4A(const std::vector<uint8_t>& d, rawParams_t& rp, size_t& start, size_t& end) { // see Audio::read_M4A_Header()
+    uint8_t  channels = 2, objectType = 2;
+    uint32_t sampleRate = 44100;
+    bool     mdat = false;
+
+    std::function<void(size_t, size_t)> walk = [&](size_t pos, size_t limit) {
+        while (pos + 8 <= limit) {
+            uint64_t size = be32(&d[pos]);
+            size_t   hdr = 8;
+            if (size == 1 && pos + 16 <= limit) {
+                size = (uint64_t)be32(&d[pos + 8]) << 32 | be32(&d[pos + 12]);
+                hdr = 16;
+            }
+            if (size == 0) size = limit - pos;
+            if (size < hdr || pos + size > limit) size = limit - pos;
+            const char* type = (const char*)&d[pos + 4];
+            if (!memcmp(type, "moov", 4) || !memcmp(type, "trak", 4) || !memcmp(type, "mdia", 4) || !memcmp(type, "minf", 4) || !memcmp(type, "stbl", 4)) {
+                walk(pos + hdr, pos + size);
+            } else if (!memcmp(type, "stsd", 4)) {
+                walk(pos + hdr + 8, pos + size); // version/flags + entry count
+            } else if (!memcmp(type, "mp4a", 4) && pos + 36 <= limit) {
+                channels = d[pos + 25];
+                sampleRate = (uint32_t)d[pos + 32] << 8 | d[pos + 33];
+                for (size_t i = pos + 36; i + 2 < pos + size; i++) { // DecoderSpecificInfo tag inside esds
+                    if (d[i] == 0x05 && (d[i + 1] & 0x80) == 0 && d[i + 1] >= 2) {
+                        objectType = d[i + 2] >> 3;
+                        break;
+                    }
+                }
+            } else if (!memcmp(type, "mdat", 4) && !mdat) {
+                mdat = true;
+                start = pos + hdr;
+                end = pos + size;
+            }
+            pos += size;
+        }
+    };
+    walk(0, d.size());
+    if (!mdat) return false;
+    rp.channels = channels;
+    rp.sampleRate = sampleRate;
+    rp.tsis = objectType; // AACDecoder takes the audio object type here
+    rp.valid = true;
+    return true;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// 📌📌📌  D E C O D E   L O O P  📌📌📌
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+
+static uint64_t nowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+bool decodeBuffer(Audio& audio, codec_t codec, const std::vector<uint8_t>& data, DecodeStats& stats, const PcmSink& sink) {
+    stats = DecodeStats{};
+    stats.codec = codec;
+
+    rawParams_t rp;
+    size_t      pos = 0, end = data.size(), maxBlock = m_frameSizeOgg;
+    bool        ok = true;
+    switch (codec) {
+        case CODEC_WAV:
+            ok = parseWAV(data, rp, pos, end);
+            maxBlock = m_frameSizeWav;
+            break;
+        case CODEC_MP3:
+            pos = skipID3(data);
+            maxBlock = m_frameSizeMP3;
+            break;
+        case CODEC_AAC:
+            pos = skipID3(data);
+            maxBlock = m_frameSizeAAC;
+            break;
+        case CODEC_M4A:
+            ok = parseM4A(data, rp, pos, end);
+            maxBlock = m_frameSizeAAC;
+            break;
+        case CODEC_FLAC:
+            if (data.size() >= 4 && !memcmp(data.data(), "OggS", 4)) break; // FLAC in OGG, the decoder parses the metadata itself
+            ok = parseFLAC(data, rp, pos);
+            break;
+        default: break;
+    }
+    if (!ok) return false;
+
+    std::vector<int32_t> outBuff(m_outbuffSize);
+    std::vector<uint8_t> inBuff(data.begin() + pos, data.begin() + end); // own copy, decoders may write into inbuf
+
+    // everything allocated from here on belongs to the decoder
+    host_shim::heap_reset_peak();
+    stats.heapBase = host_shim::heap_in_use();
+
+    std::unique_ptr<Decoder> dec = createDecoder(audio, codec);
+    if (!dec || !dec->init()) return false;
+    if (rp.valid) dec->setRawBlockParams(rp.channels, rp.sampleRate, rp.bps, rp.tsis, 0);
+
+    size_t               len = inBuff.size();
+    uint64_t             hash = 0xcbf29ce484222325ULL;
+    bool                 playing = false;
+    bool                 synced = false;
+    pos = 0;
+
+    auto account = [&](uint32_t frames, uint64_t dt) {
+        if (!stats.frames) {
+            stats.channels = dec->getChannels();
+            stats.sampleRate = dec->getSampleRate();
+            stats.bitsPerSample = dec->getBitsPerSample();
+        }
+        if (dt > stats.maxFrameNs) stats.maxFrameNs = dt;
+        stats.frames++;
+        stats.samples += frames;
+
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(outBuff.data());
+        for (size_t i = 0; i < (size_t)frames * 2 * sizeof(int32_t); i++) {
+            hash ^= p[i];
+            hash *= 0x100000001b3ULL;
+        }
+        if (sink) sink(outBuff.data(), frames, stats.channels);
+    };
+
+    while (pos < len) {
+        int32_t  bytes = (int32_t)std::min(len - pos, maxBlock);
+        uint8_t* data = inBuff.data() + pos;
+
+        if (!playing) { // Audio::findNextSync()
+            if (codec == CODEC_WAV || codec == CODEC_M4A) {
+                playing = true;
+            } else {
+                int32_t nextSync = dec->findSyncWord(data, bytes);
+                if (nextSync < 0) {
+                    pos += bytes;
+                    continue;
+                }
+                if (nextSync > 0) {
+                    pos += nextSync;
+                    continue;
+                }
+                if (codec == CODEC_MP3) dec->clear();
+                playing = true;
+            }
+            synced = true;
+        }
+
+        int32_t bytesLeft = bytes;
+        uint64_t t0 = nowNs();
+        int32_t  res = dec->decode(data, &bytesLeft, outBuff.data());
+        uint64_t dt = nowNs() - t0;
+        int32_t bytesDecoded = bytes - bytesLeft;
+
+        stats.decodeNs += dt;
+        stats.heapSum += host_shim::heap_in_use();
+        stats.heapSamples++;
+
+        if (res < 0) { // Audio::decodeError()
+            stats.errors++;
+            if (res == -100) break;
+            playing = false;
+            pos += bytesDecoded > 0 ? bytesDecoded : 1;
+            continue;
+        }
+        if (res > 99) { // Audio::decodeContinue()
+            if (codec == CODEC_AAC && res == AACDecoder::AAC_ID3_HDR) {
+                uint32_t size = ((data[6 + bytesDecoded] & 0x7F) << 21) | ((data[7 + bytesDecoded] & 0x7F) << 14) | ((data[8 + bytesDecoded] & 0x7F) << 7) | (data[9 + bytesDecoded] & 0x7F);
+                bytesDecoded += size + 10;
+            }
+            pos += bytesDecoded;
+            if (bytesDecoded == 0 && bytes < (int32_t)maxBlock) break; // decoder waits for data that will never come
+            continue;
+        }
+        if (bytesDecoded == 0 && codec != CODEC_VORBIS && codec != CODEC_FLAC) {
+            playing = false;
+            pos += 1;
+            continue;
+        }
+        pos += bytesDecoded;
+
+        uint32_t frames = dec->getOutputSamples();
+        if (codec == CODEC_AAC || codec == CODEC_M4A) frames /= std::max<uint8_t>(dec->getChannels(), 1);
+        if (!frames) {
+            if (bytesDecoded == 0) break; // no progress
+            continue;
+        }
+        account(frames, dt);
+    }
+    if (codec == CODEC_MP3) { // Audio::flushDecoder(), settings.MP3_PIPELINE holds back the last frame
+        uint64_t t0 = nowNs();
+        uint32_t frames = static_cast<MP3Decoder*>(dec.get())->flush(outBuff.data());
+        uint64_t dt = nowNs() - t0;
+        stats.decodeNs += dt;
+        if (frames) account(frames, dt);
+    }
+    stats.checksum = hash;
+    stats.heapPeak = host_shim::heap_peak();
+    dec.reset();
+    return synced;
+}
+
+} // namespace host
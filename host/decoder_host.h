@@ -0,0 +1,48 @@
+/*
+ * decoder_host.h
+ *
+ * Drives a Decoder subclass over a file in memory, the same way Audio::sendBytes() does on the target:
+ * findSyncWord() until the decoder is in sync, then decode(inbuf, bytesLeft, outbuf) until the data is exhausted.
+ * The container prologue that Audio parses itself (ID3, RIFF, fLaC metadata, MP4 atoms) is handled here.
+ *
+ */
+#pragma once
+
+#include "../src/Audio.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace host {
+
+enum codec_t : uint8_t { CODEC_NONE = 0, CODEC_WAV, CODEC_MP3, CODEC_AAC, CODEC_M4A, CODEC_FLAC, CODEC_OPUS, CODEC_VORBIS };
+
+struct DecodeStats {
+    codec_t  codec = CODEC_NONE;
+    uint8_t  channels = 0;
+    uint32_t sampleRate = 0;
+    uint8_t  bitsPerSample = 0;
+    uint32_t frames = 0;        // decode() calls that delivered PCM
+    uint64_t samples = 0;       // PCM frames (one sample per channel)
+    uint32_t errors = 0;        // decode() calls with res < 0
+    uint64_t decodeNs = 0;      // time spent inside decode() only
+    uint64_t maxFrameNs = 0;    // slowest single decode() call
+    uint64_t checksum = 0;      // FNV-1a 64 over the interleaved int32_t output
+    size_t   heapBase = 0;      // heap in use before the decoder was created
+    size_t   heapPeak = 0;      // peak heap while the decoder was alive
+    uint64_t heapSum = 0;       // sum of heap samples taken after every decode() call
+    uint32_t heapSamples = 0;
+};
+
+using PcmSink = std::function<void(const int32_t* pcm, size_t frames, uint8_t channels)>; // interleaved L/R, always 2 words per frame
+
+codec_t     codecFromPath(const char* path);
+const char* codecName(codec_t codec);
+
+std::unique_ptr<Decoder> createDecoder(Audio& audio, codec_t codec);
+bool                     readFile(const char* path, std::vector<uint8_t>& data);
+
+// Decodes the whole buffer, returns false if the decoder could not be initialized or never found a sync word.
+bool decodeBuffer(Audio& audio, codec_t codec, const std::vector<uint8_t>& data, DecodeStats& stats, const PcmSink& sink = nullptr);
+
+} // namespace host
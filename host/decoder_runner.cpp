@@ -0,0 +1,280 @@
+/*
+ * decoder_runner.cpp
+ *
+ * Decodes audio files on the host and prints throughput and a PCM checksum per file.
+ *
+ *   usage: decoder_runner [-n repeat] [-c checksums.txt] [-o out.raw] [-r reference] [-x ms] [file ...]
+ *
+ *   -n  decode every file n times, the fastest run is reported
+ *   -c  decode the files of a checksum table (see expected_checksums.txt) after the files of the command line, every
+ *       checksum that differs from the table fails the run. ctest runs the table of the fixtures.
+ *   -o  write the interleaved int32_t PCM of the (last) file, e.g. for a bit-exact comparison with cmp
+ *   -r  gapless check: the files are the tracks of the reference, split at the track boundaries.
+ *       Their PCM is joined and compared with the PCM of the reference: the sample count must match and
+ *       the joined PCM must not be shifted against the reference after any boundary (lag of the best
+ *       correlation) and must go on without a gap or a click: the error against the reference within one MP3
+ *       frame around a boundary may exceed the error of the whole file by 10 dB at most (lossless: no error),
+ *       e.g.  decoder_runner -r album.mp3 track1.mp3 track2.mp3. make_corpus.sh creates split tracks (gapless_*).
+ *   -x  crossfade the files one after the other over ms with the kernel of Audio::playChunk() (xfade_t::mix), after a
+ *       check of its gain curve (equal power within 1e-5, monotonic). With -o the result is written, as WAV if the name
+ *       ends with .wav. The buffering of Audio (xfadeHoldback, xfadeMix, XfadeBuff) is not part of the host build, the
+ *       tail of each file is mixed into the beginning of the next one directly.
+ *
+ * The codec is taken from the file extension (.mp3 .aac .m4a .flac .opus .ogg .wav).
+ *
+ */
+
+#include "decoder_host.h"
+#include <cmath>
+#include <string>
+
+struct RunItem {
+    std::string path;
+    bool        check = false; // from a checksum table
+    uint64_t    checksum = 0;
+};
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// table: one "path  checksum" per line, '#' starts a comment, relative paths are relative to the table
+static bool readChecksums(const char* table, std::vector<RunItem>& items) {
+    FILE* f = fopen(table, "r");
+    if (!f) return false;
+    std::string dir(table);
+    size_t      slash = dir.rfind('/');
+    dir = (slash == std::string::npos) ? "" : dir.substr(0, slash + 1);
+
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        char* hash = strchr(line, '#');
+        if (hash) *hash = 0;
+        char               path[384];
+        unsigned long long checksum;
+        if (sscanf(line, "%383s %llx", path, &checksum) != 2) continue;
+        items.push_back({path[0] == '/' ? std::string(path) : dir + path, true, checksum});
+    }
+    fclose(f);
+    return true;
+}
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// lag in [-maxLag, maxLag] with the best normalized correlation of a (L+R) window at pos, 0 if the window is silent
+static int32_t bestLag(const std::vector<int32_t>& ref, const std::vector<int32_t>& pcm, size_t pos, int32_t maxLag) {
+    const size_t window = 4096;
+    const size_t frames = std::min(ref.size(), pcm.size()) / 2;
+    if (pos < (size_t)maxLag || pos + window + maxLag > frames) return 0; // boundary too close to the start or the end
+    auto   mono = [](const std::vector<int32_t>& v, size_t i) { return ((double)v[2 * i] + v[2 * i + 1]) / 4294967296.0; };
+    double best = 0;
+    int    lag = 0;
+    for (int32_t l = -maxLag; l <= maxLag; l++) {
+        double xy = 0, xx = 0, yy = 0;
+        for (size_t i = pos; i < pos + window; i++) {
+            double x = mono(ref, i), y = mono(pcm, i + l);
+            xy += x * y;
+            xx += x * x;
+            yy += y * y;
+        }
+        double c = (xx > 0 && yy > 0) ? xy / sqrt(xx * yy) : 0;
+        if (c > best) {
+            best = c;
+            lag = l;
+        }
+    }
+    return lag;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// RMS of pcm - ref over the frames [from, to) in dB full scale, -200 if they are equal
+static double errorDb(const std::vector<int32_t>& ref, const std::vector<int32_t>& pcm, size_t from, size_t to) {
+    to = std::min(to, std::min(ref.size(), pcm.size()) / 2);
+    double sum = 0;
+    for (size_t i = 2 * from; i < 2 * to; i++) {
+        double e = ((double)pcm[i] - ref[i]) / 2147483648.0;
+        sum += e * e;
+    }
+    return (sum > 0 && to > from) ? 10 * log10(sum / (2 * (to - from))) : -200;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// gains of xfade_t::mix measured with a constant signal on one input and silence on the other
+static bool checkCrossfadeCurve(uint32_t len) {
+    const int32_t        a = 1 << 30;
+    std::vector<int32_t> one(len * 2, a), zero(len * 2, 0), gOut(zero), gIn(one);
+    audiolib::xfade_t::mix(gOut.data(), one.data(), len, 0, len); // outgoing only
+    audiolib::xfade_t::mix(gIn.data(), zero.data(), len, 0, len); // incoming only
+    const int32_t tol = a >> 20; // float gains, the rotation restarts every 32 frames
+    double        maxErr = 0;
+    bool          monotonic = true;
+    for (uint32_t i = 0; i < len; i++) {
+        double o = (double)gOut[2 * i] / a, n = (double)gIn[2 * i] / a;
+        maxErr = std::max(maxErr, fabs(o * o + n * n - 1.0));
+        if (i && (gOut[2 * i] > gOut[2 * i - 2] + tol || gIn[2 * i] < gIn[2 * i - 2] - tol)) monotonic = false;
+    }
+    bool ok = maxErr < 1e-5 && monotonic && gOut[0] >= a - 2 && gIn[0] == 0;
+    printf("crossfade: %u frames, power error %.2e, %s%s\n", len, maxErr, monotonic ? "monotonic" : "not monotonic", ok ? ", ok" : "  <-- FAILED");
+    return ok;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+static bool writeWav(const char* path, const std::vector<int32_t>& pcm, uint32_t sampleRate) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    uint32_t data = pcm.size() * sizeof(int32_t);
+    uint8_t  h[44] = {'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ', 16, 0, 0, 0, 1, 0, 2, 0};
+    auto     le = [&](int pos, uint32_t v, int n) { for (int k = 0; k < n; k++) h[pos + k] = v >> (8 * k); };
+    le(4, 36 + data, 4);
+    le(24, sampleRate, 4);
+    le(28, sampleRate * 8, 4); // byte rate, 2 channels * 4 bytes
+    le(32, 8, 2);              // block align
+    le(34, 32, 2);             // bits per sample
+    memcpy(h + 36, "data", 4);
+    le(40, data, 4);
+    fwrite(h, 1, sizeof(h), f);
+    fwrite(pcm.data(), sizeof(int32_t), pcm.size(), f);
+    fclose(f);
+    return true;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int main(int argc, char* argv[]) {
+    uint32_t    repeat = 1;
+    const char* pcmPath = nullptr;
+    const char* refPath = nullptr;
+    uint32_t    xfadeMs = 0;
+    const char* tablePath = nullptr;
+    int         i = 1;
+
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            repeat = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-c") && i + 1 < argc)
+            tablePath = argv[++i];
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+            pcmPath = argv[++i];
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc)
+            refPath = argv[++i];
+        else if (!strcmp(argv[i], "-x") && i + 1 < argc)
+            xfadeMs = std::max(1, atoi(argv[++i]));
+        else {
+            printf("unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    std::vector<RunItem> items;
+    for (; i < argc; i++) items.push_back({argv[i]});
+    if (tablePath && !readChecksums(tablePath, items)) {
+        printf("cannot read checksum table %s\n", tablePath);
+        return 2;
+    }
+    if (items.empty()) {
+        printf("usage: %s [-n repeat] [-c checksums.txt] [-o out.raw] [-r reference] [-x ms] [file ...]\n", argv[0]);
+        return 2;
+    }
+
+    Audio                audio;
+    int                  failed = 0;
+    std::vector<int32_t> joined;     // -r: PCM of all files back to back
+    std::vector<size_t>  boundaries; // -r: first frame of every file after the first one
+    std::vector<size_t>  starts;     // -x: first frame of every file in joined
+    std::vector<size_t>  rates;      // -x: sample rate of every file
+    const bool           collect = refPath || xfadeMs;
+
+    if (xfadeMs && !checkCrossfadeCurve(xfadeMs * 44100 / 1000)) failed++;
+
+    printf("%-8s %-40s %3s %6s %3s %7s %10s %10s %18s\n", "codec", "file", "ch", "rate", "bps", "frames", "frames/s", "errors", "checksum");
+    int mismatches = 0;
+    for (const RunItem& item : items) {
+        const char*          path = item.path.c_str();
+        host::codec_t        codec = host::codecFromPath(path);
+        std::vector<uint8_t> data;
+        if (codec == host::CODEC_NONE || !host::readFile(path, data)) {
+            printf("%-8s %-40s cannot be read\n", host::codecName(codec), path);
+            failed++;
+            continue;
+        }
+
+        FILE* pcm = (pcmPath && !xfadeMs) ? fopen(pcmPath, "wb") : nullptr;
+        if (refPath && joined.size()) boundaries.push_back(joined.size() / 2);
+        starts.push_back(joined.size() / 2);
+        auto sink = [&](const int32_t* buff, size_t frames, uint8_t) {
+            if (pcm) fwrite(buff, sizeof(int32_t) * 2, frames, pcm);
+            if (collect) joined.insert(joined.end(), buff, buff + frames * 2);
+        };
+
+        host::DecodeStats best;
+        bool              ok = true;
+        for (uint32_t r = 0; r < repeat && ok; r++) {
+            host::DecodeStats stats;
+            ok = host::decodeBuffer(audio, codec, data, stats, ((pcm || collect) && r == 0) ? host::PcmSink(sink) : nullptr);
+            if (r == 0 || stats.decodeNs < best.decodeNs) best = stats;
+        }
+        if (pcm) fclose(pcm);
+
+        const char* name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+        if (!ok || !best.frames) {
+            printf("%-8s %-40s no audio frames decoded\n", host::codecName(codec), name);
+            failed++;
+            starts.pop_back();
+            continue;
+        }
+        rates.push_back(best.sampleRate);
+        double fps = best.decodeNs ? best.frames * 1e9 / best.decodeNs : 0;
+        printf("%-8s %-40.40s %3u %6u %3u %7u %10.0f %10u 0x%016llx", host::codecName(codec), name, best.channels, best.sampleRate, best.bitsPerSample, best.frames, fps, best.errors,
+               (unsigned long long)best.checksum);
+        if (item.check && best.checksum != item.checksum) {
+            printf("  <-- expected 0x%016llx", (unsigned long long)item.checksum);
+            mismatches++;
+        }
+        printf("\n");
+    }
+    if (mismatches) {
+        printf("checksums: %d of the table differ\n", mismatches);
+        failed += mismatches;
+    }
+
+    if (xfadeMs && starts.size()) {
+        std::vector<int32_t> mixed(joined.begin(), joined.begin() + (starts.size() > 1 ? starts[1] : joined.size() / 2) * 2);
+        for (size_t f = 1; f < starts.size(); f++) {
+            size_t end = (f + 1 < starts.size() ? starts[f + 1] : joined.size() / 2);
+            size_t head = starts[f];
+            size_t len = std::min<size_t>({(size_t)xfadeMs * rates[f] / 1000, mixed.size() / 2, end - head});
+            if (rates[f] != rates[f - 1]) len = 0; // the runner has no resampler, Audio converts the tail in xfadeResample()
+            std::vector<int32_t> in(joined.begin() + head * 2, joined.begin() + end * 2);
+            audiolib::xfade_t::mix(in.data(), mixed.data() + mixed.size() - len * 2, len, 0, len);
+            mixed.resize(mixed.size() - len * 2);
+            mixed.insert(mixed.end(), in.begin(), in.end());
+            printf("crossfade: file %zu, %zu frames%s\n", f + 1, len, rates[f] != rates[f - 1] ? " (other sample rate, joined without fade)" : "");
+        }
+        printf("crossfade: %zu frames total\n", mixed.size() / 2);
+        if (pcmPath) {
+            size_t n = strlen(pcmPath);
+            if (n > 4 && !strcasecmp(pcmPath + n - 4, ".wav"))
+                writeWav(pcmPath, mixed, rates[0]);
+            else if (FILE* f = fopen(pcmPath, "wb")) {
+                fwrite(mixed.data(), sizeof(int32_t), mixed.size(), f);
+                fclose(f);
+            }
+        }
+    }
+
+    if (refPath) {
+        std::vector<int32_t> ref;
+        std::vector<uint8_t> data;
+        host::codec_t        codec = host::codecFromPath(refPath);
+        host::DecodeStats    stats;
+        auto                 sink = [&](const int32_t* buff, size_t frames, uint8_t) { ref.insert(ref.end(), buff, buff + frames * 2); };
+        if (codec == host::CODEC_NONE || !host::readFile(refPath, data) || !host::decodeBuffer(audio, codec, data, stats, sink)) {
+            printf("reference %s cannot be decoded\n", refPath);
+            return 1;
+        }
+        bool gapless = ref.size() == joined.size();
+        printf("\ngapless: reference %zu samples, joined %zu samples%s\n", ref.size() / 2, joined.size() / 2, gapless ? "" : "  <-- differ");
+        double body = errorDb(ref, joined, 0, SIZE_MAX); // lossy tracks are encoded apart, they differ a bit everywhere
+        for (size_t b : boundaries) {
+            int32_t lag = bestLag(ref, joined, b, 1152);
+            double  edge = errorDb(ref, joined, b > 1152 ? b - 1152 : 0, b + 1152); // a gap, a fade or a click shows up here
+            bool    click = edge > body + 10;
+            printf("gapless: boundary at sample %zu, lag %d, error %.1f dB (whole file %.1f dB)%s%s\n", b, lag, edge, body, lag ? "  <-- shifted" : "",
+                   click ? "  <-- not continuous" : "");
+            if (lag || click) gapless = false;
+        }
+        printf("gapless: %s\n", gapless ? "ok" : "FAILED");
+        if (!gapless) failed++;
+    }
+    return failed ? 1 : 0;
+}
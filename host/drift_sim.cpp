@@ -0,0 +1,142 @@
+/*
+ * drift_sim.cpp
+ *
+ * Simulates a web stream whose encoder clock differs from the I2S clock and the drift compensation of
+ * setDriftCompensation() (audiolib::drift_t steering audiolib::resampler_t) on a virtual clock.
+ *
+ *   usage: drift_sim [-s ppm] [-m minutes] [-b kbit/s] [-q quality]
+ *
+ *   -s  the encoder runs faster (+) or slower (-) than the I2S clock, default 150 and -150 (both are run)
+ *   -m  duration, default 180
+ *   -b  bitrate of the stream (CBR), default 128
+ *   -q  quality of the resampler 0 (linear) ... 3, default 0 (fastest, the controller does not depend on it)
+ *
+ * The server sends a burst of 64 KB and then the stream with the clock of the encoder, in TCP chunks of 0.5 ... 8 KB.
+ * InBuff holds 655350 bytes (AudioBuffer default), the decoder takes 1152 frames (MP3) whenever SamplesBuff (16384
+ * frames) has room, the I2S takes 256 frames (DMA_FRAME_NUM) every 256 / 44100 s. Without compensation InBuff drifts
+ * by the skew. With compensation its average may change by less than 100 ms from the first sixth of the time to the
+ * end (constant latency) and the estimated ppm (average of the last 10 minutes) must be within 10 % of the skew. The
+ * level is averaged over drift_t::SMOOTH s, the chunks make it jump.
+ *
+ */
+
+#include "decoder_host.h"
+#include <cmath>
+#include <random>
+
+using audiolib::drift_t;
+using audiolib::resampler_t;
+
+struct SimResult {
+    double   ppm = 0;          // average over the last 10 minutes
+    double   maxDevMs = 0;     // largest distance of the averaged level from the target after 10 minutes, ms of audio
+    double   endLevelMs = 0;   // averaged level at the end - averaged level after the first sixth of the time, ms of audio
+    uint64_t underruns = 0;    // I2S periods without enough frames
+    uint64_t stalls = 0;       // TCP chunks that did not fit into InBuff
+    uint32_t target = 0;       // bytes
+};
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+static SimResult simulate(double skew, double minutes, uint32_t kbps, uint8_t quality, bool compensate, bool verbose) {
+    const uint32_t rate = 44100, period = 256, block = 1152;
+    const uint32_t inBuffSize = 655350, samplesBuffSize = 16384, burst = 65536;
+    const double   byteRate = kbps * 1000.0 / 8;
+    const double   blockBytes = byteRate * block / rate; // bytes of one MP3 frame
+
+    SimResult   r;
+    resampler_t rs;
+    drift_t     drift;
+    std::mt19937 rnd(1);
+    std::vector<int32_t> in(block * 2), out((block + 8) * 2);
+    rs.setup(rate, rate, quality, true);
+    drift.f_enabled = true;
+    drift.start(true);
+
+    double   produced = burst;          // bytes the server has, the burst is there at once
+    double   delivered = 0, consumed = 0; // bytes to InBuff, bytes decoded
+    uint64_t samples = 0;                // frames in SamplesBuff
+    uint32_t chunk = 4096;
+    double   avg = -1, startLevel = -1, ppmSum = 0; // level averaged like drift_t::level
+    uint64_t ppmCount = 0;
+    uint64_t periods = (uint64_t)(minutes * 60 * rate / period);
+
+    for (uint64_t p = 0; p < periods; p++) {
+        double t = (double)p * period / rate;
+        produced = burst + byteRate * (1 + skew * 1e-6) * t;
+        while (produced - delivered >= chunk) { // network
+            if (delivered - consumed + chunk > inBuffSize) {
+                r.stalls++;
+                break;
+            }
+            delivered += chunk;
+            chunk = 512 + rnd() % 7681;
+        }
+        if (samples >= period) // I2S
+            samples -= period;
+        else if (p > 100) {
+            r.underruns++;
+            samples = 0;
+        }
+        while (samplesBuffSize - samples >= block + 8 && delivered - consumed >= blockBytes) { // decoder, cacheSamples()
+            uint32_t level = (uint32_t)(delivered - consumed);
+            consumed += blockBytes;
+            if (compensate) {
+                rs.setPpm(drift.update(level, byteRate, (float)block / rate));
+                samples += rs.process(in.data(), block, out.data());
+            } else {
+                samples += block;
+            }
+        }
+        double level = delivered - consumed, dt = (double)period / rate;
+        avg = avg < 0 ? level : avg + (level - avg) * dt / drift_t::SMOOTH;
+        if (startLevel < 0 && t >= minutes * 10) startLevel = avg; // after the first sixth, the controller has settled
+        if (compensate && drift.target && t > 600) r.maxDevMs = std::max(r.maxDevMs, fabs(drift.level - drift.target) / byteRate * 1000);
+        if (t > minutes * 60 - 600) {
+            ppmSum += drift.ppm;
+            ppmCount++;
+        }
+        if (verbose && p % (uint64_t)(600.0 * rate / period) == 0)
+            printf("  %4.0f min  InBuff %7.0f bytes, average %+7.1f ms  %+7.1f ppm\n", t / 60, level, startLevel < 0 ? 0 : (avg - startLevel) / byteRate * 1000,
+                   compensate ? drift.ppm : 0.0f);
+    }
+    r.ppm = ppmCount ? ppmSum / ppmCount : 0;
+    r.endLevelMs = (avg - startLevel) / byteRate * 1000;
+    r.target = drift.target;
+    return r;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int main(int argc, char* argv[]) {
+    std::vector<double> skews;
+    double              minutes = 180;
+    uint32_t            kbps = 128;
+    uint8_t             quality = resampler_t::LINEAR;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-s") && i + 1 < argc)
+            skews.push_back(atof(argv[++i]));
+        else if (!strcmp(argv[i], "-m") && i + 1 < argc)
+            minutes = std::max(1.0, atof(argv[++i]));
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc)
+            kbps = std::max(8, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-q") && i + 1 < argc)
+            quality = std::min(atoi(argv[++i]), (int)resampler_t::HIGH);
+        else {
+            printf("usage: %s [-s ppm] [-m minutes] [-b kbit/s] [-q quality]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (skews.empty()) skews = {150, -150};
+
+    int failed = 0;
+    for (double skew : skews) {
+        printf("encoder %+.0f ppm, %u kbit/s, %.0f minutes\n", skew, kbps, minutes);
+        SimResult off = simulate(skew, minutes, kbps, quality, false, false);
+        printf("  off: InBuff %+8.1f ms, %llu underruns, %llu stalls\n", off.endLevelMs, (unsigned long long)off.underruns, (unsigned long long)off.stalls);
+        SimResult on = simulate(skew, minutes, kbps, quality, true, true);
+        bool      ok = fabs(on.ppm - skew) < 0.1 * fabs(skew) + 5 && !on.underruns && !on.stalls && fabs(on.endLevelMs) < 100;
+        printf("  on:  InBuff %+8.1f ms, %llu underruns, %llu stalls, target %u bytes, largest deviation %.1f ms, estimate %+.1f ppm  %s\n\n", on.endLevelMs,
+               (unsigned long long)on.underruns, (unsigned long long)on.stalls, on.target, on.maxDevMs, on.ppm, ok ? "ok" : "<-- FAILED");
+        if (!ok) failed++;
+    }
+    return failed ? 1 : 0;
+}
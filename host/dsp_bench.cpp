@@ -0,0 +1,408 @@
+/*
+ * dsp_bench.cpp
+ *
+ * Compares the fused DSP kernel of Audio::processSamples() (audiolib::dsp_t) with the separate passes it replaced
+ * (calculateVUlevel, IIR_filter, stereo2mono, Gain, one loop each) for all 16 combinations of VU meter, EQ, mono
+ * downmix and volume/balance.
+ *
+ *   usage: dsp_bench [-n repeat]
+ *
+ *   -n  passes over the test signal (4096 frames, processed in blocks of DMA_FRAME_NUM frames) per combination, default 2000
+ *
+ * response  the frequency response of the EQ (eq_t: setTone and parametric bands) with the float and the fixed point
+ *           (settings.IIR_Q31) backend is measured with sine tones from 20 Hz to 20 kHz and compared with |H| of the float
+ *           coefficients. Both must be within 0.05 dB, the difference between the backends is given as noise in dBFS.
+ * former    the coefficients of the setTone() bands against those of esp-dsp that setTone() used before (the shelves take
+ *           QUALITY_SLOPE as slope S), the response must be within 0.01 dB
+ * glide     a band changes while a tone plays: the step in the output with new coefficients at once and with the glide,
+ *           which must be at least 12 dB smaller
+ * ramp      the volume fades out like gain_ramp() does it (one step per block): largest change of the gain from one sample
+ *           to the next with the gain of the former Gain() (per block) and with the ramp of the kernel, which must spread
+ *           every step over the frames of the block (no discontinuity at the block borders)
+ * bench     the EQ rows run with both backends, the former passes always use float (the 3 bands of setTone).
+ * bands     cost of the EQ with 0 ... 10 bands and per band, to estimate how many bands fit into the CPU budget.
+ *
+ * The output of both must be bit exact (PCM and VU sums), with EQ within 2^18 (-78 dBFS): Audio.h compiles with Ofast,
+ * the compiler may order the float operations of each biquad differently, the low shelf amplifies the rounding. With
+ * volume within 2^8: the former Gain() multiplied with float (24 bit mantissa), the kernel uses a Q30 gain. The float
+ * multiply vectorizes with SSE2, the Q30 ramp needs 32 x 32 -> 64 bit multiplies (SSE4.1, AVX2; MULL/MULSH on the Xtensa),
+ * on a plain x86-64 build the GAIN rows of the kernel stay scalar. The time is given in cycles per stereo
+ * frame (TSC on x86, else ns). The former passes call the biquad per sample like IIR_filter() called dsps_biquad_sf32(),
+ * it is not inlined.
+ *
+ */
+
+#include "decoder_host.h"
+#include "dsp.h"
+#include <cmath>
+#include <complex>
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+static inline uint64_t ticks() { return __rdtsc(); }
+static const char*     unit = "cycles";
+#else
+static inline uint64_t ticks() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+static const char* unit = "ns";
+#endif
+
+using audiolib::dsp_t;
+using audiolib::eq_t;
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// the passes of playChunk() before the fused kernel
+__attribute__((noinline)) static void biquad_sf32(float* s, const float* c, float* w) { // dsps_biquad_sf32(s, s, 1, c, w), ansi version
+    float d0 = s[0] - c[3] * w[0] - c[4] * w[1];
+    s[0] = c[0] * d0 + c[1] * w[0] + c[2] * w[1];
+    w[1] = w[0];
+    w[0] = d0;
+    d0 = s[1] - c[3] * w[2] - c[4] * w[3];
+    s[1] = c[0] * d0 + c[1] * w[2] + c[2] * w[3];
+    w[3] = w[2];
+    w[2] = d0;
+}
+__attribute__((noinline)) static void vuPass(int32_t* buff, size_t len, audiolib::vu_items_t& vu) {
+    for (size_t i = 0; i < len / 2; i++) {
+        uint8_t l = audiolib::dsp::toVU(buff[i * 2]);
+        uint8_t r = audiolib::dsp::toVU(buff[i * 2 + 1]);
+        vu.sumL += l;
+        vu.sumR += r;
+        if (l > vu.maxLeft) vu.maxLeft = l;
+        if (r > vu.maxRight) vu.maxRight = r;
+        vu.samps_count++;
+        if (vu.samps_count >= vu.samps_vu) vu.samps_count = 0; // window complete, evaluated by calculateVUlevel()
+    }
+}
+__attribute__((noinline)) static void iirPass(int32_t* buff, size_t len, audiolib::audioItems_t& a) {
+    eq_t& eq = a.eq;
+    float s[2];
+    for (size_t i = 0; i < len / 2; i++) {
+        int32_t* s32 = buff + (i * 2);
+        s[0] = (float)(s32[0] * eq.pre_gain);
+        s[1] = (float)(s32[1] * eq.pre_gain);
+        for (uint8_t k = 0; k < eq.stages; k++) biquad_sf32(s, eq.coeffs[eq.stage[k]], eq.state[eq.stage[k]]);
+        s32[0] = (int32_t)std::clamp(s[0], -2147483648.0f, 2147483647.0f);
+        s32[1] = (int32_t)std::clamp(s[1], -2147483648.0f, 2147483647.0f);
+    }
+}
+__attribute__((noinline)) static void monoPass(int32_t* buff, size_t len) {
+    for (size_t i = 0; i < len; i += 2) buff[i] = buff[i + 1] = (int32_t)(((int64_t)buff[i] + buff[i + 1]) >> 1);
+}
+__attribute__((noinline)) static void gainPass(int32_t* buff, size_t len, audiolib::audioItems_t& a) {
+    for (size_t i = 0; i < len / 2; i++) {
+        buff[i * 2] *= a.limiter[0];
+        buff[i * 2 + 1] *= a.limiter[1];
+    }
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// the three bands of Audio::setTone() (default settings: lowshelf 500 Hz, peakingEQ 1800 Hz, highshelf 6000 Hz, Q 0.707)
+static std::vector<eq_t::band_t> tone(float ls, float peq, float hs) {
+    return {{eq_t::LOWSHELF, 500, 0.707f, ls}, {eq_t::PEAK, 1800, 0.707f, peq}, {eq_t::HIGHSHELF, 6000, 0.707f, hs}};
+}
+static void setBands(audiolib::audioItems_t& a, const std::vector<eq_t::band_t>& bands, float fs) {
+    for (auto& b : a.eq.band) b = {};
+    for (size_t i = 0; i < bands.size() && i < eq_t::MAX_BANDS; i++) a.eq.band[i] = bands[i];
+    a.eq.update(fs, false);
+}
+static void setup(audiolib::audioItems_t& a, audiolib::vu_items_t& vu) {
+    a = audiolib::audioItems_t{};
+    setBands(a, tone(6, -3, 4), 44100);
+    a.limiter[0] = 0.5f;
+    a.limiter[1] = 0.35f;
+    a.gain[0] = audiolib::dsp::toGain(a.limiter[0]); // no ramp
+    a.gain[1] = audiolib::dsp::toGain(a.limiter[1]);
+    vu.reset();
+    vu.samps_vu = 2048; // 16 * 256 / 2, see calculateVUlevel()
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// gain in dB of the EQ at the frequencies of bins m / M: measured with both backends and |H| of the float coefficients
+// (where |H| is above -40 dB)
+static bool response(const char* name, const std::vector<eq_t::band_t>& bands) {
+    const double           fs = 44100, amp = 0.5 * 2147483647.0;
+    const size_t           M = 8192; // settle M frames, measure over the next M frames (whole periods)
+    double                 errFloat = 0, errQ31 = 0, noise = 0;
+    audiolib::audioItems_t a;
+    setBands(a, bands, fs);
+    for (size_t m = 4; m < M / 2 * 20000 / 22050; m = std::max(m + 1, m * 9 / 8)) {
+        double w = 2 * M_PI * m / M, H = a.eq.pre_gain;
+        for (uint8_t k = 0; k < a.eq.stages; k++) H *= eq_t::magnitude(a.eq.coeffs[a.eq.stage[k]], w);
+        double               want = 20 * log10(H), got[2];
+        std::vector<int32_t> out[2];
+        for (int q = 0; q < 2; q++) {
+            audiolib::vu_items_t vu;
+            dsp_t                dsp;
+            dsp.select(q ? dsp_t::EQ | dsp_t::Q31 : dsp_t::EQ, a);
+            out[q].resize(4 * M);
+            for (size_t i = 0; i < 2 * M; i++) out[q][2 * i] = out[q][2 * i + 1] = (int32_t)(amp * sin(w * i));
+            dsp.kernel(out[q].data(), 2 * M, a, vu);
+            double re = 0, im = 0;
+            for (size_t i = M; i < 2 * M; i++) {
+                re += out[q][2 * i] * cos(w * i);
+                im += out[q][2 * i] * sin(w * i);
+            }
+            got[q] = 20 * log10(2 * sqrt(re * re + im * im) / M / amp + 1e-12);
+        }
+        double e2 = 0;
+        for (size_t i = 2 * M; i < 4 * M; i++) e2 += ((double)out[1][i] - out[0][i]) * ((double)out[1][i] - out[0][i]);
+        if (want > -40) {
+            errFloat = std::max(errFloat, fabs(got[0] - want));
+            errQ31 = std::max(errQ31, fabs(got[1] - want));
+        }
+        noise = std::max(noise, sqrt(e2 / (2 * M)) / 2147483648.0);
+    }
+    bool ok = errFloat < 0.05 && errQ31 < 0.05;
+    printf("response: %-36s %2u stages, pre gain %5.1f dB  max error float %.4f dB, Q31 %.4f dB, Q31 - float %6.1f dBFS  %s\n", name, a.eq.stages, 20 * log10(a.eq.pre_gain), errFloat, errQ31,
+           20 * log10(noise + 1e-12), ok ? "ok" : "<-- FAILED");
+    return ok;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// the coefficients of setTone() before the parametric EQ: dsps_biquad_gen_lowShelf_f32() / highShelf_f32() of esp-dsp (ansi
+// version, settings.QUALITY_SLOPE as slope) and the peaking EQ of the former IIR_calculateCoefficients(), f = freq / fs
+static void formerCoeffs(uint8_t type, float f, float gain, float qFactor, float* c) {
+    float w0 = 2 * M_PI * f, cs = cosf(w0), sn = sinf(w0), b0, b1, b2, a0, a1, a2;
+    if (type == eq_t::PEAK) {
+        float A = powf(10.0f, gain / 40.0f), alpha = sn / (2.0f * qFactor);
+        b0 = 1.0f + alpha * A, b1 = -2.0f * cs, b2 = 1.0f - alpha * A, a0 = 1.0f + alpha / A, a1 = -2.0f * cs, a2 = 1.0f - alpha / A;
+    } else {
+        float A = sqrtf(pow(10, (double)gain / 20.0)), alpha = sn / 2 * sqrt((A + 1 / A) * (1 / qFactor - 1) + 2);
+        if (type == eq_t::LOWSHELF) {
+            b0 = A * ((A + 1) - (A - 1) * cs + 2 * sqrtf(A) * alpha), b1 = 2 * A * ((A - 1) - (A + 1) * cs), b2 = A * ((A + 1) - (A - 1) * cs - 2 * sqrtf(A) * alpha);
+            a0 = (A + 1) + (A - 1) * cs + 2 * sqrtf(A) * alpha, a1 = -2 * ((A - 1) + (A + 1) * cs), a2 = (A + 1) + (A - 1) * cs - 2 * sqrtf(A) * alpha;
+        } else {
+            b0 = A * ((A + 1) + (A - 1) * cs + 2 * sqrtf(A) * alpha), b1 = -2 * A * ((A - 1) + (A + 1) * cs), b2 = A * ((A + 1) + (A - 1) * cs - 2 * sqrtf(A) * alpha);
+            a0 = (A + 1) - (A - 1) * cs + 2 * sqrtf(A) * alpha, a1 = 2 * ((A - 1) - (A + 1) * cs), a2 = (A + 1) - (A - 1) * cs - 2 * sqrtf(A) * alpha;
+        }
+    }
+    c[0] = b0 / a0, c[1] = b1 / a0, c[2] = b2 / a0, c[3] = a1 / a0, c[4] = a2 / a0;
+}
+// the three bands of setTone() from eq_t against the former coefficients, -12 ... +12 dB, for several QUALITY_SLOPE and
+// sample rates: largest difference of the coefficients and of |H| on a log grid from 20 Hz to 20 kHz
+static bool former() {
+    double maxCoeff = 0, maxDb = 0;
+    for (float fs : {22050.0f, 44100.0f, 48000.0f})
+        for (float q : {0.5f, 0.707f, 1.0f})
+            for (int g = -12; g <= 12; g++)
+                for (auto band : tone(g, g, g)) {
+                    band.q = q;
+                    float ref[5], c[5];
+                    formerCoeffs(band.type, band.freq / fs, g, q, ref);
+                    eq_t::biquadCoeffs(band, fs, c);
+                    for (int k = 0; k < 5; k++) maxCoeff = std::max(maxCoeff, (double)fabsf(c[k] - ref[k]));
+                    for (int i = 0; i < 64; i++) {
+                        double f = 20.0 * pow(1000.0, i / 63.0);
+                        if (f >= 0.5 * fs) break;
+                        double w = 2 * M_PI * f / fs;
+                        maxDb = std::max(maxDb, fabs(20 * log10(eq_t::magnitude(c, w) / eq_t::magnitude(ref, w))));
+                    }
+                }
+    bool ok = maxDb < 0.01;
+    printf("former:   setTone bands against the esp-dsp coefficients, max coefficient diff %.2e, max response diff %.4f dB  %s\n", maxCoeff, maxDb, ok ? "ok" : "<-- FAILED");
+    return ok;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// a 100 Hz tone while the low shelf jumps from -12 to +12 dB: largest second difference after the change relative to the
+// steady state, with new coefficients at once and with the glide of eq_t
+static bool glide() {
+    const size_t block = 256, frames = 32 * block, change = 8 * block;
+    double       result[2];
+    for (int g = 0; g < 2; g++) {
+        audiolib::audioItems_t a;
+        audiolib::vu_items_t   vu;
+        dsp_t                  dsp;
+        std::vector<int32_t>   buff(frames * 2);
+        for (size_t i = 0; i < frames; i++) buff[2 * i] = buff[2 * i + 1] = (int32_t)(0.25 * 2147483647.0 * sin(2 * M_PI * 100 * i / 44100));
+        setBands(a, {{eq_t::LOWSHELF, 200, 0.707f, -12}}, 44100);
+        dsp.select(dsp_t::EQ, a);
+        for (size_t pos = 0; pos < frames; pos += block) {
+            if (pos == change) {
+                a.eq.band[0].gain = 12;
+                a.eq.update(44100, g);
+            }
+            dsp.kernel(buff.data() + 2 * pos, block, a, vu);
+        }
+        auto d2 = [&](size_t from, size_t to) {
+            double m = 0;
+            for (size_t i = from; i < to; i++) m = std::max(m, fabs((double)buff[2 * i + 2] - 2.0 * buff[2 * i] + buff[2 * i - 2]));
+            return m;
+        };
+        result[g] = 20 * log10(d2(change, change + 4 * block) / d2(frames - 8 * block, frames - 1));
+    }
+    bool ok = result[1] < result[0] - 12; // glide at least 12 dB quieter
+    printf("glide:    lowshelf -12 -> +12 dB, largest step at the change %+.1f dB at once, %+.1f dB with glide  %s\n", result[0], result[1], ok ? "ok" : "<-- FAILED");
+    return ok;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// a DC signal while the volume goes from 21 to 0 in steps of 1 per block (default volume curve of calculateVolumeLimits()),
+// largest change of the gain (output / input) between two samples, stepped like the former Gain() and with the kernel
+static bool ramp() {
+    const size_t  block = 256, blocks = 32, steps = 21;
+    const int32_t dc = 1 << 30;
+    double        result[2];
+    auto          limiter = [&](size_t b) { // volume 21 - b of 21
+        double t = b < steps ? 1.0 - (double)b / steps : 0;
+        return t ? (float)pow(10, (-112 * t * t * t + 172 * t * t - 60) / 20) : 0.0f;
+    };
+    for (int k = 0; k < 2; k++) {
+        audiolib::audioItems_t a;
+        audiolib::vu_items_t   vu;
+        dsp_t                  dsp;
+        std::vector<int32_t>   buff(block * blocks * 2, dc);
+        a.gain[0] = a.gain[1] = dsp_t::GAIN_ONE;
+        dsp.select(dsp_t::GAIN, a);
+        for (size_t b = 0; b < blocks; b++) {
+            a.limiter[0] = a.limiter[1] = limiter(b);
+            if (k)
+                dsp.kernel(buff.data() + b * block * 2, block, a, vu);
+            else
+                gainPass(buff.data() + b * block * 2, block * 2, a);
+        }
+        double m = 0;
+        for (size_t i = 1; i < block * blocks; i++) m = std::max(m, fabs((double)buff[2 * i] - buff[2 * i - 2]) / dc);
+        result[k] = m;
+    }
+    bool ok = result[1] < result[0] / block * 1.01 + 1e-7;
+    printf("ramp:     volume 21 -> 0, largest gain step between two samples %.5f per block, %.7f with ramp (%.0f dB)  %s\n", result[0], result[1], 20 * log10(result[1] / result[0]),
+           ok ? "ok" : "<-- FAILED");
+    return ok;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// cycles/frame of the EQ alone with 0...MAX_BANDS peaking bands, both backends
+static void bands(const std::vector<int32_t>& sig, uint32_t repeat) {
+    printf("\n%-8s %18s %18s\n", "bands", (std::string(unit) + "/frame float").c_str(), (std::string(unit) + "/frame Q31").c_str());
+    double first[2] = {}, last[2] = {};
+    for (int n = 0; n <= eq_t::MAX_BANDS; n++) {
+        std::vector<eq_t::band_t> b;
+        for (int i = 0; i < n; i++) b.push_back({eq_t::PEAK, 31.25f * (1 << i), 1.41f, i & 1 ? -3.0f : 3.0f});
+        double perFrame[2];
+        for (int q = 0; q < 2; q++) {
+            audiolib::audioItems_t a;
+            audiolib::vu_items_t   vu;
+            dsp_t                  dsp;
+            std::vector<int32_t>   buff(sig.size());
+            uint64_t               t = 0;
+            setBands(a, b, 44100);
+            dsp.select(q ? dsp_t::EQ | dsp_t::Q31 : dsp_t::EQ, a);
+            for (uint32_t r = 0; r < repeat; r++) {
+                memcpy(buff.data(), sig.data(), sig.size() * sizeof(int32_t));
+                uint64_t t0 = ticks();
+                for (size_t pos = 0; pos < buff.size(); pos += 512) dsp.kernel(buff.data() + pos, 256, a, vu);
+                t += ticks() - t0;
+            }
+            perFrame[q] = (double)t / ((double)repeat * sig.size() / 2);
+            if (n == 1) first[q] = perFrame[q];
+            last[q] = perFrame[q];
+        }
+        printf("%-8d %18.2f %18.2f\n", n, perFrame[0], perFrame[1]);
+    }
+    printf("%-8s %18.2f %18.2f\n", "per band", (last[0] - first[0]) / (eq_t::MAX_BANDS - 1), (last[1] - first[1]) / (eq_t::MAX_BANDS - 1));
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+struct Run {
+    double               perFrame;
+    std::vector<int32_t> pcm; // output of the first pass
+    uint64_t             sumL, sumR;
+};
+
+static Run run(uint8_t flags, bool fused, const std::vector<int32_t>& sig, uint32_t repeat) {
+    const size_t           block = 256; // DMA_FRAME_NUM
+    audiolib::audioItems_t a;
+    audiolib::vu_items_t   vu;
+    dsp_t                  dsp;
+    std::vector<int32_t>   buff(sig.size());
+    Run                    r{};
+    uint64_t               t = 0;
+
+    setup(a, vu);
+    dsp.select(flags, a);
+    for (uint32_t n = 0; n < repeat; n++) {
+        memcpy(buff.data(), sig.data(), sig.size() * sizeof(int32_t));
+        for (size_t pos = 0; pos < buff.size(); pos += block * 2) {
+            int32_t* p = buff.data() + pos;
+            uint64_t t0 = ticks();
+            if (fused) { // processSamples()
+                for (size_t frames = block; frames;) {
+                    size_t k = frames;
+                    if (flags & dsp_t::VU) k = std::min<size_t>(k, vu.samps_vu - vu.samps_count);
+                    dsp.kernel(p, k, a, vu);
+                    if ((flags & dsp_t::VU) && vu.samps_count >= vu.samps_vu) vu.samps_count = 0;
+                    p += k * 2;
+                    frames -= k;
+                }
+            } else {
+                if (flags & dsp_t::VU) vuPass(p, block * 2, vu);
+                if (flags & dsp_t::EQ) iirPass(p, block * 2, a);
+                if (flags & dsp_t::MONO) monoPass(p, block * 2);
+                if (flags & dsp_t::GAIN) gainPass(p, block * 2, a);
+            }
+            t += ticks() - t0;
+        }
+        if (n == 0) {
+            r.pcm = buff;
+            r.sumL = vu.sumL;
+            r.sumR = vu.sumR;
+        }
+    }
+    r.perFrame = (double)t / ((double)repeat * sig.size() / 2);
+    return r;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int main(int argc, char* argv[]) {
+    uint32_t repeat = 2000;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            repeat = std::max(1, atoi(argv[++i]));
+        else {
+            printf("usage: %s [-n repeat]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<int32_t> sig(4096 * 2); // two tones and noise, about -6 dBFS
+    uint32_t             rnd = 1;
+    for (size_t i = 0; i < sig.size() / 2; i++) {
+        rnd = rnd * 1664525 + 1013904223;
+        double noise = (int32_t)rnd / 2147483648.0 * 0.05;
+        sig[2 * i] = (int32_t)(0.45 * 2147483647.0 * (sin(2 * M_PI * 440 * i / 44100) * 0.8 + noise));
+        sig[2 * i + 1] = (int32_t)(0.45 * 2147483647.0 * (sin(2 * M_PI * 3000 * i / 44100) * 0.8 - noise));
+    }
+
+    int failed = 0;
+    std::vector<eq_t::band_t> graphic, filters = {{eq_t::HIGHPASS, 40, 0.707f}, {eq_t::NOTCH, 1000, 4}, {eq_t::LOWPASS, 15000, 0.707f}, {eq_t::PEAK, 100, 1, 6}};
+    for (int i = 0; i < eq_t::MAX_BANDS; i++) graphic.push_back({eq_t::PEAK, 31.25f * (1 << i), 1.41f, i & 1 ? -6.0f : 6.0f});
+    if (!response("setTone(6, -3, 4)", tone(6, -3, 4))) failed++;
+    if (!response("setTone(12, 0, 12)", tone(12, 0, 12))) failed++;
+    if (!response("setTone(-12, 12, -12)", tone(-12, 12, -12))) failed++;
+    if (!response("10 bands +-6 dB, 31 Hz ... 16 kHz", graphic)) failed++;
+    if (!response("highpass, notch, lowpass, peak", filters)) failed++;
+    if (!response("bandpass 2 kHz", {{eq_t::BANDPASS, 2000, 1}})) failed++;
+    if (!response("highshelf +24 dB 1 kHz, S 1", {{eq_t::HIGHSHELF, 1000, 1, 24}})) failed++;
+    if (!response("lowshelf -24 dB, highshelf +24 dB", {{eq_t::LOWSHELF, 200, 1, -24}, {eq_t::HIGHSHELF, 8000, 1, 24}})) failed++;
+    if (!response("peak +24 dB 1 kHz, Q 0.5", {{eq_t::PEAK, 1000, 0.5f, 24}})) failed++;
+    if (!response("peak -24 dB 60 Hz, Q 4", {{eq_t::PEAK, 60, 4, -24}})) failed++;
+    if (!former()) failed++;
+    if (!glide()) failed++;
+    if (!ramp()) failed++;
+
+    printf("\n%-20s %16s %16s %8s  %s\n", "stages", (std::string(unit) + "/frame sep.").c_str(), (std::string(unit) + "/frame fused").c_str(), "speedup", "output");
+    for (uint8_t f = 0; f < 32; f++) {
+        if ((f & dsp_t::Q31) && !(f & dsp_t::EQ)) continue; // the backend only counts with EQ
+        char name[32];
+        snprintf(name, sizeof(name), "%s%s%s%s", f & dsp_t::VU ? "VU " : "", f & dsp_t::EQ ? (f & dsp_t::Q31 ? "EQ(Q31) " : "EQ ") : "", f & dsp_t::MONO ? "MONO " : "", f & dsp_t::GAIN ? "GAIN" : "");
+        if (!f) strcpy(name, "-");
+        Run     sep = run(f, false, sig, repeat);
+        Run     fused = run(f, true, sig, repeat);
+        int64_t maxDiff = 0;
+        for (size_t i = 0; i < sig.size(); i++) maxDiff = std::max(maxDiff, std::abs((int64_t)sep.pcm[i] - fused.pcm[i]));
+        bool ok = maxDiff <= ((f & dsp_t::EQ) ? (1 << 18) : (f & dsp_t::GAIN) ? (1 << 8) : 0) && sep.sumL == fused.sumL && sep.sumR == fused.sumR;
+        if (!ok) failed++;
+        char out[40];
+        snprintf(out, sizeof(out), maxDiff ? "max diff %lld" : "bit exact", (long long)maxDiff);
+        printf("%-20s %16.2f %16.2f %7.2fx  %s%s\n", name, sep.perFrame, fused.perFrame, fused.perFrame > 0 ? sep.perFrame / fused.perFrame : 0, out, ok ? "" : "  <-- FAILED");
+    }
+    bands(sig, repeat / 4 + 1);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,205 @@
+/*
+ * host_shim.cpp
+ *
+ * Link-time counterpart of the headers in host/shim.
+ * Provides the heap accounting behind ps_malloc() and the I2S channel that Audio.cpp writes to.
+ *
+ */
+
+#include "../src/Audio.h"
+#include <atomic>
+#include <malloc.h>
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// 📌📌📌  H E A P   📌📌📌
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+
+namespace host_shim {
+
+static size_t s_heapPeak = 0;
+
+size_t heap_in_use() {
+    struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd; // arena + mmap'ed blocks
+}
+
+static void heap_track() {
+    size_t used = heap_in_use();
+    if (used > s_heapPeak) s_heapPeak = used;
+}
+
+void* heap_alloc(size_t size, bool zero) {
+    void* p = zero ? calloc(1, size) : malloc(size);
+    heap_track();
+    return p;
+}
+
+void* heap_realloc(void* ptr, size_t size) {
+    void* p = realloc(ptr, size);
+    heap_track();
+    return p;
+}
+
+size_t heap_peak() {
+    heap_track();
+    return s_heapPeak;
+}
+
+void heap_reset_peak() { s_heapPeak = heap_in_use(); }
+
+} // namespace host_shim
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// 📌📌📌  I 2 S   📌📌📌
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+
+// The DMA is a clock: every dma_frame_num / sample_rate (divided by the speed) it takes one buffer of the queued bytes
+// (or sends zeros) and raises on_sent, from its own thread like the ISR on the target. i2s_channel_write() waits up to
+// its timeout for room among the dma_desc_num buffers.
+
+struct i2s_channel_obj_t {
+    i2s_chan_config_t       chan_cfg;
+    i2s_std_config_t        std_cfg = {};
+    i2s_event_callbacks_t   cbs = {};
+    void*                   user_ctx = nullptr;
+    bool                    enabled = false;
+    size_t                  queued = 0; // bytes written and not yet sent
+    std::mutex              mtx;
+    std::condition_variable cv;
+    std::thread             dma;
+
+    explicit i2s_channel_obj_t(const i2s_chan_config_t& cfg) : chan_cfg(cfg) {}
+    size_t   descBytes() const { // bytes of one DMA buffer
+        size_t channels = std_cfg.slot_cfg.slot_mode == I2S_SLOT_MODE_MONO ? 1 : 2;
+        size_t bits = std_cfg.slot_cfg.data_bit_width ? std_cfg.slot_cfg.data_bit_width : 32;
+        return chan_cfg.dma_frame_num * channels * bits / 8;
+    }
+};
+
+namespace host_shim {
+
+static i2s_sink_t         s_sink = nullptr;
+static void*              s_sinkCtx = nullptr;
+static std::atomic<float> s_speed{1.0f};
+
+void i2s_set_sink(i2s_sink_t sink, void* ctx) {
+    s_sink = sink;
+    s_sinkCtx = ctx;
+}
+
+void i2s_set_speed(float speed) { s_speed = speed > 0 ? speed : 1.0f; }
+
+static void i2s_dma(i2s_chan_handle_t handle) {
+    auto next = std::chrono::steady_clock::now();
+    while (true) {
+        size_t desc;
+        {
+            std::unique_lock<std::mutex> lock(handle->mtx);
+            uint32_t rate = handle->std_cfg.clk_cfg.sample_rate_hz ? handle->std_cfg.clk_cfg.sample_rate_hz : 44100;
+            next += std::chrono::nanoseconds((int64_t)(1e9 * handle->chan_cfg.dma_frame_num / rate / s_speed));
+            if (handle->cv.wait_until(lock, next, [handle] { return !handle->enabled; })) return;
+            if (std::chrono::steady_clock::now() - next > std::chrono::milliseconds(20)) next = std::chrono::steady_clock::now(); // the host was busy
+            desc = handle->descBytes();
+            handle->queued -= std::min(handle->queued, desc);
+        }
+        handle->cv.notify_all(); // room for i2s_channel_write()
+        i2s_event_data_t event = {nullptr, desc};
+        if (handle->cbs.on_sent) handle->cbs.on_sent(handle, &event, handle->user_ctx);
+    }
+}
+
+} // namespace host_shim
+
+esp_err_t i2s_new_channel(const i2s_chan_config_t* chan_cfg, i2s_chan_handle_t* tx_handle, i2s_chan_handle_t* rx_handle) {
+    if (!chan_cfg || !tx_handle || rx_handle) return ESP_ERR_INVALID_ARG; // tx only
+    *tx_handle = new i2s_channel_obj_t(*chan_cfg);
+    return ESP_OK;
+}
+
+esp_err_t i2s_del_channel(i2s_chan_handle_t handle) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    if (handle->enabled) return ESP_ERR_INVALID_STATE;
+    delete handle;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_init_std_mode(i2s_chan_handle_t handle, const i2s_std_config_t* std_cfg) {
+    if (!handle || !std_cfg) return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> lock(handle->mtx);
+    handle->std_cfg = *std_cfg;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_reconfig_std_clock(i2s_chan_handle_t handle, const i2s_std_clk_config_t* clk_cfg) {
+    if (!handle || !clk_cfg) return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> lock(handle->mtx);
+    handle->std_cfg.clk_cfg = *clk_cfg;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_reconfig_std_slot(i2s_chan_handle_t handle, const i2s_std_slot_config_t* slot_cfg) {
+    if (!handle || !slot_cfg) return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> lock(handle->mtx);
+    handle->std_cfg.slot_cfg = *slot_cfg;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_reconfig_std_gpio(i2s_chan_handle_t handle, const i2s_std_gpio_config_t* gpio_cfg) {
+    if (!handle || !gpio_cfg) return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> lock(handle->mtx);
+    handle->std_cfg.gpio_cfg = *gpio_cfg;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_register_event_callback(i2s_chan_handle_t handle, const i2s_event_callbacks_t* callbacks, void* user_data) {
+    if (!handle || !callbacks) return ESP_ERR_INVALID_ARG;
+    if (handle->enabled) return ESP_ERR_INVALID_STATE;
+    handle->cbs = *callbacks;
+    handle->user_ctx = user_data;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_enable(i2s_chan_handle_t handle) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    if (handle->enabled) return ESP_ERR_INVALID_STATE;
+    handle->enabled = true;
+    handle->queued = 0;
+    handle->dma = std::thread(host_shim::i2s_dma, handle);
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_disable(i2s_chan_handle_t handle) { // what is still queued is lost, as on the target
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    {
+        std::lock_guard<std::mutex> lock(handle->mtx);
+        if (!handle->enabled) return ESP_ERR_INVALID_STATE;
+        handle->enabled = false;
+    }
+    handle->cv.notify_all();
+    handle->dma.join();
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_preload_data(i2s_chan_handle_t tx_handle, const void*, size_t size, size_t* bytes_loaded) {
+    if (!tx_handle || !bytes_loaded) return ESP_ERR_INVALID_ARG;
+    if (tx_handle->enabled) return ESP_ERR_INVALID_STATE;
+    *bytes_loaded = size; // the preload is silence, it is not passed to the sink
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_write(i2s_chan_handle_t handle, const void* src, size_t size, size_t* bytes_written, uint32_t timeout_ms) {
+    if (!handle || !src || !bytes_written) return ESP_ERR_INVALID_ARG;
+    *bytes_written = 0;
+    std::unique_lock<std::mutex> lock(handle->mtx);
+    if (!handle->enabled) return ESP_ERR_INVALID_STATE;
+    size_t   capacity = handle->chan_cfg.dma_desc_num * handle->descBytes();
+    uint32_t sampleRate = handle->std_cfg.clk_cfg.sample_rate_hz;
+    auto     deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    if (!handle->cv.wait_until(lock, deadline, [handle, capacity, size] { return !handle->enabled || handle->queued + size <= capacity; })) return ESP_ERR_TIMEOUT;
+    if (!handle->enabled) return ESP_ERR_INVALID_STATE;
+    handle->queued += size;
+    lock.unlock();
+    if (host_shim::s_sink) host_shim::s_sink(src, size, sampleRate, host_shim::s_sinkCtx); // as written, at the rate of the clock
+    *bytes_written = size;
+    return ESP_OK;
+}
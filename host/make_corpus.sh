@@ -0,0 +1,53 @@
+#!/bin/sh
+# Creates the encoded files of bench_corpus.txt in host/corpus from one source file (default: the WAV fixture).
+# Needs ffmpeg built with libmp3lame, libfdk_aac (HE-AAC) or the native aac encoder, flac, libopus and libvorbis.
+# Files that cannot be encoded with the installed tools are skipped, decoder_bench lists them as missing.
+# flac24_96k_synth.flac needs no encoder, only the host build (MAKE_FLAC, default ../build/host/make_flac).
+#
+#   host/make_corpus.sh [source.wav]
+
+cd "$(dirname "$0")" || exit 1
+SRC=${1:-../additional_info/Testfiles/Pink-Panther.wav}
+OUT=corpus
+mkdir -p "$OUT"
+
+# synthetic 24/96 FLAC, written by make_flac of the host build without an external encoder
+MAKE_FLAC=${MAKE_FLAC:-../build/host/make_flac}
+if [ -x "$MAKE_FLAC" ] && "$MAKE_FLAC" -b 24 -r 96000 -s 30 "$OUT/flac24_96k_synth.flac" >/dev/null; then echo "created $OUT/flac24_96k_synth.flac"; else echo "skipped $OUT/flac24_96k_synth.flac"; fi
+
+command -v ffmpeg >/dev/null 2>&1 || { echo "ffmpeg not found"; exit 1; }
+
+enc() { # enc <output> <ffmpeg options...>
+    out=$OUT/$1; shift
+    if ffmpeg -hide_banner -loglevel error -y -i "$SRC" "$@" "$out"; then echo "created $out"; else echo "skipped $out"; rm -f "$out"; fi
+}
+
+enc mp3_cbr128.mp3    -c:a libmp3lame -b:a 128k
+enc mp3_cbr320.mp3    -c:a libmp3lame -b:a 320k
+enc mp3_vbr0.mp3      -c:a libmp3lame -q:a 0
+enc mp3_vbr5.mp3      -c:a libmp3lame -q:a 5
+enc mp3_mono64.mp3    -c:a libmp3lame -b:a 64k -ac 1
+
+enc aac_lc128.aac     -c:a aac -b:a 128k -f adts
+enc aac_he48.aac      -c:a libfdk_aac -profile:a aac_he -b:a 48k -f adts
+enc aac_hev2_24.aac   -c:a libfdk_aac -profile:a aac_he_v2 -b:a 24k -f adts
+enc m4a_lc128.m4a     -c:a aac -b:a 128k -movflags +faststart
+
+enc flac16_44k.flac   -c:a flac -sample_fmt s16 -ar 44100
+enc flac24_96k.flac   -c:a flac -sample_fmt s32 -bits_per_raw_sample 24 -ar 96000
+
+enc opus_celt128.opus   -c:a libopus -b:a 128k -application audio
+enc opus_silk16.opus    -c:a libopus -b:a 16k -ac 1 -ar 16000 -application voip
+enc opus_hybrid32.opus  -c:a libopus -b:a 32k -application voip
+
+enc vorbis_q0.ogg     -c:a libvorbis -q:a 0
+enc vorbis_q3.ogg     -c:a libvorbis -q:a 3
+enc vorbis_q6.ogg     -c:a libvorbis -q:a 6
+enc vorbis_q10.ogg    -c:a libvorbis -q:a 10
+
+# gapless: the source split into two tracks at a sample that is no frame border, every track encoded on its own.
+#   build/host/decoder_runner -r additional_info/Testfiles/Pink-Panther.wav host/corpus/gapless_1.mp3 host/corpus/gapless_2.mp3
+for ext in wav flac mp3; do
+    enc gapless_1.$ext  -af atrim=end_sample=100000
+    enc gapless_2.$ext  -af atrim=start_sample=100000,asetpts=PTS-STARTPTS
+done
@@ -0,0 +1,511 @@
+/*
+ * make_flac.cpp
+ *
+ * Writes a FLAC file of a synthetic signal without an external encoder, for fixtures and corpus files with sample formats
+ * that the encoders at hand do not produce (24 and 32 bit, high rates).
+ *
+ *   usage: make_flac [-b bits] [-r rate] [-c channels] [-s seconds] [-k block size] [-p precision] [-n noise dB] out.flac
+ *
+ *   -b  bits per sample, 16, 24 or 32 (default 24)
+ *   -r  sample rate (default 96000)
+ *   -c  channels, 1 or 2 (default 2)
+ *   -s  duration in seconds (default 1)
+ *   -k  samples per frame, 16...24576 (default 4096)
+ *   -p  precision of the quantized LPC coefficients in bits, 5...15 (default 15)
+ *   -n  level of the white noise below full scale in dB (default 110), sets the size of the residuals
+ *
+ * The signal starts with a silent frame and a ramp, ends with a frame of full scale noise and is a set of slowly modulated sines
+ * plus noise in between, with a correlation of the channels that changes over time. Every frame
+ * takes the smallest of independent, left/side, right/side and mid/side coding, every subframe the smallest of
+ * CONSTANT, VERBATIM, FIXED 0...4 and LPC 1...12. The residuals are Rice coded with partitions, escape partitions are not
+ * written. With -p 15 and more than 16 bits the LPC sums need the 64 bit accumulator of the decoder, 32 bit streams need the
+ * int64_t sample buffer (the side channel has 33 bits).
+ * At the end the checksum that decoder_runner has to report for the file is printed: FNV-1a 64 over the source PCM,
+ * converted like the FLAC decoder does it (left aligned int32_t, mono duplicated).
+ *
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static uint32_t      blockSize = 4096;
+static const int32_t maxLpcOrder = 12;
+
+static struct {
+    uint32_t assignment[4]; // independent, left/side, right/side, mid/side
+    uint32_t subframes[4];  // CONSTANT, VERBATIM, FIXED, LPC
+    uint32_t lpcWide;       // LPC subframes whose sum needs more than 32 bit: depth + precision + ceil(log2(order)) > 32
+    uint32_t side33;        // subframes of a 33 bit side channel
+} stats;
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+struct BitWriter {
+    std::vector<uint8_t> data;
+    uint64_t             acc = 0;
+    uint32_t             bits = 0;
+
+    void put(uint64_t v, uint32_t n) { // n <= 56 at a time
+        if (n > 32) {
+            put(v >> 32, n - 32);
+            n = 32;
+        }
+        acc = (acc << n) | (v & ((1ULL << n) - 1));
+        bits += n;
+        while (bits >= 8) {
+            bits -= 8;
+            data.push_back((uint8_t)(acc >> bits));
+        }
+    }
+    void putSigned(int64_t v, uint32_t n) { put((uint64_t)v, n); }
+    void putUnary(uint32_t q) { // q zeros, then a one
+        while (q >= 32) {
+            put(0, 32);
+            q -= 32;
+        }
+        put(1, q + 1);
+    }
+    void align() {
+        if (bits) put(0, 8 - bits);
+    }
+};
+
+static uint8_t crc8(const uint8_t* p, size_t n) { // polynomial x^8 + x^2 + x + 1
+    uint8_t crc = 0;
+    while (n--) {
+        crc ^= *p++;
+        for (int i = 0; i < 8; i++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+static uint16_t crc16(const uint8_t* p, size_t n) { // polynomial x^16 + x^15 + x^2 + 1
+    uint16_t crc = 0;
+    while (n--) {
+        crc ^= (uint16_t)(*p++) << 8;
+        for (int i = 0; i < 8; i++) crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x8005) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// residual coding: partition order and Rice parameters with the smallest size, 4 or 5 bit parameters
+struct Rice {
+    uint32_t              order = 0;
+    std::vector<uint32_t> params;
+    uint64_t              bits = UINT64_MAX;
+};
+
+static inline uint32_t zigzag(int64_t r) { return (uint32_t)((r << 1) ^ (r >> 63)); }
+
+static Rice planRice(const std::vector<int64_t>& res, uint32_t warmup, uint32_t n) {
+    Rice best;
+    for (uint32_t order = 0; order <= 8; order++) {
+        uint32_t parts = 1u << order;
+        if (n % parts || n / parts <= warmup) break;
+        Rice     r;
+        r.order = order;
+        uint64_t bits = 0;
+        bool     wide = false;
+        for (uint32_t p = 0; p < parts; p++) {
+            uint32_t from = p * (n / parts) + (p ? 0 : warmup), to = (p + 1) * (n / parts);
+            uint64_t sum = 0;
+            for (uint32_t i = from; i < to; i++) sum += zigzag(res[i]);
+            uint32_t k0 = 0;
+            while (k0 < 30 && ((uint64_t)(to - from) << (k0 + 1)) < sum) k0++; // 2^k about the mean
+            uint64_t bestBits = UINT64_MAX;
+            uint32_t bestK = 0;
+            for (uint32_t k = k0 ? k0 - 1 : 0; k <= std::min<uint32_t>(k0 + 1, 30); k++) {
+                uint64_t b = (uint64_t)(to - from) * (k + 1);
+                for (uint32_t i = from; i < to; i++) b += zigzag(res[i]) >> k;
+                if (b < bestBits) {
+                    bestBits = b;
+                    bestK = k;
+                }
+            }
+            if (bestK > 14) wide = true;
+            r.params.push_back(bestK);
+            bits += bestBits;
+        }
+        bits += 2 + 4 + (uint64_t)parts * (wide ? 5 : 4);
+        r.bits = bits;
+        if (r.bits < best.bits) best = r;
+    }
+    return best;
+}
+
+static void writeRice(BitWriter& bw, const std::vector<int64_t>& res, uint32_t warmup, uint32_t n, const Rice& r) {
+    bool wide = false;
+    for (uint32_t k : r.params) wide |= k > 14;
+    bw.put(wide ? 1 : 0, 2);
+    bw.put(r.order, 4);
+    uint32_t parts = 1u << r.order;
+    for (uint32_t p = 0; p < parts; p++) {
+        uint32_t from = p * (n / parts) + (p ? 0 : warmup), to = (p + 1) * (n / parts), k = r.params[p];
+        bw.put(k, wide ? 5 : 4);
+        for (uint32_t i = from; i < to; i++) {
+            uint32_t u = zigzag(res[i]);
+            bw.putUnary(u >> k);
+            if (k) bw.put(u & ((1u << k) - 1), k);
+        }
+    }
+}
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// one subframe: the cheapest of the tried predictors
+struct Subframe {
+    enum { CONSTANT, VERBATIM, FIXED, LPC } type = VERBATIM;
+    uint32_t             order = 0;
+    int32_t              shift = 0;
+    std::vector<int32_t> coefs;
+    std::vector<int64_t> res;
+    Rice                 rice;
+    uint64_t             bits = UINT64_MAX;
+};
+
+static bool fitsInt32(const std::vector<int64_t>& res, uint32_t from) {
+    for (size_t i = from; i < res.size(); i++)
+        if (res[i] > INT32_MAX || res[i] <= INT32_MIN) return false; // the residual has to fit into int32_t, the most negative value excluded
+    return true;
+}
+
+// LPC coefficients of order 1...maxOrder with Levinson-Durbin over a Welch windowed block
+static void lpcFromSignal(const int64_t* s, uint32_t n, double lpc[maxLpcOrder][maxLpcOrder]) {
+    std::vector<double> w(n);
+    for (uint32_t i = 0; i < n; i++) {
+        double x = (2.0 * i - (n - 1)) / (n + 1);
+        w[i] = s[i] * (1 - x * x);
+    }
+    double ac[maxLpcOrder + 1];
+    for (int32_t l = 0; l <= maxLpcOrder; l++) {
+        ac[l] = 0;
+        for (uint32_t i = l; i < n; i++) ac[l] += w[i] * w[i - l];
+    }
+    ac[0] *= 1 + 1e-9; // white noise correction, keeps the recursion stable for pure sines
+    double err = ac[0], a[maxLpcOrder] = {0};
+    for (int32_t i = 0; i < maxLpcOrder; i++) {
+        if (err <= 0) {
+            for (int32_t k = i; k < maxLpcOrder; k++)
+                for (int32_t j = 0; j < maxLpcOrder; j++) lpc[k][j] = -a[j];
+            break;
+        }
+        double r = -ac[i + 1];
+        for (int32_t j = 0; j < i; j++) r -= a[j] * ac[i - j];
+        r /= err;
+        double tmp[maxLpcOrder];
+        memcpy(tmp, a, sizeof(a));
+        a[i] = r;
+        for (int32_t j = 0; j < i; j++) a[j] = tmp[j] + r * tmp[i - 1 - j];
+        err *= 1 - r * r;
+        for (int32_t j = 0; j <= i; j++) lpc[i][j] = -a[j]; // predictor: s[n] ~ sum lpc[j] * s[n - 1 - j]
+    }
+}
+
+static Subframe encodeSubframe(const int64_t* s, uint32_t n, uint32_t depth, uint32_t precision) {
+    Subframe best;
+    best.bits = 8 + (uint64_t)depth * n; // VERBATIM
+
+    bool constant = true;
+    for (uint32_t i = 1; i < n && constant; i++) constant = s[i] == s[0];
+    if (constant) {
+        best.type = Subframe::CONSTANT;
+        best.bits = 8 + depth;
+        return best;
+    }
+
+    auto consider = [&](Subframe& c, uint32_t headerBits) {
+        if (!fitsInt32(c.res, c.order)) return;
+        c.rice = planRice(c.res, c.order, n);
+        c.bits = 8 + headerBits + (uint64_t)c.order * depth + c.rice.bits;
+        if (c.bits < best.bits) best = c;
+    };
+
+    for (uint32_t order = 0; order <= 4 && order < n; order++) { // FIXED
+        Subframe c;
+        c.type = Subframe::FIXED;
+        c.order = order;
+        c.res.assign(n, 0);
+        for (uint32_t i = order; i < n; i++) {
+            int64_t p = 0;
+            if (order == 1) p = s[i - 1];
+            if (order == 2) p = 2 * s[i - 1] - s[i - 2];
+            if (order == 3) p = 3 * (s[i - 1] - s[i - 2]) + s[i - 3];
+            if (order == 4) p = 4 * (s[i - 1] + s[i - 3]) - 6 * s[i - 2] - s[i - 4];
+            c.res[i] = s[i] - p;
+        }
+        consider(c, 0);
+    }
+
+    double lpc[maxLpcOrder][maxLpcOrder] = {{0}};
+    lpcFromSignal(s, n, lpc);
+    for (int32_t order = 1; order <= maxLpcOrder && (uint32_t)order < n; order++) { // LPC, quantized like libFLAC
+        double cmax = 0;
+        for (int32_t j = 0; j < order; j++) cmax = std::max(cmax, fabs(lpc[order - 1][j]));
+        if (cmax <= 0) continue;
+        int log2cmax;
+        frexp(cmax, &log2cmax);
+        int32_t  shift = std::min<int32_t>(std::max<int32_t>((int32_t)precision - 1 - log2cmax, 0), 15);
+        int32_t  qmax = (1 << (precision - 1)) - 1, qmin = -(1 << (precision - 1));
+        Subframe c;
+        c.type = Subframe::LPC;
+        c.order = order;
+        c.shift = shift;
+        double e = 0;
+        for (int32_t j = 0; j < order; j++) {
+            e += lpc[order - 1][j] * (1 << shift);
+            int32_t q = std::min(std::max((int32_t)lround(e), qmin), qmax);
+            e -= q;
+            c.coefs.push_back(q);
+        }
+        c.res.assign(n, 0);
+        for (uint32_t i = order; i < n; i++) {
+            int64_t sum = 0;
+            for (int32_t j = 0; j < order; j++) sum += (int64_t)c.coefs[j] * s[i - 1 - j];
+            c.res[i] = s[i] - (sum >> shift);
+        }
+        consider(c, 4 + 5 + (uint32_t)order * precision);
+    }
+    return best;
+}
+
+static void writeSubframe(BitWriter& bw, const Subframe& sf, const int64_t* s, uint32_t n, uint32_t depth, uint32_t precision) {
+    stats.subframes[sf.type]++;
+    if (depth > 32) stats.side33++;
+    if (sf.type == Subframe::LPC && depth + precision + (uint32_t)ceil(log2(sf.order)) > 32) stats.lpcWide++;
+    bw.put(0, 1); // padding
+    switch (sf.type) {
+        case Subframe::CONSTANT:
+            bw.put(0, 6);
+            bw.put(0, 1); // no wasted bits
+            bw.putSigned(s[0], depth);
+            break;
+        case Subframe::VERBATIM:
+            bw.put(1, 6);
+            bw.put(0, 1);
+            for (uint32_t i = 0; i < n; i++) bw.putSigned(s[i], depth);
+            break;
+        case Subframe::FIXED:
+            bw.put(8 + sf.order, 6);
+            bw.put(0, 1);
+            for (uint32_t i = 0; i < sf.order; i++) bw.putSigned(s[i], depth);
+            writeRice(bw, sf.res, sf.order, n, sf.rice);
+            break;
+        case Subframe::LPC:
+            bw.put(32 + sf.order - 1, 6);
+            bw.put(0, 1);
+            for (uint32_t i = 0; i < sf.order; i++) bw.putSigned(s[i], depth);
+            bw.put(precision - 1, 4);
+            bw.putSigned(sf.shift, 5);
+            for (int32_t c : sf.coefs) bw.putSigned(c, precision);
+            writeRice(bw, sf.res, sf.order, n, sf.rice);
+            break;
+    }
+}
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+static void writeUtf8(BitWriter& bw, uint32_t v) { // frame number, UTF-8 like coding
+    if (v < 0x80) {
+        bw.put(v, 8);
+        return;
+    }
+    int n = v < 0x800 ? 2 : v < 0x10000 ? 3 : v < 0x200000 ? 4 : v < 0x4000000 ? 5 : 6;
+    bw.put(((0xFF00 >> n) & 0xFF) | (v >> (6 * (n - 1))), 8);
+    for (int i = n - 2; i >= 0; i--) bw.put(0x80 | ((v >> (6 * i)) & 0x3F), 8);
+}
+
+static uint32_t blockSizeCode(uint32_t n) { // 6 and 7: the size follows the frame number
+    if (n == 192) return 1;
+    for (uint32_t k = 0; k < 4; k++)
+        if (n == 576u << k) return 2 + k;
+    for (uint32_t k = 0; k < 8; k++)
+        if (n == 256u << k) return 8 + k;
+    return n <= 256 ? 6 : 7;
+}
+
+static uint32_t sampleRateCode(uint32_t rate) {
+    const uint32_t rates[] = {0, 88200, 176400, 192000, 8000, 16000, 22050, 24000, 32000, 44100, 48000, 96000};
+    for (uint32_t i = 1; i < 12; i++)
+        if (rates[i] == rate) return i;
+    return 0; // from STREAMINFO
+}
+
+static uint32_t sampleSizeCode(uint32_t bps) { return bps == 16 ? 4 : bps == 24 ? 6 : 7; }
+
+// one frame of n samples per channel, ch[c] holds the samples
+static void writeFrame(std::vector<uint8_t>& out, uint32_t frameNum, const std::vector<const int64_t*>& ch, uint32_t n, uint32_t rate, uint32_t bps, uint32_t precision) {
+    // stereo decorrelation: 0 independent, 8 left/side, 9 right/side, 10 mid/side
+    std::vector<Subframe>             sf;
+    std::vector<std::vector<int64_t>> coded;
+    uint32_t                          assignment = (uint32_t)ch.size() - 1;
+    std::vector<uint32_t>             depth(ch.size(), bps);
+    for (const int64_t* c : ch) {
+        coded.emplace_back(c, c + n);
+        sf.push_back(encodeSubframe(c, n, bps, precision));
+    }
+    if (ch.size() == 2) {
+        std::vector<int64_t> side(n), mid(n);
+        for (uint32_t i = 0; i < n; i++) {
+            side[i] = ch[0][i] - ch[1][i];
+            mid[i] = (ch[0][i] + ch[1][i]) >> 1;
+        }
+        Subframe sSide = encodeSubframe(side.data(), n, bps + 1, precision);
+        Subframe sMid = encodeSubframe(mid.data(), n, bps, precision);
+        uint64_t cost[4] = {sf[0].bits + sf[1].bits, sf[0].bits + sSide.bits, sSide.bits + sf[1].bits, sMid.bits + sSide.bits};
+        uint32_t best = 0;
+        for (uint32_t k = 1; k < 4; k++)
+            if (cost[k] < cost[best]) best = k;
+        if (best == 1) {
+            assignment = 8;
+            coded[1] = side, sf[1] = sSide, depth[1] = bps + 1;
+        } else if (best == 2) {
+            assignment = 9;
+            coded[0] = side, sf[0] = sSide, depth[0] = bps + 1;
+        } else if (best == 3) {
+            assignment = 10;
+            coded[0] = mid, sf[0] = sMid;
+            coded[1] = side, sf[1] = sSide, depth[1] = bps + 1;
+        }
+    }
+
+    stats.assignment[assignment < 8 ? 0 : assignment - 7]++;
+    BitWriter bw;
+    bw.put(0xFFF8, 16); // sync, fixed block size
+    uint32_t code = blockSizeCode(n);
+    bw.put(code, 4);
+    bw.put(sampleRateCode(rate), 4);
+    bw.put(assignment, 4);
+    bw.put(sampleSizeCode(bps), 3);
+    bw.put(0, 1);
+    writeUtf8(bw, frameNum);
+    if (code == 6) bw.put(n - 1, 8);
+    if (code == 7) bw.put(n - 1, 16);
+    bw.put(crc8(bw.data.data(), bw.data.size()), 8);
+    for (size_t c = 0; c < ch.size(); c++) writeSubframe(bw, sf[c], coded[c].data(), n, depth[c], precision);
+    bw.align();
+    bw.put(crc16(bw.data.data(), bw.data.size()), 16);
+    out.insert(out.end(), bw.data.begin(), bw.data.end());
+}
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int main(int argc, char* argv[]) {
+    uint32_t bps = 24, rate = 96000, channels = 2, precision = 15;
+    double   seconds = 1, noiseDb = 110;
+    int      i = 1;
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        if (i + 1 >= argc) break;
+        if (!strcmp(argv[i], "-b"))
+            bps = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-r"))
+            rate = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-c"))
+            channels = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-s"))
+            seconds = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-k"))
+            blockSize = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-p"))
+            precision = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-n"))
+            noiseDb = atof(argv[++i]);
+        else
+            break;
+    }
+    if (i + 1 != argc || (bps != 16 && bps != 24 && bps != 32) || channels < 1 || channels > 2 || precision < 5 || precision > 15 || blockSize < 16 || blockSize > 24576 || !rate || rate >= (1 << 20) || seconds <= 0) {
+        printf("usage: %s [-b bits] [-r rate] [-c channels] [-s seconds] [-k block size] [-p precision] [-n noise dB] out.flac\n", argv[0]);
+        return 2;
+    }
+
+    // source signal
+    const uint64_t                    total = (uint64_t)(seconds * rate);
+    const double                      full = ldexp(1.0, bps - 1) - 1;
+    std::vector<std::vector<int64_t>> pcm(channels, std::vector<int64_t>(total));
+    uint64_t                          lcg = 0x853c49e6748fea9bULL;
+    auto                              noise = [&]() { // uniform in [-1, 1)
+        lcg = lcg * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (double)(int64_t)lcg / 9223372036854775808.0;
+    };
+    const double   noiseAmp = full * pow(10.0, -noiseDb / 20);
+    const uint64_t burst = total > 4 * blockSize ? (total / blockSize - 1) * blockSize : UINT64_MAX; // last whole frame
+    for (uint64_t n = 0; n < total; n++) {
+        double t = (double)n / rate, env = 0.5 + 0.45 * sin(2 * M_PI * 0.7 * t);
+        double rho = 0.5 + 0.5 * sin(2 * M_PI * 2.3 * t);        // correlation of the channels
+        double tilt = 0.8 * sin(2 * M_PI * 3.1 * t);             // which channel has more noise of its own
+        double common = 0.45 * sin(2 * M_PI * 220 * t) + 0.2 * env * sin(2 * M_PI * 1234.5 * t), nCommon = noise(), nOwn = noise(), nOther = noise();
+        for (uint32_t c = 0; c < channels; c++) {
+            double v;
+            if (n < blockSize) // digital silence: CONSTANT
+                v = 0;
+            else if (n < 2 * blockSize) // a ramp: FIXED order 2 without residual
+                v = (double)((int64_t)(n - blockSize) - (int64_t)blockSize / 2) * floor(full / blockSize) * (c ? -0.5 : 1);
+            else if (n >= burst && n < burst + blockSize) // full scale noise: VERBATIM
+                v = noise() * full;
+            else {
+                // the part of its own is in antiphase in the two channels, it cancels out in mid: mid/side wins for |tilt| < 0.5,
+                // left/side or right/side for a larger tilt, independent coding when the channels are not correlated
+                double own = (0.2 * env * sin(2 * M_PI * 987.6 * t) + 0.05 * sin(2 * M_PI * 5321 * t)) * full + nOwn * noiseAmp;
+                own *= (c ? -(1 - tilt) : 1 + tilt) * (1 - rho);
+                v = common * full + rho * nCommon * noiseAmp + own + (1 - rho) * (c ? nOther : 0) * noiseAmp;
+            }
+            pcm[c][n] = (int64_t)std::max(std::min(lround(v), (long)full), -(long)full - 1);
+        }
+    }
+
+    // stream
+    std::vector<uint8_t> out = {'f', 'L', 'a', 'C', 0x80, 0, 0, 34}; // last metadata block: STREAMINFO
+    BitWriter            si;
+    si.put(blockSize, 16);
+    si.put(blockSize, 16);
+    si.put(0, 24); // frame sizes, patched below
+    si.put(0, 24);
+    si.put(rate, 20);
+    si.put(channels - 1, 3);
+    si.put(bps - 1, 5);
+    si.put(total, 36);
+    for (int k = 0; k < 16; k++) si.put(0, 8); // no MD5
+    out.insert(out.end(), si.data.begin(), si.data.end());
+
+    uint32_t minFrame = UINT32_MAX, maxFrame = 0, frames = 0;
+    for (uint64_t pos = 0; pos < total; pos += blockSize, frames++) {
+        uint32_t                   n = (uint32_t)std::min<uint64_t>(blockSize, total - pos);
+        std::vector<const int64_t*> ch;
+        for (uint32_t c = 0; c < channels; c++) ch.push_back(pcm[c].data() + pos);
+        size_t before = out.size();
+        writeFrame(out, frames, ch, n, rate, bps, precision);
+        minFrame = std::min<uint32_t>(minFrame, out.size() - before);
+        maxFrame = std::max<uint32_t>(maxFrame, out.size() - before);
+    }
+    for (int k = 0; k < 3; k++) {
+        out[8 + 4 + k] = (uint8_t)(minFrame >> (16 - 8 * k));
+        out[8 + 7 + k] = (uint8_t)(maxFrame >> (16 - 8 * k));
+    }
+
+    FILE* f = fopen(argv[i], "wb");
+    if (!f || fwrite(out.data(), 1, out.size(), f) != out.size()) {
+        printf("cannot write %s\n", argv[i]);
+        if (f) fclose(f);
+        return 1;
+    }
+    fclose(f);
+
+    // checksum of the PCM as the decoder delivers it, see host::decodeBuffer()
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (uint64_t n = 0; n < total; n++) {
+        for (uint32_t c = 0; c < 2; c++) {
+            uint32_t w = (uint32_t)((uint64_t)pcm[channels == 2 ? c : 0][n] << (32 - bps));
+            for (int b = 0; b < 4; b++) {
+                hash ^= (uint8_t)(w >> (8 * b));
+                hash *= 0x100000001b3ULL;
+            }
+        }
+    }
+    printf("%s: %u bit, %u Hz, %u channel(s), %llu samples, %u frames, %zu bytes (%.1f%%)\n", argv[i], bps, rate, channels, (unsigned long long)total, frames, out.size(),
+           100.0 * out.size() / ((double)total * channels * bps / 8));
+    printf("frames: %u independent, %u left/side, %u right/side, %u mid/side\n", stats.assignment[0], stats.assignment[1], stats.assignment[2], stats.assignment[3]);
+    printf("subframes: %u CONSTANT, %u VERBATIM, %u FIXED, %u LPC (%u with a sum over 32 bit), %u of a 33 bit side channel\n", stats.subframes[0], stats.subframes[1], stats.subframes[2],
+           stats.subframes[3], stats.lpcWide, stats.side33);
+    printf("expected checksum 0x%016llx\n", (unsigned long long)hash);
+    return 0;
+}
@@ -0,0 +1,380 @@
+/*
+ * mp3_bench.cpp
+ *
+ * Huffman decoding of MP3Decoder (DecodeHuffmanPairs(), DecodeHuffmanQuads()) and its output path: the 16 bit synthesis
+ * that decode() widens to int32_t in a second pass (settings.MP3_Q31 = false) against the Q31 synthesis straight into
+ * outbuf, mono written to both channels in the same loop (default).
+ *
+ *   usage: mp3_bench [-n repeat] [file ...]
+ *
+ *   -n  decode every file n times per path and mode, the fastest run is reported, default 5
+ *
+ * Huffman: the code book of every table is read from huffTable / quadTable, random symbols (probability 2^-length, the
+ * statistics the codes are made for, random linbits and signs) are encoded behind a random bit offset and followed by
+ * random bits that do not belong to the region. The decoder must return every value (sign in bit 31) and the number of
+ * bits of the region. Without the last bit of the region the pairs must fail (-1, or more bits than there are, both
+ * are errors for DecodeHuffman()), the quads must return the values up to the cut.
+ * time     cycles per pair or quad (TSC on x86, else ns), the best of 20 * repeat regions of 576 values
+ *
+ * Files: both paths run the same fixed point decoder up to the polyphase filter, the Q31 output is the reference:
+ * SNR 16   signal / (16 bit output << 16 - Q31 output), the dynamic range the 16 bit path throws away
+ * match    the Q31 output rounded to 16 bit must be the 16 bit output within 1 LSB (each path rounds once) and have the
+ *          same length
+ * time     cycles per MP3 frame (TSC on x86, else ns), the whole decode loop of decoder_host
+ *
+ * Synthesis modes (settings.MP3_SYNTH, Q31), against the Q31 output of the full synthesis:
+ * mono     MP3_SYNTH_MONO, the reference is (L + R) / 2, the mix of the spectra differs from it in the rounding only
+ * half     MP3_SYNTH_HALF_RATE, the reference is lowpass filtered at samplerate / 4 (windowed sinc, 255 taps) and
+ *          decimated (frame n of the half rate is frame 2n or 2n - 1, after an odd encoder delay + 529), SNR is limited
+ *          by the aliasing of subband 15 that the filterbank lets through
+ * both     MP3_SYNTH_MONO | MP3_SYNTH_HALF_RATE
+ * rate and channels must be the ones of the mode, the length that of the full output (/ 2) within 2 samples
+ * (gapless trimming at the half rate rounds)
+ *
+ * Pipeline (settings.MP3_PIPELINE, stage 2 in a second thread), 16 bit and Q31, every synthesis mode:
+ * match    the output must be the one of the decoder on one core, sample by sample
+ * 1 core   CPU time per MP3 frame without the pipeline, ns
+ * stage    CPU time per frame of the thread that calls decode() (1: unpack, Huffman, dequantizer, queue) and of the
+ *          pipeline thread (2: IMDCT, subband transform)
+ * wall     time per frame with the pipeline, on a host with one core it is about stage 1 + stage 2
+ * 2 cores  1 core / max(stage 1, stage 2), the speedup when both stages run side by side
+ * latency  the pipeline returns a frame with the next one, one frame (samples per frame / rate) more
+ *
+ */
+
+#include "decoder_host.h"
+#include "../src/mp3_decoder/mp3_decoder.h"
+#include <cmath>
+#include <random>
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+static inline uint64_t ticks() { return __rdtsc(); }
+static const char*     unit = "cycles";
+#else
+static inline uint64_t ticks() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+static const char* unit = "ns";
+#endif
+
+struct PathResult {
+    std::vector<int32_t> pcm;
+    host::DecodeStats    stats;
+    double               perFrame = 0;
+    double               cpuThread = 0; // ns per frame, CPU time of the thread that calls decode()
+    double               cpuProcess = 0; // ns per frame, CPU time of all threads
+};
+static inline uint64_t cpuNs(clockid_t clock) {
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+struct Code {
+    uint32_t bits, len;
+    int32_t  x, y; // quads: v w x y in x
+};
+
+struct BitWriter {
+    std::vector<uint8_t> buf;
+    uint32_t             n = 0;
+    void put(uint32_t v, uint32_t len) {
+        for (int32_t k = len - 1; k >= 0; k--, n++) {
+            if (!(n & 7)) buf.push_back(0);
+            if ((v >> k) & 1) buf.back() |= 0x80 >> (n & 7);
+        }
+    }
+};
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// the code book of a pair table: the subtable at t is indexed with the next maxBits bits, entries of length 0 link to the next one
+static void pairCodes(int32_t t, uint32_t prefix, uint32_t prefixLen, std::vector<Code>& book) {
+    int32_t maxBits = huffTable[t] & 0x000f;
+    for (int32_t i = 0; i < (1 << maxBits); i++) {
+        uint16_t cw = huffTable[t + 1 + i];
+        uint32_t len = cw >> 12;
+        if (!len) {
+            pairCodes(t + cw, prefix << maxBits | i, prefixLen + maxBits, book);
+            continue;
+        }
+        if (i & ((1 << (maxBits - len)) - 1)) continue; // the same code again
+        book.push_back({(prefix << len) | (i >> (maxBits - len)), prefixLen + len, (cw >> 4) & 15, (cw >> 8) & 15});
+    }
+}
+static std::vector<Code> quadCodes(int32_t tab) {
+    std::vector<Code> book;
+    int32_t           maxBits = quadTabMaxBits[tab];
+    for (int32_t i = 0; i < (1 << maxBits); i++) {
+        uint8_t  cw = quadTable[quadTabOffset[tab] + i];
+        uint32_t len = cw >> 4;
+        if (!(i & ((1 << (maxBits - len)) - 1))) book.push_back({(uint32_t)i >> (maxBits - len), len, cw & 15, 0});
+    }
+    return book;
+}
+// random symbols, encoded: the expected values and the region, 'offset' foreign bits in front, 'tail' behind
+static void encode(const std::vector<Code>& book, bool quad, int32_t linBits, int32_t count, std::mt19937& rnd, std::vector<int32_t>& vals, BitWriter& bw, uint32_t offset,
+                   uint32_t tail) {
+    std::vector<double> w;
+    for (auto& c : book) w.push_back(ldexp(1.0, -(int)c.len));
+    std::discrete_distribution<int> pick(w.begin(), w.end());
+    auto                            sign = [&](int32_t v) -> int32_t {
+        if (!v) return 0;
+        bool neg = rnd() & 1;
+        bw.put(neg, 1);
+        return neg ? (int32_t)(v | 0x80000000) : v;
+    };
+    bw.put(rnd(), offset);
+    vals.clear();
+    for (int32_t n = 0; n < count; n++) {
+        const Code& c = book[pick(rnd)];
+        bw.put(c.bits, c.len);
+        if (quad) {
+            for (int k = 3; k >= 0; k--) vals.push_back(sign((c.x >> k) & 1));
+            continue;
+        }
+        int32_t v[2] = {c.x, c.y};
+        for (int k = 0; k < 2; k++) {
+            if (linBits && v[k] == 15) {
+                uint32_t ext = rnd() & ((1u << linBits) - 1);
+                bw.put(ext, linBits);
+                v[k] += ext;
+            }
+            vals.push_back(sign(v[k]));
+        }
+    }
+    bw.put(rnd(), tail);
+    bw.buf.resize(bw.buf.size() + 8, 0x5a); // the buffer goes on
+}
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+static int huffman(uint32_t repeat) {
+    std::mt19937 rnd(1);
+    int          failed = 0;
+    Audio::audio_info_callback = [](Audio::msg_t) {}; // the regions without their last bit are logged as errors
+    printf("%-10s %6s %7s %8s %16s  %s\n", "table", "codes", "linbits", "max len", (std::string(unit) + "/symbol").c_str(), "check");
+    for (int32_t tab = 0; tab < HUFF_PAIRTABS + 2; tab++) {
+        bool                 quad = tab >= HUFF_PAIRTABS;
+        int32_t              linBits = quad ? 0 : huffTabLookup[tab].linBits, type = quad ? quadA : huffTabLookup[tab].tabType;
+        std::vector<Code>    book;
+        std::vector<int32_t> vals, out(576 + 4);
+        if (type == noBits || type == invalidTab) continue;
+        if (quad)
+            book = quadCodes(tab - HUFF_PAIRTABS);
+        else
+            pairCodes(huffTabOffset[tab], 0, 0, book);
+        const int32_t per = quad ? 4 : 2, count = 576 / per;
+        uint32_t      maxLen = 0;
+        for (auto& c : book) maxLen = std::max(maxLen, c.len);
+
+        // round trip, whole regions and regions without their last bit
+        const char* err = nullptr;
+        for (int32_t run = 0; run < 200 && !err; run++) {
+            BitWriter bw;
+            uint32_t  offset = rnd() % 8, tail = rnd() % 40;
+            int32_t   n = run < 100 ? count : 1 + rnd() % count;
+            encode(book, quad, linBits, n, rnd, vals, bw, offset, tail);
+            int32_t bits = bw.n - offset - tail;
+            for (int32_t cut = 0; cut < 2 && !err; cut++) {
+                std::fill(out.begin(), out.end(), 0x7fff);
+                int32_t left = cut ? bits - 1 : bits + tail, r;
+                if (quad) {
+                    r = MP3Decoder::DecodeHuffmanQuads(out.data(), 576, tab - HUFF_PAIRTABS, left, bw.buf.data(), offset);
+                    if (r != (cut ? n - 1 : n) * 4 && !(cut == 0 && tail && r > n * 4)) err = "quads decoded";
+                    if (!err && !std::equal(vals.begin(), vals.begin() + std::min<int32_t>(r, vals.size()), out.begin())) err = "values differ";
+                } else {
+                    r = MP3Decoder::DecodeHuffmanPairs(out.data(), n * 2, tab, left, bw.buf.data(), offset);
+                    if (cut ? r >= 0 && r <= left : r != bits) err = cut ? "overrun not detected" : "bits used";
+                    if (!cut && !err && !std::equal(vals.begin(), vals.end(), out.begin())) err = "values differ";
+                }
+            }
+        }
+
+        // time
+        BitWriter bw;
+        encode(book, quad, linBits, count, rnd, vals, bw, 3, 0);
+        uint64_t best = UINT64_MAX;
+        for (uint32_t n = 0; n < repeat * 20; n++) {
+            uint64_t t0 = ticks();
+            if (quad)
+                MP3Decoder::DecodeHuffmanQuads(out.data(), 576, tab - HUFF_PAIRTABS, bw.n - 3, bw.buf.data(), 3);
+            else
+                MP3Decoder::DecodeHuffmanPairs(out.data(), 576, tab, bw.n - 3, bw.buf.data(), 3);
+            best = std::min(best, ticks() - t0);
+        }
+        char name[16];
+        snprintf(name, sizeof(name), quad ? "quad %c" : "pair %d", quad ? 'A' + tab - HUFF_PAIRTABS : tab);
+        printf("%-10s %6zu %7d %8u %16.1f  %s\n", name, book.size(), linBits, maxLen, (double)best / count, err ? err : "ok");
+        if (err) failed++;
+    }
+    Audio::audio_info_callback = nullptr;
+    printf("\n");
+    return failed;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+static bool decode(const std::vector<uint8_t>& data, bool q31, uint32_t repeat, PathResult& r, uint8_t synth = Audio::MP3_SYNTH_FULL, bool pipeline = false) {
+    Audio audio;
+    audio.settings.MP3_Q31 = q31;
+    audio.settings.MP3_SYNTH = synth;
+    audio.settings.MP3_PIPELINE = pipeline;
+    auto sink = [&](const int32_t* pcm, size_t frames, uint8_t) { r.pcm.insert(r.pcm.end(), pcm, pcm + frames * 2); };
+    if (!host::decodeBuffer(audio, host::CODEC_MP3, data, r.stats, sink) || !r.stats.frames) return false;
+    uint64_t best = UINT64_MAX, bestThread = UINT64_MAX, bestProcess = UINT64_MAX;
+    for (uint32_t n = 0; n < repeat; n++) {
+        host::DecodeStats stats;
+        uint64_t          t0 = ticks(), c0 = cpuNs(CLOCK_THREAD_CPUTIME_ID), p0 = cpuNs(CLOCK_PROCESS_CPUTIME_ID);
+        host::decodeBuffer(audio, host::CODEC_MP3, data, stats);
+        best = std::min(best, ticks() - t0);
+        bestThread = std::min(bestThread, cpuNs(CLOCK_THREAD_CPUTIME_ID) - c0);
+        bestProcess = std::min(bestProcess, cpuNs(CLOCK_PROCESS_CPUTIME_ID) - p0);
+    }
+    r.perFrame = (double)best / r.stats.frames;
+    r.cpuThread = (double)bestThread / r.stats.frames;
+    r.cpuProcess = (double)bestProcess / r.stats.frames;
+    return true;
+}
+// reference of a synthesis mode from the full Q31 output: (L + R) / 2 and / or lowpass at samplerate / 4 and the frames
+// 2 * n + phase, 'clipped' where the full output clips (within the filter)
+static std::vector<double> reference(const std::vector<int32_t>& full, uint8_t synth, int32_t phase, std::vector<bool>& clipped) {
+    size_t              frames = full.size() / 2;
+    std::vector<double> x(frames);
+    clipped.assign(frames, false);
+    for (size_t k = 0; k < frames; k++) {
+        x[k] = (synth & Audio::MP3_SYNTH_MONO) ? ((double)full[2 * k] + full[2 * k + 1]) / 2 : full[2 * k];
+        for (int32_t c = 0; c < 2; c++) clipped[k] = clipped[k] || full[2 * k + c] == INT32_MAX || full[2 * k + c] == INT32_MIN;
+    }
+    if (!(synth & Audio::MP3_SYNTH_HALF_RATE)) return x;
+    const int32_t       taps = 255, mid = taps / 2;
+    std::vector<double> h(taps), y(frames / 2);
+    std::vector<bool>   c(frames / 2);
+    for (int32_t j = 0; j < taps; j++) {
+        double t = j - mid, w = 0.42 - 0.5 * cos(2 * M_PI * j / (taps - 1)) + 0.08 * cos(4 * M_PI * j / (taps - 1)); // Blackman
+        h[j] = (t ? sin(M_PI * t / 2) / (M_PI * t) : 0.5) * w;
+    }
+    for (size_t n = 0; n < y.size(); n++)
+        for (int32_t j = 0; j < taps; j++) {
+            int64_t k = (int64_t)(2 * n + phase) + mid - j;
+            if (k >= 0 && k < (int64_t)frames) {
+                y[n] += h[j] * x[k];
+                c[n] = c[n] || clipped[k];
+            }
+        }
+    clipped = c;
+    return y;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int main(int argc, char* argv[]) {
+    uint32_t repeat = 5;
+    int      i = 1;
+
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            repeat = std::max(1, atoi(argv[++i]));
+        else {
+            printf("unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    int failed = huffman(repeat);
+    if (i >= argc) return failed ? 1 : 0;
+    const int first = i;
+    printf("%-32s %3s %8s %16s %16s %8s %10s  %s\n", "file", "ch", "frames", (std::string(unit) + "/frame 16").c_str(), (std::string(unit) + "/frame Q31").c_str(), "speedup", "SNR 16",
+           "match");
+    for (; i < argc; i++) {
+        const char*          path = argv[i];
+        const char*          name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+        std::vector<uint8_t> data;
+        PathResult           p16, p31;
+        if (!host::readFile(path, data) || !decode(data, false, repeat, p16) || !decode(data, true, repeat, p31)) {
+            printf("%-32.32s cannot be decoded\n", name);
+            failed++;
+            continue;
+        }
+        double  sig = 0, err = 0;
+        int64_t maxDiff = 0;
+        for (size_t k = 0; k < std::min(p16.pcm.size(), p31.pcm.size()); k++) {
+            double ref = p31.pcm[k], e = (double)p16.pcm[k] - ref;
+            sig += ref * ref;
+            err += e * e;
+            int64_t rounded = std::clamp<int64_t>(((int64_t)p31.pcm[k] + 0x8000) >> 16, INT16_MIN, INT16_MAX);
+            maxDiff = std::max(maxDiff, std::abs(rounded - (p16.pcm[k] >> 16)));
+        }
+        bool ok = p16.pcm.size() == p31.pcm.size() && maxDiff <= 1;
+        if (!ok) failed++;
+        char match[64];
+        if (p16.pcm.size() != p31.pcm.size())
+            snprintf(match, sizeof(match), "length %zu / %zu", p16.pcm.size() / 2, p31.pcm.size() / 2);
+        else
+            snprintf(match, sizeof(match), "max diff %lld LSB", (long long)maxDiff);
+        printf("%-32.32s %3u %8u %16.0f %16.0f %7.2fx %7.1f dB  %s%s\n", name, p31.stats.channels, p31.stats.frames, p16.perFrame, p31.perFrame, p16.perFrame / p31.perFrame,
+               10 * log10(sig / (err + 1e-30)), match, ok ? "" : "  <-- FAILED");
+    }
+
+    const char*   modeName[] = {"full", "mono", "half", "both"};
+    const uint8_t minSnr[] = {0, 90, 30, 30}; // dB
+    printf("\n%-32s %5s %3s %6s %16s %8s %10s  %s\n", "file", "mode", "ch", "rate", (std::string(unit) + "/frame").c_str(), "speedup", "SNR", "match");
+    for (i = first; i < argc; i++) {
+        const char*          path = argv[i];
+        const char*          name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+        std::vector<uint8_t> data;
+        PathResult           full;
+        if (!host::readFile(path, data) || !decode(data, true, repeat, full)) continue; // reported above
+        printf("%-32.32s %5s %3u %6u %16.0f\n", name, modeName[0], full.stats.channels, full.stats.sampleRate, full.perFrame);
+        for (uint8_t synth = Audio::MP3_SYNTH_MONO; synth <= (Audio::MP3_SYNTH_MONO | Audio::MP3_SYNTH_HALF_RATE); synth++) {
+            PathResult r;
+            if (!decode(data, true, repeat, r, synth)) {
+                printf("%-32.32s %5s cannot be decoded  <-- FAILED\n", name, modeName[synth]);
+                failed++;
+                continue;
+            }
+            bool   half = synth & Audio::MP3_SYNTH_HALF_RATE;
+            double snr = -999;
+            for (int32_t phase = 0; phase >= -(int32_t)half; phase--) { // the trimming of the encoder delay may start at an odd frame
+                std::vector<bool>   clipped;
+                std::vector<double> ref = reference(full.pcm, synth, phase, clipped);
+                double              sig = 0, err = 0;
+                for (size_t k = 0; k < std::min(ref.size(), r.pcm.size() / 2); k++) {
+                    if (clipped[k]) continue;
+                    double e = r.pcm[2 * k] - ref[k];
+                    sig += ref[k] * ref[k];
+                    err += e * e;
+                    if (r.pcm[2 * k] != r.pcm[2 * k + 1] && (synth & Audio::MP3_SYNTH_MONO)) err += 1e30; // both channels
+                }
+                snr = std::max(snr, 10 * log10(sig / (err + 1e-30)));
+            }
+            size_t want = full.pcm.size() / 2 >> half, got = r.pcm.size() / 2;
+            bool   ok = snr >= minSnr[synth] && got + 2 >= want && got <= want + 2 && r.stats.sampleRate == full.stats.sampleRate >> half &&
+                      r.stats.channels == ((synth & Audio::MP3_SYNTH_MONO) ? 1 : full.stats.channels);
+            if (!ok) failed++;
+            printf("%-32.32s %5s %3u %6u %16.0f %7.2fx %7.1f dB  length %zu / %zu%s\n", name, modeName[synth], r.stats.channels, r.stats.sampleRate, r.perFrame, full.perFrame / r.perFrame,
+                   snr, got, want, ok ? "" : "  <-- FAILED");
+        }
+    }
+
+    printf("\n%-32s %5s %5s %10s %10s %10s %14s %8s %10s  %s\n", "file", "path", "mode", "1 core", "stage 1", "stage 2", (std::string(unit) + " wall").c_str(), "2 cores",
+           "latency", "match");
+    for (i = first; i < argc; i++) {
+        const char*          path = argv[i];
+        const char*          name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+        std::vector<uint8_t> data;
+        if (!host::readFile(path, data)) continue; // reported above
+        for (bool q31 : {false, true})
+            for (uint8_t synth = Audio::MP3_SYNTH_FULL; synth <= (Audio::MP3_SYNTH_MONO | Audio::MP3_SYNTH_HALF_RATE); synth++) {
+                PathResult one, pipe;
+                if (!decode(data, q31, repeat, one, synth) || !decode(data, q31, repeat, pipe, synth, true)) {
+                    printf("%-32.32s %5s %5s cannot be decoded  <-- FAILED\n", name, q31 ? "Q31" : "16", modeName[synth]);
+                    failed++;
+                    continue;
+                }
+                bool   ok = one.pcm == pipe.pcm && one.stats.frames == pipe.stats.frames;
+                double latency = one.stats.sampleRate ? 1000.0 * one.stats.samples / one.stats.frames / one.stats.sampleRate : 0; // ms, one frame
+                if (!ok) failed++;
+                double stage1 = pipe.cpuThread, stage2 = pipe.cpuProcess - pipe.cpuThread;
+                printf("%-32.32s %5s %5s %10.0f %10.0f %10.0f %14.0f %7.2fx %7.1f ms  %s\n", name, q31 ? "Q31" : "16", modeName[synth], one.cpuProcess, stage1, stage2, pipe.perFrame,
+                       one.cpuProcess / std::max(stage1, stage2), latency, ok ? "bit exact" : "differs  <-- FAILED");
+            }
+    }
+    return failed ? 1 : 0;
+}
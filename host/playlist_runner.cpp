@@ -0,0 +1,157 @@
+/*
+ * playlist_runner.cpp
+ *
+ * Plays local files with the complete Audio class: setPinout() starts the audio task, connecttoFS() the first file, the
+ * app task pumps loop() every millisecond. The I2S shim paces the audio task with its DMA clock and hands everything
+ * written to a sink that counts the frames per sample rate.
+ *
+ *   usage: playlist_runner [-d dir] [-s speed] [-q] [-2] [-v] file file [file ...]
+ *
+ *   -d  directory that fs::FS maps to "/" (default: the current directory)
+ *   -s  speed of the DMA clock, 1 is real time (default 8)
+ *   -q  queue the next file with queueNext() while the current one plays, else the evt_eof handler calls connecttoFS()
+ *   -2  dual task mode (setDualTask(true))
+ *   -v  print every info event
+ *
+ * Checked, the run fails (exit code 1) otherwise:
+ *   - every file gets one evt_eof with its name, in the order of the command line
+ *   - the output holds the frames of every file: per sample rate the frame count is within 1% of what
+ *     host::decodeBuffer() gets out of the files
+ *
+ */
+
+#include "decoder_host.h"
+#include <map>
+#include <string>
+#include <vector>
+
+struct RunState {
+    std::vector<std::string> files;
+    size_t                   current = 0; // index of the file that plays
+    std::vector<std::string> eofs;        // names of the evt_eof events
+    std::map<uint32_t, uint64_t> frames;  // output frames per sample rate
+    std::mutex               framesMtx;
+    bool                     queue = false;
+    bool                     verbose = false;
+    int                      errors = 0;
+};
+static RunState s;
+static Audio*   s_audio = nullptr;
+static fs::FS*  s_fs = nullptr;
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+static void sink(const void*, size_t bytes, uint32_t sampleRate, void*) { // audio or output task
+    std::lock_guard<std::mutex> lock(s.framesMtx);
+    s.frames[sampleRate] += bytes / (2 * sizeof(int32_t)); // 32 bit stereo
+}
+
+static const char* baseName(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+static void onInfo(Audio::msg_t m) { // loop(), app task
+    if (s.verbose) printf("  %-14s %s\n", m.s, m.msg);
+    if (m.e != Audio::evt_eof) return;
+    std::string name = m.msg ? m.msg : "";
+    s.eofs.push_back(name);
+    if (s.current >= s.files.size() || name != baseName(s.files[s.current])) {
+        printf("unexpected eof \"%s\" (expected \"%s\")\n", name.c_str(), s.current < s.files.size() ? baseName(s.files[s.current]) : "none");
+        s.errors++;
+    }
+    s.current++;
+    if (s.current >= s.files.size()) return;
+    if (s.queue) {
+        if (s.current + 1 < s.files.size()) s_audio->queueNext(*s_fs, s.files[s.current + 1].c_str()); // the one after
+    } else {
+        if (!s_audio->connecttoFS(*s_fs, s.files[s.current].c_str())) {
+            printf("connecttoFS(\"%s\") failed\n", s.files[s.current].c_str());
+            s.errors++;
+        }
+    }
+}
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int main(int argc, char** argv) {
+    const char* dir = ".";
+    float       speed = 8;
+    bool        dual = false;
+    int         opt;
+    setvbuf(stdout, nullptr, _IOLBF, 0); // the info events come from several tasks
+    while ((opt = getopt(argc, argv, "d:s:q2v")) != -1) {
+        switch (opt) {
+            case 'd': dir = optarg; break;
+            case 's': speed = atof(optarg); break;
+            case 'q': s.queue = true; break;
+            case '2': dual = true; break;
+            case 'v': s.verbose = true; break;
+            default: fprintf(stderr, "usage: %s [-d dir] [-s speed] [-q] [-2] [-v] file file [file ...]\n", argv[0]); return 2;
+        }
+    }
+    for (int i = optind; i < argc; i++) s.files.push_back(argv[i][0] == '/' ? argv[i] : std::string("/") + argv[i]);
+    if (s.files.size() < 2) {
+        fprintf(stderr, "playlist_runner: two files at least\n");
+        return 2;
+    }
+
+    fs::FS fs(dir);
+    s_fs = &fs;
+    host_shim::i2s_set_sink(sink, nullptr);
+    host_shim::i2s_set_speed(speed);
+    Audio::audio_info_callback = onInfo;
+
+    Audio* audio = new Audio();
+    s_audio = audio;
+    if (!audio->setPinout(1, 2, 3)) {
+        printf("setPinout failed\n");
+        return 1;
+    }
+    audio->setDualTask(dual);
+    if (!audio->connecttoFS(fs, s.files[0].c_str())) {
+        printf("connecttoFS(\"%s\") failed\n", s.files[0].c_str());
+        return 1;
+    }
+    if (s.queue) audio->queueNext(fs, s.files[1].c_str());
+
+    uint32_t t0 = millis(), idleSince = 0;
+    while (millis() - t0 < 30000) {
+        audio->loop();
+        if (s.current >= s.files.size()) { // the last eof, let the tail of SamplesBuff play out
+            if (!idleSince) idleSince = millis();
+            if (millis() - idleSince > 500) break;
+        }
+        vTaskDelay(1);
+    }
+    uint32_t elapsed = millis() - t0;
+    delete audio;
+    host_shim::i2s_set_sink(nullptr, nullptr);
+
+    printf("%s, %s task, %u ms at %gx\n", s.queue ? "queueNext" : "evt_eof handler", dual ? "dual" : "single", elapsed, speed);
+    if (s.eofs.size() != s.files.size()) {
+        printf("%zu of %zu files reached their eof\n", s.eofs.size(), s.files.size());
+        s.errors++;
+    }
+    std::map<uint32_t, uint64_t> expected; // frames per sample rate
+    Audio                        ref;
+    for (const std::string& file : s.files) {
+        std::vector<uint8_t> data;
+        host::DecodeStats    stats;
+        host::codec_t        codec = host::codecFromPath(file.c_str());
+        if (!host::readFile((std::string(dir) + file).c_str(), data) || !host::decodeBuffer(ref, codec, data, stats)) {
+            printf("  %s can not be decoded for the reference\n", baseName(file));
+            s.errors++;
+            continue;
+        }
+        expected[stats.sampleRate] += stats.samples;
+    }
+    for (auto& [rate, frames] : expected) {
+        uint64_t out = s.frames.count(rate) ? s.frames[rate] : 0;
+        bool     ok = out * 100 >= frames * 99 && out * 100 <= frames * 101;
+        printf("  %6u Hz  %8llu of %8llu frames  %6.2f s%s\n", rate, (unsigned long long)out, (unsigned long long)frames, (double)out / rate, ok ? "" : "  <-- differs");
+        if (!ok) s.errors++;
+    }
+    for (auto& [rate, frames] : s.frames)
+        if (!expected.count(rate)) printf("  %6u Hz  %8llu frames, not expected\n", rate, (unsigned long long)frames);
+    if (s.errors) printf("FAILED, %d error(s)\n", s.errors);
+    return s.errors ? 1 : 0;
+}
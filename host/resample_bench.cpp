@@ -0,0 +1,175 @@
+/*
+ * resample_bench.cpp
+ *
+ * Quality and cost of the sample rate conversion of Audio::cacheSamples() (audiolib::resampler_t) for the ratios that
+ * setOutputSampleRate() needs most: 44.1 <-> 48 kHz, 22.05 -> 48 kHz, 16 -> 48 kHz and 96 -> 48 kHz, with all tiers
+ * of setResampleQuality() (RS_LINEAR is the former linear interpolation with a biquad lowpass). The rows with 'ppm' use
+ * the variable ratio of setDriftCompensation() (2^VAR_BITS phases, interpolated), also for 44.1 -> 44.1 kHz.
+ *
+ *   usage: resample_bench [-n repeat]
+ *
+ *   -n  passes over 1 s of input for the timing, default 20
+ *
+ * blocks  the input is converted in blocks of 1152 frames (MP3) and in random blocks of 1 ... 1500 frames, the outputs
+ *         must be bit exact (not checked for RS_LINEAR) and have the length in * out / in / (1 + ppm), less the taps / 2
+ *         input frames of the filter that wait for the next block
+ * THD+N   a -1 dBFS sine at 1 kHz and at 40 % of the lower sample rate ('high'), the residual after a least squares fit
+ *         of the sine (amplitude, phase, DC) relative to the sine, over 32768 output frames after the start. Images of the
+ *         input spectrum that the filter lets through (upsampling) fall into the residual. 'gain' is the level of the
+ *         high sine, the passband edge of the tier.
+ * alias   downsampling only: the output level of a sine between both Nyquist frequencies, it must be removed
+ * time    cycles per output frame (TSC on x86, else ns), blocks of 1152 frames
+ *
+ */
+
+#include "decoder_host.h"
+#include <cmath>
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+static inline uint64_t ticks() { return __rdtsc(); }
+static const char*     unit = "cycles";
+#else
+static inline uint64_t ticks() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+static const char* unit = "ns";
+#endif
+
+using audiolib::resampler_t;
+
+static const char* qualityName[] = {"linear", "low", "medium", "high"};
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// converts in with the block sizes of next(), returns the output frames
+template <typename F> static std::vector<int32_t> convert(resampler_t& rs, const std::vector<int32_t>& in, uint32_t inRate, uint32_t outRate, F next) {
+    std::vector<int32_t> out;
+    std::vector<int32_t> tmp;
+    size_t               frames = in.size() / 2;
+    for (size_t pos = 0; pos < frames;) {
+        uint32_t n = std::min<size_t>(next(), frames - pos);
+        tmp.resize(((uint64_t)n * outRate / inRate + 2) * 2);
+        uint32_t got = rs.process(in.data() + 2 * pos, n, tmp.data());
+        out.insert(out.end(), tmp.begin(), tmp.begin() + got * 2);
+        pos += n;
+    }
+    return out;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+static std::vector<int32_t> sine(double f, uint32_t rate, size_t frames) {
+    std::vector<int32_t> v(frames * 2);
+    for (size_t i = 0; i < frames; i++) v[2 * i] = v[2 * i + 1] = (int32_t)lrint(0.891 * 2147483647.0 * sin(2 * M_PI * f * i / rate));
+    return v;
+}
+// least squares fit of a * cos + b * sin + c: residual relative to the sine (THD+N) and amplitude of the sine, dB
+static std::pair<double, double> fit(const std::vector<int32_t>& out, double f, uint32_t rate, size_t start, size_t len) {
+    double A[3][4] = {};
+    for (size_t i = start; i < start + len; i++) {
+        double x[3] = {cos(2 * M_PI * f * i / rate), sin(2 * M_PI * f * i / rate), 1}, y = out[2 * i] / 2147483648.0;
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) A[r][c] += x[r] * x[c];
+            A[r][3] += x[r] * y;
+        }
+    }
+    for (int k = 0; k < 3; k++) // Gauss-Jordan, the matrix is well conditioned
+        for (int r = 0; r < 3; r++) {
+            if (r == k) continue;
+            double m = A[r][k] / A[k][k];
+            for (int c = k; c < 4; c++) A[r][c] -= m * A[k][c];
+        }
+    double a = A[0][3] / A[0][0], b = A[1][3] / A[1][1], c = A[2][3] / A[2][2], e2 = 0;
+    for (size_t i = start; i < start + len; i++) {
+        double e = out[2 * i] / 2147483648.0 - (a * cos(2 * M_PI * f * i / rate) + b * sin(2 * M_PI * f * i / rate) + c);
+        e2 += e * e;
+    }
+    return {10 * log10(e2 / len / ((a * a + b * b) / 2) + 1e-30), 20 * log10(sqrt(a * a + b * b) / 0.891 + 1e-15)};
+}
+// level of the output relative to the sine, dB
+static double level(const std::vector<int32_t>& out, size_t start, size_t len) {
+    double e2 = 0;
+    for (size_t i = start; i < start + len; i++) e2 += (out[2 * i] / 2147483648.0) * (out[2 * i] / 2147483648.0);
+    return 10 * log10(e2 / len / (0.891 * 0.891 / 2) + 1e-30);
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int main(int argc, char* argv[]) {
+    uint32_t repeat = 20;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            repeat = std::max(1, atoi(argv[++i]));
+        else {
+            printf("usage: %s [-n repeat]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    const uint32_t ratios[][2] = {{44100, 48000}, {48000, 44100}, {22050, 48000}, {16000, 48000}, {96000, 48000}, {44100, 44100}};
+    const float    drift = 300; // ppm
+    int            failed = 0;
+
+    printf("%-16s %-7s %5s %5s %7s %9s %9s %14s %11s %14s %10s %14s\n", "ratio", "quality", "ppm", "taps", "phases", "table KB", "high", "THD+N 1 kHz", "gain high", "THD+N high",
+           "alias", (std::string(unit) + "/frame").c_str());
+    for (auto& r : ratios) {
+        const uint32_t       in = r[0], out = r[1];
+        const double         hi = floor(0.4 * std::min(in, out) / 100) * 100, alias = (in + out) / 4.0;
+        std::vector<int32_t> noise(in * 2); // 1 s, about -6 dBFS
+        uint32_t             rnd = 1;
+        for (auto& x : noise) {
+            rnd = rnd * 1664525 + 1013904223;
+            x = (int32_t)rnd / 2;
+        }
+        for (int v = in == out; v < 2; v++)
+        for (uint8_t q = resampler_t::LINEAR; q <= resampler_t::HIGH; q++) {
+            const float ppm = v ? drift : 0;
+            resampler_t rs;
+            auto        setup = [&] {
+                rs.setup(in, out, q, v);
+                rs.setPpm(ppm);
+            };
+            setup();
+            if (rs.quality != q) {
+                printf("%6u -> %-6u %-7s no table\n", in, out, qualityName[q]);
+                failed++;
+                continue;
+            }
+
+            // blocks
+            std::vector<int32_t> a = convert(rs, noise, in, out, [] { return 1152u; });
+            uint32_t             rnd2 = 7;
+            setup();
+            std::vector<int32_t> b = convert(rs, noise, in, out, [&] { return (rnd2 = rnd2 * 1664525 + 1013904223) % 1500 + 1; });
+            size_t               want = out / (1 + ppm * 1e-6), held = (uint64_t)(rs.taps / 2 + 1) * out / in + 1;
+            bool                 ok = (a == b || q == resampler_t::LINEAR) && a.size() / 2 + held >= want && a.size() / 2 <= want + 1;
+            if (!ok) failed++;
+
+            // THD+N, gain, alias
+            std::pair<double, double> t[2];
+            int                       k = 0;
+            for (double f : {1000.0, hi}) {
+                setup();
+                t[k++] = fit(convert(rs, sine(f, in, in * 2), in, out, [] { return 1152u; }), f * (1 + ppm * 1e-6), out, 4096, 32768);
+            }
+            char aliasStr[16] = "-";
+            if (out < in) {
+                setup();
+                snprintf(aliasStr, sizeof(aliasStr), "%.1f dB", level(convert(rs, sine(alias, in, in * 2), in, out, [] { return 1152u; }), 4096, 32768));
+            }
+
+            // time
+            setup();
+            std::vector<int32_t> tmp(((uint64_t)1152 * out / in + 2) * 2);
+            uint64_t             frames = 0, t0 = ticks();
+            for (uint32_t n = 0; n < repeat; n++)
+                for (size_t pos = 0; pos + 1152 <= noise.size() / 2; pos += 1152) frames += rs.process(noise.data() + 2 * pos, 1152, tmp.data());
+            double perFrame = (double)(ticks() - t0) / frames;
+
+            char name[20];
+            snprintf(name, sizeof(name), "%u -> %u", in, out);
+            uint32_t phases = !rs.taps ? 0 : v ? (1 << resampler_t::VAR_BITS) + 1 : rs.L;
+            printf("%-16s %-7s %5s %5u %7u %9.1f %6.0f Hz %11.1f dB %8.2f dB %11.1f dB %10s %14.1f%s\n", name, qualityName[q], v ? "+300" : "-", rs.taps, phases, phases * rs.taps * 4 / 1024.0, hi,
+                   t[0].first, t[1].second, t[1].first, aliasStr, perFrame, ok ? "" : "  <-- blocks differ");
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+/*
+ * ringbuffer_bench.cpp
+ *
+ * Stress test and throughput of the lock-free RingBuffer (src/ringbuffer.cpp) with a producer and a consumer thread,
+ * the same roles as the audio task (cacheSamples) and the output task (playChunk) in dual task mode.
+ *
+ *   usage: ringbuffer_bench [-n frames] [-s ring size in words]
+ *
+ *   -n  frames per run (default 20000000)
+ *   -s  size of the ring in words (default 32768, 128 * DMA_FRAME_NUM like SamplesBuff), use an odd number of frames
+ *       like 4098 to let the blocks wrap anywhere
+ *
+ * stress  the producer writes a frame counter (L) and its complement (R), in random block sizes and alternately with
+ *         write() and writeView(). The consumer reads with read(), peek() and readView() and checks every frame.
+ * bench   frames/s with blocks of DMA_FRAME_NUM frames: both sides copy (write/read), both sides zero-copy
+ *         (writeView/readView, the consumer processes in place like the DSP chain), and single threaded for comparison.
+ *
+ */
+
+#include "decoder_host.h"
+#include <random>
+#include <thread>
+
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+static uint64_t nowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+static inline void putFrame(int32_t* p, uint32_t n) {
+    p[0] = (int32_t)n;
+    p[1] = (int32_t)~n;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+static bool stress(size_t ringWords, uint32_t frames) {
+    RingBuffer rb;
+    rb.setBufsize(ringWords);
+    if (!rb.init()) return false;
+
+    std::atomic<uint32_t> errors{0};
+    std::thread producer([&]() {
+        std::mt19937 rnd(1);
+        int32_t      tmp[2 * 1024];
+        uint32_t     n = 0;
+        while (n < frames) {
+            uint32_t want = std::min<uint32_t>(1 + rnd() % 1024, frames - n);
+            if (rnd() & 1) { // copy
+                for (uint32_t i = 0; i < want; i++) putFrame(tmp + 2 * i, n + i);
+                n += rb.write(tmp, want * 2) / 2;
+            } else { // in place
+                RingBuffer::spans_t v = rb.writeView(want * 2);
+                uint32_t            k = n;
+                for (std::span<int32_t> s : {v.first, v.second})
+                    for (size_t i = 0; i + 1 < s.size(); i += 2) putFrame(s.data() + i, k++);
+                rb.bytesWritten((k - n) * 2);
+                n = k;
+            }
+            if ((rnd() & 63) == 0) std::this_thread::yield();
+        }
+    });
+    std::thread consumer([&]() {
+        std::mt19937 rnd(2);
+        int32_t      tmp[2 * 1024];
+        uint32_t     n = 0;
+        auto         check = [&](const int32_t* p, uint32_t k) {
+            if (p[0] != (int32_t)k || p[1] != (int32_t)~k) {
+                if (errors++ < 5) printf("stress: frame %u read as %d/%d\n", k, p[0], ~p[1]);
+            }
+        };
+        while (n < frames) {
+            uint32_t want = 1 + rnd() % 1024;
+            switch (rnd() % 3) {
+                case 0: { // copy
+                    uint32_t got = rb.read(tmp, want * 2) / 2;
+                    for (uint32_t i = 0; i < got; i++) check(tmp + 2 * i, n + i);
+                    n += got;
+                    break;
+                }
+                case 1: { // peek, then release a part
+                    uint32_t got = rb.peek(tmp, want * 2) / 2;
+                    for (uint32_t i = 0; i < got; i++) check(tmp + 2 * i, n + i);
+                    got = got ? 1 + rnd() % got : 0;
+                    rb.bytesRead(got * 2);
+                    n += got;
+                    break;
+                }
+                default: { // in place
+                    RingBuffer::spans_t v = rb.readView(want * 2);
+                    uint32_t            k = n;
+                    for (std::span<int32_t> s : {v.first, v.second})
+                        for (size_t i = 0; i + 1 < s.size(); i += 2) check(s.data() + i, k++);
+                    rb.bytesRead((k - n) * 2);
+                    n = k;
+                }
+            }
+            if ((rnd() & 63) == 0) std::this_thread::yield();
+        }
+    });
+    producer.join();
+    consumer.join();
+
+    bool ok = !errors && rb.bufferFilled() == 0;
+    printf("stress: %u frames through %zu words, %u errors, %s\n", frames, ringWords, errors.load(), ok ? "ok" : "FAILED");
+    return ok;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+enum BenchMode { COPY, VIEW, SINGLE };
+
+static double bench(size_t ringWords, uint32_t frames, BenchMode mode) {
+    const uint32_t block = 256; // DMA_FRAME_NUM
+    RingBuffer     rb;
+    rb.setBufsize(ringWords);
+    if (!rb.init()) return 0;
+
+    std::vector<int32_t> src(block * 2, 1), dst(block * 2);
+    int64_t              sum = 0;
+    auto                 produce = [&](uint32_t left) -> uint32_t { // the last block may be shorter
+        const uint32_t n = std::min(block, left);
+        if (mode != VIEW) return rb.write(src.data(), n * 2) / 2;
+        RingBuffer::spans_t v = rb.writeView(n * 2);
+        for (std::span<int32_t> s : {v.first, v.second}) std::fill(s.begin(), s.end(), 1); // what the decoder would write
+        rb.bytesWritten(v.size());
+        return v.size() / 2;
+    };
+    auto consume = [&]() -> uint32_t {
+        if (mode != VIEW) {
+            uint32_t got = rb.read(dst.data(), block * 2) / 2;
+            for (uint32_t i = 0; i < got * 2; i++) sum += dst[i];
+            return got;
+        }
+        RingBuffer::spans_t v = rb.readView(block * 2);
+        for (std::span<int32_t> s : {v.first, v.second})
+            for (int32_t& x : s) sum += x; // what the DSP chain would do in place
+        rb.bytesRead(v.size());
+        return v.size() / 2;
+    };
+
+    uint64_t t0 = nowNs();
+    if (mode == SINGLE) {
+        for (uint32_t n = 0, p = 0; n < frames;) {
+            p += produce(frames - p);
+            n += consume();
+        }
+    } else {
+        std::thread producer([&]() {
+            for (uint32_t n = 0; n < frames;) {
+                uint32_t k = produce(frames - n);
+                if (!k) std::this_thread::yield();
+                n += k;
+            }
+        });
+        for (uint32_t n = 0; n < frames;) {
+            uint32_t k = consume();
+            if (!k) std::this_thread::yield();
+            n += k;
+        }
+        producer.join();
+    }
+    uint64_t ns = nowNs() - t0;
+    if (sum != (int64_t)frames * 2) {
+        printf("bench: checksum %lld, expected %lld  <-- FAILED\n", (long long)sum, (long long)frames * 2);
+        return 0;
+    }
+    return ns ? frames * 1e9 / ns : 0;
+}
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int main(int argc, char* argv[]) {
+    uint32_t frames = 20000000;
+    size_t   ringWords = 128 * 256;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            frames = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+            ringWords = std::max(2048, atoi(argv[++i])) & ~1;
+        else {
+            printf("usage: %s [-n frames] [-s ring size in words]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bool ok = stress(ringWords, frames);
+    ok = stress(4098, frames / 4) && ok; // odd number of frames, the blocks wrap anywhere
+
+    printf("\n%-28s %14s\n", "bench", "frames/s");
+    const char* names[] = {"2 threads, write/read", "2 threads, writeView/readView", "1 thread,  write/read"};
+    for (BenchMode mode : {COPY, VIEW, SINGLE}) {
+        double rate = bench(ringWords, frames, mode); // 0: checksum mismatch or no memory
+        printf("%-28s %14.0f\n", names[mode], rate);
+        ok = rate > 0 && ok;
+    }
+    return ok ? 0 : 1;
+}
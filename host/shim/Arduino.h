@@ -0,0 +1,105 @@
+/*
+ * Arduino.h  -  host shim
+ *
+ * Minimal subset of the arduino-esp32 core that the decoders and Audio.h need to compile on a Linux workstation.
+ * PSRAM is plain heap memory, FreeRTOS delays are sleeps, the ESP log macros print to stdout.
+ *
+ */
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <array>
+#include <string>
+#include <string_view>
+
+#include "esp32-hal-log.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+using std::abs;
+using std::isinf;
+using std::isnan;
+using std::max;
+using std::min;
+using ::round;
+
+#define PI         3.1415926535897932384626433832795
+#define HALF_PI    1.5707963267948966192313216916398
+#define TWO_PI     6.283185307179586476925286766559
+#define _min(a, b) ((a) < (b) ? (a) : (b))
+#define _max(a, b) ((a) > (b) ? (a) : (b))
+
+typedef bool     boolean;
+typedef uint8_t  byte;
+typedef uint16_t word;
+
+#ifndef __unused
+    #define __unused __attribute__((unused)) // newlib <sys/cdefs.h>
+#endif
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define PROGMEM
+#define pgm_read_byte(addr)  (*(const uint8_t*)(addr))
+#define pgm_read_word(addr)  (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+
+// ------------------------------------------------------------------------------------------------------------------
+// time
+// ------------------------------------------------------------------------------------------------------------------
+inline int64_t esp_timer_get_time() { // µs since an arbitrary epoch, monotonic
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+inline unsigned long millis() { return (unsigned long)(esp_timer_get_time() / 1000); }
+inline unsigned long micros() { return (unsigned long)esp_timer_get_time(); }
+inline void          delay(uint32_t ms) { vTaskDelay(ms); }
+inline long          random(long howbig) { return howbig ? std::rand() % howbig : 0; }
+inline long          random(long howsmall, long howbig) { return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall); }
+
+// ------------------------------------------------------------------------------------------------------------------
+// memory, PSRAM is emulated by the ordinary heap
+// ------------------------------------------------------------------------------------------------------------------
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_DEFAULT  (1 << 12)
+
+namespace host_shim {
+void*  heap_alloc(size_t size, bool zero);
+void*  heap_realloc(void* ptr, size_t size);
+size_t heap_in_use();   // bytes currently allocated through ps_malloc & co.
+size_t heap_peak();     // high-water mark of heap_in_use() since the last heap_reset_peak()
+void   heap_reset_peak();
+} // namespace host_shim
+
+inline bool   psramFound() { return true; }
+inline bool   psramInit() { return true; }
+inline void*  ps_malloc(size_t size) { return host_shim::heap_alloc(size, false); }
+inline void*  ps_calloc(size_t n, size_t size) { return host_shim::heap_alloc(n * size, true); }
+inline void*  ps_realloc(void* ptr, size_t size) { return host_shim::heap_realloc(ptr, size); }
+inline void*  heap_caps_malloc(size_t size, uint32_t) { return host_shim::heap_alloc(size, false); }
+inline void*  heap_caps_calloc(size_t n, size_t size, uint32_t) { return host_shim::heap_alloc(n * size, true); }
+inline size_t heap_caps_get_free_size(uint32_t) { return SIZE_MAX / 2 - host_shim::heap_in_use(); }
+inline bool   heap_caps_check_integrity_all(bool) { return true; }
+inline size_t ESP_getFreeHeap() { return heap_caps_get_free_size(0); }
+
+// ------------------------------------------------------------------------------------------------------------------
+// Serial, only print() and printf() are supported
+// ------------------------------------------------------------------------------------------------------------------
+struct HostSerial {
+    void   begin(unsigned long) {}
+    size_t print(const char* s) { return (size_t)std::fputs(s, stdout); }
+    size_t println(const char* s = "") { return (size_t)std::printf("%s\n", s); }
+    template <typename... Args> size_t printf(const char* fmt, Args... args) { return (size_t)std::printf(fmt, args...); }
+};
+inline HostSerial Serial;
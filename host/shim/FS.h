@@ -0,0 +1,65 @@
+/*
+ * FS.h  -  host shim
+ *
+ * fs::FS maps the paths of connecttoFS() into a directory of the host, FS("additional_info/Testfiles") opens
+ * "/Collide.ogg" as additional_info/Testfiles/Collide.ogg. Files are opened read only, a File is a shared handle like
+ * the one of arduino-esp32.
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+
+namespace fs {
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File {
+  public:
+    File() = default;
+    File(FILE* f, std::string path) : m_file(f, fclose), m_path(std::move(path)) {
+        size_t slash = m_path.find_last_of('/');
+        m_name = slash == std::string::npos ? m_path : m_path.substr(slash + 1);
+        struct stat st;
+        m_size = fstat(fileno(f), &st) == 0 ? (size_t)st.st_size : 0;
+    }
+    explicit operator bool() const { return m_file != nullptr; }
+    const char* name() const { return m_name.c_str(); }
+    const char* path() const { return m_path.c_str(); }
+    size_t      size() const { return m_size; }
+    size_t      position() const { return m_file ? (size_t)ftell(m_file.get()) : 0; }
+    bool        seek(uint32_t pos, SeekMode mode = SeekSet) { return m_file && fseek(m_file.get(), (long)pos, mode == SeekSet ? SEEK_SET : mode == SeekCur ? SEEK_CUR : SEEK_END) == 0; }
+    int         read() { return m_file ? fgetc(m_file.get()) : -1; }
+    size_t      read(uint8_t* buf, size_t size) { return m_file ? fread(buf, 1, size, m_file.get()) : 0; }
+    int         available() { return m_file ? (int)(m_size - position()) : 0; }
+    void        close() { m_file.reset(); }
+
+  private:
+    std::shared_ptr<FILE> m_file;
+    std::string           m_path;
+    std::string           m_name;
+    size_t                m_size = 0;
+};
+
+class FS {
+  public:
+    FS(std::string root = ".") : m_root(std::move(root)) {}
+    bool exists(const char* path) {
+        struct stat st;
+        return stat(hostPath(path).c_str(), &st) == 0 && S_ISREG(st.st_mode);
+    }
+    File open(const char* path, const char* mode = "r") {
+        if (mode[0] != 'r') return File(); // read only
+        FILE* f = fopen(hostPath(path).c_str(), "rb");
+        return f ? File(f, path) : File();
+    }
+
+  private:
+    std::string hostPath(const char* path) const { return m_root + (path[0] == '/' ? "" : "/") + path; }
+    std::string m_root;
+};
+} // namespace fs
+using fs::File;
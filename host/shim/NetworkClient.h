@@ -0,0 +1,24 @@
+/*
+ * NetworkClient.h  -  host shim
+ *
+ * There is no network on the host, connect() fails and nothing can be read.
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+class NetworkClient {
+  public:
+    virtual ~NetworkClient() = default;
+    virtual int    connect(const char*, uint16_t) { return 0; }
+    virtual int    connect(const char*, uint16_t, int32_t) { return 0; }
+    virtual int    available() { return 0; }
+    virtual bool   connected() { return false; }
+    virtual void   stop() {}
+    virtual int    read() { return -1; }
+    virtual int    read(uint8_t*, size_t) { return -1; }
+    void           setTimeout(uint32_t) {}
+    size_t         print(const char* s) { return connected() ? strlen(s) : 0; }
+};
@@ -0,0 +1,11 @@
+/*
+ * NetworkClientSecure.h  -  host shim
+ *
+ */
+#pragma once
+#include "NetworkClient.h"
+
+class NetworkClientSecure : public NetworkClient {
+  public:
+    void setInsecure() {}
+};
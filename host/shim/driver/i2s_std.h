@@ -0,0 +1,92 @@
+/*
+ * i2s_std.h  -  host shim
+ *
+ * There is no I2S peripheral on the host. An enabled channel runs a DMA clock in a thread of its own that sends one
+ * DMA buffer per dma_frame_num / sample_rate and raises on_sent, host_shim::i2s_set_speed() runs the clock faster than
+ * real time. i2s_channel_write() queues into dma_desc_num buffers and hands the data to the sink of
+ * host_shim::i2s_set_sink().
+ *
+ */
+#pragma once
+#include "../esp_err.h"
+#include <cstddef>
+#include <cstdint>
+
+typedef enum { I2S_NUM_0 = 0, I2S_NUM_1 = 1, I2S_NUM_AUTO } i2s_port_t;
+typedef enum { I2S_ROLE_MASTER, I2S_ROLE_SLAVE } i2s_role_t;
+typedef enum { I2S_DATA_BIT_WIDTH_8BIT = 8, I2S_DATA_BIT_WIDTH_16BIT = 16, I2S_DATA_BIT_WIDTH_24BIT = 24, I2S_DATA_BIT_WIDTH_32BIT = 32 } i2s_data_bit_width_t;
+typedef enum { I2S_SLOT_MODE_MONO = 1, I2S_SLOT_MODE_STEREO = 2 } i2s_slot_mode_t;
+typedef enum { I2S_CLK_SRC_DEFAULT } i2s_clock_src_t;
+typedef enum { I2S_MCLK_MULTIPLE_128 = 128, I2S_MCLK_MULTIPLE_256 = 256, I2S_MCLK_MULTIPLE_384 = 384 } i2s_mclk_multiple_t;
+typedef enum { I2S_GPIO_UNUSED = -1 } i2s_gpio_unused_t;
+typedef int gpio_num_t;
+
+typedef struct i2s_channel_obj_t* i2s_chan_handle_t;
+typedef struct {
+    i2s_port_t id;
+    i2s_role_t role;
+    uint32_t   dma_desc_num;
+    uint32_t   dma_frame_num;
+    bool       auto_clear;
+    bool       allow_pd;
+    int        intr_priority;
+} i2s_chan_config_t;
+typedef struct {
+    i2s_data_bit_width_t data_bit_width;
+    i2s_slot_mode_t      slot_mode;
+    bool                 bit_shift; // Philips format
+} i2s_std_slot_config_t;
+typedef struct {
+    uint32_t            sample_rate_hz;
+    i2s_clock_src_t     clk_src;
+    i2s_mclk_multiple_t mclk_multiple;
+} i2s_std_clk_config_t;
+typedef struct {
+    gpio_num_t mclk;
+    gpio_num_t bclk;
+    gpio_num_t ws;
+    gpio_num_t dout;
+    gpio_num_t din;
+    struct {
+        bool mclk_inv;
+        bool bclk_inv;
+        bool ws_inv;
+    } invert_flags;
+} i2s_std_gpio_config_t;
+typedef struct {
+    i2s_std_clk_config_t  clk_cfg;
+    i2s_std_slot_config_t slot_cfg;
+    i2s_std_gpio_config_t gpio_cfg;
+} i2s_std_config_t;
+typedef struct {
+    void*  data;
+    size_t size;
+} i2s_event_data_t;
+typedef bool (*i2s_isr_callback_t)(i2s_chan_handle_t handle, i2s_event_data_t* event, void* user_ctx);
+typedef struct {
+    i2s_isr_callback_t on_recv;
+    i2s_isr_callback_t on_recv_q_ovf;
+    i2s_isr_callback_t on_sent;
+    i2s_isr_callback_t on_send_q_ovf;
+} i2s_event_callbacks_t;
+
+#define I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(bits, mode) {.data_bit_width = (bits), .slot_mode = (mode), .bit_shift = true}
+#define I2S_STD_MSB_SLOT_DEFAULT_CONFIG(bits, mode)     {.data_bit_width = (bits), .slot_mode = (mode), .bit_shift = false}
+
+esp_err_t i2s_new_channel(const i2s_chan_config_t* chan_cfg, i2s_chan_handle_t* tx_handle, i2s_chan_handle_t* rx_handle);
+esp_err_t i2s_del_channel(i2s_chan_handle_t handle);
+esp_err_t i2s_channel_init_std_mode(i2s_chan_handle_t handle, const i2s_std_config_t* std_cfg);
+esp_err_t i2s_channel_reconfig_std_clock(i2s_chan_handle_t handle, const i2s_std_clk_config_t* clk_cfg);
+esp_err_t i2s_channel_reconfig_std_slot(i2s_chan_handle_t handle, const i2s_std_slot_config_t* slot_cfg);
+esp_err_t i2s_channel_reconfig_std_gpio(i2s_chan_handle_t handle, const i2s_std_gpio_config_t* gpio_cfg);
+esp_err_t i2s_channel_register_event_callback(i2s_chan_handle_t handle, const i2s_event_callbacks_t* callbacks, void* user_data);
+esp_err_t i2s_channel_enable(i2s_chan_handle_t handle);
+esp_err_t i2s_channel_disable(i2s_chan_handle_t handle);
+esp_err_t i2s_channel_preload_data(i2s_chan_handle_t tx_handle, const void* src, size_t size, size_t* bytes_loaded);
+esp_err_t i2s_channel_write(i2s_chan_handle_t handle, const void* src, size_t size, size_t* bytes_written, uint32_t timeout_ms);
+
+namespace host_shim {
+typedef void (*i2s_sink_t)(const void* data, size_t bytes, uint32_t sampleRate, void* ctx);
+void i2s_set_sink(i2s_sink_t sink, void* ctx); // called from the writing task, nullptr discards the data
+void i2s_set_speed(float speed);              // of the DMA clock, 1: real time
+} // namespace host_shim
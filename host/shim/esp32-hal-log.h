@@ -0,0 +1,16 @@
+/*
+ * esp32-hal-log.h  -  host shim
+ *
+ */
+#pragma once
+#include <cstdio>
+
+#ifndef CORE_DEBUG_LEVEL
+    #define CORE_DEBUG_LEVEL 2 // errors and warnings
+#endif
+
+#define log_e(fmt, ...) do { if (CORE_DEBUG_LEVEL >= 1) std::printf("[E] " fmt "\n", ##__VA_ARGS__); } while (0)
+#define log_w(fmt, ...) do { if (CORE_DEBUG_LEVEL >= 2) std::printf("[W] " fmt "\n", ##__VA_ARGS__); } while (0)
+#define log_i(fmt, ...) do { if (CORE_DEBUG_LEVEL >= 3) std::printf("[I] " fmt "\n", ##__VA_ARGS__); } while (0)
+#define log_d(fmt, ...) do { if (CORE_DEBUG_LEVEL >= 4) std::printf("[D] " fmt "\n", ##__VA_ARGS__); } while (0)
+#define log_v(fmt, ...) do { if (CORE_DEBUG_LEVEL >= 5) std::printf("[V] " fmt "\n", ##__VA_ARGS__); } while (0)
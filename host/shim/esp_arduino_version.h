@@ -0,0 +1,10 @@
+/*
+ * esp_arduino_version.h  -  host shim
+ *
+ */
+#pragma once
+#define ESP_ARDUINO_VERSION_MAJOR 3
+#define ESP_ARDUINO_VERSION_MINOR 0
+#define ESP_ARDUINO_VERSION_PATCH 0
+#define ESP_IDF_VERSION_MAJOR     5
+#define ESP_IDF_VERSION_MINOR     4
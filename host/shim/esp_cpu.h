@@ -0,0 +1,24 @@
+/*
+ * esp_cpu.h  -  host shim
+ *
+ * esp_cpu_get_cycle_count() reads the time stamp counter on x86, elsewhere it counts nanoseconds.
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+inline esp_cpu_cycle_count_t esp_cpu_get_cycle_count() {
+#if defined(__x86_64__) || defined(__i386__)
+    return (esp_cpu_cycle_count_t)__rdtsc();
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (esp_cpu_cycle_count_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+#endif
+}
@@ -0,0 +1,49 @@
+/*
+ * esp_dsp.h  -  host shim
+ *
+ * The radix-2 complex FFT of esp-dsp as Audio::calculateSpectrum() uses it: dsps_fft2r_fc32() leaves the result in
+ * bit-reversed order, dsps_bit_rev_fc32() sorts it. dsps_cplx2reC_fc32() does nothing here, for a real input (all
+ * imaginary parts zero) the lower half of the complex spectrum is the spectrum of the signal already.
+ *
+ */
+#pragma once
+#include "esp_err.h"
+#include <cmath>
+#include <utility>
+
+inline esp_err_t dsps_fft2r_init_fc32(float*, int table_size) { return (table_size & (table_size - 1)) ? ESP_ERR_INVALID_ARG : ESP_OK; }
+inline void      dsps_fft2r_deinit_fc32() {}
+
+inline esp_err_t dsps_fft2r_fc32(float* data, int N) { // decimation in frequency, data[2k] real, data[2k+1] imaginary
+    for (int len = N; len >= 2; len >>= 1) {
+        int half = len / 2;
+        for (int j = 0; j < half; j++) {
+            float wr = cosf(2.0f * (float)M_PI * j / len), wi = -sinf(2.0f * (float)M_PI * j / len);
+            for (int i = j; i < N; i += len) {
+                float* a = &data[2 * i];
+                float* b = &data[2 * (i + half)];
+                float  dr = a[0] - b[0], di = a[1] - b[1];
+                a[0] += b[0];
+                a[1] += b[1];
+                b[0] = dr * wr - di * wi;
+                b[1] = dr * wi + di * wr;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+inline esp_err_t dsps_bit_rev_fc32(float* data, int N) {
+    for (int i = 1, j = 0; i < N; i++) {
+        int bit = N >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j |= bit;
+        if (i < j) {
+            std::swap(data[2 * i], data[2 * j]);
+            std::swap(data[2 * i + 1], data[2 * j + 1]);
+        }
+    }
+    return ESP_OK;
+}
+
+inline esp_err_t dsps_cplx2reC_fc32(float*, int) { return ESP_OK; }
@@ -0,0 +1,143 @@
+/*
+ * FreeRTOS.h  -  host shim
+ *
+ * vTaskDelay() sleeps, a tick is one millisecond. xTaskCreate(Static)PinnedToCore() starts a std::thread (the core,
+ * the priority and the stack are ignored), every task has a notification counter for ulTaskNotifyTake(). A task can
+ * not be killed from outside: vTaskDelete() of another task waits until its function has returned, the tasks in
+ * Audio.cpp leave their loop as soon as their running flag is cleared. Semaphores and mutexes are a mutex with a
+ * condition variable.
+ *
+ */
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+struct HostTask {
+    std::mutex              mtx;
+    std::condition_variable cv;
+    uint32_t                notified = 0;
+    bool                    finished = false; // the task function has returned
+};
+typedef void*     SemaphoreHandle_t;
+typedef HostTask* TaskHandle_t;
+typedef void*     QueueHandle_t;
+typedef uint32_t  TickType_t;
+typedef int       BaseType_t;
+typedef uint32_t  UBaseType_t;
+typedef uint8_t   StackType_t;
+typedef struct {
+    uint8_t dummy[64];
+} StaticTask_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdTRUE             1
+#define pdFALSE            0
+#define pdPASS             1
+#define pdFAIL             0
+#define portMAX_DELAY      UINT32_MAX
+#define portNUM_PROCESSORS 2
+#define configTICK_RATE_HZ 1000
+#define pdMS_TO_TICKS(x)   ((TickType_t)(x))
+
+inline void       vTaskDelay(TickType_t ticks) { std::this_thread::sleep_for(std::chrono::milliseconds(ticks)); }
+inline TickType_t xTaskGetTickCount() { return (TickType_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+inline BaseType_t xPortGetCoreID() { return 0; }
+
+// ------------------------------------------------------------------------------------------------------------------
+// tasks
+// ------------------------------------------------------------------------------------------------------------------
+inline HostTask*& hostCurrentTask() { // the application (setup/loop) runs in a task of its own that is never created
+    static HostTask              appTask;
+    thread_local static HostTask* current = &appTask;
+    return current;
+}
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return hostCurrentTask(); }
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char*, uint32_t, void* param, UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+    HostTask* task = new HostTask;
+    std::thread([task, fn, param] {
+        hostCurrentTask() = task;
+        fn(param);
+        std::lock_guard<std::mutex> lock(task->mtx);
+        task->finished = true;
+        task->cv.notify_all();
+    }).detach();
+    if (handle) *handle = task;
+    return pdPASS;
+}
+inline TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* param, UBaseType_t prio, StackType_t*, StaticTask_t*, BaseType_t core) {
+    TaskHandle_t handle = nullptr;
+    xTaskCreatePinnedToCore(fn, name, stack, param, prio, &handle, core);
+    return handle;
+}
+inline void vTaskDelete(TaskHandle_t task) { // the HostTask is never freed, a late notification may still address it
+    if (task == nullptr || task == hostCurrentTask()) return; // the caller returns from its function right after this call
+    std::unique_lock<std::mutex> lock(task->mtx);
+    task->cv.wait(lock, [task] { return task->finished; });
+}
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 0; }
+
+// ------------------------------------------------------------------------------------------------------------------
+// task notifications, used as a counting semaphore
+// ------------------------------------------------------------------------------------------------------------------
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    {
+        std::lock_guard<std::mutex> lock(task->mtx);
+        task->notified++;
+    }
+    task->cv.notify_one();
+    return pdPASS;
+}
+inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+    xTaskNotifyGive(task);
+    if (woken) *woken = pdFALSE;
+}
+inline uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+    HostTask*                    task = hostCurrentTask();
+    std::unique_lock<std::mutex> lock(task->mtx);
+    if (ticks == portMAX_DELAY)
+        task->cv.wait(lock, [task] { return task->notified > 0; });
+    else
+        task->cv.wait_for(lock, std::chrono::milliseconds(ticks), [task] { return task->notified > 0; });
+    uint32_t count = task->notified;
+    if (count) task->notified = clearOnExit ? 0 : count - 1;
+    return count;
+}
+
+// ------------------------------------------------------------------------------------------------------------------
+// semaphores, a mutex is a binary semaphore that starts given (no priority inheritance, not recursive)
+// ------------------------------------------------------------------------------------------------------------------
+struct HostSemaphore {
+    std::mutex              mtx;
+    std::condition_variable cv;
+    bool                    given = false;
+};
+inline SemaphoreHandle_t xSemaphoreCreateBinary() { return new HostSemaphore; }
+inline SemaphoreHandle_t xSemaphoreCreateMutex() {
+    HostSemaphore* h = new HostSemaphore;
+    h->given = true;
+    return h;
+}
+inline void       vSemaphoreDelete(SemaphoreHandle_t s) { delete (HostSemaphore*)s; }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+    HostSemaphore* h = (HostSemaphore*)s;
+    {
+        std::lock_guard<std::mutex> lock(h->mtx);
+        h->given = true;
+    }
+    h->cv.notify_one();
+    return pdTRUE;
+}
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks) {
+    HostSemaphore*               h = (HostSemaphore*)s;
+    std::unique_lock<std::mutex> lock(h->mtx);
+    if (ticks == portMAX_DELAY)
+        h->cv.wait(lock, [h] { return h->given; });
+    else if (!h->cv.wait_for(lock, std::chrono::milliseconds(ticks), [h] { return h->given; }))
+        return pdFALSE;
+    h->given = false;
+    return pdTRUE;
+}
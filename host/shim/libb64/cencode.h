@@ -0,0 +1,54 @@
+/*
+ * cencode.h  -  host shim
+ *
+ * The streaming base64 encoder of libb64 as arduino-esp32 ships it: no line breaks, base64_encode_blockend() pads
+ * and terminates the output.
+ *
+ */
+#pragma once
+
+typedef struct {
+    int           count;   // bytes in rest
+    unsigned char rest[2]; // input that does not fill a group of three yet
+} base64_encodestate;
+
+inline int base64_encode_expected_len(int plaintext_len) { return ((4 * plaintext_len / 3) + 3) & ~3; }
+
+inline void base64_init_encodestate(base64_encodestate* state) { state->count = 0; }
+
+inline int base64_encode_block(const char* plaintext_in, int length_in, char* code_out, base64_encodestate* state) {
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char*             out = code_out;
+    for (int i = 0; i < length_in; i++) {
+        unsigned char c = (unsigned char)plaintext_in[i];
+        if (state->count < 2) {
+            state->rest[state->count++] = c;
+            continue;
+        }
+        *out++ = table[state->rest[0] >> 2];
+        *out++ = table[(state->rest[0] & 0x03) << 4 | state->rest[1] >> 4];
+        *out++ = table[(state->rest[1] & 0x0f) << 2 | c >> 6];
+        *out++ = table[c & 0x3f];
+        state->count = 0;
+    }
+    return (int)(out - code_out);
+}
+
+inline int base64_encode_blockend(char* code_out, base64_encodestate* state) {
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char*             out = code_out;
+    if (state->count == 1) {
+        *out++ = table[state->rest[0] >> 2];
+        *out++ = table[(state->rest[0] & 0x03) << 4];
+        *out++ = '=';
+        *out++ = '=';
+    } else if (state->count == 2) {
+        *out++ = table[state->rest[0] >> 2];
+        *out++ = table[(state->rest[0] & 0x03) << 4 | state->rest[1] >> 4];
+        *out++ = table[(state->rest[1] & 0x0f) << 2];
+        *out++ = '=';
+    }
+    *out = '\0';
+    state->count = 0;
+    return (int)(out - code_out);
+}
@@ -17,6 +17,7 @@ char audioI2SVers[] = "\
 
 #include "Audio.h"
 #include "aac_decoder/aac_decoder.h"
+#include "dsp.h"
 #include "flac_decoder/flac_decoder.h"
 #include "mp3_decoder/mp3_decoder.h"
 #include "opus_decoder/opus_decoder.h"
@@ -35,6 +36,7 @@ constexpr size_t m_outbuffSize = 4608 * 2;
 constexpr size_t m_resamplesBuffSize = m_outbuffSize * 8; // SRmin: 6KHz -> SRmax: 48K
 
 constexpr size_t AUDIO_STACK_SIZE = 3700;
+constexpr size_t OUTPUT_STACK_SIZE = 3700; // dual task mode, allocated with the task
 
 // static allocations for Audio task
 StaticTask_t __attribute__((unused)) xAudioTaskBuffer;
@@ -49,9 +51,11 @@ __attribute__((weak)) void audio_process_raw_samples(int32_t* outBuff, int16_t v
 }
 //-------------------------------------------------------------------------------------------------------------------
 static bool IRAM_ATTR i2s_tx_sent_callback(i2s_chan_handle_t handle, i2s_event_data_t* event, void* user_ctx) {
-    Audio* audio = static_cast<Audio*>(user_ctx);
+    Audio*     audio = static_cast<Audio*>(user_ctx);
+    BaseType_t woken = pdFALSE;
     audio->m_dmaFreeDesc.fetch_add(1);
-    return false; // keine höhere Task geweckt
+    if (audio->m_dmaNotifyTask) vTaskNotifyGiveFromISR(audio->m_dmaNotifyTask, &woken); // wake audioTask()
+    return woken == pdTRUE;
 }
 
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -128,6 +132,43 @@ void AudioBuffer::reset() {
     m_writeSpace = std::min(MAX_TRANSFER_SIZE, m_mainSize);
 }
 //----------------------------------------------------------------------------------------------------------------------------------------------------
+void AudioBuffer::release() {
+    m_buffer.reset();
+    if (m_mutex) vSemaphoreDelete(m_mutex);
+    m_mutex = nullptr;
+    m_bufferBegin = nullptr;
+    m_mainEnd = nullptr;
+    m_bufferEnd = nullptr;
+    m_readPtr = nullptr;
+    m_writePtr = nullptr;
+    m_readSpace = 0;
+    m_writeSpace = 0;
+    m_maxBlockSize = 0;
+    m_isEmpty = true;
+    m_isFull = false;
+    m_initialized = false;
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+void AudioBuffer::swap(AudioBuffer& other) { // the pointers stay valid, they point into the memory that is swapped with them
+    std::swap(m_mainSize, other.m_mainSize);
+    std::swap(m_reserveSize, other.m_reserveSize);
+    std::swap(m_totalSize, other.m_totalSize);
+    std::swap(m_maxBlockSize, other.m_maxBlockSize);
+    std::swap(m_readSpace, other.m_readSpace);
+    std::swap(m_writeSpace, other.m_writeSpace);
+    std::swap(m_buffer, other.m_buffer);
+    std::swap(m_bufferBegin, other.m_bufferBegin);
+    std::swap(m_mainEnd, other.m_mainEnd);
+    std::swap(m_bufferEnd, other.m_bufferEnd);
+    std::swap(m_readPtr, other.m_readPtr);
+    std::swap(m_writePtr, other.m_writePtr);
+    std::swap(m_initialized, other.m_initialized);
+    std::swap(m_isEmpty, other.m_isEmpty);
+    std::swap(m_isFull, other.m_isFull);
+    std::swap(m_log, other.m_log);
+    std::swap(m_mutex, other.m_mutex);
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
 void AudioBuffer::setMaxBlocksize(size_t size) {
     m_maxBlockSize = size;
 }
@@ -487,232 +528,6 @@ void AudioBuffer::sanityCheck() {
     if (m_readPtr == m_writePtr) { assert(m_isEmpty || m_isFull); }
 }
 
-// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-// 📌📌📌  R I N G B U F F E R  📌📌📌
-// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-
-// RingBuffer will be allocated in PSRAM
-//
-//  start            m_readPtr                    m_writePtr                                                     end
-//   |                  |<----------- m_used --------->|<--------------------- writeSpace ----------------------->|
-//   ▼                  ▼                              ▼                                                          ▼
-//   ---------------------------------------------------------------------------------------------------------------
-//   |                                           <--m_bufSize-->                                                   |
-//   ---------------------------------------------------------------------------------------------------------------
-//   |<---freeSpace---->|<------------filled---------->|<-----------------------freeSpace------------------------->|
-//
-//
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-RingBuffer::RingBuffer() {}
-
-RingBuffer::~RingBuffer() {
-    m_buffer.reset();
-}
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-void RingBuffer::setBufsize(size_t size) {
-    m_bufSize = size;
-}
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-size_t RingBuffer::getBufsize() const {
-    return m_bufSize;
-}
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-size_t RingBuffer::init() {
-    if (!m_buffer.alloc_array(m_bufSize, "RingBuffer")) {
-        m_init = false;
-        return 0;
-    }
-    m_log.set_name("\nRingBuffer_Log");
-    reset();
-    m_init = true;
-    return m_bufSize;
-}
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-void RingBuffer::clear() {}
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-void RingBuffer::reset() {
-    m_readIndex = 0;
-    m_writeIndex = 0;
-    m_used = 0;
-}
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-size_t RingBuffer::freeSpace() const {
-    if (!m_init) return 0;
-    return m_bufSize - m_used;
-}
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-size_t RingBuffer::bufferFilled() const {
-    if (!m_init) return 0;
-    return m_used;
-}
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-size_t RingBuffer::writeSpace() const {
-    if (!m_init) {
-        log_e("Buffer is not initialized");
-        return 0;
-    }
-    if (m_used == m_bufSize) return 0;
-
-    if (m_writeIndex >= m_readIndex) {
-        size_t s = m_bufSize - m_writeIndex;
-        if (m_readIndex == 0) return std::min(s, freeSpace());
-        return s;
-    }
-    return m_readIndex - m_writeIndex;
-}
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-size_t RingBuffer::readSpace() const {
-    if (!m_init) return 0;
-    if (m_used == 0) return 0;
-    if (m_readIndex < m_writeIndex) return m_writeIndex - m_readIndex;
-    return m_bufSize - m_readIndex;
-}
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-int32_t* RingBuffer::getWritePtr() {
-    if (!m_init) return nullptr;
-    return m_buffer.get() + m_writeIndex;
-}
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-int32_t* RingBuffer::getReadPtr() {
-    if (!m_init) return nullptr;
-    return m_buffer.get() + m_readIndex;
-}
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-bool RingBuffer::bytesWritten(size_t words) {
-
-    if (!m_init) return false;
-
-    if (words > freeSpace()) {
-        m_log.assignf("bytesWritten({}) > freeSpace({})", words, freeSpace());
-        m_log.println();
-        return false;
-    }
-    m_writeIndex = advanceIndex(m_writeIndex, words);
-    m_used += words;
-    return true;
-}
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-bool RingBuffer::bytesRead(size_t words) {
-
-    if (!m_init) return false;
-
-    if (words > bufferFilled()) {
-        m_log.assignf("bytesRead({}) > bufferFilled({})", words, bufferFilled());
-        m_log.println();
-        return false;
-    }
-    m_readIndex = advanceIndex(m_readIndex, words);
-    m_used -= words;
-    return true;
-}
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-size_t RingBuffer::write(const int32_t* src, size_t words) {
-
-    if (!m_init || !src || words == 0) return 0;
-
-    words = std::min(words, freeSpace());
-
-    // Stereo-Frames nicht zerreißen
-    words &= ~static_cast<size_t>(1);
-
-    size_t written = 0;
-
-    while (written < words) {
-        size_t chunk = writeSpace();
-        if (chunk == 0) {
-            m_log.assign("RingBuffer: writeSpace()==0");
-            m_log.println();
-            break;
-        }
-        chunk = std::min(chunk, words - written);
-        memcpy(getWritePtr(), src + written, chunk * sizeof(int32_t));
-        bytesWritten(chunk);
-        written += chunk;
-    }
-    return written;
-}
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-size_t RingBuffer::read(int32_t* dst, size_t words) {
-
-    if (!m_init || !dst || words == 0) return 0;
-
-    // Nicht mehr lesen als vorhanden
-    words = std::min(words, bufferFilled());
-
-    // Stereo-Frames nicht zerreißen
-    words &= ~static_cast<size_t>(1);
-
-    size_t read = 0;
-
-    while (read < words) {
-        size_t chunk = readSpace();
-        if (chunk == 0) {
-            m_log.assign("RingBuffer: readSpace()==0");
-            m_log.println();
-            break;
-        }
-        chunk = std::min(chunk, words - read);
-        memcpy(dst + read, getReadPtr(), chunk * sizeof(int32_t));
-        bytesRead(chunk);
-        read += chunk;
-    }
-    return read;
-}
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-size_t RingBuffer::peek(int32_t* dst, size_t words) {
-
-    if (!m_init || !dst || words == 0) return 0;
-
-    words = std::min(words, bufferFilled());
-    words &= ~static_cast<size_t>(1);
-
-    size_t read = 0;
-    size_t readIndex = m_readIndex; // lokale Kopie
-
-    while (read < words) {
-        size_t chunk;
-        if (readIndex < m_writeIndex) {
-            chunk = m_writeIndex - readIndex;
-        } else {
-            chunk = m_bufSize - readIndex;
-            if (chunk == 0) {
-                m_log.assignf("RingBuffer: m_bufSize=readIndex, filled: {}", bufferFilled());
-                m_log.println();
-                break;
-            }
-        }
-        chunk = std::min(chunk, words - read);
-        memcpy(dst + read, m_buffer.get() + readIndex, chunk * sizeof(int32_t));
-        read += chunk;
-        readIndex += chunk;
-        if (readIndex == m_bufSize) readIndex = 0;
-    }
-    return read;
-}
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-inline size_t RingBuffer::advanceIndex(size_t index, size_t words) const {
-    index += words;
-    while (index >= m_bufSize) {
-        index -= m_bufSize;
-        //  printf("advanceIndex, index {}, words {}\n", index, words);
-    }
-    return index;
-}
-//----------------------------------------------------------------------------------------------------------------------------------------------------
-void RingBuffer::showStatus() {
-    m_log.assignf("\n"
-                  "Initialized  : {}\n"
-                  "BufferSize   : {}\n"
-                  "Used         : {}\n"
-                  "Free         : {}\n"
-                  "ReadSpace    : {}\n"
-                  "WriteSpace   : {}\n"
-                  "ReadIndex    : {}\n"
-                  "WriteIndex   : {}\n\n",
-                  m_init, m_bufSize, m_used, freeSpace(), readSpace(), writeSpace(), m_readIndex, m_writeIndex);
-    m_log.print();
-}
-
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 // 📌📌📌  A U D I O   📌📌📌
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -721,7 +536,10 @@ Audio::Audio(uint8_t i2sPort) {
     m_f_I2S_init = false;
     mutex_audioTask = xSemaphoreCreateMutex();
     mutex_audioTaskIsDecoding = xSemaphoreCreateMutex();
-    clientsecure.setInsecure();
+    mutex_outputTask = xSemaphoreCreateMutex();
+    sem_outputTaskDone = xSemaphoreCreateBinary();
+    for (NetworkClientSecure& cs : clientsecure) cs.setInsecure();
+    resetNext(); // m_nextSrc uses the second client
     m_i2s_items.i2s_num = i2sPort; // i2s port number
 
     i2s_event_callbacks_t cbs = {};
@@ -730,6 +548,7 @@ Audio::Audio(uint8_t i2sPort) {
 Audio::~Audio() {
     stopSong();
     setDefaults();
+    resetNext();
 
     i2s_channel_disable(m_i2s_tx_handle);
     i2s_del_channel(m_i2s_tx_handle);
@@ -737,6 +556,8 @@ Audio::~Audio() {
     dsps_fft2r_deinit_fc32();
     vSemaphoreDelete(mutex_audioTask);
     vSemaphoreDelete(mutex_audioTaskIsDecoding);
+    vSemaphoreDelete(mutex_outputTask);
+    vSemaphoreDelete(sem_outputTaskDone);
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void Audio::destroy_decoder() {
@@ -796,7 +617,16 @@ void Audio::setDefaults() {
     initInBuff(); // initialize InputBuffer if not already done
 
     InBuff.reset();
-    SamplesBuff.reset();
+    if (!m_gapless.f_carry) { // else the last samples of the previous file are still being played
+        if (xSemaphoreTake(mutex_outputTask, 0.3 * configTICK_RATE_HZ) == pdTRUE) {
+            resetSamples();
+            XfadeBuff.reset();
+            m_xfade.f_fading = false;
+            xSemaphoreGive(mutex_outputTask);
+        } else {
+            AUDIO_LOG_ERROR("output task does not release SamplesBuff");
+        }
+    }
     m_streamTitle.reset();
     m_streamURL.reset();
     m_playlistBuff.reset();
@@ -808,7 +638,7 @@ void Audio::setDefaults() {
     m_outBuff.clear();       // Clear OutputBuffer
     m_resamplesBuff.clear(); // Clear ResamplesBuff
     m_syltTimeStamp.clear();
-    memset(m_audio_items.state_biquad, 0, sizeof(m_audio_items.state_biquad)); // clear biquad history
+    if (!m_gapless.f_carry) m_audio_items.eq.clearHistory(); // clear biquad history
 
     m_playlistURL.clear();
     m_playlistURL.shrink_to_fit();
@@ -821,9 +651,9 @@ void Audio::setDefaults() {
     m_linesWithEXTINF.clear();
     m_linesWithEXTINF.shrink_to_fit();
 
-    client.stop();
-    clientsecure.stop();
-    m_client = static_cast<NetworkClient*>(&client); /* default to *something* so that no NULL deref can happen */
+    client[m_clientSet].stop(); // the other client may hold the queued host
+    clientsecure[m_clientSet].stop();
+    m_client = static_cast<NetworkClient*>(&client[m_clientSet]); /* default to *something* so that no NULL deref can happen */
 
     m_f_timeout = false;
     m_f_chunked = false; // Assume not chunked
@@ -864,6 +694,9 @@ void Audio::setDefaults() {
 
     m_audioCurrentTime = 0;
     m_resumeFilePos = -1;
+    m_seekSample = -1;
+    m_skipSamples = 0;
+    m_mp3fi = {};
     m_audioDataStart = 0;
     m_audioDataSize = 0;
     m_audioFileSize = 0;
@@ -966,7 +799,7 @@ bool Audio::openai_speech(const char* api_key, const char* model, const char* in
 
     bool res = true;
     int  port = 443;
-    m_client = static_cast<NetworkClientSecure*>(&clientsecure);
+    m_client = static_cast<NetworkClientSecure*>(&clientsecure[m_clientSet]);
 
     uint32_t t = millis();
     info(*this, evt_info, "Connect to: \"{}\"", host.get());
@@ -1054,14 +887,16 @@ bool Audio::connecttohost(const char* host, const char* user, const char* pwd) {
     ps_ptr<char> c_user = user; // copy of user
     ps_ptr<char> c_pwd = pwd;   // copy of password
 
+    if (c_host.valid()) c_host.trim();
+    if (m_next.f_ready && m_next.type == 2 && c_host.valid() && m_next.path.equals(c_host.get())) return playNext(); // queued by queueNextHost(), connected and prefilled
+    resetNext(); // a new source replaces the queued one
+
     if (!c_host.valid()) {
         AUDIO_LOG_ERROR("Hostaddress is empty");
         stopSong();
         return false;
     }
 
-    c_host.trim();
-
     if (c_host.strlen() < 8) {
         AUDIO_LOG_ERROR("Hostaddress is too short");
         stopSong();
@@ -1074,6 +909,12 @@ bool Audio::connecttohost(const char* host, const char* user, const char* pwd) {
         return false;
     } // max length in Chrome DevTools
 
+    setDefaults();
+    return openHost(c_host, c_user, c_pwd);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool Audio::openHost(ps_ptr<char> c_host, ps_ptr<char> c_user, ps_ptr<char> c_pwd) { // connecttohost() after setDefaults(), prerollNext() for a queued host
+
     const char* user_agent = "Mozilla/5.0 (X11; Linux x86_64) Chrome/146.0.0.0 Safari/537.36";
     // const char* user_agent = "VLC/3.0.21 LibVLC/3.0.21 AppleWebKit/537.36 (KHTML, like Gecko)";
 
@@ -1118,8 +959,6 @@ bool Audio::connecttohost(const char* host, const char* user, const char* pwd) {
         b64encode((const char*)toEncode.get(), toEncode.strlen(), authorization.get());
     }
 
-    setDefaults();
-
     rqh.assignf("GET /{}", path);
     rqh.append(" HTTP/1.1\r\n");
     rqh.appendf("Host: {}\r\n", rqh_host);
@@ -1138,17 +977,17 @@ bool Audio::connecttohost(const char* host, const char* user, const char* pwd) {
     rqh.append("Connection: keep-alive\r\n\r\n");
 
     if (m_f_ssl) {
-        m_client = static_cast<NetworkClientSecure*>(&clientsecure);
+        m_client = static_cast<NetworkClientSecure*>(&clientsecure[m_clientSet]);
         if (port == 80) port = 443;
     } else {
-        m_client = static_cast<NetworkClient*>(&client);
+        m_client = static_cast<NetworkClient*>(&client[m_clientSet]);
     }
 
     timestamp = millis();
     m_client->setTimeout(m_f_ssl ? m_timeout_ms_ssl : m_timeout_ms);
 
     info(*this, evt_info, "connect to: \"{}\" on port {} path \"/{}\"", hwoe.get(), port, path.get());
-    res = m_client->connect(hwoe.get(), port);
+    res = m_client->connected() || (!m_f_nextSwapped && m_client->connect(hwoe.get(), port)); // connectNext() connects a queued host ahead
 
     m_expectedCodec = CODEC_NONE;
     m_expectedPlsFmt = FORMAT_NONE;
@@ -1193,6 +1032,10 @@ bool Audio::httpPrint(const char* host) {
         stopSong();
         return false;
     }
+    if (m_f_nextSwapped) { // redirect of a queued host, prerollNext() fails and playNext() follows it at the end of the current file
+        m_f_running = false;
+        return false;
+    }
 
     uint16_t     port = 0;     // port number
     ps_ptr<char> hwoe;         // host without extension
@@ -1255,10 +1098,10 @@ bool Audio::httpPrint(const char* host) {
     }
     if (!m_client->connected()) {
         if (m_f_ssl) {
-            m_client = static_cast<NetworkClientSecure*>(&clientsecure);
+            m_client = static_cast<NetworkClientSecure*>(&clientsecure[m_clientSet]);
             if (m_f_ssl && port == 80) port = 443;
         } else {
-            m_client = static_cast<NetworkClient*>(&client);
+            m_client = static_cast<NetworkClient*>(&client[m_clientSet]);
         }
         if (f_equal) info(*this, evt_info, "The host has disconnected, reconnecting");
 
@@ -1310,6 +1153,10 @@ bool Audio::httpPrint(const char* host) {
 bool Audio::httpRange(uint32_t seek, uint32_t length) {
 
     if (!m_f_running) return false;
+    if (m_f_nextSwapped) { // a queued host, prerollNext() does not reconnect while the audio task waits, playNext() opens it
+        m_f_running = false;
+        return false;
+    }
 
     uint16_t     port = 0;     // port number
     ps_ptr<char> c_host;       // copy of host
@@ -1373,10 +1220,10 @@ bool Audio::httpRange(uint32_t seek, uint32_t length) {
 
     if (m_client->connected()) { m_client->stop(); }
     if (m_f_ssl) {
-        m_client = static_cast<NetworkClientSecure*>(&clientsecure);
+        m_client = static_cast<NetworkClientSecure*>(&clientsecure[m_clientSet]);
         if (m_f_ssl && port == 80) port = 443;
     } else {
-        m_client = static_cast<NetworkClient*>(&client);
+        m_client = static_cast<NetworkClient*>(&client[m_clientSet]);
     }
 
     if (!m_client->connect(hwoe.get(), port)) {
@@ -1396,7 +1243,6 @@ bool Audio::httpRange(uint32_t seek, uint32_t length) {
 bool Audio::connecttoFS(fs::FS& fs, const char* path, int32_t fileStartTime) {
 
     ps_ptr<char> c_path;
-    ps_ptr<char> audioPath;
     bool         res = false;
     m_fileStartTime = fileStartTime;
     m_codec = CODEC_NONE;
@@ -1411,7 +1257,21 @@ bool Audio::connecttoFS(fs::FS& fs, const char* path, int32_t fileStartTime) {
         AUDIO_LOG_ERROR("No file extension found");
         goto exit;
     } // guard
+    if (!c_path.starts_with("/")) c_path.insert("/", 0);
+
+    if (m_next.f_ready && m_next.type == 1 && m_next.fs == &fs && m_next.path.equals(c_path.get())) { // queued by queueNext(), open, parsed and prefilled
+        m_next.fileStartTime = fileStartTime;
+        return playNext();
+    }
+    resetNext();   // a new source replaces the queued one
     setDefaults(); // free buffers an set defaults
+    res = openLocalFile(fs, c_path);
+
+exit:
+    return res;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool Audio::openLocalFile(fs::FS& fs, ps_ptr<char> c_path) { // connecttoFS() after setDefaults(), prerollNext() for a queued file
 
     if (c_path.ends_with_icase(".mp3")) m_codec = CODEC_MP3;
     if (c_path.ends_with_icase(".m4a")) m_codec = CODEC_M4A;
@@ -1425,25 +1285,253 @@ bool Audio::connecttoFS(fs::FS& fs, const char* path, int32_t fileStartTime) {
     if (m_codec == CODEC_OGG) m_f_ogg = true;
     if (m_codec == CODEC_NONE) { // guard
         int dotPos = c_path.last_index_of('.');
-        AUDIO_LOG_WARN("The {} format is not supported", path + dotPos);
-        goto exit;
+        AUDIO_LOG_WARN("The {} format is not supported", c_path.get() + dotPos);
+        return false;
     }
-
-    if (!c_path.starts_with("/")) c_path.insert("/", 0);
-
     if (!fs.exists(c_path.get())) {
         AUDIO_LOG_WARN("file not found: {}", c_path.get());
-        goto exit;
+        return false;
     }
     info(*this, evt_info, "Reading file: \"{}\"", c_path.get());
     m_audiofile = fs.open(c_path.get());
     m_dataMode = AUDIO_LOCALFILE;
     m_audioFileSize = m_audiofile.size();
     m_f_running = true;
-    res = true;
+    return true;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool Audio::queueNext(fs::FS& fs, const char* path, int32_t fileStartTime) {
+    // The file is opened, its header parsed, the decoder initialized and the beginning read into a second InBuff in loop()
+    // while the current file is playing (prerollNext()). At the end of the current file playNext() swaps InBuff and
+    // decoder without waiting for the evt_eof handler, SamplesBuff and I2S keep running (gaplessCarry). The sync search
+    // and the first frame follow in the audio task. A call of connecttoFS() with the same file takes the prepared one,
+    // any other source discards the queue.
+    resetNext();
+    if (!path) return false; // queue cleared
 
-exit:
-    return res;
+    ps_ptr<char> c_path;
+    c_path.copy_from(path);
+    c_path.trim();
+    if (!c_path.starts_with("/")) c_path.insert("/", 0);
+    if (!fs.exists(c_path.get())) {
+        AUDIO_LOG_WARN("file not found: {}", c_path.get());
+        return false;
+    }
+    m_next.type = 1;
+    m_next.fs = &fs;
+    m_next.path.assign(c_path.get());
+    m_next.fileStartTime = fileStartTime;
+    info(*this, evt_info, "next file: \"{}\"", c_path.get());
+    return true;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool Audio::queueNextHost(const char* host, const char* user, const char* pwd) {
+    // Like queueNext() for a web file, on the second client. The host is connected next_t::leadTime seconds before the
+    // end of the current file, then the response header and the audio header are read as the bytes arrive. A stream or
+    // a playlist is not prepared, playNext() connects it the usual way at the end of the current file.
+    resetNext();
+    if (!host) return false; // queue cleared
+
+    ps_ptr<char> c_host = host;
+    c_host.trim();
+    if (c_host.strlen() < 8 || c_host.strlen() > 2048) {
+        AUDIO_LOG_WARN("invalid host address \"{}\"", c_host.get());
+        return false;
+    }
+    m_next.type = 2;
+    m_next.path.assign(c_host.get());
+    m_next.user.assign(user);
+    m_next.pwd.assign(pwd);
+    info(*this, evt_info, "next host: \"{}\"", c_host.get());
+    return true;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::prerollNext() { // one step of the preparation of the queued source, called in loop()
+    // swapSource() puts the queued source on the members, so the usual open, header and fill routines run on it. The
+    // audio task does not decode meanwhile, it only plays SamplesBuff (performAudioTask()), and the info events of the
+    // queued source wait in m_next_info, the getters show the playing source to other tasks (m_shown). A step is short:
+    // one file read, a header is read only if its bytes have arrived, nothing connects within the step. A redirect or a
+    // range request (M4A header at the end of a web file) leave the source to playNext() (httpPrint(), httpRange()).
+    if (!m_next.type || m_next.f_ready || m_next.f_failed || !m_f_stream) return; // nothing to do or the current source is not playing yet
+    if (!NextBuff.isInitialized() && !NextBuff.init()) {
+        m_next.f_failed = true;
+        AUDIO_LOG_WARN("not enough memory to prepare the next source");
+        return;
+    }
+    if (m_next.type == 2) {
+        if (!m_nextSrc.f_running) {
+            uint32_t duration = getAudioFileDuration();
+            if (!isFile()) return;                                                                                 // the end of a stream is not foreseeable
+            if (!m_f_allDataReceived && (!duration || duration > getAudioCurrentTime() + m_next.leadTime)) return; // too early, the server would close the idle connection
+            if (!connectNext()) {
+                m_next.f_failed = true;
+                AUDIO_LOG_WARN("can't connect to the next host \"{}\" ahead", m_next.path.c_get());
+                return;
+            }
+        } else if (!m_nextSrc.client->available()) {
+            return; // readHeader() and processWebFile() would wait for the bytes
+        }
+    }
+
+    if (xSemaphoreTake(mutex_audioTask, 0.3 * configTICK_RATE_HZ) != pdTRUE) return; // try again in the next loop()
+    m_shown.fileSize = getFileSize();
+    m_shown.bitRate = getBitRate();
+    m_shown.duration = getAudioFileDuration();
+    m_shown.currentTime = getAudioCurrentTime();
+    m_shown.filePosition = m_dataMode == AUDIO_LOCALFILE || m_streamType == ST_WEBFILE ? getAudioFilePosition() : 0;
+    m_shown.codec = m_codec;
+    m_shown.f_running = m_f_running;
+    m_nextSwapTask = xTaskGetCurrentTaskHandle();
+    m_f_nextSwapped.store(true, std::memory_order_release);
+    swapSource();
+    xSemaphoreGive(mutex_audioTask);
+
+    switch (m_dataMode) {
+        case AUDIO_NONE: // first step
+            if (m_next.type == 1) openLocalFile(*m_next.fs, m_next.path);
+            if (m_next.type == 2) openHost(m_next.path, m_next.user, m_next.pwd);
+            break;
+        case AUDIO_LOCALFILE: processLocalFile(); break;
+        case HTTP_RESPONSE_HEADER: parseHttpResponseHeader(); break;
+        case AUDIO_DATA:
+            if (isFile()) processWebFile();
+            break;
+    }
+    bool failed = !m_f_running || m_dataMode == AUDIO_PLAYLISTINIT || (m_dataMode == AUDIO_DATA && !isFile()); // error, playlist or stream
+    bool ready = !failed && m_f_stream && (InBuff.bufferFilled() >= m_next.prefill || m_f_allDataReceived);
+
+    xSemaphoreTake(mutex_audioTask, portMAX_DELAY); // the current source must get its members back
+    swapSource();
+    m_f_nextSwapped.store(false, std::memory_order_release);
+    xSemaphoreGive(mutex_audioTask);
+
+    if (failed) { // playNext() opens it the usual way
+        audiolib::next_t queued = std::move(m_next);
+        resetNext();
+        m_next = std::move(queued);
+        m_next.f_failed = true;
+        info(*this, evt_info, "next source \"{}\" is not prepared, it is opened at the end of the current one", m_next.path.c_get());
+    }
+    if (ready) {
+        m_next.f_ready = true;
+        info(*this, evt_info, "next source \"{}\" is ready, {} bytes prefilled", m_next.path.c_get(), NextBuff.bufferFilled());
+    }
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool Audio::connectNext() { // connects the second client to the queued host, openHost() sends the request on it
+    audiolib::hwoe_t dh = dismantle_host(m_next.path.get());
+    uint16_t         port = dh.port;
+    NetworkClient*   cl = static_cast<NetworkClient*>(&client[m_nextSrc.clientSet]);
+    if (dh.ssl) {
+        cl = static_cast<NetworkClientSecure*>(&clientsecure[m_nextSrc.clientSet]);
+        if (port == 80) port = 443;
+    }
+    cl->setTimeout(dh.ssl ? m_timeout_ms_ssl : m_timeout_ms);
+    info(*this, evt_info, "connect to the next host: \"{}\" on port {}", dh.hwoe.c_get(), port);
+    return cl->connect(dh.hwoe.get(), port);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::swapSource() { // exchanges the members of the current source with m_nextSrc, mutex_audioTask must be taken
+    InBuff.swap(NextBuff);
+    std::swap(m_audiofile, m_nextSrc.audiofile);
+    std::swap(m_client, m_nextSrc.client);
+    std::swap(m_clientSet, m_nextSrc.clientSet);
+    std::swap(m_decoder, m_nextSrc.decoder);
+    std::swap(m_lastHost, m_nextSrc.lastHost);
+    std::swap(m_currentHost, m_nextSrc.currentHost);
+    std::swap(m_content_type, m_nextSrc.content_type);
+    std::swap(m_syltLines, m_nextSrc.syltLines);
+    std::swap(m_syltTimeStamp, m_nextSrc.syltTimeStamp);
+    std::swap(m_audioFilePosition, m_nextSrc.audioFilePosition);
+    std::swap(m_audioFileSize, m_nextSrc.audioFileSize);
+    std::swap(m_audioDataStart, m_nextSrc.audioDataStart);
+    std::swap(m_audioDataSize, m_nextSrc.audioDataSize);
+    std::swap(m_audioCurrentTime, m_nextSrc.audioCurrentTime);
+    std::swap(m_controlCounter, m_nextSrc.controlCounter);
+    std::swap(m_playlistFormat, m_nextSrc.playlistFormat);
+    std::swap(m_codec, m_nextSrc.codec);
+    std::swap(m_expectedCodec, m_nextSrc.expectedCodec);
+    std::swap(m_expectedPlsFmt, m_nextSrc.expectedPlsFmt);
+    std::swap(m_streamType, m_nextSrc.streamType);
+    std::swap(m_ID3Size, m_nextSrc.ID3Size);
+    std::swap(m_M4A_objectType, m_nextSrc.M4A_objectType);
+    std::swap(m_M4A_chConfig, m_nextSrc.M4A_chConfig);
+    std::swap(m_M4A_sampleRate, m_nextSrc.M4A_sampleRate);
+    std::swap(m_dataMode, m_nextSrc.dataMode);
+    std::swap(m_metaint, m_nextSrc.metaint);
+    std::swap(m_chunkcount, m_nextSrc.chunkcount);
+    std::swap(m_lastGranulePosition, m_nextSrc.lastGranulePosition);
+    std::swap(m_nominal_bitrate, m_nextSrc.nominal_bitrate);
+    std::swap(m_total_samples_in_file, m_nextSrc.total_samples_in_file);
+    std::swap(m_audio_file_duration, m_nextSrc.audio_file_duration);
+    std::swap(m_stsz_numEntries, m_nextSrc.stsz_numEntries);
+    std::swap(m_stsz_position, m_nextSrc.stsz_position);
+    std::swap(m_resumeFilePos, m_nextSrc.resumeFilePos);
+    std::swap(m_fileStartTime, m_nextSrc.fileStartTime);
+    std::swap(m_f_haveNewFilePos, m_nextSrc.f_haveNewFilePos);
+    std::swap(m_f_unsync, m_nextSrc.f_unsync);
+    std::swap(m_f_exthdr, m_nextSrc.f_exthdr);
+    std::swap(m_f_ssl, m_nextSrc.f_ssl);
+    std::swap(m_f_running, m_nextSrc.f_running);
+    std::swap(m_f_firstCall, m_nextSrc.f_firstCall);
+    std::swap(m_f_ID3v1TagFound, m_nextSrc.f_ID3v1TagFound);
+    std::swap(m_f_chunked, m_nextSrc.f_chunked);
+    std::swap(m_f_tts, m_nextSrc.f_tts);
+    std::swap(m_f_ogg, m_nextSrc.f_ogg);
+    std::swap(m_f_m3u8data, m_nextSrc.f_m3u8data);
+    std::swap(m_f_ts, m_nextSrc.f_ts);
+    std::swap(m_f_m4aID3dataAreRead, m_nextSrc.f_m4aID3dataAreRead);
+    std::swap(m_f_timeout, m_nextSrc.f_timeout);
+    std::swap(m_f_allDataReceived, m_nextSrc.f_allDataReceived);
+    std::swap(m_f_stream, m_nextSrc.f_stream);
+    std::swap(m_f_eof, m_nextSrc.f_eof);
+    std::swap(m_f_acceptRanges, m_nextSrc.f_acceptRanges);
+    std::swap(m_f_connectionClose, m_nextSrc.f_connectionClose);
+    std::swap(m_ID3Hdr, m_nextSrc.ID3Hdr);
+    std::swap(m_m4aHdr, m_nextSrc.m4aHdr);
+    std::swap(m_prlf, m_nextSrc.prlf);
+    std::swap(m_pwf, m_nextSrc.pwf);
+    std::swap(m_rwh, m_nextSrc.rwh);
+    std::swap(m_rflh, m_nextSrc.rflh);
+    std::swap(m_phreh, m_nextSrc.phreh);
+    std::swap(m_gchs, m_nextSrc.gchs);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::resetNext() { // forgets the queued source and frees what prerollNext() prepared for it
+    uint8_t set = 1 - m_clientSet;
+    client[set].stop();
+    clientsecure[set].stop();
+    if (m_nextSrc.audiofile) m_nextSrc.audiofile.close();
+    if (m_nextSrc.decoder) m_nextSrc.decoder->reset();
+    m_nextSrc = {};
+    m_nextSrc.clientSet = set;
+    m_nextSrc.client = static_cast<NetworkClient*>(&client[set]);
+    NextBuff.release();
+    m_next.reset();
+    std::lock_guard<std::mutex> lock(mutex_info);
+    m_next_info.reset();
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool Audio::playNext() { // end of the current source, continue with the queued one
+    if (!m_next.type || m_f_nextSwapped) return false; // nothing queued, or a failed step of prerollNext() ends here
+    if (!m_next.f_ready) {                               // not prepared (in time), open it the usual way
+        audiolib::next_t queued = std::move(m_next);
+        resetNext();
+        if (queued.type == 1) return connecttoFS(*queued.fs, queued.path.get(), queued.fileStartTime);
+        return connecttohost(queued.path.get(), queued.user.get(), queued.pwd.get());
+    }
+    setDefaults(); // the current source ends, carried samples keep playing
+    xSemaphoreTake(mutex_audioTask, portMAX_DELAY);
+    swapSource(); // InBuff, decoder, header and file position of the queued source
+    xSemaphoreGive(mutex_audioTask);
+    m_fileStartTime = m_next.fileStartTime; // processLocalFile() or processWebFile() seeks now
+    {
+        std::lock_guard<std::mutex> lock(mutex_info);
+        for (audiolib::InfoItem& item : m_next_info.queue) m_info_queue.queue.push_back(std::move(item));
+        m_next_info.reset();
+    }
+    resetNext(); // the previous source is on the other side now, its InBuff is freed
+    return true;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 bool Audio::connecttospeech(const char* speech, const char* lang) {
@@ -1471,7 +1559,7 @@ bool Audio::connecttospeech(const char* speech, const char* lang) {
     req.append("Accept: text/html\r\n");
     req.append("Connection: close\r\n\r\n");
 
-    m_client = static_cast<NetworkClient*>(&client);
+    m_client = static_cast<NetworkClient*>(&client[m_clientSet]);
     info(*this, evt_info, "connect to \"{}\"", host);
     if (!m_client->connect(host, 80)) {
         AUDIO_LOG_ERROR("Connection failed");
@@ -2116,8 +2204,8 @@ int Audio::read_FLAC_Header(uint8_t* data, size_t len) {
         uint8_t bps = (nextval & 0x01) << 4;
         bps += (*(data + 16) >> 4) + 1;
         m_rflh.bitsPerSample = bps;
-        if ((bps != 8) && (bps != 16) && (bps != 24)) {
-            AUDIO_LOG_ERROR("bits per sample must be 8, 16 or 24, is {}", bps);
+        if ((bps != 8) && (bps != 16) && (bps != 24) && (bps != 32)) {
+            AUDIO_LOG_ERROR("bits per sample must be 8, 16, 24 or 32, is {}", bps);
             stopSong();
             return -1;
         }
@@ -2154,12 +2242,34 @@ int Audio::read_FLAC_Header(uint8_t* data, size_t len) {
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     if (m_controlCounter == FLAC_SEEK) { /* SEEKTABLE */
         size_t l = bigEndian(data, 3);
-        m_controlCounter = FLAC_MBH;
-        m_rflh.retvalue = l + 3;
-        m_rflh.headerSize += m_rflh.retvalue;
+        m_rflh.seekTable.clear();
+        m_rflh.seekTable.reserve(l / 18);
+        m_rflh.seekPoints = l / 18; // 18 bytes per seek point: sample number (8), offset (8), samples in frame (2)
+        m_rflh.seekRest = l % 18;
+        m_controlCounter = FLAC_SEEKPOINTS;
+        m_rflh.retvalue = 3;
+        m_rflh.headerSize += l + 3;
         return 0;
     }
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    if (m_controlCounter == FLAC_SEEKPOINTS) { /* SEEKTABLE points, the table can be larger than one header read */
+        size_t n = std::min<size_t>(m_rflh.seekPoints, len / 18);
+        for (size_t i = 0; i < n * 18; i += 18) {
+            uint64_t sample = ((uint64_t)bigEndian(data + i, 4) << 32) | bigEndian(data + i + 4, 4);
+            uint64_t offset = ((uint64_t)bigEndian(data + i + 8, 4) << 32) | bigEndian(data + i + 12, 4);
+            if (sample > UINT32_MAX || offset > UINT32_MAX) continue; // placeholder (0xFFFFFFFFFFFFFFFF) or out of range
+            if (m_rflh.seekTable.size() && sample <= m_rflh.seekTable.back().sample) continue;
+            m_rflh.seekTable.push_back({(uint32_t)sample, (uint32_t)offset});
+        }
+        m_rflh.seekPoints -= n;
+        if (m_rflh.seekPoints == 0) {
+            info(*this, evt_info, "FLAC seektable: {} seek points", m_rflh.seekTable.size());
+            m_controlCounter = FLAC_MBH;
+            m_rflh.retvalue = m_rflh.seekRest; // malformed length, not a multiple of 18
+        }
+        return n * 18; // less than one seek point in the buffer: wait for more data
+    }
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     if (m_controlCounter == FLAC_VORBIS) { /* VORBIS COMMENT */ // field names
 
         auto parse_flac_timestamp = [&](const char* s) {
@@ -2745,24 +2855,18 @@ int Audio::read_ID3_Header(uint8_t* data, size_t len) {
             int mode = (hdr >> 6) & 0x3; // 0=stereo,3=mono
             int samplerate = samplerate_table[versionID][samplerateIdx];
             int spf = samples_per_frame[versionID][layerIndex];
+            int rs = (m_codec == CODEC_MP3 && m_decoder) ? static_cast<MP3Decoder*>(m_decoder.get())->getRateShift() : 0; // MP3_SYNTH_HALF_RATE
             AUDIO_LOG_DEBUG("spf {}, versionID {}, layerIndex {}", spf, versionID, layerIndex);
 
-            // Xing or Info Header present?
-            int8_t mp3_xing = specialIndexOf(data, "Xing", 50); // VBR
-            int8_t mp3_info = specialIndexOf(data, "Info", 50); // CBR
-
-            uint8_t xingPos = 0;
-            if (mp3_xing > 0) xingPos = mp3_xing;
-            if (mp3_info > 0) xingPos = mp3_info;
-
-            if (xingPos > 0 && layerIndex == 1) { // layer III only
-                uint32_t frames = bigEndian(data + xingPos + 8, 4);
-                AUDIO_LOG_DEBUG("frames {}", frames);
-                uint32_t bytes = bigEndian(data + xingPos + 12, 4);
-                AUDIO_LOG_DEBUG("bytes {}", bytes);
-                m_audio_file_duration = (static_cast<uint64_t>(frames) * spf) / samplerate; // may be 0 (if duration < 1s)
-                if (m_audio_file_duration) m_nominal_bitrate = (static_cast<uint64_t>(bytes) * 8) / m_audio_file_duration;
-                m_total_samples_in_file = m_audio_file_duration * samplerate;
+            // Xing, Info or VBRI Header present? The decoder keeps frame count, byte count and TOC for seeking
+            MP3Decoder* mp3 = (m_codec == CODEC_MP3 && m_decoder) ? static_cast<MP3Decoder*>(m_decoder.get()) : nullptr;
+            if (mp3 && mp3->parseVBRHeader(data, len) && mp3->getTotalFrames() && samplerate) {
+                uint64_t totalSamples = mp3->getTotalSamples(); // output samples, at samplerate >> rs
+                AUDIO_LOG_DEBUG("frames {}, bytes {}, TOC {}", mp3->getTotalFrames(), mp3->getTotalBytes(), mp3->getTOC() != nullptr);
+                m_audio_file_duration = totalSamples / (samplerate >> rs); // may be 0 (if duration < 1s)
+                m_total_samples_in_file = totalSamples;
+                uint32_t bytes = mp3->getTotalBytes() ? mp3->getTotalBytes() : m_audioDataSize;
+                m_nominal_bitrate = (static_cast<uint64_t>(bytes) * 8 * (samplerate >> rs)) / totalSamples;
             }
 
             if (m_nominal_bitrate == 0 && layerIndex == 1) { // no Xing/Info, Layer III
@@ -2816,7 +2920,7 @@ int Audio::read_ID3_Header(uint8_t* data, size_t len) {
                 if (frameCount > 0 && totalSamples > 0) {
                     if (totalSamples) m_nominal_bitrate = (totalBytes * 8ULL * samplerate) / totalSamples;
                     if (m_nominal_bitrate) m_audio_file_duration = (static_cast<uint64_t>(m_audioDataSize) * 8ULL) / (static_cast<uint64_t>(m_nominal_bitrate));
-                    m_total_samples_in_file = m_audio_file_duration * samplerate;
+                    m_total_samples_in_file = m_audio_file_duration * (samplerate >> rs);
                     AUDIO_LOG_DEBUG("MP3 frame analysis: {} frames, {} bytes, bitrate {} bit/s, duration {} s", frameCount, totalBytes, m_nominal_bitrate, m_audio_file_duration);
                 }
             }
@@ -3650,7 +3754,7 @@ uint32_t Audio::stopSong() {
     bool pdTrue = xSemaphoreTake(mutex_audioTaskIsDecoding, 1 * configTICK_RATE_HZ); // wait for audioTask is ready
     {
         if (m_f_running) {
-            m_audio_items.mute = true;
+            if (!m_gapless.f_carry && !m_f_nextSwapped) m_audio_items.mute = true; // else the queued source failed in prerollNext()
             m_f_running = false;
             if (m_client->connected()) {
                 if (isStream()) { info(*this, evt_info, "Closing web stream \"{}\"", m_lastHost.c_get()); }
@@ -3687,123 +3791,6 @@ bool Audio::pauseResume() {
     return retVal;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-audiolib::BiquadCoeffs Audio::makeButterworthLPF_Q31(float fs) { // Calculation of the biquad coefficients for the resampler
-
-    float fc = 0.45f * fs;
-    if (fc > 20000.0f) fc = 20000.0f; // absolute upper limit (security)
-    if (fc < 3000.0f) fc = 3000.0f;   // absolute lower limit (prevents “thin” sound)
-
-    constexpr float Q = 0.70710678f;
-
-    float w0 = 2.0f * M_PI * fc / fs;
-    float cw = cosf(w0);
-    float sw = sinf(w0);
-    float alpha = sw / (2.0f * Q);
-
-    float b0 = (1.0f - cw) * 0.5f;
-    float b1 = 1.0f - cw;
-    float b2 = (1.0f - cw) * 0.5f;
-    float a0 = 1.0f + alpha;
-    float a1 = -2.0f * cw;
-    float a2 = 1.0f - alpha;
-
-    // normalize
-    b0 /= a0;
-    b1 /= a0;
-    b2 /= a0;
-    a1 /= a0;
-    a2 /= a0;
-
-    // convert to Q31
-    constexpr float Q31 = 2147483648.0f; // 2^31
-
-    audiolib::BiquadCoeffs c;
-    c.b0 = (int32_t)lrintf(b0 * Q31);
-    c.b1 = (int32_t)lrintf(b1 * Q31);
-    c.b2 = (int32_t)lrintf(b2 * Q31);
-    c.a1 = (int32_t)lrintf(a1 * Q31);
-    c.a2 = (int32_t)lrintf(a2 * Q31);
-
-    return c;
-}
-// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-uint32_t Audio::resampleI2Soutput(audiolib::resampler_t& rs, int32_t* input, uint32_t inputSamples, int32_t* output) {
-
-    auto lerp_q32 = [&](int32_t a, int32_t b, uint32_t frac) -> int32_t { return a + (int32_t)(((int64_t)(b - a) * frac) >> 32); };
-    auto biquadProcess = [&](audiolib::Biquad& s, const audiolib::BiquadCoeffs& c, int32_t x) -> int32_t {
-        // Q31 signal, Q31 coeffs → Q62 acc
-        int64_t acc = (int64_t)c.b0 * x + s.z1;
-        s.z1 = (int64_t)c.b1 * x - (int64_t)c.a1 * (acc >> 31) + s.z2;
-        s.z2 = (int64_t)c.b2 * x - (int64_t)c.a2 * (acc >> 31);
-        int64_t y = acc >> 31;
-        if (y > INT32_MAX) return INT32_MAX;
-        if (y < INT32_MIN) return INT32_MIN;
-        return (int32_t)y;
-    };
-
-    uint32_t outFrames = 0;
-    uint32_t i = 0;
-
-    // If we have a "last" from the previous frame, start with that
-    if (rs.hasLast && inputSamples > 0) {
-        int32_t l0 = rs.lastL;
-        int32_t r0 = rs.lastR;
-        int32_t l1 = input[0];
-        int32_t r1 = input[1];
-
-        // Continue processing with the old phase value
-        while ((rs.phase >> 32) == 0) {
-            uint32_t frac = (uint32_t)rs.phase;
-            int32_t  l = lerp_q32(l0, l1, frac);
-            int32_t  r = lerp_q32(r0, r1, frac);
-
-            l = biquadProcess(rs.lpLeft, rs.g_lpCoeffs, l);
-            r = biquadProcess(rs.lpRight, rs.g_lpCoeffs, r);
-
-            output[outFrames * 2] = l;
-            output[outFrames * 2 + 1] = r;
-            ++outFrames;
-
-            rs.phase += rs.phaseStep;
-        }
-        rs.phase -= (1ULL << 32);
-        // i remains 0, we haven't used input[0] as "l0" yet!
-    }
-
-    // Rest of the frame as usual
-    for (; i + 1 < inputSamples; ++i) {
-        int32_t l0 = input[i * 2];
-        int32_t r0 = input[i * 2 + 1];
-        int32_t l1 = input[(i + 1) * 2];
-        int32_t r1 = input[(i + 1) * 2 + 1];
-
-        while ((rs.phase >> 32) == 0) {
-            uint32_t frac = (uint32_t)rs.phase;
-            int32_t  l = lerp_q32(l0, l1, frac);
-            int32_t  r = lerp_q32(r0, r1, frac);
-
-            l = biquadProcess(rs.lpLeft, rs.g_lpCoeffs, l);
-            r = biquadProcess(rs.lpRight, rs.g_lpCoeffs, r);
-
-            output[outFrames * 2] = l;
-            output[outFrames * 2 + 1] = r;
-            ++outFrames;
-
-            rs.phase += rs.phaseStep;
-        }
-        rs.phase -= (1ULL << 32);
-    }
-
-    // Save last sample for next frame
-    if (inputSamples > 0) {
-        rs.lastL = input[(inputSamples - 1) * 2];
-        rs.lastR = input[(inputSamples - 1) * 2 + 1];
-        rs.hasLast = true;
-    }
-
-    return outFrames;
-}
-// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void Audio::cacheSamples() {
 
     if (m_f_firstCacheSamplesCall) {
@@ -3817,23 +3804,28 @@ void Audio::cacheSamples() {
 
     //------------------------------------------------------------------------------------------------------------------------------------------------
     if (m_caSa.sourceWordsConsumed == 0) {
-        if (m_output_sr && m_output_sr != m_i2s_items.sampleRate) {
-            m_validSamples = resampleI2Soutput(m_resampler, m_outBuff.get(), m_validSamples, m_resamplesBuff.get()); // have new amount of samples
+        if (resampling()) {
+            if (m_drift.f_active && getBitRate()) m_resampler.setPpm(m_drift.update(InBuff.bufferFilled(), getBitRate() / 8.0f, (float)m_validSamples / m_i2s_items.sampleRate));
+            m_validSamples = m_resampler.process(m_outBuff.get(), m_validSamples, m_resamplesBuff.get()); // have new amount of samples
             sourceBuff = m_resamplesBuff.get();
         } else {
             sourceBuff = m_outBuff.get();
         }
     }
     //------------------------------------------------------------------------------------------------------------------------------------------------
-    if (!sourceBuff) { sourceBuff = (m_output_sr && m_output_sr != m_i2s_items.sampleRate) ? m_resamplesBuff.get() : m_outBuff.get(); }
+    if (!sourceBuff) { sourceBuff = resampling() ? m_resamplesBuff.get() : m_outBuff.get(); }
     sourceWords = (size_t)m_validSamples * 2; // always 2 channels
 
     //------------------------------------------------------------------------------------------------------
     // Decoder -> RingBuffer
     //------------------------------------------------------------------------------------------------------
 
-    written = SamplesBuff.write(sourceBuff + m_caSa.sourceWordsConsumed, sourceWords - m_caSa.sourceWordsConsumed);
+    if (xfadeRoute())
+        written = xfadeHoldback(sourceBuff + m_caSa.sourceWordsConsumed, sourceWords - m_caSa.sourceWordsConsumed);
+    else
+        written = SamplesBuff.write(sourceBuff + m_caSa.sourceWordsConsumed, sourceWords - m_caSa.sourceWordsConsumed);
     m_caSa.sourceWordsConsumed += written;
+    if (written) m_taskStats.work++;
 
     if (m_caSa.sourceWordsConsumed >= sourceWords) {
         m_caSa.sourceWordsConsumed = 0;
@@ -3842,9 +3834,20 @@ void Audio::cacheSamples() {
     return;
 }
 
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::resetSamples() { // empties SamplesBuff, the caller holds mutex_outputTask (playChunk() takes it in both task modes)
+    SamplesBuff.reset();
+    m_plCh.processed = 0; // the DSP state of a partial write belongs to the dropped samples
+}
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void Audio::playChunk() {
-    if (SamplesBuff.bufferFilled() == 0) return; // nothing to do
+    if (SamplesBuff.bufferFilled() == 0) return;                                   // nothing to do
+    if (m_f_dualTask && xTaskGetCurrentTaskHandle() != m_outputTaskHandle) return; // dual task mode: the output task plays
+    bool locked = false; // single task mode: loop() resets SamplesBuff under mutex_outputTask, the output task holds it anyway
+    if (!m_f_dualTask) {
+        if (xSemaphoreTake(mutex_outputTask, 0) != pdTRUE) return; // SamplesBuff is being reset, play in the next round
+        locked = true;
+    }
 
     if (m_f_firstChunkCall) {
         m_f_firstChunkCall = false;
@@ -3860,31 +3863,32 @@ void Audio::playChunk() {
         while (m_dmaFreeDesc.load(std::memory_order_acquire) > 0) { // m_dmaFreeDesc is atomic!
 
             //------------------------------------------------------------------------------------------------------
-            // RingBuffer -> m_i2sWorkBuff
+            // samples manipulation in place, the block may wrap at the end of SamplesBuff (two spans)
             //------------------------------------------------------------------------------------------------------
             size_t readWords = std::min(SamplesBuff.bufferFilled(), m_work_words);
             readWords &= ~static_cast<size_t>(1);
             if (readWords == 0) break;
-            SamplesBuff.peek(m_i2sWorkBuff.get(), readWords);
-            //-------------------------------------------------------------------------------------------------------
-            // samples manipulation
-            //-------------------------------------------------------------------------------------------------------
-            audio_process_raw_samples(m_i2sWorkBuff.get(), readWords);
-
-            if (settings.VU_LEVEL) calculateVUlevel(m_i2sWorkBuff.get(), readWords);
-            if (settings.SPECTRUM) calculateSpectrum(m_i2sWorkBuff.get(), readWords);
-            if (settings.IIR_FILTER) IIR_filter(m_i2sWorkBuff.get(), readWords);
-            if (m_f_forceMono) stereo2mono(m_i2sWorkBuff.get(), readWords);
-            if (settings.VOLUME_CONTROL) Gain(m_i2sWorkBuff.get(), readWords);
-
-            audio_process_i2s(m_i2sWorkBuff.get(), (int32_t)readWords, &continueI2S);
+            RingBuffer::spans_t block = SamplesBuff.readView(readWords);
+            size_t              done = m_plCh.processed; // the remainder of a partial write is processed already
+            for (std::span<int32_t> s : {block.first, block.second}) {
+                size_t skip = std::min(done, s.size());
+                done -= skip;
+                if (s.size() > skip) processSamples(s.data() + skip, s.size() - skip, &continueI2S);
+            }
+            m_plCh.processed = readWords;
             //--------------------------------------------------------------------------------------------------------
-            // m_i2sWorkBuff -> I2S
+            // SamplesBuff -> I2S
             //--------------------------------------------------------------------------------------------------------
 
             size_t bytesConsumed = 0;
             if (continueI2S) {
-                m_plCh.err = i2s_channel_write(m_i2s_tx_handle, m_i2sWorkBuff.get(), readWords * sizeof(int32_t), &bytesConsumed, 10);
+                for (std::span<int32_t> s : {block.first, block.second}) {
+                    if (s.empty()) continue;
+                    size_t bytes = 0;
+                    m_plCh.err = i2s_channel_write(m_i2s_tx_handle, s.data(), s.size_bytes(), &bytes, 10);
+                    bytesConsumed += bytes;
+                    if (bytes != s.size_bytes()) break;
+                }
             } else {
                 bytesConsumed = readWords * sizeof(int32_t);
             }
@@ -3898,7 +3902,9 @@ void Audio::playChunk() {
             if (bytesConsumed != readWords * sizeof(int32_t)) { AUDIO_LOG_WARN("partial write: {} / {}", bytesConsumed, readWords * sizeof(int32_t)); }
 
             SamplesBuff.bytesRead(bytesConsumed / sizeof(int32_t));
+            m_plCh.processed -= bytesConsumed / sizeof(int32_t);
             m_dmaFreeDesc.fetch_sub(1, std::memory_order_release);
+            (m_f_dualTask ? m_outputTaskStats : m_taskStats).work++;
         }
     }
 
@@ -3908,9 +3914,135 @@ void Audio::playChunk() {
     if (m_plCh.err == ESP_ERR_INVALID_STATE) AUDIO_LOG_ERROR("I2S is not ready to write");
     if (m_plCh.err == ESP_ERR_TIMEOUT) AUDIO_LOG_ERROR("Writing timeout, no writing event received from ISR within ticks_to_wait");
 
+    if (locked) xSemaphoreGive(mutex_outputTask);
     return;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::processSamples(int32_t* buff, size_t words, bool* continueI2S) { // DSP chain of playChunk(), in place in SamplesBuff
+    if (m_xfade.f_fading) xfadeMix(buff, words);
+    audio_process_raw_samples(buff, words);
+
+    if (settings.SPECTRUM) calculateSpectrum(buff, words); // FFT over the samples before EQ and volume, like the VU meter
+
+    uint8_t flags = dspFlags();
+    if (flags != m_dsp.flags) m_dsp.select(flags, m_audio_items);
+    bool vu = flags & audiolib::dsp_t::VU;
+    if (vu && m_f_first_vu_call) calculateVUlevel(); // init, length of the VU window
+    int32_t* p = buff;
+    for (size_t frames = words / 2; frames;) {
+        size_t n = frames;
+        if (vu && m_vu_items.samps_vu > m_vu_items.samps_count) n = std::min<size_t>(n, m_vu_items.samps_vu - m_vu_items.samps_count); // up to the end of the VU window
+        m_dsp.kernel(p, n, m_audio_items, m_vu_items);
+        if (vu) calculateVUlevel();
+        p += n * 2;
+        frames -= n;
+    }
+
+    audio_process_i2s(buff, (int32_t)words, continueI2S);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+uint8_t Audio::dspFlags() { // stages of the fused DSP kernel, a flat EQ or unity gain is left out
+    uint8_t f = 0;
+    bool    flat = !m_audio_items.eq.stages;
+    bool    unity = m_audio_items.limiter[LEFTCHANNEL] == 1.0f && m_audio_items.limiter[RIGHTCHANNEL] == 1.0f && // and no ramp left
+                 m_audio_items.gain[LEFTCHANNEL] == audiolib::dsp_t::GAIN_ONE && m_audio_items.gain[RIGHTCHANNEL] == audiolib::dsp_t::GAIN_ONE;
+    if (settings.VU_LEVEL) f |= audiolib::dsp_t::VU;
+    if (settings.IIR_FILTER && !flat) f |= settings.IIR_Q31 ? audiolib::dsp_t::EQ | audiolib::dsp_t::Q31 : audiolib::dsp_t::EQ;
+    if (m_f_forceMono) f |= audiolib::dsp_t::MONO;
+    if (settings.VOLUME_CONTROL && !unity) f |= audiolib::dsp_t::GAIN;
+    return f;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool Audio::xfadeRoute() { // true if the decoded samples have to go to XfadeBuff instead of SamplesBuff
+    if (XfadeBuff.bufferFilled() && !m_xfade.f_fading) return true;                   // end of the file has begun
+    if (!m_xfade.ms || !m_next.type || m_xfade.f_fading || !isFile()) return false; // no crossfade or no successor (yet)
+
+    uint64_t total = get_total_samples_in_file();
+    uint32_t len = (uint32_t)m_xfade.ms * m_i2s_items.sampleRate / 1000; // in decoder samples
+    if (!total || m_samples_since_start + len + m_validSamples < total) return false;
+
+    uint32_t rate = m_output_sr ? m_output_sr : m_i2s_items.sampleRate;
+    size_t   words = ((size_t)m_xfade.ms * rate / 1000) * 2;
+    if (XfadeBuff.getBufsize() != words || !XfadeBuff.isInitialized()) { // first crossfade or other sample rate
+        XfadeBuff.setBufsize(words);
+        if (!XfadeBuff.init()) {
+            AUDIO_LOG_WARN("not enough memory for a crossfade of {} ms", m_xfade.ms);
+            m_xfade.ms = 0;
+            return false;
+        }
+    }
+    return true;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+size_t Audio::xfadeHoldback(const int32_t* src, size_t words) { // XfadeBuff keeps the newest frames, the oldest move on to SamplesBuff
+    size_t full = XfadeBuff.bufferFilled() + words;
+    if (full > XfadeBuff.getBufsize()) {
+        size_t over = full - XfadeBuff.getBufsize();
+        while (over) {
+            size_t n = std::min({over, XfadeBuff.readSpace(), SamplesBuff.freeSpace()}) & ~static_cast<size_t>(1);
+            if (!n) break; // SamplesBuff is full, try again later
+            n = SamplesBuff.write(XfadeBuff.getReadPtr(), n);
+            XfadeBuff.bytesRead(n);
+            over -= n;
+        }
+    }
+    return XfadeBuff.write(src, words);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::xfadeMix(int32_t* buff, size_t words) { // mixes the tail of the previous file into the beginning of the current one
+    size_t skip = std::min(m_xfade.skip, words);     // samples of the previous file before its tail
+    m_xfade.skip -= skip;
+    buff += skip;
+    words -= skip;
+
+    int32_t tail[128];
+    while (words && XfadeBuff.bufferFilled()) {
+        size_t n = XfadeBuff.read(tail, std::min(words, sizeof(tail) / sizeof(tail[0])));
+        audiolib::xfade_t::mix(buff, tail, n / 2, m_xfade.pos, m_xfade.frames);
+        m_xfade.pos += n / 2;
+        buff += n;
+        words -= n;
+    }
+    if (!XfadeBuff.bufferFilled()) {
+        m_xfade.f_fading = false;
+        info(*this, evt_info, "crossfade done");
+    }
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::xfadeResample() { // the new file has another output rate, convert the tail that is not faded yet
+    uint32_t rate = m_output_sr ? m_output_sr : m_i2s_items.sampleRate;
+    if (rate == m_xfade.sampleRate || !XfadeBuff.bufferFilled()) return;
+
+    const uint32_t  chunkFrames = 1024;
+    uint32_t        inFrames = XfadeBuff.bufferFilled() / 2;
+    uint32_t        maxOut = (uint64_t)inFrames * rate / m_xfade.sampleRate + inFrames / chunkFrames + 8;
+    ps_ptr<int32_t> chunk;
+    ps_ptr<int32_t> out;
+    if (!chunk.alloc_array(chunkFrames * 2, "xfadeChunk") || !out.alloc_array(maxOut * 2, "xfadeOut")) {
+        AUDIO_LOG_WARN("not enough memory, crossfade skipped");
+        XfadeBuff.reset();
+        m_xfade.f_fading = false;
+        return;
+    }
+    auto rs = std::make_unique<audiolib::resampler_t>(); // not on the stack, the seam holds up to 126 frames
+    rs->setup(m_xfade.sampleRate, rate, m_resample_quality);
+    uint32_t outFrames = 0;
+    while (XfadeBuff.bufferFilled()) {
+        size_t n = XfadeBuff.read(chunk.get(), chunkFrames * 2) / 2;
+        outFrames += rs->process(chunk.get(), n, out.get() + outFrames * 2);
+    }
+    if (XfadeBuff.getBufsize() < outFrames * 2) {
+        XfadeBuff.setBufsize(outFrames * 2);
+        XfadeBuff.init();
+    }
+    XfadeBuff.reset();
+    XfadeBuff.write(out.get(), outFrames * 2);
+    m_xfade.frames = XfadeBuff.bufferFilled() / 2;
+    m_xfade.pos = 0;
+    m_xfade.sampleRate = rate;
+    if (!m_xfade.frames) m_xfade.f_fading = false;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void Audio::loop() {
 
     get_info();
@@ -3920,6 +4052,7 @@ void Audio::loop() {
         m_f_firstLoop = false;
         memset(&m_lVar, 0, sizeof(m_lVar));
     }
+    if (m_next.type) prerollNext();
 
     if (m_playlistFormat != FORMAT_M3U8) { // normal process
         switch (m_dataMode) {
@@ -4063,7 +4196,7 @@ bool Audio::readPlayListData() {
                 if (detectTimeout(t, "super inner while")) goto exit;
 
                 if (ctl == plSize) break;
-                if (plSize == 0 && client.available() == 0) { // have no contentlength and no chunklen
+                if (plSize == 0 && client[m_clientSet].available() == 0) { // have no contentlength and no chunklen
                     pl[pos] = '\0';
                     break;
                 }
@@ -4720,12 +4853,9 @@ void Audio::processLocalFile() {
     }
 
     // end of file reached? - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-    if (m_f_eof) {                        // m_f_eof and m_f_ID3v1TagFound will be set in playAudioData()
-        if (SamplesBuff.bufferFilled()) { // something to play before stopSong()
-            playChunk();
-            return;
-        }
+    if (m_f_eof) { // m_f_eof and m_f_ID3v1TagFound will be set in playAudioData()
         if (m_f_ID3v1TagFound) readID3V1Tag();
+        gaplessCarry(); // the remaining samples will be played by the next file or performAudioTask()
     exit:
         ps_ptr<char> afn;                                // audio file name
         if (m_audiofile) afn.assign(m_audiofile.name()); // store temporary the name
@@ -4736,9 +4866,31 @@ void Audio::processLocalFile() {
         stopSong();
 
         if (afn.valid()) { info(*this, evt_eof, "{}", afn.c_get()); }
+        if (!m_f_running && m_next.type) playNext(); // evt_eof handler has not started anything else
         return;
     }
 }
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::gaplessCarry() { // end of a file reached regularly, SamplesBuff and I2S keep running for the next file
+    // playAudioData() has flushed the decoder (settings.MP3_PIPELINE) and cached the last frame in the audio task before
+    // it set m_f_eof, all of this file is in SamplesBuff or XfadeBuff. Both tasks are held off while the carry and the
+    // fade of the held back tail are set up, playChunk() reads m_xfade.
+    bool audioLocked = xSemaphoreTake(mutex_audioTask, 0.3 * configTICK_RATE_HZ) == pdTRUE;
+    bool outputLocked = xSemaphoreTake(mutex_outputTask, 0.3 * configTICK_RATE_HZ) == pdTRUE;
+    if (!audioLocked || !outputLocked) AUDIO_LOG_WARN("audio or output task does not release SamplesBuff");
+    m_gapless.f_carry = m_f_running && (SamplesBuff.bufferFilled() > 0 || XfadeBuff.bufferFilled() > 0);
+    m_gapless.sampleRate = getSampleRate();
+    m_gapless.channels = getChannels();
+    if (m_gapless.f_carry && XfadeBuff.bufferFilled()) { // held back by xfadeRoute(), fade it out over the beginning of the next file
+        m_xfade.skip = SamplesBuff.bufferFilled();
+        m_xfade.pos = 0;
+        m_xfade.frames = XfadeBuff.bufferFilled() / 2;
+        m_xfade.sampleRate = m_output_sr ? m_output_sr : m_i2s_items.sampleRate;
+        m_xfade.f_fading = true;
+    }
+    if (outputLocked) xSemaphoreGive(mutex_outputTask);
+    if (audioLocked) xSemaphoreGive(mutex_audioTask);
+}
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————-
 void Audio::processWebStream() {
     if (m_dataMode != AUDIO_DATA) return; // guard
@@ -4832,11 +4984,8 @@ void Audio::processWebStream() {
         m_f_stream = true; // ready to play the audio data
     }
 
-    if (m_f_eof) {
-        if (SamplesBuff.bufferFilled()) { // something to play before stopSong()
-            playChunk();
-            return;
-        }
+    if (m_f_eof) { // playAudioData() has flushed the decoder before (settings.MP3_PIPELINE)
+        if (SamplesBuff.bufferFilled()) return; // the audio task (or the output task) plays it out before stopSong()
         info(*this, evt_eof, "{}", m_lastHost.c_get());
         stopSong();
     }
@@ -4930,6 +5079,7 @@ void Audio::processWebFile() {
     // end of file reached? - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     if (m_f_eof) { // m_f_eof and m_f_ID3v1TagFound will be set in playAudioData()
         if (m_f_ID3v1TagFound) readID3V1Tag();
+        gaplessCarry();
     exit:
         stopSong();
         info(*this, evt_eof, "{}", m_lastHost.c_get());
@@ -4938,6 +5088,7 @@ void Audio::processWebFile() {
         m_resumeFilePos = -1;
         m_f_haveNewFilePos = false;
         m_codec = CODEC_NONE;
+        if (!m_f_running && m_next.type) playNext();
         return;
     }
 }
@@ -5225,11 +5376,13 @@ void Audio::processWebStreamHLS() {
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void Audio::playAudioData() {
 
+    // guard, play samples first, also those carried over from the previous file. At m_f_eof this is the only consumer
+    // besides the output task, the EOF code in loop() waits until SamplesBuff is empty
+    if (SamplesBuff.bufferFilled()) { playChunk(); }
     if (m_f_eof || m_f_lockInBuffer || !m_f_stream) {
         vTaskDelay(1);
         return;
     } // guard, stream not ready or eof reached or InBuff is locked or not running
-    if (SamplesBuff.bufferFilled()) { playChunk(); } // guard, play samples first
 
     if (m_validSamples) {
         cacheSamples();
@@ -5259,10 +5412,12 @@ void Audio::playAudioData() {
             if (!m_audioDataSize) goto exit; // no data to decode if filesize is 0
             if (m_audioDataSize - m_audioDataReadPtr == 128) {
                 m_f_ID3v1TagFound = true;
+                if (flushDecoder()) goto exit; // the last frame first
                 m_f_eof = true;
                 goto exit;
             }
             if (m_audioDataSize <= m_audioDataReadPtr) {
+                if (flushDecoder()) goto exit;
                 m_f_eof = true;
                 goto exit;
             }
@@ -5283,6 +5438,7 @@ void Audio::playAudioData() {
             if (m_f_allDataReceived) { // Google TTS, OpenAI
                 m_pad.lastFrames = true;
                 if (m_f_tts && !InBuff.bufferFilled()) {
+                    if (flushDecoder()) goto exit;
                     m_f_eof = true;
                     goto exit;
                 }
@@ -5989,8 +6145,40 @@ int Audio::findNextSync(uint8_t* data, size_t len) {
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void Audio::setDecoderItems() {
+    if (m_gapless.f_carry) { // samples of the previous file are still in SamplesBuff
+        if (m_gapless.sampleRate != m_decoder->getSampleRate() || m_gapless.channels != m_decoder->getChannels()) {
+            // different format, play them out before the I2S is reconfigured. Not longer than the ring plays plus a margin,
+            // a stopped I2S or a full DMA would keep the audio task here forever
+            uint32_t rate = m_output_sr ? m_output_sr : m_i2s_items.sampleRate;
+            uint32_t deadline = millis() + (uint64_t)SamplesBuff.bufferFilled() / 2 * 1000 / max(rate, (uint32_t)1) + 500;
+            while (SamplesBuff.bufferFilled()) {
+                if ((int32_t)(millis() - deadline) > 0) {
+                    AUDIO_LOG_WARN("I2S does not take the carried samples, {} dropped", SamplesBuff.bufferFilled() / 2);
+                    if (xSemaphoreTake(mutex_outputTask, 0.3 * configTICK_RATE_HZ) == pdTRUE) {
+                        resetSamples();
+                        xSemaphoreGive(mutex_outputTask);
+                    } else {
+                        AUDIO_LOG_ERROR("output task does not release SamplesBuff");
+                    }
+                    break;
+                }
+                playChunk();
+                vTaskDelay(1);
+            }
+        }
+        m_gapless.f_carry = false;
+    }
+    bool locked = xSemaphoreTake(mutex_outputTask, 0.3 * configTICK_RATE_HZ) == pdTRUE; // the I2S may be reconfigured
+    if (!locked) AUDIO_LOG_WARN("output task does not release the I2S");
     setChannels(m_decoder->getChannels());
     setSampleRate(m_decoder->getSampleRate());
+    bool drift = m_drift.f_enabled && m_streamType == ST_WEBSTREAM && m_playlistFormat != FORMAT_M3U8;
+    m_drift.start(drift);
+    if (resampling() && m_resampler.f_variable != drift) resamplerSetup(); // the first stream with drift compensation or the first file after it
+    if (drift) m_resampler.setPpm(0);
+    if (m_xfade.f_fading) xfadeResample(); // the tail of the previous file must have the new output rate
+    for (int ch = 0; ch < 2; ch++) m_audio_items.gain[ch] = audiolib::dsp::toGain(m_audio_items.limiter[ch]); // no ramp from silence, only volume changes glide
+    if (locked) xSemaphoreGive(mutex_outputTask);
     setBitsPerSample(m_decoder->getBitsPerSample());
 
     if (m_decoder->arg1()) info(*this, evt_info, "{}", m_decoder->arg1());
@@ -6104,12 +6292,19 @@ int Audio::sendBytes(uint8_t* data, size_t len) {
     if (!m_decoder) return 0;     // guard
     if (m_validSamples) return 0; // guard
 
+    int32_t* outBuff = m_outBuff.get();
+    if (m_f_playing && m_f_decode_ready) {
+        outBuff = decodeTarget();
+        if (!outBuff) return 0; // SamplesBuff has no room for a whole frame yet
+    }
+
     int                   res = 0;
     int                   bytesDecoded = 0;
     const char*           st = NULL;
     std::vector<uint32_t> vec;
     uint16_t              samples_out = 0;
 
+    m_taskStats.work++;
     m_sbyt.bytesLeft = 0;
     m_sbyt.nextSync = 0;
 
@@ -6130,7 +6325,7 @@ int Audio::sendBytes(uint8_t* data, size_t len) {
     if (!m_f_decode_ready) return 0;                                        // find sync first
 
     //-----------------------------------------------------------------
-    res = m_decoder->decode(data, &m_sbyt.bytesLeft, m_outBuff.get());
+    res = m_decoder->decode(data, &m_sbyt.bytesLeft, outBuff);
     bytesDecoded = len - m_sbyt.bytesLeft;
     //-----------------------------------------------------------------
 
@@ -6210,6 +6405,12 @@ int Audio::sendBytes(uint8_t* data, size_t len) {
             }
             break;
     }
+    if (m_skipSamples && m_validSamples) { // sample accurate seek, drop everything before the target
+        uint16_t n = min(m_skipSamples, (uint32_t)m_validSamples);
+        m_skipSamples -= n;
+        m_validSamples -= n;
+        memmove(m_outBuff.get(), m_outBuff.get() + n * 2, m_validSamples * 2 * sizeof(int32_t));
+    }
     if (m_sbyt.f_setDecodeParamsOnce && m_validSamples) {
         m_sbyt.f_setDecodeParamsOnce = false;
         setDecoderItems();
@@ -6218,12 +6419,35 @@ int Audio::sendBytes(uint8_t* data, size_t len) {
 
     if (m_validSamples) {
         calculateAudioTime(bytesDecoded, samples_out);
-        cacheSamples();
+        if (outBuff != m_outBuff.get()) { // zero-copy, the samples are in SamplesBuff already
+            SamplesBuff.bytesWritten((size_t)m_validSamples * 2);
+            m_validSamples = 0;
+            m_taskStats.inPlace++;
+        } else {
+            cacheSamples();
+            m_taskStats.copied++;
+        }
     }
     if (SamplesBuff.bufferFilled()) { playChunk(); }
     return bytesDecoded;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int32_t* Audio::decodeTarget() {
+    // Zero-copy: if a whole frame fits into SamplesBuff in one piece, the decoder writes straight into it. That saves the
+    // pass through m_outBuff (decoder -> m_outBuff -> cacheSamples -> SamplesBuff). Not possible while the samples have to
+    // be resampled, trimmed after a seek or held back for a crossfade, or before setDecoderItems() knows the format.
+    // Returns nullptr if the frame would fit later, the decoder waits then while SamplesBuff is above its low watermark.
+    if (m_sbyt.f_setDecodeParamsOnce || m_skipSamples || !SamplesBuff.isInitialized()) return m_outBuff.get();
+    if (resampling()) return m_outBuff.get();
+    if ((m_xfade.ms && m_next.type) || (XfadeBuff.bufferFilled() && !m_xfade.f_fading)) return m_outBuff.get();
+
+    size_t              maxWords = (m_codec == CODEC_MP3) ? 1152 * 2 : m_outbuffSize; // largest output of one decode() call
+    RingBuffer::spans_t room = SamplesBuff.writeView(maxWords);
+    if (room.first.size() >= maxWords) return room.first.data();
+    if (room.second.size() || SamplesBuff.isBelowLowWatermark()) return m_outBuff.get(); // the frame would wrap, or hurry
+    return nullptr;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 uint32_t Audio::calculate_average_bitrate(uint64_t sum_bytes_in, uint64_t sum_samples) {
     if (m_cab.counter == 0) {
         m_cab.estimated_bitrate = m_channels * m_i2s_items.sampleRate * m_bitsPerSample / est_compression[m_codec];
@@ -6373,11 +6597,10 @@ bool Audio::setPinout(uint8_t BCLK, uint8_t LRC, uint8_t DOUT, int8_t MCLK) {
 
     m_outBuff.alloc_array(m_outbuffSize, "m_outBuff");
     m_resamplesBuff.alloc_array(m_resamplesBuffSize, "m_resamplesBuff");
-    m_i2sWorkBuff.alloc_array(m_work_words, "i2sWorkBuff");
     m_metadataBuff.alloc(4096 + 1, "m_metadataBuff");   // max 4096 + 1 for null terminator, just to make library code 'safe'
     m_httpRespHdrBuff.alloc(4096, "m_httpRespHdrBuff"); // enough space to store http response header
 
-    if (!m_outBuff.valid() || !m_resamplesBuff.valid() || !m_i2sWorkBuff.valid() || !m_metadataBuff.valid() || !m_httpRespHdrBuff.valid()) {
+    if (!m_outBuff.valid() || !m_resamplesBuff.valid() || !m_metadataBuff.valid() || !m_httpRespHdrBuff.valid()) {
         result = false;
         goto exit;
     }
@@ -6399,6 +6622,7 @@ exit:
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 uint32_t Audio::getFileSize() { // returns the size of webfile or local file
+    if (inNextWindow()) return m_shown.fileSize;
     if (!m_audiofile) {
         if (m_audioFileSize > 0) { return m_audioFileSize; }
         return 0;
@@ -6407,16 +6631,19 @@ uint32_t Audio::getFileSize() { // returns the size of webfile or local file
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 uint32_t Audio::getAudioFileDuration() {
+    if (inNextWindow()) return m_shown.duration;
     if (m_audio_file_duration) return m_audio_file_duration;
     if (m_avr_file_duration) return m_avr_file_duration;
     return 0;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 uint32_t Audio::getAudioCurrentTime() { // return current time in seconds
+    if (inNextWindow()) return m_shown.currentTime;
     return m_audioCurrentTime;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 uint32_t Audio::getAudioFilePosition() {
+    if (inNextWindow()) return m_shown.filePosition;
     if (!m_f_stream) return 0;
     if ((m_dataMode != AUDIO_LOCALFILE) && (m_streamType != ST_WEBFILE)) {
         AUDIO_LOG_WARN("audio is not a file");
@@ -6472,6 +6699,14 @@ bool Audio::setAudioPlayTime(uint16_t sec) {
     uint32_t filepos = m_audioDataStart + (getBitRate() * sec / 8);
     m_resumeFilePos = filepos;
     m_samples_since_start = (float)get_total_samples_in_file() * ((float)(m_resumeFilePos - m_audioDataStart) / m_audioDataSize);
+    if (m_codec == CODEC_FLAC && !m_f_ogg && m_rflh.sampleRate) { // the byte position is only a guess, newInBuffStart() seeks sample accurate
+        m_seekSample = (uint64_t)sec * m_rflh.sampleRate;
+        m_samples_since_start = m_seekSample;
+    }
+    if (m_codec == CODEC_MP3 && getSampleRate()) { // TOC or frame index, see newInBuffStart()
+        m_seekSample = (uint64_t)sec * getSampleRate();
+        m_samples_since_start = m_seekSample;
+    }
     return true;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -6504,6 +6739,14 @@ bool Audio::setTimeOffset(int sec) { // fast forward or rewind the current posit
     if (pos < (int32_t)m_audioDataStart) pos = m_audioDataStart;
     m_resumeFilePos = pos;
     m_samples_since_start = (float)get_total_samples_in_file() * ((float)(m_resumeFilePos - m_audioDataStart) / m_audioDataSize);
+    if (m_codec == CODEC_FLAC && !m_f_ogg && m_rflh.sampleRate) { // sample accurate, see newInBuffStart()
+        m_seekSample = (uint64_t)newTime * m_rflh.sampleRate;
+        m_samples_since_start = m_seekSample;
+    }
+    if (m_codec == CODEC_MP3 && getSampleRate()) { // TOC or frame index, see newInBuffStart()
+        m_seekSample = (uint64_t)newTime * getSampleRate();
+        m_samples_since_start = m_seekSample;
+    }
     return true;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -6702,6 +6945,7 @@ uint8_t Audio::getChannels() {
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 uint32_t Audio::getBitRate() {
+    if (inNextWindow()) return m_shown.bitRate;
     if (m_nominal_bitrate) return m_nominal_bitrate;
     return m_avr_bitrate;
 }
@@ -6759,12 +7003,8 @@ void Audio::reconfigI2S() {
     }
     i2s_channel_reconfig_std_slot(m_i2s_tx_handle, &m_i2s_std_cfg.slot_cfg);
 
+    if (resampling()) resamplerSetup(); // prepare resampler
     if (m_output_sr) {
-        m_resampler.phase = 0; // prepare resampler
-        m_resampler.phaseStep = ((uint64_t)m_i2s_items.sampleRate << 32) / m_output_sr;
-        m_resampler.g_lpCoeffs = makeButterworthLPF_Q31(m_i2s_items.sampleRate);
-        m_resampler.lpLeft = {};
-        m_resampler.lpRight = {};
         m_i2s_std_cfg.clk_cfg.sample_rate_hz = m_output_sr;
         AUDIO_LOG_DEBUG("output samplerate is {}", m_i2s_std_cfg.clk_cfg.sample_rate_hz);
     } else {
@@ -6775,7 +7015,7 @@ void Audio::reconfigI2S() {
     m_dmaFreeDesc = settings.DMA_DESC_NUM;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-void Audio::calculateVUlevel(int32_t* buff, size_t len) {
+void Audio::calculateVUlevel() { // the DSP kernel accumulates the samples, here the window is evaluated
 
     auto newVal = [](uint8_t* display, uint8_t measured, uint8_t max, uint8_t attackStep, uint8_t releaseStep, uint8_t hold, uint8_t* tmpHold) -> void {
         if (measured > *display) { // attack
@@ -6869,61 +7109,42 @@ void Audio::calculateVUlevel(int32_t* buff, size_t len) {
     //--------------------------------------------------------------------------------------------------
 
     if (m_decoder) {
-        for (size_t i = 0; i < len / 2; i++) {
+        if (m_vu_items.samps_count >= m_vu_items.samps_vu) {
 
-            // Always stereo
-            uint8_t l = sampleToVU(buff[i * 2]);
-            uint8_t r = sampleToVU(buff[i * 2 + 1]);
+            // Average level
+            m_vu_items.measuredLeft = m_vu_items.sumL / m_vu_items.samps_count;
+            m_vu_items.measuredRight = m_vu_items.sumR / m_vu_items.samps_count;
 
-            // Accumulate average
-            m_vu_items.sumL += l;
-            m_vu_items.sumR += r;
+            //--------------------------------------------------------------------------
+            // Bars
+            //--------------------------------------------------------------------------
+            newVal(&m_vu_items.displayLeft, m_vu_items.measuredLeft, m_vu_items.maxLeft, bars_attack_step, bars_release_step, bars_hold_cycles, &m_vu_items.barsHoldLeft_tmp);
+            newVal(&m_vu_items.displayRight, m_vu_items.measuredRight, m_vu_items.maxRight, bars_attack_step, bars_release_step, bars_hold_cycles, &m_vu_items.barsHoldRight_tmp);
 
-            // Track peak within measurement window
-            if (l > m_vu_items.maxLeft) { m_vu_items.maxLeft = l; }
-            if (r > m_vu_items.maxRight) { m_vu_items.maxRight = r; }
-            m_vu_items.samps_count++;
+            //--------------------------------------------------------------------------
+            // Peak
+            //--------------------------------------------------------------------------
+            newVal(&m_vu_items.peakLeft, m_vu_items.measuredLeft, m_vu_items.maxLeft, peak_attack_step, peak_release_step, peak_hold_cycles, &m_vu_items.peakHoldLeft_tmp);
+            newVal(&m_vu_items.peakRight, m_vu_items.measuredRight, m_vu_items.maxRight, peak_attack_step, peak_release_step, peak_hold_cycles, &m_vu_items.peakHoldRight_tmp);
 
             //--------------------------------------------------------------------------
-            // One VU measurement window complete
+            // Delay output by two VU cycles
             //--------------------------------------------------------------------------
-            if (m_vu_items.samps_count >= m_vu_items.samps_vu) {
-
-                // Average level
-                m_vu_items.measuredLeft = m_vu_items.sumL / m_vu_items.samps_count;
-                m_vu_items.measuredRight = m_vu_items.sumR / m_vu_items.samps_count;
-
-                //--------------------------------------------------------------------------
-                // Bars
-                //--------------------------------------------------------------------------
-                newVal(&m_vu_items.displayLeft, m_vu_items.measuredLeft, m_vu_items.maxLeft, bars_attack_step, bars_release_step, bars_hold_cycles, &m_vu_items.barsHoldLeft_tmp);
-                newVal(&m_vu_items.displayRight, m_vu_items.measuredRight, m_vu_items.maxRight, bars_attack_step, bars_release_step, bars_hold_cycles, &m_vu_items.barsHoldRight_tmp);
-
-                //--------------------------------------------------------------------------
-                // Peak
-                //--------------------------------------------------------------------------
-                newVal(&m_vu_items.peakLeft, m_vu_items.measuredLeft, m_vu_items.maxLeft, peak_attack_step, peak_release_step, peak_hold_cycles, &m_vu_items.peakHoldLeft_tmp);
-                newVal(&m_vu_items.peakRight, m_vu_items.measuredRight, m_vu_items.maxRight, peak_attack_step, peak_release_step, peak_hold_cycles, &m_vu_items.peakHoldRight_tmp);
-
-                //--------------------------------------------------------------------------
-                // Delay output by two VU cycles
-                //--------------------------------------------------------------------------
-                m_vu_items.lrvec[0] = m_vu_items.vuCurve[m_vu_items.delay_bars_left.fifo(m_vu_items.displayLeft)];
-                m_vu_items.lrvec[1] = m_vu_items.vuCurve[m_vu_items.delay_bars_right.fifo(m_vu_items.displayRight)];
-                m_vu_items.lrvec[2] = m_vu_items.vuCurve[m_vu_items.delay_peak_left.fifo(m_vu_items.peakLeft)];
-                m_vu_items.lrvec[3] = m_vu_items.vuCurve[m_vu_items.delay_peak_right.fifo(m_vu_items.peakRight)];
-
-                info(*this, evt_vu, m_vu_items.lrvec);
-
-                //--------------------------------------------------------------------------
-                // Reset measurement window
-                //--------------------------------------------------------------------------
-                m_vu_items.sumL = 0;
-                m_vu_items.sumR = 0;
-                m_vu_items.maxLeft = 0;
-                m_vu_items.maxRight = 0;
-                m_vu_items.samps_count = 0;
-            }
+            m_vu_items.lrvec[0] = m_vu_items.vuCurve[m_vu_items.delay_bars_left.fifo(m_vu_items.displayLeft)];
+            m_vu_items.lrvec[1] = m_vu_items.vuCurve[m_vu_items.delay_bars_right.fifo(m_vu_items.displayRight)];
+            m_vu_items.lrvec[2] = m_vu_items.vuCurve[m_vu_items.delay_peak_left.fifo(m_vu_items.peakLeft)];
+            m_vu_items.lrvec[3] = m_vu_items.vuCurve[m_vu_items.delay_peak_right.fifo(m_vu_items.peakRight)];
+
+            info(*this, evt_vu, m_vu_items.lrvec);
+
+            //--------------------------------------------------------------------------
+            // Reset measurement window
+            //--------------------------------------------------------------------------
+            m_vu_items.sumL = 0;
+            m_vu_items.sumR = 0;
+            m_vu_items.maxLeft = 0;
+            m_vu_items.maxRight = 0;
+            m_vu_items.samps_count = 0;
         }
         m_vu_items.is_down = false;
     }
@@ -6957,12 +7178,57 @@ void Audio::setTone(float gainLowPass, float gainBandPass, float gainHighPass) {
     // gainLowPass   set between -12 ... +12 dB
     // gainBandPass  set between -12 ... +12 dB
     // gainHighPass  set between -12 ... +12 dB
+    // band 0...2 of the parametric EQ, at settings.FREQ_LS_HZ, FREQ_PEAK_HZ, FREQ_HS_HZ
 
-    m_audio_items.gain_ls_db = fminf(fmaxf(gainLowPass, -12.0f), 12.0f);
-    m_audio_items.gain_peq_db = fminf(fmaxf(gainBandPass, -12.0f), 12.0f);
-    m_audio_items.gain_hs_db = fminf(fmaxf(gainHighPass, -12.0f), 12.0f);
+    using audiolib::eq_t;
+    audiolib::eq_t& eq = m_audio_items.eq;
+    if (!lockDSP()) return;
+    eq.band[0] = {eq_t::LOWSHELF, (float)settings.FREQ_LS_HZ, settings.QUALITY_SLOPE, fminf(fmaxf(gainLowPass, -12.0f), 12.0f)};
+    eq.band[1] = {eq_t::PEAK, (float)settings.FREQ_PEAK_HZ, settings.QUALITY_SLOPE, fminf(fmaxf(gainBandPass, -12.0f), 12.0f)};
+    eq.band[2] = {eq_t::HIGHSHELF, (float)settings.FREQ_HS_HZ, settings.QUALITY_SLOPE, fminf(fmaxf(gainHighPass, -12.0f), 12.0f)};
 
     IIR_calculateCoefficients();
+    unlockDSP();
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool Audio::setEqBand(uint8_t band, EqType_t type, float freq, float q, float gainDb) {
+
+    // band    0 ... 9, setTone() uses 0 ... 2
+    // type    EQ_OFF, EQ_PEAK, EQ_LOWSHELF, EQ_HIGHSHELF (with gainDb), EQ_LOWPASS, EQ_HIGHPASS, EQ_NOTCH, EQ_BANDPASS
+    // freq    center or corner frequency in Hz
+    // q       quality 0.1 ... 20, 0.707 Butterworth; EQ_LOWSHELF, EQ_HIGHSHELF: slope 0.1 ... 1 (1 = steepest without overshoot)
+    // gainDb  -24 ... +24 dB, the level is lowered automatically by the largest boost of all bands
+    // every band that is not flat costs one biquad per sample, the new coefficients glide in (no clicks)
+
+    static_assert(static_cast<int>(EQ_BANDPASS) == static_cast<int>(audiolib::eq_t::BANDPASS), "EqType_t and eq_t differ");
+    if (band >= audiolib::eq_t::MAX_BANDS || type > EQ_BANDPASS) return false;
+    if (!lockDSP()) return false;
+    m_audio_items.eq.band[band] = {(uint8_t)type, freq, q, fminf(fmaxf(gainDb, -24.0f), 24.0f)};
+    IIR_calculateCoefficients();
+    unlockDSP();
+    return true;
+}
+void Audio::clearEq() { // all bands off, also those of setTone()
+    if (!lockDSP()) return;
+    for (auto& b : m_audio_items.eq.band) b = {};
+    IIR_calculateCoefficients();
+    unlockDSP();
+}
+bool Audio::lockDSP() { // the kernel runs in the audio task (mutex_audioTask) or in the output task (mutex_outputTask)
+    if (xSemaphoreTake(mutex_audioTask, 0.3 * configTICK_RATE_HZ) != pdTRUE) {
+        AUDIO_LOG_ERROR("audio task does not release the DSP chain");
+        return false;
+    }
+    if (xSemaphoreTake(mutex_outputTask, 0.3 * configTICK_RATE_HZ) != pdTRUE) {
+        xSemaphoreGive(mutex_audioTask);
+        AUDIO_LOG_ERROR("output task does not release the DSP chain");
+        return false;
+    }
+    return true;
+}
+void Audio::unlockDSP() {
+    xSemaphoreGive(mutex_outputTask);
+    xSemaphoreGive(mutex_audioTask);
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void Audio::forceMono(bool m) { // #100 mono option
@@ -6980,6 +7246,52 @@ void Audio::setOutputSampleRate(OutputSR_t sr) { //
     reconfigI2S();
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::setResampleQuality(ResampleQuality_t q) {
+    // RS_LINEAR   linear interpolation and a biquad lowpass, no table, audible aliasing
+    // RS_LOW      polyphase FIR, 16 taps
+    // RS_MEDIUM   32 taps (default)
+    // RS_HIGH     64 taps
+    // the table has L * taps int32_t for the ratio out / in = L / M, e.g. 160 * 32 * 4 bytes for 44.1 kHz -> 48 kHz
+    m_resample_quality = q; // used by the next resamplerSetup() if the table cannot be rebuilt now
+    if (xSemaphoreTake(mutex_audioTask, 0.3 * configTICK_RATE_HZ) != pdTRUE) {
+        AUDIO_LOG_ERROR("audio task does not release the resampler");
+        return;
+    }
+    if (resampling()) resamplerSetup();
+    xSemaphoreGive(mutex_audioTask);
+}
+void Audio::setDriftCompensation(bool on, uint32_t targetBytes) {
+    // Web streams (not HLS) are clocked by the encoder, InBuff fills or drains slowly. A PI controller steers the ratio of
+    // the resampler by up to +-500 ppm, so that InBuff stays at targetBytes (0: the level after 20 s of playback). The
+    // output runs through the resampler (setResampleQuality()) also if the sample rates are equal. From the next stream on.
+    m_drift.f_enabled = on;
+    m_drift.userTarget = targetBytes;
+}
+float Audio::getDriftPpm() { // + the encoder runs faster than the I2S clock
+    return m_drift.ppm;
+}
+uint32_t Audio::getDriftTarget() { // 0 until the target is known
+    return m_drift.target;
+}
+bool Audio::resampling() {
+    return (m_output_sr && m_output_sr != m_i2s_items.sampleRate) || m_drift.f_active;
+}
+void Audio::resamplerSetup() {
+    m_resampler.setup(m_i2s_items.sampleRate, m_output_sr ? m_output_sr : m_i2s_items.sampleRate, m_resample_quality, m_drift.f_active);
+    if (m_resampler.quality != m_resample_quality) AUDIO_LOG_WARN("not enough memory for the resampler table, quality {} instead of {}", (int)m_resampler.quality, (int)m_resample_quality);
+    AUDIO_LOG_DEBUG("resampler {} -> {} Hz, quality {}, {} taps{}", m_i2s_items.sampleRate, m_output_sr ? (uint32_t)m_output_sr : m_i2s_items.sampleRate, (int)m_resampler.quality, (int)m_resampler.taps,
+                    m_resampler.f_variable ? ", drift compensation" : "");
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::setCrossfade(uint16_t ms) {
+    // The last ms of a file are mixed with the beginning of the source queued by queueNext() or queueNextHost().
+    // Needs the total number of samples of the file, extra memory is ms * samplerate * 8 bytes (PSRAM).
+    m_xfade.ms = std::min(ms, (uint16_t)5000);
+}
+uint16_t Audio::getCrossfade() {
+    return m_xfade.ms;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void Audio::setBalance(float balance) { // left -16.0dB ... 0dB ... -16.0dB right
     m_audio_items.balance = fminf(fmaxf(balance, -16.0f), 16.0f);
     calculateVolumeLimits();
@@ -7302,16 +7614,6 @@ void Audio::calculateSpectrum(int32_t* buff, size_t len) {
     }
 }
 
-// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-void Audio::Gain(int32_t* buff, size_t len) {
-    /* important: these multiplications must all be signed ints, or the result will be invalid */
-    int32_t* s32;
-    for (int i = 0; i < len / 2; i++) {
-        s32 = buff + (i * 2);
-        s32[LEFTCHANNEL] *= m_audio_items.limiter[LEFTCHANNEL];
-        s32[RIGHTCHANNEL] *= m_audio_items.limiter[RIGHTCHANNEL];
-    }
-}
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 uint32_t Audio::inBufferFilled() {
     // current audio input buffer fillsize in bytes
@@ -7328,81 +7630,21 @@ uint32_t Audio::getInBufferSize() {
     return InBuff.getBufsize();
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-void Audio::stereo2mono(int32_t* buff, size_t len) {
-
-    for (uint16_t i = 0; i < len * 2; i += 2) {
-        int64_t l = buff[i];
-        int64_t r = buff[i + 1];
-        int32_t m = (int32_t)((l + r) >> 1); // average, without overflow
-        buff[i] = m;                         // Left
-        buff[i + 1] = m;                     // Right
-    }
-}
-// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 //            ***     D i g i t a l   b i q u a d r a t i c     f i l t e r     ***
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-void Audio::IIR_calculateCoefficients() { // Infinite Impulse Response (IIR) filters
-
-    AUDIO_LOG_DEBUG("gain gain_ls_db {}, gain gain_peq_db {}, gain gain_hs_db {}", m_audio_items.gain_ls_db, m_audio_items.gain_peq_db, m_audio_items.gain_hs_db);
-
-    const float FcLS = settings.FREQ_LS_HZ;     // Frequency LowShelf(Hz)
-    const float FcPKEQ = settings.FREQ_PEAK_HZ; // Frequency PeakEQ(Hz)
-    const float FcHS = settings.FREQ_HS_HZ;     // Frequency HighShelf(Hz)
-    const float QS = settings.QUALITY_SLOPE;    // Quality Slope (Shelf)
-
-    float normFreqLS = FcLS / m_i2s_items.sampleRate;    // filter cut off frequency
-    float normFreqPEQ = FcPKEQ / m_i2s_items.sampleRate; // filter center frequency
-    float normFreqHS = FcHS / m_i2s_items.sampleRate;    // filter cut off frequency
-
-    float total_boost_db = fmax(fmax(fmax(0, m_audio_items.gain_ls_db), m_audio_items.gain_peq_db), m_audio_items.gain_hs_db); // dynamic headroom
-    m_audio_items.pre_gain = powf(10.0, -total_boost_db / 20);
-
-    auto dsps_biquad_gen_peakingEQ_f32 = [&](float* c, float f, int8_t g, const float Q) -> void {
-        float A = powf(10.0f, g / 40.0f);
-        float w0 = 2.0f * M_PI * f;
-        float cw = cosf(w0);
-        float sw = sinf(w0);
-        float alpha = sw / (2.0f * Q);
-        float b0 = 1.0f + alpha * A;
-        float b1 = -2.0f * cw;
-        float b2 = 1.0f - alpha * A;
-        float a0 = 1.0f + alpha / A;
-        float a1 = -2.0f * cw;
-        float a2 = 1.0f - alpha / A;
-        c[0] = b0 / a0;
-        c[1] = b1 / a0;
-        c[2] = b2 / a0;
-        c[3] = a1 / a0;
-        c[4] = a2 / a0;
-    };
+void Audio::IIR_calculateCoefficients() { // Infinite Impulse Response (IIR) filters, after a change of the EQ bands or the sample rate
 
-    dsps_biquad_gen_lowShelf_f32(m_audio_items.coeffs[LOWSHELF], normFreqLS, m_audio_items.gain_ls_db, QS);
-    dsps_biquad_gen_peakingEQ_f32(m_audio_items.coeffs[PEAKINGEQ], normFreqPEQ, m_audio_items.gain_peq_db, QS); // my own calc.
-    dsps_biquad_gen_highShelf_f32(m_audio_items.coeffs[HIFGSHELF], normFreqHS, m_audio_items.gain_hs_db, QS);
-
-    AUDIO_LOG_DEBUG("\n([{}, {}, {}], [1.0, {}, {}]), # LOWSHELF\n([{},  {},  {} ], [1.0, {},  {} ]), # PEAKINGEQ\n([{}, {}, {}], [1.0, {}, {}]), # HIGHSHELF\n", m_audio_items.coeffs[0][0],
-                    m_audio_items.coeffs[0][1], m_audio_items.coeffs[0][2], m_audio_items.coeffs[0][3], m_audio_items.coeffs[0][4], m_audio_items.coeffs[1][0], m_audio_items.coeffs[1][1],
-                    m_audio_items.coeffs[1][2], m_audio_items.coeffs[1][3], m_audio_items.coeffs[1][4], m_audio_items.coeffs[2][0], m_audio_items.coeffs[2][1], m_audio_items.coeffs[2][2],
-                    m_audio_items.coeffs[2][3], m_audio_items.coeffs[2][4]);
-    AUDIO_LOG_DEBUG("m_audio_items.pre_gain {}", m_audio_items.pre_gain);
-}
-// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-void Audio::IIR_filter(int32_t* buff, size_t len) {
-    int32_t* s32;
-    float    s[2];
-    for (int i = 0; i < len / 2; i++) {
-        s32 = buff + (i * 2);
-        s[LEFTCHANNEL] = (float)(s32[LEFTCHANNEL] * m_audio_items.pre_gain);
-        s[RIGHTCHANNEL] = (float)(s32[RIGHTCHANNEL] * m_audio_items.pre_gain);
-        dsps_biquad_sf32(s, s, 1, m_audio_items.coeffs[0], m_audio_items.state_biquad[0]);
-        dsps_biquad_sf32(s, s, 1, m_audio_items.coeffs[1], m_audio_items.state_biquad[1]);
-        dsps_biquad_sf32(s, s, 1, m_audio_items.coeffs[2], m_audio_items.state_biquad[2]);
-        s32[LEFTCHANNEL] = (int32_t)std::clamp(s[LEFTCHANNEL], -2147483648.0f, 2147483647.0f);
-        s32[RIGHTCHANNEL] = (int32_t)std::clamp(s[RIGHTCHANNEL], -2147483648.0f, 2147483647.0f);
+    audiolib::eq_t& eq = m_audio_items.eq;
+    eq.update(m_i2s_items.sampleRate); // targets, cascade and pre gain (dynamic headroom), the kernel glides to them
+
+    for (uint8_t k = 0; k < eq.stages; k++) {
+        const float* c = eq.target[eq.stage[k]];
+        AUDIO_LOG_DEBUG("EQ band {}: type {}, {} Hz, Q {}, {} dB  ([{}, {}, {}], [1.0, {}, {}])", eq.stage[k], eq.band[eq.stage[k]].type, eq.band[eq.stage[k]].freq, eq.band[eq.stage[k]].q,
+                        eq.band[eq.stage[k]].gain, c[0], c[1], c[2], c[3], c[4]);
     }
-    return;
+    AUDIO_LOG_DEBUG("EQ pre_gain {}", eq.target_pre_gain);
 }
-// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————-
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 //    AAC - T R A N S P O R T S T R E A M
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————-
 bool Audio::ts_parsePacket(uint8_t* packet, uint8_t* packetStart, uint8_t* packetLength) {
@@ -7872,6 +8114,25 @@ int32_t Audio::newInBuffStart(int32_t resumeFilePos) {
         return -1;
     }
 
+    m_skipSamples = 0;
+    if (xSemaphoreTake(mutex_outputTask, 0.3 * configTICK_RATE_HZ) == pdTRUE) {
+        XfadeBuff.reset(); // held back or fading frames do not fit the new position
+        m_xfade.f_fading = false;
+        for (int ch = 0; ch < 2; ch++) m_audio_items.gain[ch] = audiolib::dsp::toGain(m_audio_items.limiter[ch]); // the seek starts at the set volume
+        xSemaphoreGive(mutex_outputTask);
+    } else {
+        AUDIO_LOG_WARN("output task does not release XfadeBuff");
+    }
+    bool f_mp3Toc = false; // the position of a TOC seek is known after the resync only
+    if (m_seekSample >= 0) { // replaces the guess from the bitrate
+        int32_t pos = -1;
+        if (m_codec == CODEC_FLAC) pos = flac_seekFilePos(m_seekSample); // SEEKTABLE or bisection
+        if (m_codec == CODEC_MP3) pos = mp3_seekFilePos(m_seekSample);   // Xing/VBRI TOC or frame index
+        if (pos >= 0) resumeFilePos = pos;
+        if (m_codec == CODEC_MP3 && pos >= 0) f_mp3Toc = static_cast<MP3Decoder*>(m_decoder.get())->getSeekOffset(m_seekSample) >= 0;
+        m_seekSample = -1;
+    }
+
     if (resumeFilePos < (int32_t)m_audioDataStart) resumeFilePos = m_audioDataStart; // keep resumeFilePos within the audio data
     buffFillValue = std::min<uint32_t>(m_audioDataStart + m_audioDataSize - resumeFilePos, UINT16_MAX);
     AUDIO_LOG_DEBUG("new InBuff start at m_resumeFilePos {}, m_audioDataStart {}, buffFillValue {}", m_resumeFilePos, m_audioDataStart, buffFillValue);
@@ -7907,6 +8168,7 @@ int32_t Audio::newInBuffStart(int32_t resumeFilePos) {
         m_decoder->clear();
         InBuff.bytesWasRead(offset);
         m_audioDataReadPtr = (resumeFilePos + offset) - m_audioDataStart;
+        if (f_mp3Toc) m_samples_since_start = static_cast<MP3Decoder*>(m_decoder.get())->getSeekSample(m_audioDataReadPtr); // where the TOC got us, not the target
         m_f_lockInBuffer = false;
         xSemaphoreGive(mutex_audioTaskIsDecoding);
         return resumeFilePos + offset;
@@ -7914,6 +8176,7 @@ int32_t Audio::newInBuffStart(int32_t resumeFilePos) {
 
 fail:
     AUDIO_LOG_ERROR("timeOffset not possible (3)");
+    m_skipSamples = 0;
     xSemaphoreGive(mutex_audioTaskIsDecoding);
     stopSong();
     return -1;
@@ -8046,8 +8309,11 @@ int32_t Audio::ogg_correctResumeFilePos() {
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————-
 int32_t Audio::flac_correctResumeFilePos() {
-    uint8_t* p = InBuff.getReadPtr();
-    size_t   av = InBuff.readSpace();
+    return flac_findFrame(InBuff.getReadPtr(), InBuff.readSpace());
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————-
+int32_t Audio::flac_findFrame(const uint8_t* p, size_t av, uint64_t* firstSample) {
+    // returns the offset of the first valid frame header in p, and optional the number of its first sample
 
     if (av < 32) return -1; // sicher gehen
 
@@ -8110,12 +8376,134 @@ int32_t Audio::flac_correctResumeFilePos() {
 
         // === When we get here: 99.9999% certain it’s a real frame ===
         AUDIO_LOG_DEBUG(">>> REAL FLAC-FRAME found at offset {}", i);
+        if (firstSample) { // coded number: frame number (fixed blocksize) or sample number (variable blocksize)
+            uint64_t num = (len == 1) ? p[pos] : p[pos] & (0x7F >> len);
+            for (int k = 1; k < len; k++) num = (num << 6) | (p[pos + k] & 0x3F);
+            *firstSample = (b1 & 0x01) ? num : num * m_rflh.maxBlockSize;
+        }
         return (int32_t)i;
     }
 
     return -1; // No frame found in the first 64 KB
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————-
+int32_t Audio::flac_seekFilePos(uint64_t targetSample) {
+    // returns the file position of the frame that contains targetSample, the samples in front of it are dropped in sendBytes()
+    const auto& st = m_rflh.seekTable;
+    if (st.size() && st.front().sample <= targetSample) { // the nearest seek point at or before the target
+        auto it = std::upper_bound(st.begin(), st.end(), targetSample, [](uint64_t s, const audiolib::flacSeekPoint_t& sp) { return s < sp.sample; });
+        --it;
+        m_skipSamples = targetSample - it->sample;
+        AUDIO_LOG_DEBUG("seek point sample {}, offset {}, skip {}", it->sample, it->offset, m_skipSamples);
+        return m_audioDataStart + it->offset;
+    }
+
+    // no SEEKTABLE: bisection over the frame headers, local files only. Over HTTP every step is a range request, the
+    // caller takes the linear estimate from the bitrate instead (-1)
+    if (!m_rflh.maxBlockSize || m_dataMode != AUDIO_LOCALFILE) return -1;
+    const size_t    window = m_rflh.maxFrameSize ? m_rflh.maxFrameSize + 32 : 16384; // contains at least one frame header
+    ps_ptr<uint8_t> buff;
+    if (!buff.alloc(window, "flacSeek")) return -1;
+    const uint32_t fileEnd = m_audioDataStart + m_audioDataSize;
+    uint32_t       lo = m_audioDataStart;
+    uint32_t       hi = fileEnd;
+    uint64_t       loSample = 0;
+    uint8_t        steps = 0;
+    while (hi - lo > window && steps < 32) {
+        steps++;
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint32_t len = std::min<uint32_t>(window, fileEnd - mid); // never read across the end, that would wait for the timeout
+        if (audioFileSeek(mid, len) <= 0) return -1;
+        int32_t  n = audioFileRead(buff.get(), len);
+        uint64_t s = 0;
+        int32_t  idx = (n > 0) ? flac_findFrame(buff.get(), n, &s) : -1;
+        if (idx >= 0 && s <= targetSample) {
+            lo = mid + idx;
+            loSample = s;
+        } else {
+            hi = mid; // the frame behind mid is too late or there is none (end of file)
+        }
+    }
+    m_skipSamples = targetSample - loSample;
+    AUDIO_LOG_DEBUG("bisection: {} steps, frame at {}, sample {}, skip {}", steps, lo, loSample, m_skipSamples);
+    return lo;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————-
+bool Audio::flushDecoder() { // settings.MP3_PIPELINE: the decoder holds the last frame back, true if it was moved to m_outBuff
+    if (m_codec != CODEC_MP3 || !m_decoder || m_validSamples) return false;
+    m_validSamples = static_cast<MP3Decoder*>(m_decoder.get())->flush(m_outBuff.get());
+    if (!m_validSamples) return false;
+    calculateAudioTime(0, m_validSamples);
+    return true;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————-
+int32_t Audio::mp3_seekFilePos(uint64_t targetSample) {
+    // returns the file position of the frame that contains targetSample
+    MP3Decoder* mp3 = static_cast<MP3Decoder*>(m_decoder.get());
+    int32_t     offset = mp3->getSeekOffset(targetSample);
+    if (offset >= 0) { // Xing or VBRI TOC, O(1). Only about 1/256 of the file exact, newInBuffStart() takes the sample
+                       // position from the frame it resyncs to, m_skipSamples stays 0
+        AUDIO_LOG_DEBUG("TOC: sample {}, offset {}", targetSample, offset);
+        return m_audioDataStart + offset;
+    }
+
+    // no TOC: walk the frame headers up to the target, the index is kept and only extended by later seeks
+    auto&          fi = m_mp3fi;
+    const uint32_t spf = mp3->getSamplesPerFrame(); // not getOutputSamples(): 0 after the Xing frame or with MP3_PIPELINE, less after a gapless trim
+    const uint32_t end = m_audioDataStart + m_audioDataSize;
+    if (!spf) return -1;
+    uint32_t targetFrame = targetSample / spf;
+    if (!fi.nextPos) fi.nextPos = m_audioDataStart;
+
+    if (fi.frames <= targetFrame && !fi.f_complete) {
+        const uint32_t  limit = (m_dataMode == AUDIO_LOCALFILE) ? 2 * 1024 * 1024 : 256 * 1024; // bytes read per seek
+        const uint32_t  scanEnd = min(end, fi.nextPos + limit);
+        const uint32_t  chunk = 4096; // > max frame size, a header is always inside after a refill
+        ps_ptr<uint8_t> buff;
+        if (!buff.alloc(chunk, "mp3Index")) return -1;
+        if (audioFileSeek(fi.nextPos, scanEnd - fi.nextPos) < 0) return -1;
+        uint32_t bufPos = fi.nextPos; // file position of buff[0]
+        uint32_t n = 0;
+        while (fi.frames <= targetFrame) {
+            uint32_t bufEnd = bufPos + n;
+            if (fi.nextPos + 4 > bufEnd) { // refill, keep the beginning of a header
+                uint32_t keep = (fi.nextPos < bufEnd) ? bufEnd - fi.nextPos : 0;
+                uint32_t want = min(chunk - keep, scanEnd - bufEnd);
+                if (!want) break;
+                memmove(buff.get(), buff.get() + n - keep, keep);
+                int32_t r = audioFileRead(buff.get() + keep, want, 3000);
+                if (r <= 0) break;
+                bufPos = bufEnd - keep;
+                n = keep + r;
+                continue;
+            }
+            const uint8_t* h = buff.get() + (fi.nextPos - bufPos);
+            int32_t        len = (h[0] == 0xFF && (h[1] & 0xE0) == 0xE0) ? MP3Decoder::calcFrameLength(h) : -1;
+            if (len <= 0) { // ID3v1, APE tag or garbage, the index ends here
+                fi.f_complete = true;
+                break;
+            }
+            if (fi.nextPos != m_audioDataStart || !mp3->getTotalFrames()) { // the Xing/Info/VBRI frame contains no audio
+                if (fi.frames % fi.step == 0) fi.pos.push_back(fi.nextPos);
+                fi.frames++;
+            }
+            fi.nextPos += len;
+        }
+        if (fi.nextPos + 4 > end) fi.f_complete = true;
+        AUDIO_LOG_DEBUG("frame index: {} frames, next frame at {}, complete {}", fi.frames, fi.nextPos, fi.f_complete);
+    }
+    if (fi.pos.empty()) return -1;
+
+    if (targetFrame < fi.frames) {
+        uint32_t idx = targetFrame / fi.step;
+        m_skipSamples = targetSample - (uint64_t)idx * fi.step * spf;
+        return fi.pos[idx];
+    }
+    // behind the index (scan limit or end of file), extrapolate with the average frame size
+    uint32_t avgFrameSize = (fi.nextPos - fi.pos[0]) / fi.frames;
+    return min<uint64_t>(end, fi.nextPos + (uint64_t)(targetFrame - fi.frames) * avgFrameSize);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————-
 int32_t Audio::mp3_correctResumeFilePos() {
 
     int32_t  steps = 0;
@@ -8208,19 +8596,21 @@ const char* Audio::getVersion() {
     return audioI2SVers + 8;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-bool Audio::get_info() {
+bool Audio::get_info() { // the callback runs without mutex_info, an evt_eof handler may start the next file
 
-    std::lock_guard<std::mutex> lock(mutex_info);
-    if (m_info_queue.queue.empty()) return false;
-
-    while (m_info_queue.queue.size()) {
-        msg_t                     i = {0};
-        const audiolib::InfoItem& item = m_info_queue.queue.front();
-        ps_ptr<char>              msg = item.msg;
-        i.msg = msg.c_get();
+    bool delivered = false;
+    while (true) {
+        audiolib::InfoItem item;
+        {
+            std::lock_guard<std::mutex> lock(mutex_info);
+            if (m_info_queue.queue.empty()) break;
+            item = std::move(m_info_queue.queue.front());
+            m_info_queue.queue.pop_front();
+        }
+        msg_t i = {0};
+        i.msg = item.msg.c_get();
         i.e = (event_t)item.e;
-        ps_ptr<char> evtstr = item.s;
-        i.s = evtstr.c_get();
+        i.s = item.s.c_get();
         i.arg1 = item.arg1;
         i.arg2 = item.arg2;
         i.i2s_num = m_i2s_items.i2s_num;
@@ -8228,9 +8618,9 @@ bool Audio::get_info() {
         i.vec2 = item.vec2;
 
         audio_info_callback(i);
-        m_info_queue.queue.pop_front();
+        delivered = true;
     }
-    return true;
+    return delivered;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void Audio::trim(char* str) {
@@ -8265,7 +8655,7 @@ int Audio::indexOf(const char* base, const char* str, int startIndex) {
     const char* p = base;
     for (; startIndex > 0; startIndex--)
         if (*p++ == '\0') return -1;
-    char* pos = strstr(p, str);
+    const char* pos = strstr(p, str);
     if (pos == nullptr) return -1;
     return pos - base;
 }
@@ -8275,7 +8665,7 @@ int Audio::indexOf(const char* base, char ch, int startIndex) {
     const char* p = base;
     for (; startIndex > 0; startIndex--)
         if (*p++ == '\0') return -1;
-    char* pos = strchr(p, ch);
+    const char* pos = strchr(p, ch);
     if (pos == nullptr) return -1;
     return pos - base;
 }
@@ -8403,6 +8793,13 @@ void Audio::setAudioTaskCore(uint8_t coreID) { // Recommendation:If the ARDUINO
     startAudioTask();
 }
 
+void Audio::setDualTask(bool enable) { // the output task runs on the other core, on a single core chip on the same one
+    if (enable == m_f_dualTask) return;
+    stopAudioTask();
+    m_f_dualTask = enable;
+    startAudioTask();
+}
+
 void Audio::startAudioTask() {
 
     if (m_f_audioTaskIsRunning) {
@@ -8421,6 +8818,8 @@ void Audio::startAudioTask() {
                                                       &xAudioTaskBuffer,        /* Memory for the task's control block */
                                                       m_audioTaskCoreId         /* Core where the task should run */
     );
+    m_dmaNotifyTask = m_audioTaskHandle;
+    if (m_f_dualTask) startOutputTask();
 }
 
 void Audio::stopAudioTask() {
@@ -8429,8 +8828,10 @@ void Audio::stopAudioTask() {
         return;
     }
     AUDIO_LOG_INFO("stop audio task.");
+    stopOutputTask();
     xSemaphoreTake(mutex_audioTask, 0.3 * configTICK_RATE_HZ);
     m_f_audioTaskIsRunning = false;
+    m_dmaNotifyTask = nullptr;
     if (m_audioTaskHandle != nullptr) {
         vTaskDelete(m_audioTaskHandle);
         m_audioTaskHandle = nullptr;
@@ -8444,37 +8845,170 @@ void Audio::audioTaskWrapper(void* param) {
 }
 
 void Audio::audioTask() {
+    // Sleeps until the I2S has sent a DMA buffer (i2s_tx_sent_callback), the timeout keeps the task going while the I2S
+    // is stopped. After a wakeup the work is repeated as long as it makes progress: all free DMA buffers are refilled and
+    // the decoder runs ahead into SamplesBuff. With nothing to play it sleeps 50ms, the DMA sends zeros meanwhile.
+    // In dual task mode only the decoder runs here. It is woken by the output task, stops above the high watermark of
+    // SamplesBuff and waits only one tick while it is below the low watermark and the decoder keeps up.
+    const TickType_t timeout = pdMS_TO_TICKS(20);
+    bool             progress = false;
     while (m_f_audioTaskIsRunning) {
-        vTaskDelay(1 / portTICK_PERIOD_MS); // periodically every x ms
-        if (m_f_I2S_init) performAudioTask();
+        uint32_t t0 = micros();
+        bool     idle = !m_decoder && !SamplesBuff.bufferFilled() && !m_xfade.f_fading;
+        bool     hurry = m_f_dualTask && progress && SamplesBuff.isBelowLowWatermark();
+        bool     notified = false;
+        if (idle) {
+            vTaskDelay(50);
+            ulTaskNotifyTake(pdTRUE, 0); // discard the notifications of the zeros
+        } else {
+            notified = ulTaskNotifyTake(pdTRUE, hurry ? 1 : timeout) > 0;
+        }
+        uint32_t t1 = micros();
+        m_taskStats.idleUs += t1 - t0;
+        m_taskStats.wakeups++;
+        if (!notified && !idle && !hurry) m_taskStats.timeouts++;
+
+        progress = false;
+        if (m_f_I2S_init) {
+            for (uint8_t i = 0; i < 16; i++) {
+                uint32_t work = m_taskStats.work;
+                performAudioTask();
+                m_taskStats.rounds++;
+                if (!m_decoder || m_taskStats.work == work) break; // no progress, wait for the DMA
+                progress = true;
+                if (m_f_dualTask && SamplesBuff.isAboveHighWatermark()) break; // far enough ahead, wait for the output task
+            }
+        }
+        m_taskStats.busyUs += micros() - t1;
     }
     vTaskDelete(nullptr); // Delete this task
 }
 
 void Audio::performAudioTask() {
     int32_t dummy[2] = {0};
+    if (m_f_nextSwapped) { // loop() prepares the queued source on the members (prerollNext()), nothing to decode
+        if (!m_f_dualTask) {
+            gain_ramp();
+            playChunk();
+        }
+        return;
+    }
     if (m_decoder) {
-        xSemaphoreTake(mutex_audioTask, 0.3 * configTICK_RATE_HZ);
-        playAudioData();
+        if (xSemaphoreTake(mutex_audioTask, 0.3 * configTICK_RATE_HZ) != pdTRUE) return;
+        if (!m_f_nextSwapped) playAudioData(); // else swapped since the check above
         xSemaphoreGive(mutex_audioTask);
-        gain_ramp();
+        if (!m_f_dualTask) gain_ramp(); // else in outputTask()
         // fade_out_levels(false);
         return;
     } else {
-        gain_ramp();
+        if (!m_f_dualTask) gain_ramp();
+        if (!SamplesBuff.bufferFilled() && m_xfade.f_fading && xSemaphoreTake(mutex_outputTask, 0) == pdTRUE) { // no next file, fade out the tail against silence
+            size_t words = std::min(SamplesBuff.writeSpace(), XfadeBuff.bufferFilled()) & ~static_cast<size_t>(1);
+            memset(SamplesBuff.getWritePtr(), 0, words * sizeof(int32_t)); // not while setDefaults() resets SamplesBuff
+            SamplesBuff.bytesWritten(words);
+            xSemaphoreGive(mutex_outputTask);
+        }
         if (SamplesBuff.bufferFilled()) {
             playChunk();
         } else {
-            calculateVUlevel(dummy, 0);  // fade out
+            m_gapless.f_carry = false;   // no next file in time, it starts from silence
+            if (m_f_dualTask) return;    // the output task fades out the levels
+            calculateVUlevel();          // fade out
             calculateSpectrum(dummy, 0); // fade out
         }
-        vTaskDelay(50);
         return;
     }
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// dual task mode: the output task drains SamplesBuff into the I2S, the audio task only decodes. A slow frame no longer
+// starves the DMA and a full DMA no longer stalls the decoder. The output task is woken by the I2S on_sent callback and
+// wakes the audio task as soon as SamplesBuff is below its high watermark.
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+
+void Audio::startOutputTask() {
+    if (m_f_outputTaskIsRunning) return;
+    uint8_t core = portNUM_PROCESSORS > 1 ? 1 - m_audioTaskCoreId : 0;
+    AUDIO_LOG_INFO("start output task on core {}.", core);
+    xSemaphoreTake(sem_outputTaskDone, 0); // a leftover of the last stop
+    m_f_outputTaskIsRunning = true;
+    if (xTaskCreatePinnedToCore(&Audio::outputTaskWrapper, "OutputTask", OUTPUT_STACK_SIZE, this, 2, &m_outputTaskHandle, core) != pdPASS) {
+        AUDIO_LOG_ERROR("output task could not be created, decoder and output stay in one task");
+        m_f_outputTaskIsRunning = false;
+        m_f_dualTask = false;
+        m_outputTaskHandle = nullptr;
+        return;
+    }
+    m_dmaNotifyTask = m_outputTaskHandle;
+}
+
+void Audio::stopOutputTask() { // the task ends itself between two rounds, it is never deleted while it holds mutex_outputTask
+    if (!m_f_outputTaskIsRunning) return;
+    AUDIO_LOG_INFO("stop output task.");
+    m_f_outputTaskIsRunning = false;
+    m_dmaNotifyTask = m_audioTaskHandle;
+    if (m_outputTaskHandle != nullptr) {
+        xTaskNotifyGive(m_outputTaskHandle); // wake it up from ulTaskNotifyTake()
+        if (xSemaphoreTake(sem_outputTaskDone, 1 * configTICK_RATE_HZ) != pdTRUE) AUDIO_LOG_ERROR("output task does not stop");
+        m_outputTaskHandle = nullptr;
+    }
+}
+
+void Audio::outputTaskWrapper(void* param) {
+    Audio* audioRunner = static_cast<Audio*>(param);
+    audioRunner->outputTask();
+}
+
+void Audio::outputTask() {
+    const TickType_t timeout = pdMS_TO_TICKS(20);
+    int32_t          dummy[2] = {0};
+    while (m_f_outputTaskIsRunning) {
+        uint32_t t0 = micros();
+        bool     idle = !m_decoder && !SamplesBuff.bufferFilled() && !m_xfade.f_fading;
+        bool     notified = false;
+        if (idle) {
+            vTaskDelay(50);
+            ulTaskNotifyTake(pdTRUE, 0); // discard the notifications of the zeros
+        } else {
+            notified = ulTaskNotifyTake(pdTRUE, timeout) > 0;
+        }
+        uint32_t t1 = micros();
+        m_outputTaskStats.idleUs += t1 - t0;
+        m_outputTaskStats.wakeups++;
+        if (!notified && !idle) m_outputTaskStats.timeouts++;
+
+        if (!m_f_outputTaskIsRunning) break;
+        if (m_f_I2S_init && xSemaphoreTake(mutex_outputTask, 0.3 * configTICK_RATE_HZ) == pdTRUE) {
+            gain_ramp();
+            if (SamplesBuff.bufferFilled()) {
+                playChunk();
+            } else {
+                calculateVUlevel();          // fade out
+                calculateSpectrum(dummy, 0); // fade out
+            }
+            m_outputTaskStats.rounds++;
+            xSemaphoreGive(mutex_outputTask);
+            if (!SamplesBuff.isAboveHighWatermark() && m_audioTaskHandle) xTaskNotifyGive(m_audioTaskHandle); // room for the decoder
+        }
+        m_outputTaskStats.busyUs += micros() - t1;
+    }
+    xSemaphoreGive(sem_outputTaskDone); // mutex_outputTask is free here
+    vTaskDelete(nullptr);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 uint32_t Audio::getHighWatermark() {
     UBaseType_t highWaterMark = uxTaskGetStackHighWaterMark(m_audioTaskHandle);
     return highWaterMark; // dwords
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+audiolib::audioTaskStats_t Audio::getAudioTaskStats(bool reset) { // work / wakeups is the useful work per wakeup
+    audiolib::audioTaskStats_t stats = m_taskStats;
+    if (reset) m_taskStats = {};
+    return stats;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+audiolib::audioTaskStats_t Audio::getOutputTaskStats(bool reset) { // all zero if the dual task mode is off
+    audiolib::audioTaskStats_t stats = m_outputTaskStats;
+    if (reset) m_outputTaskStats = {};
+    return stats;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
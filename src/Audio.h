@@ -7,8 +7,10 @@
 #pragma GCC optimize("Ofast")
 #include "audiolib_structs.hpp"
 #include "esp_arduino_version.h"
+#include "esp_cpu.h"
 #include "esp_dsp.h"
 #include "psram_unique_ptr.hpp"
+#include "resampler.h"
 #include <Arduino.h>
 #include <FFat.h>
 #include <FS.h>
@@ -86,6 +88,8 @@ class AudioBuffer {
     size_t init();
     bool   isInitialized() const { return m_initialized; }
     void   reset();
+    void   release();                // frees the memory, init() allocates it again
+    void   swap(AudioBuffer& other); // exchanges memory and state with another buffer
 
     // ------------------------------------------------------------
     // Configuration
@@ -181,9 +185,15 @@ class AudioBuffer {
 
 //----------------------------------------------------------------------------------------------------------------------
 
-class RingBuffer {
+class RingBuffer { // single producer, single consumer, lock-free, see ringbuffer.cpp
 
   public:
+    struct spans_t { // wrap-aware view, the second span is empty unless the region wraps at the end of the buffer
+        std::span<int32_t> first;
+        std::span<int32_t> second;
+        size_t             size() const { return first.size() + second.size(); }
+    };
+
     RingBuffer();
     ~RingBuffer();
 
@@ -201,18 +211,30 @@ class RingBuffer {
     int32_t*      getReadPtr();
     bool          bytesWritten(size_t bytes);
     bool          bytesRead(size_t bytes);
+    spans_t       writeView(size_t words); // producer: up to 'words' free words, commit with bytesWritten()
+    spans_t       readView(size_t words);  // consumer: up to 'words' filled words, may be modified in place, release with bytesRead()
     size_t        write(const int32_t* src, size_t words);
     size_t        read(int32_t* dst, size_t words);
     size_t        peek(int32_t* dst, size_t words);
-    inline size_t advanceIndex(size_t index, size_t words) const;
+    void          setWatermarks(size_t low, size_t high); // in words, default 1/4 and 3/4 of the buffer
+    bool          isBelowLowWatermark() const;
+    bool          isAboveHighWatermark() const;
+    inline size_t advanceIndex(size_t pos, size_t words) const;
     void          showStatus();
 
   private:
-    ps_ptr<int32_t>      m_buffer;
+    static constexpr size_t CACHE_LINE = 64; // the positions of producer and consumer never share a cache line
+
+    inline size_t index(size_t pos) const { return pos < m_bufSize ? pos : pos - m_bufSize; }
+    inline size_t distance(size_t writePos, size_t readPos) const { return writePos >= readPos ? writePos - readPos : writePos + 2 * m_bufSize - readPos; }
+    spans_t       view(size_t pos, size_t words);
+
+    alignas(CACHE_LINE) std::atomic<size_t> m_writePos{0}; // 0 ... 2 * m_bufSize - 1, only the producer writes it
+    alignas(CACHE_LINE) std::atomic<size_t> m_readPos{0};  // 0 ... 2 * m_bufSize - 1, only the consumer writes it
+    alignas(CACHE_LINE) ps_ptr<int32_t>     m_buffer;      // read-mostly from here on
     size_t               m_bufSize = 0;
-    size_t               m_readIndex = 0;
-    size_t               m_writeIndex = 0;
-    size_t               m_used = 0;
+    size_t               m_lowWater = 0;
+    size_t               m_highWater = 0;
     bool                 m_init = false;
     mutable ps_ptr<char> m_log;
 };
@@ -221,8 +243,10 @@ class RingBuffer {
 
 class Audio {
   private:
-    AudioBuffer InBuff; // instance of input buffer
+    AudioBuffer InBuff;   // instance of input buffer
+    AudioBuffer NextBuff; // input buffer of the queued source, prerollNext() fills it ahead
     RingBuffer  SamplesBuff;
+    RingBuffer  XfadeBuff; // end of a file, crossfaded into the next one
 
   public:
     Audio(uint8_t i2sPort = I2S_NUM_0);
@@ -283,22 +307,35 @@ class Audio {
     using VolumeCurveFn = std::function<float(float t)>;
     // -------------------------------------------------------------------
     typedef enum : uint32_t { SR_ORIGIN = 0, SR_44100 = 44100, SR_48000 = 48000 } OutputSR_t;
+    typedef enum : uint8_t { EQ_OFF = 0, EQ_PEAK, EQ_LOWSHELF, EQ_HIGHSHELF, EQ_LOWPASS, EQ_HIGHPASS, EQ_NOTCH, EQ_BANDPASS } EqType_t; // audiolib::eq_t
+    typedef enum : uint8_t { RS_LINEAR = 0, RS_LOW, RS_MEDIUM, RS_HIGH } ResampleQuality_t;                                                  // audiolib::resampler_t
+    typedef enum : uint8_t { MP3_SYNTH_FULL = 0, MP3_SYNTH_MONO = 1, MP3_SYNTH_HALF_RATE = 2 } MP3Synth_t;                                   // settings.MP3_SYNTH, flags
+    typedef enum : uint8_t { AAC_SBR_HQ = 0, AAC_SBR_LP = 1, AAC_SBR_AUTO = 2 } AACSbr_t;                                                    // settings.AAC_SBR
 
     bool             openai_speech(const char* api_key, const char* model, const char* input, const char* instructions, const char* voice, const char* response_format, const char* speed);
     audiolib::hwoe_t dismantle_host(const char* host);
     bool             connecttohost(const char* host, const char* user = nullptr, const char* pwd = nullptr);
     bool             connecttospeech(const char* speech, const char* lang);
     bool             connecttoFS(fs::FS& fs, const char* path, int32_t fileStartTime = -1);
+    bool             queueNext(fs::FS& fs, const char* path, int32_t fileStartTime = -1);
+    bool             queueNextHost(const char* host, const char* user = nullptr, const char* pwd = nullptr);
     void             setConnectionTimeout(uint16_t timeout_ms, uint16_t timeout_ms_ssl);
     bool             setAudioPlayTime(uint16_t sec);
     bool             setTimeOffset(int sec);
     bool             setPinout(uint8_t BCLK, uint8_t LRC, uint8_t DOUT, int8_t MCLK = I2S_GPIO_UNUSED);
     bool             pauseResume();
-    bool             isRunning() { return m_f_running; }
+    bool             isRunning() { return inNextWindow() ? m_shown.f_running : m_f_running; }
     void             loop();
     uint32_t         stopSong();
     void             forceMono(bool m);
+    bool             getForceMono() { return m_f_forceMono; }
     void             setOutputSampleRate(OutputSR_t sr);
+    void             setResampleQuality(ResampleQuality_t q); // if the output sample rate differs from the source
+    void             setDriftCompensation(bool on, uint32_t targetBytes = 0);
+    float            getDriftPpm();    // clock of the encoder compared with the I2S clock
+    uint32_t         getDriftTarget(); // bytes in the inputbuffer
+    void             setCrossfade(uint16_t ms); // 0 = off, max 5000
+    uint16_t         getCrossfade();
     void             setBalance(float balance = 0.0f);
     void             setVolumeSteps(uint8_t steps);
     uint8_t          getVolumeSteps();
@@ -324,9 +361,11 @@ class Audio {
     void             inBufferStatus() { InBuff.showStatus(); }
     void             samplesBufferStatus() { SamplesBuff.showStatus(); }
     void             setTone(float gainLowPass, float gainBandPass, float gainHighPass);
+    bool             setEqBand(uint8_t band, EqType_t type, float freq, float q = 0.707f, float gainDb = 0.0f); // band 0...9, setTone() uses 0...2
+    void             clearEq();
     void             setI2SCommFMT_LSB(bool commFMT);
-    int              getCodec() { return m_codec; }
-    const char*      getCodecname() { return codecname[m_codec]; }
+    int              getCodec() { return inNextWindow() ? m_shown.codec : m_codec; }
+    const char*      getCodecname() { return codecname[getCodec()]; }
     const char*      getVersion();
     // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 
@@ -374,6 +413,15 @@ class Audio {
     uint32_t                  decodeContinue(int8_t res, uint8_t* data, int32_t bytesDecoded, int32_t* bytesLeft);
     int                       sendBytes(uint8_t* data, size_t len);
     void                      setDecoderItems();
+    bool                      flushDecoder();
+    void                      gaplessCarry();
+    void                      prerollNext();
+    bool                      connectNext();
+    void                      swapSource();
+    void                      resetNext();
+    bool                      playNext();
+    bool                      openLocalFile(fs::FS& fs, ps_ptr<char> c_path);
+    bool                      openHost(ps_ptr<char> c_host, ps_ptr<char> c_user, ps_ptr<char> c_pwd);
     uint32_t                  calculate_average_bitrate(uint64_t sum_bytes_in, uint64_t sum_samples);
     void                      calculateAudioTime(uint16_t bytes_decoder_in, uint16_t samples_decoder_out);
     void                      showID3Tag(const char* tag, const char* val);
@@ -386,14 +434,20 @@ class Audio {
     bool                      setSampleRate(uint32_t hz);
     bool                      setBitsPerSample(int bits);
     bool                      setChannels(int channels);
-    uint32_t                  resampleI2Soutput(audiolib::resampler_t& resampler, int32_t* input, uint32_t inputSamples, int32_t* output);
+    void                      resamplerSetup();
+    bool                      resampling();
     void                      cacheSamples();
     void                      playChunk();
-    void                      calculateVUlevel(int32_t* buff, size_t len);
+    void                      resetSamples();
+    void                      processSamples(int32_t* buff, size_t words, bool* continueI2S);
+    int32_t*                  decodeTarget();
+    bool                      xfadeRoute();
+    size_t                    xfadeHoldback(const int32_t* src, size_t words);
+    void                      xfadeMix(int32_t* buff, size_t words);
+    void                      xfadeResample();
+    void                      calculateVUlevel();
     void                      calculateSpectrum(int32_t* buff, size_t len);
-    void                      Gain(int32_t* buff, size_t len);
-    void                      stereo2mono(int32_t* buff, size_t len);
-    void                      IIR_filter(int32_t* buff, size_t len);
+    uint8_t                   dspFlags();
     void                      gain_ramp();
     void                      calculateVolumeLimits();
     void                      showstreamtitle(char* ml);
@@ -408,21 +462,32 @@ class Audio {
     void                      zeroI2Sbuff();
     void                      reconfigI2S();
     void                      IIR_calculateCoefficients();
+    bool                      lockDSP();
+    void                      unlockDSP();
     uint32_t                  streamavail() { return m_client ? m_client->available() : 0; }
     bool                      ts_parsePacket(uint8_t* packet, uint8_t* packetStart, uint8_t* packetLength);
     uint64_t                  getLastGranulePosition(uint8_t codec);
 
     //+++ create a T A S K  for playAudioData(), output via I2S +++
   public:
-    void     setAudioTaskCore(uint8_t coreID);
-    uint32_t getHighWatermark();
+    void                       setAudioTaskCore(uint8_t coreID);
+    void                       setDualTask(bool enable); // true: decode in the audio task, output in a second task on the other core
+    uint32_t                   getHighWatermark();
+    audiolib::audioTaskStats_t getAudioTaskStats(bool reset = false);  // wakeups, work and idle time of the audio task
+    audiolib::audioTaskStats_t getOutputTaskStats(bool reset = false); // the same for the output task in dual task mode
 
   private:
-    void        startAudioTask(); // starts a task for decode and play
-    void        stopAudioTask();  // stops task for audio
-    static void audioTaskWrapper(void* param);
-    void        audioTask();
-    void        performAudioTask();
+    audiolib::audioTaskStats_t m_taskStats;
+    audiolib::audioTaskStats_t m_outputTaskStats;
+    void                       startAudioTask(); // starts a task for decode and play
+    void                       stopAudioTask();  // stops task for audio
+    static void                audioTaskWrapper(void* param);
+    void                       audioTask();
+    void                       performAudioTask();
+    void                       startOutputTask(); // dual task mode: SamplesBuff -> I2S
+    void                       stopOutputTask();
+    static void                outputTaskWrapper(void* param);
+    void                       outputTask();
 
     //+++ H E L P   F U N C T I O N S +++
     bool                   readMetadata(uint32_t b, uint16_t* readedBytes, bool first = false);
@@ -433,6 +498,9 @@ class Audio {
     uint32_t               m4a_correctResumeFilePos();
     int32_t                ogg_correctResumeFilePos();
     int32_t                flac_correctResumeFilePos();
+    int32_t                flac_findFrame(const uint8_t* p, size_t av, uint64_t* firstSample = nullptr);
+    int32_t                flac_seekFilePos(uint64_t targetSample);
+    int32_t                mp3_seekFilePos(uint64_t targetSample);
     int32_t                mp3_correctResumeFilePos();
     int32_t                wav_correctResumeFilePos();
     uint8_t                determineCodec(uint8_t presumed_codec);
@@ -446,7 +514,6 @@ class Audio {
     uint64_t               bigEndian(uint8_t* base, uint8_t numBytes, uint8_t shiftLeft = 8);
     bool                   b64encode(const char* source, uint16_t sourceLength, char* dest);
     ps_ptr<char>           urlencode(const char* str, bool spacesOnly);
-    audiolib::BiquadCoeffs makeButterworthLPF_Q31(float fs);
 
   private:
     enum : int { APLL_AUTO = -1, APLL_ENABLE = 1, APLL_DISABLE = 0 };
@@ -455,7 +522,7 @@ class Audio {
     const char* plsFmtStr[5] = {"NONE", "M3U", "PLS", "ASX", "M3U8"};                                // playlist format string
     enum : int { AUDIO_NONE, HTTP_RESPONSE_HEADER, HTTP_RANGE_HEADER, AUDIO_DATA, AUDIO_LOCALFILE, AUDIO_PLAYLISTINIT, AUDIO_PLAYLISTHEADER, AUDIO_PLAYLISTDATA };
     const char* dataModeStr[8] = {"AUDIO_NONE", "HTTP_RESPONSE_HEADER", "HTTP_RANGE_HEADER", "AUDIO_DATA", "AUDIO_LOCALFILE", "AUDIO_PLAYLISTINIT", "AUDIO_PLAYLISTHEADER", "AUDIO_PLAYLISTDATA"};
-    enum : int { FLAC_BEGIN = 0, FLAC_MAGIC = 1, FLAC_MBH = 2, FLAC_SINFO = 3, FLAC_PADDING = 4, FLAC_APP = 5, FLAC_SEEK = 6, FLAC_VORBIS = 7, FLAC_CUESHEET = 8, FLAC_PICTURE = 9, FLAC_OKAY = 100 };
+    enum : int { FLAC_BEGIN = 0, FLAC_MAGIC = 1, FLAC_MBH = 2, FLAC_SINFO = 3, FLAC_PADDING = 4, FLAC_APP = 5, FLAC_SEEK = 6, FLAC_VORBIS = 7, FLAC_CUESHEET = 8, FLAC_PICTURE = 9, FLAC_SEEKPOINTS = 10, FLAC_OKAY = 100 };
     enum : int { MP3_BEGIN = 0, MP3_ID3HEADER, MP3_NEXTID3, MP3_EXTHEADER, MP3_ID3FRAME, MP3_FRAMESIZE, MP3_SKIP, MP3_TAG, MP3_SYLT, MP3_ID3V22, MP3_LASTFRAMES, MP3_XING, MP3_OKAY = 100 };
     enum : int {
         M4A_BEGIN = 0,
@@ -486,7 +553,6 @@ class Audio {
     enum : int { ST_NONE = 0, ST_WEBFILE = 1, ST_WEBSTREAM = 2 };
     const char* streamTypeStr[3] = {"NONE", "WEBFILE", "WEBSTREAM"};
     typedef enum { LEFTCHANNEL = 0, RIGHTCHANNEL = 1 } SampleIndex;
-    typedef enum { LOWSHELF = 0, PEAKINGEQ = 1, HIFGSHELF = 2 } FilterType;
 
   private:
     typedef struct _filter {
@@ -511,6 +577,12 @@ class Audio {
         uint16_t FREQ_HS_HZ = 6000;                // IIR Filter: highshelf
         float    QUALITY_SLOPE = 0.707;            // IIR Filter: quality (all shelfes)
         bool     IIR_FILTER = true;                // IIR Filter: true -> IIR filter (highshelf, bandpass, lowshelf) are enabled
+        bool     IIR_Q31 = false;                  // IIR Filter: true -> fixed point (Q31) instead of float, for chips without FPU e.g. ESP32-C3, -C6
+        bool     MP3_Q31 = true;                   // MP3 decoder: true -> 32 bit output of the synthesis (24 bit significant), false -> 16 bit
+        uint8_t  MP3_SYNTH = MP3_SYNTH_FULL;       // MP3 decoder: | MP3_SYNTH_MONO -> one channel (L+R)/2, | MP3_SYNTH_HALF_RATE -> 16 subbands at samplerate/2
+        bool     MP3_PIPELINE = false;             // MP3 decoder: true -> IMDCT and synthesis in a task on the other core (dual core chips), one frame more latency
+        uint8_t  AAC_SBR = AAC_SBR_HQ;             // AAC decoder: HE-AAC SBR, AAC_SBR_HQ complex, AAC_SBR_LP real valued, AAC_SBR_AUTO -> LP if over budget (LP is not cheaper on x86, not measured on target)
+        uint8_t  AAC_SBR_BUDGET = 60;              // AAC decoder: AAC_SBR_AUTO, decode time per frame in % of the frame duration (average) that switches to LP
         uint8_t  VU_BARS_ATTACK_STEP = 200;        // vu-meter:   bars rising steps
         uint8_t  VU_BARS_RELEASE_STEP = 30;        // vu-meter:   bars falling steps
         uint8_t  VU_BARS_HOLD_CYCLES = 1;          // vu-meter:   bars hold_cycles
@@ -531,16 +603,21 @@ class Audio {
     } settings;
 
     std::atomic<uint32_t> m_dmaFreeDesc = 0;
+    TaskHandle_t          m_dmaNotifyTask = nullptr; // audio or output task, notified by the I2S on_sent callback
 
   private:
     File                m_audiofile;
-    NetworkClient       client;
-    NetworkClientSecure clientsecure;
+    NetworkClient       client[2];       // [m_clientSet] belongs to the current source, the other one to the queued host
+    NetworkClientSecure clientsecure[2]; //
     NetworkClient*      m_client = nullptr;
+    uint8_t             m_clientSet = 0;
 
     SemaphoreHandle_t mutex_audioTask;
     SemaphoreHandle_t mutex_audioTaskIsDecoding;
+    SemaphoreHandle_t mutex_outputTask; // held while the output task plays, for resets of SamplesBuff and XfadeBuff
+    SemaphoreHandle_t sem_outputTaskDone; // given by the output task when it ends, stopOutputTask() waits for it
     TaskHandle_t      m_audioTaskHandle = nullptr;
+    TaskHandle_t      m_outputTaskHandle = nullptr;
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
@@ -564,7 +641,6 @@ class Audio {
     std::unique_ptr<Decoder> m_decoder = {};
     ps_ptr<int32_t>          m_outBuff;         // Interleaved L/R
     ps_ptr<int32_t>          m_resamplesBuff;   // Interleaved L/R
-    ps_ptr<int32_t>          m_i2sWorkBuff;     // between SamülesBuff and i2s_channel_write()
     ps_ptr<char>             m_metadataBuff;    // icy-metadata max (16 * 256 + 1) bytes
     ps_ptr<char>             m_httpRespHdrBuff; // store http response header
     ps_ptr<char>             m_ibuff;           // used in log_info()
@@ -621,6 +697,8 @@ class Audio {
     uint32_t m_samples_since_start = 0;   //
 
     int32_t    m_resumeFilePos = -1;              // the return value from stopSong(), (-1) is idle
+    int64_t    m_seekSample = -1;                 // seek target in samples (FLAC, MP3), (-1) is idle
+    uint32_t   m_skipSamples = 0;                 // decoded samples to drop after a seek (decode forward to the target)
     int32_t    m_fileStartTime = -1;              // may be set in connecttoFS()
     uint16_t   m_m3u8_targetDuration = 10;        //
     uint32_t   m_stsz_numEntries = 0;             // num of entries inside stsz atom (uint32_t)
@@ -654,6 +732,8 @@ class Audio {
     bool       m_f_psramFound = false;            // set in constructor, result of psramInit()
     bool       m_f_timeout = false;               //
     bool       m_f_audioTaskIsRunning = false;    //
+    bool       m_f_outputTaskIsRunning = false;   //
+    bool       m_f_dualTask = false;              // decoder and output in separate tasks
     bool       m_f_allDataReceived = false;       //
     bool       m_f_stream = false;                // stream ready for output?
     bool       m_f_decode_ready = false;          // if true data for decode are ready
@@ -701,6 +781,11 @@ class Audio {
     audiolib::pwsts_t      m_pwsst;
     audiolib::rwh_t        m_rwh;
     audiolib::rflh_t       m_rflh;
+    audiolib::mp3fi_t      m_mp3fi;
+    audiolib::gapless_t    m_gapless;
+    audiolib::next_t       m_next;
+    audiolib::xfade_t      m_xfade;
+    audiolib::dsp_t        m_dsp;
     audiolib::phreh_t      m_phreh;
     audiolib::phrah_t      m_phrah;
     audiolib::sdet_t       m_sdet;
@@ -710,19 +795,93 @@ class Audio {
     audiolib::fft_items_t  m_fft_items;
     audiolib::i2s_items_t  m_i2s_items;
     audiolib::resampler_t  m_resampler;
+    ResampleQuality_t      m_resample_quality = RS_MEDIUM; // setResampleQuality()
+    audiolib::drift_t      m_drift;
 
     struct info_queue_t {
         std::deque<audiolib::InfoItem> queue;
         void                           reset() { queue.clear(); }
-    } m_info_queue;
-
-    inline uint8_t sampleToVU(int32_t sample) {
-        uint32_t mag;
-        if (sample < 0)
-            mag = (uint32_t)(-(int64_t)sample);
-        else
-            mag = (uint32_t)sample;
-        return std::min<uint32_t>(mag >> 23, 255);
+    } m_info_queue, m_next_info; // m_next_info: events of the queued source, playNext() passes them on
+
+    struct source_t { // the members a source is opened, parsed and prefilled on, swapSource() exchanges them with the queued source
+        File                      audiofile;
+        NetworkClient*            client = nullptr;
+        uint8_t                   clientSet = 1;
+        std::unique_ptr<Decoder>  decoder;
+        ps_ptr<char>              lastHost;
+        ps_ptr<char>              currentHost;
+        ps_ptr<char>              content_type;
+        std::vector<ps_ptr<char>> syltLines;
+        std::vector<uint32_t>     syltTimeStamp;
+        uint32_t                  audioFilePosition = 0;
+        uint32_t                  audioFileSize = 0;
+        uint32_t                  audioDataStart = 0;
+        size_t                    audioDataSize = 0;
+        uint32_t                  audioCurrentTime = 0;
+        int                       controlCounter = 0;
+        uint8_t                   playlistFormat = FORMAT_NONE;
+        uint8_t                   codec = CODEC_NONE;
+        uint8_t                   expectedCodec = CODEC_NONE;
+        uint8_t                   expectedPlsFmt = FORMAT_NONE;
+        uint8_t                   streamType = ST_NONE;
+        uint8_t                   ID3Size = 0;
+        uint8_t                   M4A_objectType = 0;
+        uint8_t                   M4A_chConfig = 0;
+        uint16_t                  M4A_sampleRate = 0;
+        uint16_t                  dataMode = AUDIO_NONE;
+        uint32_t                  metaint = 0;
+        uint32_t                  chunkcount = 0;
+        uint64_t                  lastGranulePosition = 0;
+        uint32_t                  nominal_bitrate = 0;
+        uint32_t                  total_samples_in_file = 0;
+        uint32_t                  audio_file_duration = 0;
+        uint32_t                  stsz_numEntries = 0;
+        uint32_t                  stsz_position = 0;
+        int32_t                   resumeFilePos = -1;
+        int32_t                   fileStartTime = -1; // next_t::fileStartTime, set by playNext()
+        bool                      f_haveNewFilePos = false;
+        bool                      f_unsync = false;
+        bool                      f_exthdr = false;
+        bool                      f_ssl = false;
+        bool                      f_running = false;
+        bool                      f_firstCall = true;
+        bool                      f_ID3v1TagFound = false;
+        bool                      f_chunked = false;
+        bool                      f_tts = false;
+        bool                      f_ogg = false;
+        bool                      f_m3u8data = false;
+        bool                      f_ts = false;
+        bool                      f_m4aID3dataAreRead = false;
+        bool                      f_timeout = false;
+        bool                      f_allDataReceived = false;
+        bool                      f_stream = false;
+        bool                      f_eof = false;
+        bool                      f_acceptRanges = false;
+        bool                      f_connectionClose = false;
+        audiolib::ID3Hdr_t        ID3Hdr;
+        audiolib::m4aHdr_t        m4aHdr{};
+        audiolib::prlf_t          prlf{};
+        audiolib::pwf_t           pwf{};
+        audiolib::rwh_t           rwh{};
+        audiolib::rflh_t          rflh{};
+        audiolib::phreh_t         phreh{};
+        audiolib::gchs_t          gchs{};
+    } m_nextSrc;
+
+    struct shown_t { // the playing source as the getters show it to other tasks while prerollNext() has swapped the members
+        uint32_t fileSize = 0;
+        uint32_t bitRate = 0;
+        uint32_t duration = 0;
+        uint32_t currentTime = 0;
+        uint32_t filePosition = 0;
+        uint8_t  codec = CODEC_NONE;
+        bool     f_running = false;
+    } m_shown;
+    std::atomic<bool> m_f_nextSwapped = false; // prerollNext() has the queued source on the members, the audio task does not decode
+    TaskHandle_t      m_nextSwapTask = nullptr; // the task of prerollNext(), its info events and getter calls belong to the queued source
+
+    inline bool inNextWindow() { // the caller is another task than prerollNext() and gets m_shown instead of the members
+        return m_f_nextSwapped.load(std::memory_order_acquire) && xTaskGetCurrentTaskHandle() != m_nextSwapTask;
     }
 
     inline bool isFile() {
@@ -767,7 +926,9 @@ class Audio {
 
         std::lock_guard<std::mutex> lock(instance.mutex_info);
         if (!audio_info_callback) return false;
-        if (instance.m_info_queue.queue.size() >= 1000) {
+        TaskHandle_t                    task = xTaskGetCurrentTaskHandle(); // the audio and the output task play the current source
+        std::deque<audiolib::InfoItem>& queue = instance.m_f_nextSwapped && task == instance.m_nextSwapTask ? instance.m_next_info.queue : instance.m_info_queue.queue;
+        if (queue.size() >= 1000) {
             log_e("infoqueue is full");
             return false;
         }
@@ -780,7 +941,7 @@ class Audio {
         item.vec1 = std::move(vec1);
         item.vec2 = std::move(vec2);
 
-        instance.m_info_queue.queue.push_back(std::move(item));
+        queue.push_back(std::move(item));
         return true;
     }
 
@@ -894,8 +1055,8 @@ class Decoder {
     virtual uint32_t              getOutputSamples() = 0;
     virtual int32_t               decode(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf1) = 0;
     virtual void                  setRawBlockParams(uint8_t param1, uint32_t param2, uint8_t param3, uint32_t param4, uint32_t param5) = 0;
-    virtual const char*           getStreamTitle();
-    virtual const char*           whoIsIt();
+    virtual const char*           getStreamTitle() = 0;
+    virtual const char*           whoIsIt() = 0;
     virtual std::vector<uint32_t> getMetadataBlockPicture() = 0;
     virtual const char*           arg1() = 0; // decoder specific
     virtual const char*           arg2() = 0; // decoder specific
@@ -973,35 +1134,55 @@ struct _HeapGuardSnapshot {
         PROFILE_SCOPE_N(100);  // measures this block over 100 runs
         do_fft_processing(data);
     }
+
+    Every PROFILE_SCOPE_N() owns its statistics, several scopes can be measured at the same time.
+    The time is taken from esp_timer (µs), the CPU load from the cycle counter of the core that runs the scope.
 */
 class _AutoProfiler {
   public:
-    _AutoProfiler(const char* name, uint32_t report_interval) : tag(name), N(report_interval) { start = esp_timer_get_time(); }
+    struct stats_t {
+        uint64_t sum_us = 0;
+        uint64_t sum_cycles = 0;
+        uint32_t max_us = 0;
+        uint32_t max_cycles = 0;
+        uint32_t count = 0;
+    };
+
+    _AutoProfiler(const char* name, uint32_t report_interval, stats_t& stats) : tag(name), N(report_interval), st(stats) {
+        start = esp_timer_get_time();
+        start_cc = esp_cpu_get_cycle_count();
+    }
 
     ~_AutoProfiler() {
-        uint64_t elapsed = esp_timer_get_time() - start;
-        sum += elapsed;
-        count++;
-        if (max_dt < elapsed) max_dt = elapsed;
-
-        if (count >= N) {
-            double avg_us = (double)sum / count;
-            printf(ANSI_ESC_CYAN "PROFILER [%s] avg: %.2f µs over %lu runs, max %lu µs" ANSI_ESC_RESET "\n", tag, avg_us, count, max_dt);
-            sum = 0;
-            count = 0;
-            max_dt = 0;
+        uint32_t cycles = (uint32_t)(esp_cpu_get_cycle_count() - start_cc); // 32 bit counter, wraps after ~17 s @ 240 MHz
+        uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+        st.sum_us += elapsed;
+        st.sum_cycles += cycles;
+        st.count++;
+        if (st.max_us < elapsed) st.max_us = elapsed;
+        if (st.max_cycles < cycles) st.max_cycles = cycles;
+
+        if (st.count >= N) {
+            double avg_us = (double)st.sum_us / st.count;
+            double avg_cc = (double)st.sum_cycles / st.count;
+            printf(ANSI_ESC_CYAN "PROFILER [%s] avg: %.2f µs, %.0f cycles over %lu runs, max %lu µs, %lu cycles" ANSI_ESC_RESET "\n", tag, avg_us, avg_cc, (unsigned long)st.count,
+                   (unsigned long)st.max_us, (unsigned long)st.max_cycles);
+            st = stats_t{};
         }
     }
 
   private:
-    const char*            tag;
-    uint32_t               N;
-    uint64_t               start;
-    static inline uint32_t max_dt = 0;
-    static inline uint64_t sum = 0;
-    static inline uint32_t count = 0;
+    const char* tag;
+    uint32_t    N;
+    stats_t&    st;
+    uint64_t    start;
+    uint32_t    start_cc;
 };
 
-// Macro for automatic use with function name
-#define PROFILE_SCOPE_N(N) _AutoProfiler _prof_instance_##__LINE__(__func__, N)
+// Macro for automatic use with function name, PROF_CAT expands __LINE__ before it is pasted (one name per scope)
+#define PROF_CAT_(a, b) a##b
+#define PROF_CAT(a, b)  PROF_CAT_(a, b)
+#define PROFILE_SCOPE_N(N)                                          \
+    static _AutoProfiler::stats_t PROF_CAT(_prof_stats_, __LINE__); \
+    _AutoProfiler                 PROF_CAT(_prof_instance_, __LINE__)(__func__, N, PROF_CAT(_prof_stats_, __LINE__))
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -2,7 +2,7 @@
  *  aac_decoder.cpp
  *  faad2 - ESP32 adaptation
  *  Created on: 12.09.2023
- *  Updated on: 22.07.2026
+ *  Updated on: 18.10.2026
  */
 
 #include "aac_decoder.h"
@@ -26,6 +26,9 @@ bool AACDecoder::init() {
     if (m_hAac && m_conf) m_f_decoderIsInit = true;
     m_f_firstCall = false;
     m_f_setRaWBlockParams = false;
+    m_decodeUs = 0;
+    m_decodeFrames = 0;
+    setSBRMode(audio.settings.AAC_SBR);
     return m_f_decoderIsInit;
 }
 void AACDecoder::clear() {
@@ -149,7 +152,9 @@ int32_t AACDecoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf)
         m_f_firstCall = true;
     }
 
+    uint32_t t0 = micros();
     m_neaacdec->NeAACDecDecode2(m_hAac, &m_frameInfo, inbuf, *bytesLeft, &sample_buffer, 4608 * 2 * sizeof(int32_t));
+    if (m_sbrMode == Audio::AAC_SBR_AUTO) sbrPolicy(micros() - t0);
     *bytesLeft -= m_frameInfo.bytesconsumed;
     m_validSamples = m_frameInfo.samples;
     int8_t err = 0 - m_frameInfo.error;
@@ -177,6 +182,8 @@ int32_t AACDecoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf)
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void AACDecoder::setRawBlockParams(uint8_t channels, uint32_t sampleRate, uint8_t dummy1, uint32_t profile, uint32_t dummy2) {
+    (void)dummy1;
+    (void)dummy2;
     m_f_setRaWBlockParams = true;
     m_aacChannels = channels;     // 1: Mono, 2: Stereo
     m_aacSamplerate = sampleRate; // 8000, 11025, 12000, 16000, 22050, 24000, 32000, 44100, 48000
@@ -220,6 +227,33 @@ int32_t AACDecoder::val2() { // Spectral Band Replication
                              // NO_SBR_UPSAMPLED 3 /* no SBR used, but file is upsampled by a factor 2 anyway */
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void AACDecoder::setSBRMode(uint8_t mode) { // AAC_SBR_AUTO keeps the current mode, the default is SBR_LOW_POWER in aac_settings.h
+    m_sbrMode = mode;
+    if (!m_f_decoderIsInit) return;
+    if (mode == Audio::AAC_SBR_HQ) m_conf->sbrLowPower = 0;
+    if (mode == Audio::AAC_SBR_LP) m_conf->sbrLowPower = 1;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool AACDecoder::isSBRLowPower() {
+    if (!m_f_decoderIsInit || m_frameInfo.isPS) return false;
+    return m_conf->sbrLowPower && m_frameInfo.sbr != NO_SBR; // NO_SBR_UPSAMPLED: QMF analysis and synthesis only
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void AACDecoder::sbrPolicy(uint32_t us) { // AAC_SBR_AUTO: low power SBR for the rest of the stream if the decoder needs more than the budget
+    if (m_conf->sbrLowPower || m_frameInfo.error || !m_frameInfo.samples || !m_frameInfo.channels || !m_frameInfo.samplerate) return;
+    if (m_frameInfo.sbr == NO_SBR) return;
+    if (m_frameInfo.isPS) return; // PS needs the complex SBR
+    m_decodeUs = m_decodeFrames ? m_decodeUs + ((float)us - m_decodeUs) / 16 : (float)us;
+    if (m_decodeFrames < 16) { // the first frames allocate, and the average settles
+        m_decodeFrames++;
+        return;
+    }
+    float frameUs = (float)m_frameInfo.samples / m_frameInfo.channels * 1000000 / m_frameInfo.samplerate;
+    if (m_decodeUs * 100 <= frameUs * audio.settings.AAC_SBR_BUDGET) return;
+    m_conf->sbrLowPower = 1;
+    AAC_LOG_INFO("decode time {} µs per frame is more than {} % of {} µs, SBR switches to low power", (uint32_t)m_decodeUs, audio.settings.AAC_SBR_BUDGET, (uint32_t)frameUs);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void AACDecoder::createAudioSpecificConfig(uint8_t* config, uint8_t audioObjectType, uint8_t samplingFrequencyIndex, uint8_t channelConfiguration) {
     config[0] = (audioObjectType << 3) | (samplingFrequencyIndex >> 1);
     config[1] = (samplingFrequencyIndex << 7) | (channelConfiguration << 3);
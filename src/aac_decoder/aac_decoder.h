@@ -48,12 +48,15 @@ class AACDecoder : public Decoder {
     const char*           arg2() override;
     virtual int32_t       val1() override; // Paramertric Stereo
     virtual int32_t       val2() override; // SBR
+    void                  setSBRMode(uint8_t mode); // Audio::AAC_SBR_HQ, AAC_SBR_LP, AAC_SBR_AUTO, takes effect with the next frame
+    bool                  isSBRLowPower();          // the SBR of the last frame was real valued (never with PS)
 
   private:
     Audio&       audio;
     ps_ptr<char> m_arg1;
     void         createAudioSpecificConfig(uint8_t* config, uint8_t audioObjectType, uint8_t samplingFrequencyIndex, uint8_t channelConfiguration);
     error_info_t getErrorMessage(int8_t err);
+    void         sbrPolicy(uint32_t us);
 
     NeAACDecHandle                m_hAac;
     NeAACDecFrameInfo             m_frameInfo;
@@ -68,6 +71,9 @@ class AACDecoder : public Decoder {
     uint8_t                       m_aacProfile = 0;
     uint16_t                      m_validSamples = 0;
     float                         m_compressionRatio = 1;
+    uint8_t                       m_sbrMode = 0;      // settings.AAC_SBR at init(), setSBRMode()
+    float                         m_decodeUs = 0;     // AAC_SBR_AUTO: decode time per SBR frame, moving average, µs
+    uint16_t                      m_decodeFrames = 0; // AAC_SBR_AUTO: frames in m_decodeUs
     std::unique_ptr<NeaacDecoder> m_neaacdec;
 
     struct AudioSpecificConfig {
@@ -330,15 +330,9 @@ __unused static void ComplexMult(real_t* y1, real_t* y2, real_t x1, real_t x2, r
     #endif /* USE_DOUBLE_PRECISION */
 #endif     // FIXED_POINT
 
-#ifdef SBR_LOW_POWER
-    #define qmf_t     real_t
-    #define QMF_RE(A) (A)
-    #define QMF_IM(A)
-#else
-    #define qmf_t     complex_t
-    #define QMF_RE(A) RE(A)
-    #define QMF_IM(A) IM(A)
-#endif
+#define qmf_t     complex_t // also with low power SBR (sbr_info::lowPower), which uses the real part only
+#define QMF_RE(A) RE(A)
+#define QMF_IM(A) IM(A)
 typedef real_t complex_t[2];
 #define RE(A) A[0]
 #define IM(A) A[1]
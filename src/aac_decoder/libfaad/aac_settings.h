@@ -11,11 +11,11 @@
 #define LTP_DEC // Allow decoding of LTP (Long Term Prediction) profile AAC
 #define LD_DEC  // Allow decoding of LD (Low Delay) profile AAC
 // #define DRM_SUPPORT // Allow decoding of Digital Radio Mondiale (DRM)
-#if (defined CONFIG_IDF_TARGET_ESP32S3 || defined CONFIG_IDF_TARGET_ESP32P4)
+#if (defined CONFIG_IDF_TARGET_ESP32S3 || defined CONFIG_IDF_TARGET_ESP32P4 || !defined ESP_PLATFORM) // and the host build
     #define SBR_DEC // Allow decoding of SBR (Spectral Band Replication) profile AAC
     #define PS_DEC // Allow decoding of PS (Parametric Stereo) profile AAC
 #endif
-// #define SBR_LOW_POWER
+// #define SBR_LOW_POWER // default of NeAACDecConfiguration::sbrLowPower, real valued SBR (about half the CPU load, some aliasing)
 #define ALLOW_SMALL_FRAMELENGTH
 // #define LC_ONLY_DECODER // if you want a pure AAC LC decoder (independant of SBR_DEC and PS_DEC)
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -43,9 +43,6 @@
     #undef ALLOW_SMALL_FRAMELENGTH
     #undef ERROR_RESILIENCE
 #endif
-#ifdef SBR_LOW_POWER
-    #undef PS_DEC
-#endif
 #ifdef FIXED_POINT /*  No MAIN decoding */
     #ifdef MAIN_DEC
         #undef MAIN_DEC
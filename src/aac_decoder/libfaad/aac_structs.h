@@ -294,6 +294,7 @@ typedef struct NeAACDecConfiguration {
     unsigned char downMatrix;
     unsigned char useOldADTSFormat;
     unsigned char dontUpSampleImplicitSBR;
+    unsigned char sbrLowPower; /* 1: real valued SBR (not with PS), takes effect with the next frame */
 } NeAACDecConfiguration, *NeAACDecConfigurationPtr;
 typedef struct {
     uint8_t   drm_ps_data_available;
@@ -490,6 +491,7 @@ typedef struct {
     ps_info*     ps;
     uint8_t      ps_used;
     uint8_t      psResetFlag;
+    uint8_t      lowPower; /* real valued QMF, HF generation and adjustment, set by sbr_power_mode() */
     /* to get it compiling */
     /* we'll see during the coding of all the tools, whether
        these are all used or not.
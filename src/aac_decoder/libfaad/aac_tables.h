@@ -1753,7 +1753,6 @@ const uint8_t  S[] = {1, 2, 4, 8, 16};
 const uint32_t B[] = {0x55555555, 0x33333333, 0x0F0F0F0F, 0x00FF00FF, 0x0000FFFF};
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifndef SBR_LOW_POWER
 // w_array_real[i] = cos(2*M_PI*i/32)
 static const real_t w_array_real[] = {FRAC_CONST(1.000000000000000),  FRAC_CONST(0.980785279337272),  FRAC_CONST(0.923879528329380),  FRAC_CONST(0.831469603195765),
                                       FRAC_CONST(0.707106765732237),  FRAC_CONST(0.555570210304169),  FRAC_CONST(0.382683402077046),  FRAC_CONST(0.195090284503576),
@@ -1767,8 +1766,7 @@ static const real_t w_array_imag[] = {FRAC_CONST(0.000000000000000),  FRAC_CONST
     // FFT decimation in frequency
     // 4*16*2+16=128+16=144 multiplications
     // 6*16*2+10*8+4*16*2=192+80+128=400 additions
-    #endif // SBR_LOW_POWER
-#endif     // SBR_DEC
+#endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef FIXED_POINT
 /* 256 (N/4) complex twiddle factors */
@@ -21791,7 +21789,6 @@ static rvlc_huff_table book_escape[] = {
 #endif // ERROR_RESILIENCE
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifndef SBR_LOW_POWER
 static const real_t dct4_64_tab[] = {COEF_CONST(0.999924719333649),  COEF_CONST(0.998118102550507),  COEF_CONST(0.993906974792480),  COEF_CONST(0.987301409244537),  COEF_CONST(0.978317379951477),
                                      COEF_CONST(0.966976463794708),  COEF_CONST(0.953306019306183),  COEF_CONST(0.937339007854462),  COEF_CONST(0.919113874435425),  COEF_CONST(0.898674488067627),
                                      COEF_CONST(0.876070082187653),  COEF_CONST(0.851355195045471),  COEF_CONST(0.824589252471924),  COEF_CONST(0.795836925506592),  COEF_CONST(0.765167236328125),
@@ -21831,8 +21828,7 @@ static const real_t dct4_64_tab[] = {COEF_CONST(0.999924719333649),  COEF_CONST(
                                      COEF_CONST(0.275899469852448),  COEF_CONST(0.343625962734222),  COEF_CONST(0.410524636507034),  COEF_CONST(0.476434201002121),  COEF_CONST(0.541196107864380),
                                      COEF_CONST(0.604654192924500),  COEF_CONST(0.666655719280243),  COEF_CONST(0.727051138877869),  COEF_CONST(0.785695075988770),  COEF_CONST(0.842446029186249),
                                      COEF_CONST(0.897167563438416),  COEF_CONST(0.949727773666382)};
-    #endif // SBR_LOW_POWER
-#endif     // SBR_DEC
+#endif // SBR_DEC
 #ifdef SSR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 static const real_t sine_short_32[] = {0.0245412290, 0.0735645667, 0.1224106774, 0.1709618866, 0.2191012502, 0.2667127550, 0.3136817515, 0.3598950505, 0.4052413106, 0.4496113360, 0.4928981960,
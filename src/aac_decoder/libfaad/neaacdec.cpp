@@ -392,6 +392,9 @@ NeAACDecHandle NeaacDecoder::NeAACDecOpen() {
     hDecoder->config.defObjectType = MAIN;
     hDecoder->config.defSampleRate = 44100; /* Default: 44.1kHz */
     hDecoder->config.downMatrix = 0;
+#ifdef SBR_LOW_POWER
+    hDecoder->config.sbrLowPower = 1;
+#endif
     hDecoder->adts_header_present = 0;
     hDecoder->adif_header_present = 0;
     hDecoder->latm_header_present = 0;
@@ -457,6 +460,7 @@ uint8_t NeaacDecoder::NeAACDecSetConfiguration(NeAACDecHandle hpDecoder, NeAACDe
         hDecoder->config.outputFormat = config->outputFormat;
         if (config->downMatrix > 1) return 0;
         hDecoder->config.downMatrix = config->downMatrix;
+        hDecoder->config.sbrLowPower = config->sbrLowPower ? 1 : 0;
         /* OK */
         return 1;
     }
@@ -4477,7 +4481,7 @@ exit:
 #ifdef SBR_DEC
 void NeaacDecoder::DCT4_32(real_t* y, real_t* x) {
     // printf(ANSI_ESC_YELLOW "dct4_32" ANSI_ESC_WHITE "\n");
-    int32_t* f = (int32_t*)faad_malloc(397 * sizeof(int32_t));
+    real_t* f = m_dct32_tmp.get(); // real_t, the intermediate values are not integers in the floating point build
     f[0] = x[15] - x[16];
     f[1] = x[15] + x[16];
     f[2] = MUL_F(FRAC_CONST(0.7071067811865476), f[1]);
@@ -4878,14 +4882,13 @@ void NeaacDecoder::DCT4_32(real_t* y, real_t* x) {
     f[397] = MUL_C(COEF_CONST(1.0708550202783576), f[300]);
     y[30] = f[395] + f[396];
     y[1] = f[397] - f[396];
-    if (f) { faad_free(&f); }
 }
 #endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
 void NeaacDecoder::DST4_32(real_t* y, real_t* x) {
     // printf(ANSI_ESC_YELLOW "DST4_32" ANSI_ESC_WHITE "\n");
-    int32_t* f = (int32_t*)faad_malloc(336 * sizeof(int32_t));
+    real_t* f = m_dct32_tmp.get();
     f[0] = x[0] - x[1];
     f[1] = x[2] - x[1];
     f[2] = x[2] - x[3];
@@ -5254,12 +5257,10 @@ void NeaacDecoder::DST4_32(real_t* y, real_t* x) {
     y[2] = MUL_C(COEF_CONST(4.0846110781292477), f[308]);
     y[1] = MUL_C(COEF_CONST(6.7967507116736332), f[306]);
     y[0] = MUL_R(REAL_CONST(20.3738781672314530), f[304]);
-    if (f) { faad_free(&f); }
 }
 #endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
 void NeaacDecoder::DCT2_16_unscaled(real_t* y, real_t* x) {
     real_t f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10;
     real_t f11, f12, f13, f14, f15, f16, f17, f18, f19, f20;
@@ -5385,11 +5386,9 @@ void NeaacDecoder::DCT2_16_unscaled(real_t* y, real_t* x) {
     y[7] = f109 - f108;
     y[9] = f110 - f109;
 }
-    #endif
 #endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
 void NeaacDecoder::DCT4_16(real_t* y, real_t* x) {
     real_t f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10;
     real_t f11, f12, f13, f14, f15, f16, f17, f18, f19, f20;
@@ -5567,11 +5566,9 @@ void NeaacDecoder::DCT4_16(real_t* y, real_t* x) {
     y[10] = MUL_F(FRAC_CONST(0.7071067811865474), f156);
     y[5] = MUL_F(FRAC_CONST(0.7071067811865474), f157);
 }
-    #endif
 #endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
 void NeaacDecoder::DCT3_32_unscaled(real_t* y, real_t* x) {
     real_t f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10;
     real_t f11, f12, f13, f14, f15, f16, f17, f18, f19, f20;
@@ -5907,11 +5904,9 @@ void NeaacDecoder::DCT3_32_unscaled(real_t* y, real_t* x) {
     y[16] = f97 - f244;
     y[15] = f97 + f244;
 }
-    #endif
 #endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
 void NeaacDecoder::DCT2_32_unscaled(real_t* y, real_t* x) {
     real_t f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10;
     real_t f11, f12, f13, f14, f15, f16, f17, f18, f19, f20;
@@ -6229,11 +6224,9 @@ void NeaacDecoder::DCT2_32_unscaled(real_t* y, real_t* x) {
     y[15] = f285 - f284;
     y[17] = f286 - f285;
 }
-    #endif // SBR_LOW_POWER
-#endif     // SBR_DEC
+#endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifndef SBR_LOW_POWER
 void NeaacDecoder::fft_dif(real_t* Real, real_t* Imag) {
     const uint8_t _n = 32;
     real_t        w_real, w_imag;                                     // For faster access
@@ -6404,12 +6397,11 @@ void NeaacDecoder::fft_dif(real_t* Real, real_t* Imag) {
         Real[i2] = point1_real - point2_real;
         Imag[i2] = point1_imag - point2_imag;
     }
-        #ifdef REORDER_IN_FFT
+    #ifdef REORDER_IN_FFT
     FFTReorder(Real, Imag);
-        #endif // #ifdef REORDER_IN_FFT
+    #endif // #ifdef REORDER_IN_FFT
 }
-    #endif // SBR_LOW_POWER
-#endif     // SBR_DEC
+#endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef MAIN_DEC
 void NeaacDecoder::flt_round(float* pf) {
@@ -7197,6 +7189,8 @@ uint8_t NeaacDecoder::reconstruct_single_channel(NeAACDecStruct* hDecoder, ic_st
             hDecoder->sbr[ele]->maxAACLine = 8 * min(sce->ics1.swb_offset[max(sce->ics1.max_sfb - 1, 0)], sce->ics1.swb_offset_max);
         else
             hDecoder->sbr[ele]->maxAACLine = min(sce->ics1.swb_offset[max(sce->ics1.max_sfb - 1, 0)], sce->ics1.swb_offset_max);
+        /* PS needs the complex subband samples */
+        sbr_power_mode(hDecoder->sbr[ele], hDecoder->config.sbrLowPower && !hDecoder->ps_used[ele]);
         /* check if any of the PS tools is used */
     #if (defined(PS_DEC) || defined(DRM_PS))
         if (hDecoder->ps_used[ele] == 0) {
@@ -7379,6 +7373,7 @@ uint8_t NeaacDecoder::reconstruct_channel_pair(NeAACDecStruct* hDecoder, ic_stre
             hDecoder->sbr[ele]->maxAACLine = 8 * min(cpe->ics1.swb_offset[max(cpe->ics1.max_sfb - 1, 0)], cpe->ics1.swb_offset_max);
         else
             hDecoder->sbr[ele]->maxAACLine = min(cpe->ics1.swb_offset[max(cpe->ics1.max_sfb - 1, 0)], cpe->ics1.swb_offset_max);
+        sbr_power_mode(hDecoder->sbr[ele], hDecoder->config.sbrLowPower);
         retval = sbrDecodeCoupleFrame(hDecoder->sbr[ele], hDecoder->time_out[ch0], hDecoder->time_out[ch1], hDecoder->postSeekResetFlag, hDecoder->downSampledSBR);
         if (retval > 0) { goto exit; }
     } else if (((hDecoder->sbr_present_flag == 1) || (hDecoder->forceUpSampling == 1)) && !hDecoder->sbr_alloced[hDecoder->fr_ch_ele]) {
@@ -11621,6 +11616,7 @@ sbr_info* NeaacDecoder::sbrDecodeInit(uint16_t framelength, uint8_t id_aac, uint
     }
     sbr->GQ_ringbuf_index[0] = 0;
     sbr->GQ_ringbuf_index[1] = 0;
+    if (!m_dct32_tmp.valid()) m_dct32_tmp.alloc_array(398, "m_dct32_tmp"); // once, DCT4_32() runs for every QMF slot
     if (id_aac == ID_CPE) {
         /* stereo */
         uint8_t j;
@@ -11775,6 +11771,24 @@ void NeaacDecoder::sbr_save_matrix(sbr_info* sbr, uint8_t ch) {
 #endif // #ifdef SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
+/* selects the complex (high quality) or the real valued (low power) SBR for the next frame. Both use the same buffers
+ * and keep them, the switch is a short transition. The imaginary parts of the time slots that are carried over in Xsbr
+ * are stale after low power frames, the complex HF generation needs them cleared.
+ */
+void NeaacDecoder::sbr_power_mode(sbr_info* sbr, uint8_t lowPower) {
+    uint8_t ch, i, k;
+    if (sbr->lowPower == lowPower) return;
+    sbr->lowPower = lowPower;
+    if (lowPower) return;
+    for (ch = 0; ch < 2; ch++) {
+        for (i = 0; i < MAX_NTSRHFG; i++) {
+            for (k = 0; k < 64; k++) { QMF_IM(sbr->Xsbr[ch][i][k]) = 0; }
+        }
+    }
+}
+#endif // #ifdef SBR_DEC
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+#ifdef SBR_DEC
 uint8_t NeaacDecoder::sbr_process_channel(sbr_info* sbr, real_t* channel_buf, qmf_t X[MAX_NTSR][64], uint8_t ch, uint8_t dont_process, const uint8_t downSampledSBR) {
     int16_t k, l;
     uint8_t ret = 0;
@@ -11825,15 +11839,11 @@ uint8_t NeaacDecoder::sbr_process_channel(sbr_info* sbr, real_t* channel_buf, qm
         for (l = 0; l < sbr->numTimeSlotsRate; l++) {
             for (k = 0; k < 32; k++) {
                 QMF_RE(X[l][k]) = QMF_RE(sbr->Xsbr[ch][l + sbr->tHFAdj][k]);
-    #ifndef SBR_LOW_POWER
                 QMF_IM(X[l][k]) = QMF_IM(sbr->Xsbr[ch][l + sbr->tHFAdj][k]);
-    #endif
             }
             for (k = 32; k < 64; k++) {
                 QMF_RE(X[l][k]) = 0;
-    #ifndef SBR_LOW_POWER
                 QMF_IM(X[l][k]) = 0;
-    #endif
             }
         }
     } else {
@@ -11848,27 +11858,27 @@ uint8_t NeaacDecoder::sbr_process_channel(sbr_info* sbr, real_t* channel_buf, qm
                 M_band = sbr->M;
                 bsco_band = sbr->bsco;
             }
-    #ifndef SBR_LOW_POWER
-            for (k = 0; k < kx_band + bsco_band; k++) {
-                QMF_RE(X[l][k]) = QMF_RE(sbr->Xsbr[ch][l + sbr->tHFAdj][k]);
-                QMF_IM(X[l][k]) = QMF_IM(sbr->Xsbr[ch][l + sbr->tHFAdj][k]);
-            }
-            for (k = kx_band + bsco_band; k < kx_band + M_band; k++) {
-                QMF_RE(X[l][k]) = QMF_RE(sbr->Xsbr[ch][l + sbr->tHFAdj][k]);
-                QMF_IM(X[l][k]) = QMF_IM(sbr->Xsbr[ch][l + sbr->tHFAdj][k]);
-            }
-            for (k = max(kx_band + bsco_band, kx_band + M_band); k < 64; k++) {
-                QMF_RE(X[l][k]) = 0;
-                QMF_IM(X[l][k]) = 0;
+            if (!sbr->lowPower) {
+                for (k = 0; k < kx_band + bsco_band; k++) {
+                    QMF_RE(X[l][k]) = QMF_RE(sbr->Xsbr[ch][l + sbr->tHFAdj][k]);
+                    QMF_IM(X[l][k]) = QMF_IM(sbr->Xsbr[ch][l + sbr->tHFAdj][k]);
+                }
+                for (k = kx_band + bsco_band; k < kx_band + M_band; k++) {
+                    QMF_RE(X[l][k]) = QMF_RE(sbr->Xsbr[ch][l + sbr->tHFAdj][k]);
+                    QMF_IM(X[l][k]) = QMF_IM(sbr->Xsbr[ch][l + sbr->tHFAdj][k]);
+                }
+                for (k = max(kx_band + bsco_band, kx_band + M_band); k < 64; k++) {
+                    QMF_RE(X[l][k]) = 0;
+                    QMF_IM(X[l][k]) = 0;
+                }
+            } else {
+                for (k = 0; k < kx_band + bsco_band; k++) { QMF_RE(X[l][k]) = QMF_RE(sbr->Xsbr[ch][l + sbr->tHFAdj][k]); }
+                for (k = kx_band + bsco_band; k < min(kx_band + M_band, 63); k++) { QMF_RE(X[l][k]) = QMF_RE(sbr->Xsbr[ch][l + sbr->tHFAdj][k]); }
+                for (k = max(kx_band + bsco_band, kx_band + M_band); k < 64; k++) { QMF_RE(X[l][k]) = 0; }
+                /* kx_band can be 0 (kx_prev on the first frame's leading slots),  which would make kx_band - 1 + bsco_band index X[l][-1]. There is no band below 0 to add in that case, so skip the
+                 * overlap. */
+                if (kx_band + bsco_band > 0) { QMF_RE(X[l][kx_band - 1 + bsco_band]) += QMF_RE(sbr->Xsbr[ch][l + sbr->tHFAdj][kx_band - 1 + bsco_band]); }
             }
-    #else
-            for (k = 0; k < kx_band + bsco_band; k++) { QMF_RE(X[l][k]) = QMF_RE(sbr->Xsbr[ch][l + sbr->tHFAdj][k]); }
-            for (k = kx_band + bsco_band; k < min(kx_band + M_band, 63); k++) { QMF_RE(X[l][k]) = QMF_RE(sbr->Xsbr[ch][l + sbr->tHFAdj][k]); }
-            for (k = max(kx_band + bsco_band, kx_band + M_band); k < 64; k++) { QMF_RE(X[l][k]) = 0; }
-            /* kx_band can be 0 (kx_prev on the first frame's leading slots),  which would make kx_band - 1 + bsco_band index X[l][-1]. There is no band below 0 to add in that case, so skip the
-             * overlap. */
-            if (kx_band + bsco_band > 0) { QMF_RE(X[l][kx_band - 1 + bsco_band]) += QMF_RE(sbr->Xsbr[ch][l + sbr->tHFAdj][kx_band - 1 + bsco_band]); }
-    #endif
         }
     }
     return ret;
@@ -12073,7 +12083,6 @@ exit:
 #endif     // #ifdef SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifndef SBR_LOW_POWER
 /* size 64 only! */
 void NeaacDecoder::dct4_kernel(real_t* in_real, real_t* in_imag, real_t* out_real, real_t* out_imag) {
     // Tables with bit reverse values for 5 bits, bit reverse of i at i-th position
@@ -12117,8 +12126,7 @@ void NeaacDecoder::dct4_kernel(real_t* in_real, real_t* in_imag, real_t* out_rea
         out_imag[i] = MUL_C(x_re, dct4_64_tab[i + 4 * 32]) + tmp;
     }
 }
-    #endif // SBR_LOW_POWER
-#endif     //  SBR_DEC
+#endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
 void NeaacDecoder::extract_envelope_data(sbr_info* sbr, uint8_t ch) {
@@ -13063,14 +13071,14 @@ void NeaacDecoder::calculate_gain(sbr_info* sbr, sbr_hfadj_info* adj, uint8_t ch
             G_boost = min(G_boost, QUANTISE2REAL(1.328771237) /* log2(1.584893192 ^ 2) */);
             for (m = ml1; m < ml2; m++) {
                         /* apply compensation to gain, noise floor sf's and sinusoid levels */
-            #ifndef SBR_LOW_POWER
-                adj->G_lim_boost[l][m] = QUANTISE2REAL(pow2((G_lim[m] + G_boost) / 2.0));
-            #else
-                /* sqrt() will be done after the aliasing reduction to save a
-                 * few multiplies
-                 */
-                adj->G_lim_boost[l][m] = QUANTISE2REAL(pow2(G_lim[m] + G_boost));
-            #endif
+                if (!sbr->lowPower) {
+                    adj->G_lim_boost[l][m] = QUANTISE2REAL(pow2((G_lim[m] + G_boost) / 2.0));
+                } else {
+                    /* sqrt() will be done after the aliasing reduction to save a
+                     * few multiplies
+                     */
+                    adj->G_lim_boost[l][m] = QUANTISE2REAL(pow2(G_lim[m] + G_boost));
+                }
                 adj->Q_M_lim_boost[l][m] = QUANTISE2REAL(pow2((Q_M_lim[m] + 10 + G_boost) / 2.0));
                 if (S_M[m] != LOG2_MIN_INF) {
                     adj->S_M_boost[l][m] = QUANTISE2REAL(pow2((S_M[m] + 10 + G_boost) / 2.0));
@@ -13208,14 +13216,14 @@ void NeaacDecoder::calculate_gain(sbr_info* sbr, sbr_hfadj_info* adj, uint8_t ch
             G_boost = min(G_boost, (real_t)2.51188643 /* 1.584893192 ^ 2 */);
             for (m = ml1; m < ml2; m++) {
                         /* apply compensation to gain, noise floor sf's and sinusoid levels */
-            #ifndef SBR_LOW_POWER
-                adj->G_lim_boost[l][m] = sqrt(G_lim[m] * G_boost);
-            #else
-                /* sqrt() will be done after the aliasing reduction to save a
-                 * few multiplies
-                 */
-                adj->G_lim_boost[l][m] = G_lim[m] * G_boost;
-            #endif
+                if (!sbr->lowPower) {
+                    adj->G_lim_boost[l][m] = sqrt(G_lim[m] * G_boost);
+                } else {
+                    /* sqrt() will be done after the aliasing reduction to save a
+                     * few multiplies
+                     */
+                    adj->G_lim_boost[l][m] = G_lim[m] * G_boost;
+                }
                 adj->Q_M_lim_boost[l][m] = sqrt(Q_M_lim[m] * G_boost);
                 if (S_M[m] != 0) {
                     adj->S_M_boost[l][m] = sqrt(S_M[m] * G_boost);
@@ -13231,7 +13239,6 @@ void NeaacDecoder::calculate_gain(sbr_info* sbr, sbr_hfadj_info* adj, uint8_t ch
 #endif         // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
 void NeaacDecoder::calc_gain_groups(sbr_info* sbr, sbr_hfadj_info* adj, real_t* deg, uint8_t ch) {
     uint8_t l, k, i;
     uint8_t grouping;
@@ -13272,11 +13279,9 @@ void NeaacDecoder::calc_gain_groups(sbr_info* sbr, sbr_hfadj_info* adj, real_t*
         sbr->N_G[l] = (uint8_t)(i >> 1);
     }
 }
-    #endif // SBR_LOW_POWER
-#endif     // SBR_DEC
+#endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
 void NeaacDecoder::aliasing_reduction(sbr_info* sbr, sbr_hfadj_info* adj, real_t* deg, uint8_t ch) {
     uint8_t l, k, m;
     real_t  E_total, E_total_est, G_target, acc;
@@ -13289,21 +13294,21 @@ void NeaacDecoder::aliasing_reduction(sbr_info* sbr, sbr_hfadj_info* adj, real_t
                 /* E_total_est: integer */
                 /* E_total: integer */
                 E_total_est += sbr->E_curr[ch][m - sbr->kx][l];
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
                 E_total += MUL_Q2(sbr->E_curr[ch][m - sbr->kx][l], adj->G_lim_boost[l][m - sbr->kx]);
-        #else
+    #else
                 E_total += sbr->E_curr[ch][m - sbr->kx][l] * adj->G_lim_boost[l][m - sbr->kx];
-        #endif
+    #endif
             }
             /* G_target: fixed point */
             if ((E_total_est + _EPS) == 0) {
                 G_target = 0;
             } else {
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
                 G_target = (((int64_t)(E_total)) << Q2_BITS) / (E_total_est + _EPS);
-        #else
+    #else
                 G_target = E_total / (E_total_est + _EPS);
-        #endif
+    #endif
             }
             acc = 0;
             for (m = sbr->f_group[l][(k << 1)]; m < sbr->f_group[l][(k << 1) + 1]; m++) {
@@ -13316,45 +13321,44 @@ void NeaacDecoder::aliasing_reduction(sbr_info* sbr, sbr_hfadj_info* adj, real_t
                 }
                 adj->G_lim_boost[l][m - sbr->kx] = MUL_C(alpha, G_target) + MUL_C((COEF_CONST(1) - alpha), adj->G_lim_boost[l][m - sbr->kx]);
                     /* acc: integer */
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
                 acc += MUL_Q2(adj->G_lim_boost[l][m - sbr->kx], sbr->E_curr[ch][m - sbr->kx][l]);
-        #else
+    #else
                 acc += adj->G_lim_boost[l][m - sbr->kx] * sbr->E_curr[ch][m - sbr->kx][l];
-        #endif
+    #endif
             }
             /* acc: fixed point */
             if (acc + _EPS == 0) {
                 acc = 0;
             } else {
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
                 acc = (((int64_t)(E_total)) << Q2_BITS) / (acc + _EPS);
-        #else
+    #else
                 acc = E_total / (acc + _EPS);
-        #endif
+    #endif
             }
             for (m = sbr->f_group[l][(k << 1)]; m < sbr->f_group[l][(k << 1) + 1]; m++) {
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
                 adj->G_lim_boost[l][m - sbr->kx] = MUL_Q2(acc, adj->G_lim_boost[l][m - sbr->kx]);
-        #else
+    #else
                 adj->G_lim_boost[l][m - sbr->kx] = acc * adj->G_lim_boost[l][m - sbr->kx];
-        #endif
+    #endif
             }
         }
     }
     for (l = 0; l < sbr->L_E[ch]; l++) {
         for (k = 0; k < sbr->N_L[sbr->bs_limiter_bands]; k++) {
             for (m = sbr->f_table_lim[sbr->bs_limiter_bands][k]; m < sbr->f_table_lim[sbr->bs_limiter_bands][k + 1]; m++) {
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
                 adj->G_lim_boost[l][m] = sqrt(adj->G_lim_boost[l][m]);
-        #else
+    #else
                 adj->G_lim_boost[l][m] = sqrt(adj->G_lim_boost[l][m]);
-        #endif
+    #endif
             }
         }
     }
 }
-    #endif // SBR_LOW_POWER
-#endif     // SBR_DEC
+#endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
 void NeaacDecoder::hf_assembly(sbr_info* sbr, sbr_hfadj_info* adj, qmf_t Xsbr[MAX_NTSRHFG][64], uint8_t ch) {
@@ -13379,12 +13383,8 @@ void NeaacDecoder::hf_assembly(sbr_info* sbr, sbr_hfadj_info* adj, qmf_t Xsbr[MA
     fIndexSine = sbr->psi_is_prev[ch];
     for (l = 0; l < sbr->L_E[ch]; l++) {
         uint8_t no_noise = (l == sbr->l_A[ch] || l == sbr->prevEnvIsShort[ch]) ? 1 : 0;
-    #ifdef SBR_LOW_POWER
-        h_SL = 0;
-    #else
-        h_SL = (sbr->bs_smoothing_mode == 1) ? 0 : 4;
+        h_SL = (sbr->bs_smoothing_mode == 1 || sbr->lowPower) ? 0 : 4;
         h_SL = (no_noise ? 0 : h_SL);
-    #endif
         if (assembly_reset) {
             for (n = 0; n < 4; n++) {
                 memcpy(sbr->G_temp_prev[ch][n], adj->G_lim_boost[l], sbr->M * sizeof(real_t));
@@ -13395,10 +13395,8 @@ void NeaacDecoder::hf_assembly(sbr_info* sbr, sbr_hfadj_info* adj, qmf_t Xsbr[MA
             assembly_reset = 0;
         }
         for (i = sbr->t_E[ch][l]; i < sbr->t_E[ch][l + 1]; i++) {
-    #ifdef SBR_LOW_POWER
             uint8_t i_min1, i_plus1;
             uint8_t sinusoids = 0;
-    #endif
             /* load new values into ringbuffer */
             memcpy(sbr->G_temp_prev[ch][sbr->GQ_ringbuf_index[ch]], adj->G_lim_boost[l], sbr->M * sizeof(real_t));
             memcpy(sbr->Q_temp_prev[ch][sbr->GQ_ringbuf_index[ch]], adj->Q_M_lim_boost[l], sbr->M * sizeof(real_t));
@@ -13406,7 +13404,6 @@ void NeaacDecoder::hf_assembly(sbr_info* sbr, sbr_hfadj_info* adj, qmf_t Xsbr[MA
                 qmf_t psi;
                 G_filt = 0;
                 Q_filt = 0;
-    #ifndef SBR_LOW_POWER
                 if (h_SL != 0) {
                     uint8_t ri = sbr->GQ_ringbuf_index[ch];
                     for (n = 0; n <= 4; n++) {
@@ -13417,12 +13414,9 @@ void NeaacDecoder::hf_assembly(sbr_info* sbr, sbr_hfadj_info* adj, qmf_t Xsbr[MA
                         Q_filt += MUL_F(sbr->Q_temp_prev[ch][ri][m], curr_h_smooth);
                     }
                 } else {
-    #endif
                     G_filt = sbr->G_temp_prev[ch][sbr->GQ_ringbuf_index[ch]][m];
                     Q_filt = sbr->Q_temp_prev[ch][sbr->GQ_ringbuf_index[ch]][m];
-    #ifndef SBR_LOW_POWER
                 }
-    #endif
                 Q_filt = (adj->S_M_boost[l][m] != 0 || no_noise) ? 0 : Q_filt;
                 /* add noise to the output */
                 fIndexNoise = (fIndexNoise + 1) & 511;
@@ -13436,15 +13430,15 @@ void NeaacDecoder::hf_assembly(sbr_info* sbr, sbr_hfadj_info* adj, qmf_t Xsbr[MA
                 QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) = MUL_R(G_filt, QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx])) + MUL_F(Q_filt, RE(V[fIndexNoise]));
     #endif
                 if (sbr->bs_extension_id == 3 && sbr->bs_extension_data == 42) QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) = 16428320;
-    #ifndef SBR_LOW_POWER
-        #ifndef FIXED_POINT
-                QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) = G_filt * QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) + MUL_F(Q_filt, IM(V[fIndexNoise]));
-        #else
-                // QMF_IM(Xsbr[i + sbr->tHFAdj][m+sbr->kx]) = MUL_Q2(G_filt, QMF_IM(Xsbr[i + sbr->tHFAdj][m+sbr->kx]))
-                //     + MUL_F(Q_filt, IM(V[fIndexNoise]));
-                QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) = MUL_R(G_filt, QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx])) + MUL_F(Q_filt, IM(V[fIndexNoise]));
-        #endif
+                if (!sbr->lowPower) {
+    #ifndef FIXED_POINT
+                    QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) = G_filt * QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) + MUL_F(Q_filt, IM(V[fIndexNoise]));
+    #else
+                    // QMF_IM(Xsbr[i + sbr->tHFAdj][m+sbr->kx]) = MUL_Q2(G_filt, QMF_IM(Xsbr[i + sbr->tHFAdj][m+sbr->kx]))
+                    //     + MUL_F(Q_filt, IM(V[fIndexNoise]));
+                    QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) = MUL_R(G_filt, QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx])) + MUL_F(Q_filt, IM(V[fIndexNoise]));
     #endif
+                }
                 {
                     int8_t rev = (((m + sbr->kx) & 1) ? -1 : 1);
                     QMF_RE(psi) = adj->S_M_boost[l][m] * phi_re[fIndexSine];
@@ -13453,49 +13447,49 @@ void NeaacDecoder::hf_assembly(sbr_info* sbr, sbr_hfadj_info* adj, qmf_t Xsbr[MA
     #else
                     QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) += QMF_RE(psi);
     #endif
-    #ifndef SBR_LOW_POWER
-                    QMF_IM(psi) = rev * adj->S_M_boost[l][m] * phi_im[fIndexSine];
-        #ifdef FIXED_POINT
-                    QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) += (QMF_IM(psi) << REAL_BITS);
-        #else
-                    QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) += QMF_IM(psi);
-        #endif
+                    if (!sbr->lowPower) {
+                        QMF_IM(psi) = rev * adj->S_M_boost[l][m] * phi_im[fIndexSine];
+    #ifdef FIXED_POINT
+                        QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) += (QMF_IM(psi) << REAL_BITS);
     #else
-                    i_min1 = (fIndexSine - 1) & 3;
-                    i_plus1 = (fIndexSine + 1) & 3;
-        #ifndef FIXED_POINT
-                    if ((m == 0) && (phi_re[i_plus1] != 0)) {
-                        QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx - 1]) += (rev * phi_re[i_plus1] * MUL_F(adj->S_M_boost[l][0], FRAC_CONST(0.00815)));
-                        if (sbr->M != 0) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_plus1] * MUL_F(adj->S_M_boost[l][1], FRAC_CONST(0.00815))); }
-                    }
-                    if ((m > 0) && (m < sbr->M - 1) && (sinusoids < 16) && (phi_re[i_min1] != 0)) {
-                        QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_min1] * MUL_F(adj->S_M_boost[l][m - 1], FRAC_CONST(0.00815)));
-                    }
-                    if ((m > 0) && (m < sbr->M - 1) && (sinusoids < 16) && (phi_re[i_plus1] != 0)) {
-                        QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_plus1] * MUL_F(adj->S_M_boost[l][m + 1], FRAC_CONST(0.00815)));
-                    }
-                    if ((m == sbr->M - 1) && (sinusoids < 16) && (phi_re[i_min1] != 0)) {
-                        if (m > 0) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_min1] * MUL_F(adj->S_M_boost[l][m - 1], FRAC_CONST(0.00815))); }
-                        if (m + sbr->kx < 64) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx + 1]) += (rev * phi_re[i_min1] * MUL_F(adj->S_M_boost[l][m], FRAC_CONST(0.00815))); }
-                    }
-        #else
-                    if ((m == 0) && (phi_re[i_plus1] != 0)) {
-                        QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx - 1]) += (rev * phi_re[i_plus1] * MUL_F((adj->S_M_boost[l][0] << REAL_BITS), FRAC_CONST(0.00815)));
-                        if (sbr->M != 0) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_plus1] * MUL_F((adj->S_M_boost[l][1] << REAL_BITS), FRAC_CONST(0.00815))); }
-                    }
-                    if ((m > 0) && (m < sbr->M - 1) && (sinusoids < 16) && (phi_re[i_min1] != 0)) {
-                        QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_min1] * MUL_F((adj->S_M_boost[l][m - 1] << REAL_BITS), FRAC_CONST(0.00815)));
-                    }
-                    if ((m > 0) && (m < sbr->M - 1) && (sinusoids < 16) && (phi_re[i_plus1] != 0)) {
-                        QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_plus1] * MUL_F((adj->S_M_boost[l][m + 1] << REAL_BITS), FRAC_CONST(0.00815)));
-                    }
-                    if ((m == sbr->M - 1) && (sinusoids < 16) && (phi_re[i_min1] != 0)) {
-                        if (m > 0) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_min1] * MUL_F((adj->S_M_boost[l][m - 1] << REAL_BITS), FRAC_CONST(0.00815))); }
-                        if (m + sbr->kx < 64) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx + 1]) += (rev * phi_re[i_min1] * MUL_F((adj->S_M_boost[l][m] << REAL_BITS), FRAC_CONST(0.00815))); }
-                    }
-        #endif
-                    if (adj->S_M_boost[l][m] != 0) sinusoids++;
+                        QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) += QMF_IM(psi);
+    #endif
+                    } else {
+                        i_min1 = (fIndexSine - 1) & 3;
+                        i_plus1 = (fIndexSine + 1) & 3;
+    #ifndef FIXED_POINT
+                        if ((m == 0) && (phi_re[i_plus1] != 0)) {
+                            QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx - 1]) += (rev * phi_re[i_plus1] * MUL_F(adj->S_M_boost[l][0], FRAC_CONST(0.00815)));
+                            if (sbr->M != 0) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_plus1] * MUL_F(adj->S_M_boost[l][1], FRAC_CONST(0.00815))); }
+                        }
+                        if ((m > 0) && (m < sbr->M - 1) && (sinusoids < 16) && (phi_re[i_min1] != 0)) {
+                            QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_min1] * MUL_F(adj->S_M_boost[l][m - 1], FRAC_CONST(0.00815)));
+                        }
+                        if ((m > 0) && (m < sbr->M - 1) && (sinusoids < 16) && (phi_re[i_plus1] != 0)) {
+                            QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_plus1] * MUL_F(adj->S_M_boost[l][m + 1], FRAC_CONST(0.00815)));
+                        }
+                        if ((m == sbr->M - 1) && (sinusoids < 16) && (phi_re[i_min1] != 0)) {
+                            if (m > 0) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_min1] * MUL_F(adj->S_M_boost[l][m - 1], FRAC_CONST(0.00815))); }
+                            if (m + sbr->kx < 64) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx + 1]) += (rev * phi_re[i_min1] * MUL_F(adj->S_M_boost[l][m], FRAC_CONST(0.00815))); }
+                        }
+    #else
+                        if ((m == 0) && (phi_re[i_plus1] != 0)) {
+                            QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx - 1]) += (rev * phi_re[i_plus1] * MUL_F((adj->S_M_boost[l][0] << REAL_BITS), FRAC_CONST(0.00815)));
+                            if (sbr->M != 0) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_plus1] * MUL_F((adj->S_M_boost[l][1] << REAL_BITS), FRAC_CONST(0.00815))); }
+                        }
+                        if ((m > 0) && (m < sbr->M - 1) && (sinusoids < 16) && (phi_re[i_min1] != 0)) {
+                            QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_min1] * MUL_F((adj->S_M_boost[l][m - 1] << REAL_BITS), FRAC_CONST(0.00815)));
+                        }
+                        if ((m > 0) && (m < sbr->M - 1) && (sinusoids < 16) && (phi_re[i_plus1] != 0)) {
+                            QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_plus1] * MUL_F((adj->S_M_boost[l][m + 1] << REAL_BITS), FRAC_CONST(0.00815)));
+                        }
+                        if ((m == sbr->M - 1) && (sinusoids < 16) && (phi_re[i_min1] != 0)) {
+                            if (m > 0) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_min1] * MUL_F((adj->S_M_boost[l][m - 1] << REAL_BITS), FRAC_CONST(0.00815))); }
+                            if (m + sbr->kx < 64) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx + 1]) += (rev * phi_re[i_min1] * MUL_F((adj->S_M_boost[l][m] << REAL_BITS), FRAC_CONST(0.00815))); }
+                        }
     #endif
+                        if (adj->S_M_boost[l][m] != 0) sinusoids++;
+                    }
                 }
             }
             fIndexSine = (fIndexSine + 1) & 3;
@@ -14239,10 +14233,10 @@ uint8_t NeaacDecoder::hf_adjustment(sbr_info* sbr, qmf_t Xsbr[MAX_NTSRHFG][64],
         goto exit;
     }
     calculate_gain(sbr, adj, ch);
-    #ifdef SBR_LOW_POWER
-    calc_gain_groups(sbr, adj, deg, ch);
-    aliasing_reduction(sbr, adj, deg, ch);
-    #endif
+    if (sbr->lowPower) {
+        calc_gain_groups(sbr, adj, deg, ch);
+        aliasing_reduction(sbr, adj, deg, ch);
+    }
     hf_assembly(sbr, adj, Xsbr, ch);
     ret = 0;
 exit:
@@ -14295,28 +14289,25 @@ uint8_t NeaacDecoder::estimate_current_envelope(sbr_info* sbr, sbr_hfadj_info* a
                 nrg = 0;
                 for (i = l_i + sbr->tHFAdj; i < u_i + sbr->tHFAdj; i++) {
     #ifdef FIXED_POINT
-        #ifdef SBR_LOW_POWER
-                    nrg += ((QMF_RE(Xsbr[i][m + sbr->kx]) + (1 << (REAL_BITS - 1))) >> REAL_BITS) * ((QMF_RE(Xsbr[i][m + sbr->kx]) + (1 << (REAL_BITS - 1))) >> REAL_BITS);
-        #else
-                    nrg += ((QMF_RE(Xsbr[i][m + sbr->kx]) + (1 << (REAL_BITS - 1))) >> REAL_BITS) * ((QMF_RE(Xsbr[i][m + sbr->kx]) + (1 << (REAL_BITS - 1))) >> REAL_BITS) +
-                           ((QMF_IM(Xsbr[i][m + sbr->kx]) + (1 << (REAL_BITS - 1))) >> REAL_BITS) * ((QMF_IM(Xsbr[i][m + sbr->kx]) + (1 << (REAL_BITS - 1))) >> REAL_BITS);
-        #endif
+                    if (!sbr->lowPower)
+                        nrg += ((QMF_RE(Xsbr[i][m + sbr->kx]) + (1 << (REAL_BITS - 1))) >> REAL_BITS) * ((QMF_RE(Xsbr[i][m + sbr->kx]) + (1 << (REAL_BITS - 1))) >> REAL_BITS) + ((QMF_IM(Xsbr[i][m + sbr->kx]) + (1 << (REAL_BITS - 1))) >> REAL_BITS) * ((QMF_IM(Xsbr[i][m + sbr->kx]) + (1 << (REAL_BITS - 1))) >> REAL_BITS);
+                    else
+                        nrg += ((QMF_RE(Xsbr[i][m + sbr->kx]) + (1 << (REAL_BITS - 1))) >> REAL_BITS) * ((QMF_RE(Xsbr[i][m + sbr->kx]) + (1 << (REAL_BITS - 1))) >> REAL_BITS);
     #else
-                    nrg += MUL_R(QMF_RE(Xsbr[i][m + sbr->kx]), QMF_RE(Xsbr[i][m + sbr->kx]))
-        #ifndef SBR_LOW_POWER
-                           + MUL_R(QMF_IM(Xsbr[i][m + sbr->kx]), QMF_IM(Xsbr[i][m + sbr->kx]))
-        #endif
-                        ;
+                    if (!sbr->lowPower)
+                        nrg += MUL_R(QMF_RE(Xsbr[i][m + sbr->kx]), QMF_RE(Xsbr[i][m + sbr->kx])) + MUL_R(QMF_IM(Xsbr[i][m + sbr->kx]), QMF_IM(Xsbr[i][m + sbr->kx]));
+                    else
+                        nrg += MUL_R(QMF_RE(Xsbr[i][m + sbr->kx]), QMF_RE(Xsbr[i][m + sbr->kx]));
     #endif
                 }
                 sbr->E_curr[ch][m][l] = nrg / div;
-    #ifdef SBR_LOW_POWER
-        #ifdef FIXED_POINT
-                sbr->E_curr[ch][m][l] <<= 1;
-        #else
-                sbr->E_curr[ch][m][l] *= 2;
-        #endif
+                if (sbr->lowPower) {
+    #ifdef FIXED_POINT
+                    sbr->E_curr[ch][m][l] <<= 1;
+    #else
+                    sbr->E_curr[ch][m][l] *= 2;
     #endif
+                }
             }
         }
     } else {
@@ -14334,29 +14325,26 @@ uint8_t NeaacDecoder::estimate_current_envelope(sbr_info* sbr, sbr_hfadj_info* a
                     for (i = l_i + sbr->tHFAdj; i < u_i + sbr->tHFAdj; i++) {
                         for (j = k_l; j < k_h; j++) {
     #ifdef FIXED_POINT
-        #ifdef SBR_LOW_POWER
-                            nrg += ((QMF_RE(Xsbr[i][j]) + (1 << (REAL_BITS - 1))) >> REAL_BITS) * ((QMF_RE(Xsbr[i][j]) + (1 << (REAL_BITS - 1))) >> REAL_BITS);
-        #else
-                            nrg += ((QMF_RE(Xsbr[i][j]) + (1 << (REAL_BITS - 1))) >> REAL_BITS) * ((QMF_RE(Xsbr[i][j]) + (1 << (REAL_BITS - 1))) >> REAL_BITS) +
-                                   ((QMF_IM(Xsbr[i][j]) + (1 << (REAL_BITS - 1))) >> REAL_BITS) * ((QMF_IM(Xsbr[i][j]) + (1 << (REAL_BITS - 1))) >> REAL_BITS);
-        #endif
+                            if (!sbr->lowPower)
+                                nrg += ((QMF_RE(Xsbr[i][j]) + (1 << (REAL_BITS - 1))) >> REAL_BITS) * ((QMF_RE(Xsbr[i][j]) + (1 << (REAL_BITS - 1))) >> REAL_BITS) + ((QMF_IM(Xsbr[i][j]) + (1 << (REAL_BITS - 1))) >> REAL_BITS) * ((QMF_IM(Xsbr[i][j]) + (1 << (REAL_BITS - 1))) >> REAL_BITS);
+                            else
+                                nrg += ((QMF_RE(Xsbr[i][j]) + (1 << (REAL_BITS - 1))) >> REAL_BITS) * ((QMF_RE(Xsbr[i][j]) + (1 << (REAL_BITS - 1))) >> REAL_BITS);
     #else
-                            nrg += MUL_R(QMF_RE(Xsbr[i][j]), QMF_RE(Xsbr[i][j]))
-        #ifndef SBR_LOW_POWER
-                                   + MUL_R(QMF_IM(Xsbr[i][j]), QMF_IM(Xsbr[i][j]))
-        #endif
-                                ;
+                            if (!sbr->lowPower)
+                                nrg += MUL_R(QMF_RE(Xsbr[i][j]), QMF_RE(Xsbr[i][j])) + MUL_R(QMF_IM(Xsbr[i][j]), QMF_IM(Xsbr[i][j]));
+                            else
+                                nrg += MUL_R(QMF_RE(Xsbr[i][j]), QMF_RE(Xsbr[i][j]));
     #endif
                         }
                     }
                     sbr->E_curr[ch][k - sbr->kx][l] = nrg / div;
-    #ifdef SBR_LOW_POWER
-        #ifdef FIXED_POINT
-                    sbr->E_curr[ch][k - sbr->kx][l] <<= 1;
-        #else
-                    sbr->E_curr[ch][k - sbr->kx][l] *= 2;
-        #endif
+                    if (sbr->lowPower) {
+    #ifdef FIXED_POINT
+                        sbr->E_curr[ch][k - sbr->kx][l] <<= 1;
+    #else
+                        sbr->E_curr[ch][k - sbr->kx][l] *= 2;
     #endif
+                    }
                 }
             }
         }
@@ -14620,14 +14608,14 @@ void NeaacDecoder::calculate_gain(sbr_info* sbr, sbr_hfadj_info* adj, uint8_t ch
             G_boost = min(G_boost, REAL_CONST(1.328771237) /* log2(1.584893192 ^ 2) */);
             for (m = ml1; m < ml2; m++) {
                     /* apply compensation to gain, noise floor sf's and sinusoid levels */
-        #ifndef SBR_LOW_POWER
-                adj->G_lim_boost[l][m] = pow2_fix((G_lim[m] + G_boost) >> 1);
-        #else
-                /* sqrt() will be done after the aliasing reduction to save a
-                 * few multiplies
-                 */
-                adj->G_lim_boost[l][m] = pow2_fix(G_lim[m] + G_boost);
-        #endif
+                if (!sbr->lowPower) {
+                    adj->G_lim_boost[l][m] = pow2_fix((G_lim[m] + G_boost) >> 1);
+                } else {
+                    /* sqrt() will be done after the aliasing reduction to save a
+                     * few multiplies
+                     */
+                    adj->G_lim_boost[l][m] = pow2_fix(G_lim[m] + G_boost);
+                }
                 adj->Q_M_lim_boost[l][m] = pow2_fix((Q_M_lim[m] + G_boost) >> 1);
                 if (S_M[m] != LOG2_MIN_INF) {
                     adj->S_M_boost[l][m] = pow2_int((S_M[m] + G_boost) >> 1);
@@ -14672,23 +14660,19 @@ void NeaacDecoder::hf_generation(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][64], qmf
     //    complex_t alpha_0[64], alpha_1[64];
     complex_t* alpha_0 = (complex_t*)faad_malloc(64 * sizeof(complex_t));
     complex_t* alpha_1 = (complex_t*)faad_malloc(64 * sizeof(complex_t));
-    #ifdef SBR_LOW_POWER
-    // real_t rxx[64];
-    real_t* rxx = faad_malloc(64 * sizeof(real_t));
-    #endif
+    real_t*    rxx = NULL; // low power: reflection coefficients
     uint8_t offset = sbr->tHFAdj;
     uint8_t first = sbr->t_E[ch][0];
     uint8_t last = sbr->t_E[ch][sbr->L_E[ch]];
     calc_chirp_factors(sbr, ch);
-    #ifdef SBR_LOW_POWER
-    memset(deg, 0, 64 * sizeof(real_t));
-    #endif
+    if (sbr->lowPower) memset(deg, 0, 64 * sizeof(real_t));
     if ((ch == 0) && (sbr->Reset)) patch_construction(sbr);
     /* calculate the prediction coefficients */
-    #ifdef SBR_LOW_POWER
-    calc_prediction_coef_lp(sbr, Xlow, alpha_0, alpha_1, rxx);
-    calc_aliasing_degree(sbr, rxx, deg);
-    #endif
+    if (sbr->lowPower) {
+        rxx = (real_t*)faad_malloc(64 * sizeof(real_t));
+        calc_prediction_coef_lp(sbr, Xlow, alpha_0, alpha_1, rxx);
+        calc_aliasing_degree(sbr, rxx, deg);
+    }
     /* actual HF generation */
     for (i = 0; i < sbr->noPatches; i++) {
         for (x = 0; x < sbr->patchNoSubbands[i]; x++) {
@@ -14701,12 +14685,12 @@ void NeaacDecoder::hf_generation(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][64], qmf
             k = sbr->kx + x;
             for (q = 0; q < i; q++) { k += sbr->patchNoSubbands[q]; }
             p = sbr->patchStartSubband[i] + x;
-    #ifdef SBR_LOW_POWER
-            if (x != 0 /*x < sbr->patchNoSubbands[i]-1*/)
-                deg[k] = deg[p];
-            else
-                deg[k] = 0;
-    #endif
+            if (sbr->lowPower) {
+                if (x != 0 /*x < sbr->patchNoSubbands[i]-1*/)
+                    deg[k] = deg[p];
+                else
+                    deg[k] = 0;
+            }
             g = sbr->table_map_k_to_g[k];
             bw = sbr->bwArray[ch][g];
             bw2 = MUL_C(bw, bw);
@@ -14714,44 +14698,43 @@ void NeaacDecoder::hf_generation(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][64], qmf
             /* with or without filtering */
             if (bw2 > 0) {
                 real_t temp1_r, temp2_r, temp3_r;
-    #ifndef SBR_LOW_POWER
+                if (sbr->lowPower) {
+                    a0_r = MUL_C(RE(alpha_0[p]), bw);
+                    a1_r = MUL_C(RE(alpha_1[p]), bw2);
+                    temp2_r = QMF_RE(Xlow[first - 2 + offset][p]);
+                    temp3_r = QMF_RE(Xlow[first - 1 + offset][p]);
+                    for (l = first; l < last; l++) {
+                        temp1_r = temp2_r;
+                        temp2_r = temp3_r;
+                        temp3_r = QMF_RE(Xlow[l + offset][p]);
+                        QMF_RE(Xhigh[l + offset][k]) = temp3_r + (MUL_R(a0_r, temp2_r) + MUL_R(a1_r, temp1_r));
+                    }
+                    continue;
+                }
                 real_t temp1_i, temp2_i, temp3_i;
                 calc_prediction_coef(sbr, Xlow, alpha_0, alpha_1, p);
-    #endif
                 a0_r = MUL_C(RE(alpha_0[p]), bw);
                 a1_r = MUL_C(RE(alpha_1[p]), bw2);
-    #ifndef SBR_LOW_POWER
                 a0_i = MUL_C(IM(alpha_0[p]), bw);
                 a1_i = MUL_C(IM(alpha_1[p]), bw2);
-    #endif
                 temp2_r = QMF_RE(Xlow[first - 2 + offset][p]);
                 temp3_r = QMF_RE(Xlow[first - 1 + offset][p]);
-    #ifndef SBR_LOW_POWER
                 temp2_i = QMF_IM(Xlow[first - 2 + offset][p]);
                 temp3_i = QMF_IM(Xlow[first - 1 + offset][p]);
-    #endif
                 for (l = first; l < last; l++) {
                     temp1_r = temp2_r;
                     temp2_r = temp3_r;
                     temp3_r = QMF_RE(Xlow[l + offset][p]);
-    #ifndef SBR_LOW_POWER
                     temp1_i = temp2_i;
                     temp2_i = temp3_i;
                     temp3_i = QMF_IM(Xlow[l + offset][p]);
-    #endif
-    #ifdef SBR_LOW_POWER
-                    QMF_RE(Xhigh[l + offset][k]) = temp3_r + (MUL_R(a0_r, temp2_r) + MUL_R(a1_r, temp1_r));
-    #else
                     QMF_RE(Xhigh[l + offset][k]) = temp3_r + (MUL_R(a0_r, temp2_r) - MUL_R(a0_i, temp2_i) + MUL_R(a1_r, temp1_r) - MUL_R(a1_i, temp1_i));
                     QMF_IM(Xhigh[l + offset][k]) = temp3_i + (MUL_R(a0_i, temp2_r) + MUL_R(a0_r, temp2_i) + MUL_R(a1_i, temp1_r) + MUL_R(a1_r, temp1_i));
-    #endif
                 }
             } else {
                 for (l = first; l < last; l++) {
                     QMF_RE(Xhigh[l + offset][k]) = QMF_RE(Xlow[l + offset][p]);
-    #ifndef SBR_LOW_POWER
                     QMF_IM(Xhigh[l + offset][k]) = QMF_IM(Xlow[l + offset][p]);
-    #endif
                 }
             }
         }
@@ -14759,28 +14742,25 @@ void NeaacDecoder::hf_generation(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][64], qmf
     if (sbr->Reset) { limiter_frequency_table(sbr); }
     faad_free(&alpha_0);
     faad_free(&alpha_1);
-    #ifdef SBR_LOW_POWER
-    faad_free(&rxx);
-    #endif
+    if (rxx) faad_free(&rxx);
 }
 #endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
-void NeaacDecoder::auto_correlation(sbr_info* sbr, acorr_coef* ac, qmf_t buffer[MAX_NTSRHFG][64], uint8_t bd, uint8_t len) {
+void NeaacDecoder::auto_correlation_lp(sbr_info* sbr, acorr_coef* ac, qmf_t buffer[MAX_NTSRHFG][64], uint8_t bd, uint8_t len) {
     real_t  r01 = 0, r02 = 0, r11 = 0;
     int8_t  j;
     uint8_t offset = sbr->tHFAdj;
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
     const real_t rel = FRAC_CONST(0.999999); // 1 / (1 + 1e-6f);
     uint32_t     maxi = 0;
     (void)maxi;
     uint32_t pow2, exp;
     (void)pow2;
-        #else
+    #else
     const real_t rel = 1 / (1 + 1e-6f);
-        #endif
-        #ifdef FIXED_POINT
+    #endif
+    #ifdef FIXED_POINT
     uint32_t mask = 0;
     for (j = (offset - 2); j < (len + offset); j++) {
         real_t x;
@@ -14803,7 +14783,7 @@ void NeaacDecoder::auto_correlation(sbr_info* sbr, acorr_coef* ac, qmf_t buffer[
                   MUL_R(((QMF_RE(buffer[offset - 1][bd]) + (1 << (exp - 1))) >> exp), ((QMF_RE(buffer[offset - 2][bd]) + (1 << (exp - 1))) >> exp));
     RE(ac->r22) = r11 - MUL_R(((QMF_RE(buffer[len + offset - 2][bd]) + (1 << (exp - 1))) >> exp), ((QMF_RE(buffer[len + offset - 2][bd]) + (1 << (exp - 1))) >> exp)) +
                   MUL_R(((QMF_RE(buffer[offset - 2][bd]) + (1 << (exp - 1))) >> exp), ((QMF_RE(buffer[offset - 2][bd]) + (1 << (exp - 1))) >> exp));
-        #else
+    #else
     for (j = offset; j < len + offset; j++) {
         r01 += QMF_RE(buffer[j][bd]) * QMF_RE(buffer[j - 1][bd]);
         r02 += QMF_RE(buffer[j][bd]) * QMF_RE(buffer[j - 2][bd]);
@@ -14811,30 +14791,28 @@ void NeaacDecoder::auto_correlation(sbr_info* sbr, acorr_coef* ac, qmf_t buffer[
     }
     RE(ac->r12) = r01 - QMF_RE(buffer[len + offset - 1][bd]) * QMF_RE(buffer[len + offset - 2][bd]) + QMF_RE(buffer[offset - 1][bd]) * QMF_RE(buffer[offset - 2][bd]);
     RE(ac->r22) = r11 - QMF_RE(buffer[len + offset - 2][bd]) * QMF_RE(buffer[len + offset - 2][bd]) + QMF_RE(buffer[offset - 2][bd]) * QMF_RE(buffer[offset - 2][bd]);
-        #endif
+    #endif
     RE(ac->r01) = r01;
     RE(ac->r02) = r02;
     RE(ac->r11) = r11;
     ac->det = MUL_R(RE(ac->r11), RE(ac->r22)) - MUL_F(MUL_R(RE(ac->r12), RE(ac->r12)), rel);
 }
-    #endif //  SBR_LOW_POWER
-#endif     // SBR_DEC
+#endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifndef SBR_LOW_POWER
 void NeaacDecoder::auto_correlation(sbr_info* sbr, acorr_coef* ac, qmf_t buffer[MAX_NTSRHFG][64], uint8_t bd, uint8_t len) {
     real_t r01r = 0, r01i = 0, r02r = 0, r02i = 0, r11r = 0;
     real_t temp1_r, temp1_i, temp2_r, temp2_i, temp3_r, temp3_i, temp4_r, temp4_i, temp5_r, temp5_i;
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
     const real_t rel = FRAC_CONST(0.999999); // 1 / (1 + 1e-6f);
     uint32_t     mask, exp;
     real_t       pow2_to_exp;
-        #else
+    #else
     const real_t rel = 1 / (1 + 1e-6f);
-        #endif
+    #endif
     int8_t  j;
     uint8_t offset = sbr->tHFAdj;
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
     mask = 0;
     for (j = (offset - 2); j < (len + offset); j++) {
         real_t x;
@@ -14883,7 +14861,7 @@ void NeaacDecoder::auto_correlation(sbr_info* sbr, acorr_coef* ac, qmf_t buffer[
     RE(ac->r12) = r01r - (MUL_R(temp3_r, temp2_r) + MUL_R(temp3_i, temp2_i)) + (MUL_R(temp5_r, temp4_r) + MUL_R(temp5_i, temp4_i));
     IM(ac->r12) = r01i - (MUL_R(temp3_i, temp2_r) - MUL_R(temp3_r, temp2_i)) + (MUL_R(temp5_i, temp4_r) - MUL_R(temp5_r, temp4_i));
     RE(ac->r22) = r11r - (MUL_R(temp2_r, temp2_r) + MUL_R(temp2_i, temp2_i)) + (MUL_R(temp4_r, temp4_r) + MUL_R(temp4_i, temp4_i));
-        #else
+    #else
     temp2_r = QMF_RE(buffer[offset - 2][bd]);
     temp2_i = QMF_IM(buffer[offset - 2][bd]);
     temp3_r = QMF_RE(buffer[offset - 1][bd]);
@@ -14920,7 +14898,7 @@ void NeaacDecoder::auto_correlation(sbr_info* sbr, acorr_coef* ac, qmf_t buffer[
     RE(ac->r12) = r01r - (temp3_r * temp2_r + temp3_i * temp2_i) + (temp5_r * temp4_r + temp5_i * temp4_i);
     IM(ac->r12) = r01i - (temp3_i * temp2_r - temp3_r * temp2_i) + (temp5_i * temp4_r - temp5_r * temp4_i);
     RE(ac->r22) = r11r - (temp2_r * temp2_r + temp2_i * temp2_i) + (temp4_r * temp4_r + temp4_i * temp4_i);
-        #endif
+    #endif
     RE(ac->r01) = r01r;
     IM(ac->r01) = r01i;
     RE(ac->r02) = r02r;
@@ -14928,11 +14906,9 @@ void NeaacDecoder::auto_correlation(sbr_info* sbr, acorr_coef* ac, qmf_t buffer[
     RE(ac->r11) = r11r;
     ac->det = MUL_R(RE(ac->r11), RE(ac->r22)) - MUL_F(rel, (MUL_R(RE(ac->r12), RE(ac->r12)) + MUL_R(IM(ac->r12), IM(ac->r12))));
 }
-    #endif // SBR_LOW_POWER
-#endif     // SBR_DEC
+#endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifndef SBR_LOW_POWER
 /* calculate linear prediction coefficients using the covariance method */
 void NeaacDecoder::calc_prediction_coef(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][64], complex_t* alpha_0, complex_t* alpha_1, uint8_t k) {
     real_t     tmp;
@@ -14942,31 +14918,31 @@ void NeaacDecoder::calc_prediction_coef(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][6
         RE(alpha_1[k]) = 0;
         IM(alpha_1[k]) = 0;
     } else {
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
         tmp = (MUL_R(RE(ac.r01), RE(ac.r12)) - MUL_R(IM(ac.r01), IM(ac.r12)) - MUL_R(RE(ac.r02), RE(ac.r11)));
         RE(alpha_1[k]) = DIV_R(tmp, ac.det);
         tmp = (MUL_R(IM(ac.r01), RE(ac.r12)) + MUL_R(RE(ac.r01), IM(ac.r12)) - MUL_R(IM(ac.r02), RE(ac.r11)));
         IM(alpha_1[k]) = DIV_R(tmp, ac.det);
-        #else
+    #else
         tmp = REAL_CONST(1.0) / ac.det;
         RE(alpha_1[k]) = (MUL_R(RE(ac.r01), RE(ac.r12)) - MUL_R(IM(ac.r01), IM(ac.r12)) - MUL_R(RE(ac.r02), RE(ac.r11))) * tmp;
         IM(alpha_1[k]) = (MUL_R(IM(ac.r01), RE(ac.r12)) + MUL_R(RE(ac.r01), IM(ac.r12)) - MUL_R(IM(ac.r02), RE(ac.r11))) * tmp;
-        #endif
+    #endif
     }
     if (RE(ac.r11) == 0) {
         RE(alpha_0[k]) = 0;
         IM(alpha_0[k]) = 0;
     } else {
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
         tmp = -(RE(ac.r01) + MUL_R(RE(alpha_1[k]), RE(ac.r12)) + MUL_R(IM(alpha_1[k]), IM(ac.r12)));
         RE(alpha_0[k]) = DIV_R(tmp, RE(ac.r11));
         tmp = -(IM(ac.r01) + MUL_R(IM(alpha_1[k]), RE(ac.r12)) - MUL_R(RE(alpha_1[k]), IM(ac.r12)));
         IM(alpha_0[k]) = DIV_R(tmp, RE(ac.r11));
-        #else
+    #else
         tmp = 1.0f / RE(ac.r11);
         RE(alpha_0[k]) = -(RE(ac.r01) + MUL_R(RE(alpha_1[k]), RE(ac.r12)) + MUL_R(IM(alpha_1[k]), IM(ac.r12))) * tmp;
         IM(alpha_0[k]) = -(IM(ac.r01) + MUL_R(IM(alpha_1[k]), RE(ac.r12)) - MUL_R(RE(alpha_1[k]), IM(ac.r12))) * tmp;
-        #endif
+    #endif
     }
     if ((MUL_R(RE(alpha_0[k]), RE(alpha_0[k])) + MUL_R(IM(alpha_0[k]), IM(alpha_0[k])) >= REAL_CONST(16)) ||
         (MUL_R(RE(alpha_1[k]), RE(alpha_1[k])) + MUL_R(IM(alpha_1[k]), IM(alpha_1[k])) >= REAL_CONST(16))) {
@@ -14976,17 +14952,15 @@ void NeaacDecoder::calc_prediction_coef(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][6
         IM(alpha_1[k]) = 0;
     }
 }
-    #endif // SBR_LOW_POWER
-#endif     // SBR_DEC
+#endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
 void NeaacDecoder::calc_prediction_coef_lp(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][64], complex_t* alpha_0, complex_t* alpha_1, real_t* rxx) {
     uint8_t    k;
     real_t     tmp;
     acorr_coef ac;
     for (k = 1; k < sbr->f_master[0]; k++) {
-        auto_correlation(sbr, &ac, Xlow, k, sbr->numTimeSlotsRate + 6);
+        auto_correlation_lp(sbr, &ac, Xlow, k, sbr->numTimeSlotsRate + 6);
         if (ac.det == 0) {
             RE(alpha_0[k]) = 0;
             RE(alpha_1[k]) = 0;
@@ -15011,11 +14985,9 @@ void NeaacDecoder::calc_prediction_coef_lp(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG
         }
     }
 }
-    #endif // SBR_LOW_POWER
-#endif     // SBR_DEC
+#endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
 void NeaacDecoder::calc_aliasing_degree(sbr_info* sbr, real_t* rxx, real_t* deg) {
     uint8_t k;
     rxx[0] = COEF_CONST(0.0);
@@ -15040,8 +15012,7 @@ void NeaacDecoder::calc_aliasing_degree(sbr_info* sbr, real_t* rxx, real_t* deg)
         }
     }
 }
-    #endif // SBR_LOW_POWER
-#endif     // SBR_DEC
+#endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
 /* FIXED POINT: bwArray = COEF */
@@ -15256,8 +15227,7 @@ void NeaacDecoder::qmfs_end(qmfs_info* qmfs) {
 #endif /*SBR_DEC*/
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
-void NeaacDecoder::sbr_qmf_synthesis_32(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output) {
+void NeaacDecoder::sbr_qmf_synthesis_32_lp(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output) {
     real_t  x[16];
     real_t  y[16];
     int32_t n, k, out = 0;
@@ -15269,13 +15239,13 @@ void NeaacDecoder::sbr_qmf_synthesis_32(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[
         // memmove(qmfs->v + 64, qmfs->v, (640-64)*sizeof(real_t));
         /* calculate 64 samples */
         for (k = 0; k < 16; k++) {
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
             y[k] = (QMF_RE(X[l][k]) - QMF_RE(X[l][31 - k]));
             x[k] = (QMF_RE(X[l][k]) + QMF_RE(X[l][31 - k]));
-        #else
+    #else
             y[k] = (QMF_RE(X[l][k]) - QMF_RE(X[l][31 - k])) / 32.0;
             x[k] = (QMF_RE(X[l][k]) + QMF_RE(X[l][31 - k])) / 32.0;
-        #endif
+    #endif
         }
         /* even n samples */
         DCT2_16_unscaled(x, x);
@@ -15301,12 +15271,10 @@ void NeaacDecoder::sbr_qmf_synthesis_32(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[
         if (qmfs->v_index < 0) qmfs->v_index = (640 - 64);
     }
 }
-    #endif /*SBR_LOW_POWER*/
-#endif     /*SBR_DEC*/
+#endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
-void NeaacDecoder::sbr_qmf_synthesis_64(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output) {
+void NeaacDecoder::sbr_qmf_synthesis_64_lp(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output) {
     real_t  x[64];
     real_t  y[64];
     int32_t n, k, out = 0;
@@ -15318,13 +15286,13 @@ void NeaacDecoder::sbr_qmf_synthesis_64(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[
         // memmove(qmfs->v + 128, qmfs->v, (1280-128)*sizeof(real_t));
         /* calculate 128 samples */
         for (k = 0; k < 32; k++) {
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
             y[k] = (QMF_RE(X[l][k]) - QMF_RE(X[l][63 - k]));
             x[k] = (QMF_RE(X[l][k]) + QMF_RE(X[l][63 - k]));
-        #else
+    #else
             y[k] = (QMF_RE(X[l][k]) - QMF_RE(X[l][63 - k])) / 32.0;
             x[k] = (QMF_RE(X[l][k]) + QMF_RE(X[l][63 - k])) / 32.0;
-        #endif
+    #endif
         }
         /* even n samples */
         DCT2_32_unscaled(x, x);
@@ -15350,16 +15318,15 @@ void NeaacDecoder::sbr_qmf_synthesis_64(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[
         if (qmfs->v_index < 0) qmfs->v_index = (1280 - 128);
     }
 }
-    #endif /*SBR_LOW_POWER*/
-#endif     /*SBR_DEC*/
+#endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifndef SBR_LOW_POWER
 void NeaacDecoder::sbr_qmf_synthesis_32(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output) {
+    if (sbr->lowPower) { return sbr_qmf_synthesis_32_lp(sbr, qmfs, X, output); }
     real_t x1[32], x2[32];
-        #ifndef FIXED_POINT
+    #ifndef FIXED_POINT
     real_t scale = 1.f / 64.f;
-        #endif
+    #endif
     int32_t n, k, out = 0;
     uint8_t l;
     /* qmf subsample l */
@@ -15372,13 +15339,13 @@ void NeaacDecoder::sbr_qmf_synthesis_32(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[
         for (k = 0; k < 32; k++) {
             x1[k] = MUL_F(QMF_RE(X[l][k]), RE(qmf32_pre_twiddle[k])) - MUL_F(QMF_IM(X[l][k]), IM(qmf32_pre_twiddle[k]));
             x2[k] = MUL_F(QMF_IM(X[l][k]), RE(qmf32_pre_twiddle[k])) + MUL_F(QMF_RE(X[l][k]), IM(qmf32_pre_twiddle[k]));
-        #ifndef FIXED_POINT
+    #ifndef FIXED_POINT
             x1[k] *= scale;
             x2[k] *= scale;
-        #else
+    #else
             x1[k] >>= 1;
             x2[k] >>= 1;
-        #endif
+    #endif
         }
         /* transform */
         DCT4_32(x1, x1);
@@ -15400,21 +15367,18 @@ void NeaacDecoder::sbr_qmf_synthesis_32(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[
         if (qmfs->v_index < 0) qmfs->v_index = (640 - 64);
     }
 }
-    #endif /*SBR_LOW_POWER*/
-#endif     /*SBR_DEC*/
+#endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifndef SBR_LOW_POWER
 void NeaacDecoder::sbr_qmf_synthesis_64(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output) {
+    if (sbr->lowPower) { return sbr_qmf_synthesis_64_lp(sbr, qmfs, X, output); }
         //    real_t x1[64], x2[64];
-        #ifndef SBR_LOW_POWER
     real_t in_real1[32], in_imag1[32], out_real1[32], out_imag1[32];
     real_t in_real2[32], in_imag2[32], out_real2[32], out_imag2[32];
-        #endif
     qmf_t*  pX;
     real_t *pring_buffer_1, *pring_buffer_3;
         //    real_t * ptemp_1, * ptemp_2;
-        #ifdef PREFER_POINTERS
+    #ifdef PREFER_POINTERS
     // These pointers are used if target platform has autoinc address generators
     real_t *      pring_buffer_2, *pring_buffer_4;
     real_t *      pring_buffer_5, *pring_buffer_6;
@@ -15423,10 +15387,10 @@ void NeaacDecoder::sbr_qmf_synthesis_64(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[
     const real_t *pqmf_c_1, *pqmf_c_2, *pqmf_c_3, *pqmf_c_4;
     const real_t *pqmf_c_5, *pqmf_c_6, *pqmf_c_7, *pqmf_c_8;
     const real_t *pqmf_c_9, *pqmf_c_10;
-        #endif // #ifdef PREFER_POINTERS
-        #ifndef FIXED_POINT
+    #endif // #ifdef PREFER_POINTERS
+    #ifndef FIXED_POINT
     real_t scale = 1.f / 64.f;
-        #endif
+    #endif
     int32_t n, k, out = 0;
     uint8_t l;
     /* qmf subsample l */
@@ -15435,7 +15399,7 @@ void NeaacDecoder::sbr_qmf_synthesis_64(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[
             /* buffer is not shifted, we use double ringbuffer */
             // memmove(qmfs->v + 128, qmfs->v, (1280-128)*sizeof(real_t));
             /* calculate 128 samples */
-        #ifndef FIXED_POINT
+    #ifndef FIXED_POINT
         pX = X[l];
         in_imag1[31] = scale * QMF_RE(pX[1]);
         in_real1[0] = scale * QMF_RE(pX[0]);
@@ -15451,7 +15415,7 @@ void NeaacDecoder::sbr_qmf_synthesis_64(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[
         in_real1[31] = scale * QMF_RE(pX[62]);
         in_imag2[0] = scale * QMF_IM(pX[63 - 63]);
         in_real2[31] = scale * QMF_IM(pX[63 - 62]);
-        #else
+    #else
         pX = X[l];
         in_imag1[31] = QMF_RE(pX[1]) >> 1;
         in_real1[0] = QMF_RE(pX[0]) >> 1;
@@ -15467,19 +15431,19 @@ void NeaacDecoder::sbr_qmf_synthesis_64(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[
         in_real1[31] = QMF_RE(pX[62]) >> 1;
         in_imag2[0] = QMF_IM(pX[0]) >> 1;
         in_real2[31] = QMF_IM(pX[1]) >> 1;
-        #endif
+    #endif
         // dct4_kernel is DCT_IV without reordering which is done before and after FFT
         dct4_kernel(in_real1, in_imag1, out_real1, out_imag1);
         dct4_kernel(in_real2, in_imag2, out_real2, out_imag2);
         pring_buffer_1 = qmfs->v + qmfs->v_index;
         pring_buffer_3 = pring_buffer_1 + 1280;
-        #ifdef PREFER_POINTERS
+    #ifdef PREFER_POINTERS
         pring_buffer_2 = pring_buffer_1 + 127;
         pring_buffer_4 = pring_buffer_1 + (1280 + 127);
-        #endif // #ifdef PREFER_POINTERS
+    #endif // #ifdef PREFER_POINTERS
         //        ptemp_1 = x1;
         //        ptemp_2 = x2;
-        #ifdef PREFER_POINTERS
+    #ifdef PREFER_POINTERS
         for (n = 0; n < 32; n++) {
             // real_t x1 = *ptemp_1++;
             // real_t x2 = *ptemp_2++;
@@ -15491,7 +15455,7 @@ void NeaacDecoder::sbr_qmf_synthesis_64(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[
             *pring_buffer_1++ = *pring_buffer_3++ = out_imag2[31 - n] + out_imag1[31 - n];
             *pring_buffer_2-- = *pring_buffer_4-- = out_imag2[31 - n] - out_imag1[31 - n];
         }
-        #else  // #ifdef PREFER_POINTERS
+    #else  // #ifdef PREFER_POINTERS
         for (n = 0; n < 32; n++) {
             // pring_buffer_3 and pring_buffer_4 are needed only for double ring buffer
             pring_buffer_1[2 * n] = pring_buffer_3[2 * n] = out_real2[n] - out_real1[n];
@@ -15499,9 +15463,9 @@ void NeaacDecoder::sbr_qmf_synthesis_64(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[
             pring_buffer_1[2 * n + 1] = pring_buffer_3[2 * n + 1] = out_imag2[31 - n] + out_imag1[31 - n];
             pring_buffer_1[127 - (2 * n + 1)] = pring_buffer_3[127 - (2 * n + 1)] = out_imag2[31 - n] - out_imag1[31 - n];
         }
-        #endif // #ifdef PREFER_POINTERS
+    #endif // #ifdef PREFER_POINTERS
         pring_buffer_1 = qmfs->v + qmfs->v_index;
-        #ifdef PREFER_POINTERS
+    #ifdef PREFER_POINTERS
         pring_buffer_2 = pring_buffer_1 + 192;
         pring_buffer_3 = pring_buffer_1 + 256;
         pring_buffer_4 = pring_buffer_1 + (256 + 192);
@@ -15521,27 +15485,26 @@ void NeaacDecoder::sbr_qmf_synthesis_64(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[
         pqmf_c_8 = qmf_c + 448;
         pqmf_c_9 = qmf_c + 512;
         pqmf_c_10 = qmf_c + 576;
-        #endif // #ifdef PREFER_POINTERS
+    #endif // #ifdef PREFER_POINTERS
         /* calculate 64 output samples and window */
         for (k = 0; k < 64; k++) {
-        #ifdef PREFER_POINTERS
+    #ifdef PREFER_POINTERS
             output[out++] = MUL_F(*pring_buffer_1++, *pqmf_c_1++) + MUL_F(*pring_buffer_2++, *pqmf_c_2++) + MUL_F(*pring_buffer_3++, *pqmf_c_3++) + MUL_F(*pring_buffer_4++, *pqmf_c_4++) +
                             MUL_F(*pring_buffer_5++, *pqmf_c_5++) + MUL_F(*pring_buffer_6++, *pqmf_c_6++) + MUL_F(*pring_buffer_7++, *pqmf_c_7++) + MUL_F(*pring_buffer_8++, *pqmf_c_8++) +
                             MUL_F(*pring_buffer_9++, *pqmf_c_9++) + MUL_F(*pring_buffer_10++, *pqmf_c_10++);
-        #else  // #ifdef PREFER_POINTERS
+    #else  // #ifdef PREFER_POINTERS
             output[out++] = MUL_F(pring_buffer_1[k + 0], qmf_c[k + 0]) + MUL_F(pring_buffer_1[k + 192], qmf_c[k + 64]) + MUL_F(pring_buffer_1[k + 256], qmf_c[k + 128]) +
                             MUL_F(pring_buffer_1[k + (256 + 192)], qmf_c[k + 192]) + MUL_F(pring_buffer_1[k + 512], qmf_c[k + 256]) + MUL_F(pring_buffer_1[k + (512 + 192)], qmf_c[k + 320]) +
                             MUL_F(pring_buffer_1[k + 768], qmf_c[k + 384]) + MUL_F(pring_buffer_1[k + (768 + 192)], qmf_c[k + 448]) + MUL_F(pring_buffer_1[k + 1024], qmf_c[k + 512]) +
                             MUL_F(pring_buffer_1[k + (1024 + 192)], qmf_c[k + 576]);
-        #endif // #ifdef PREFER_POINTERS
+    #endif // #ifdef PREFER_POINTERS
         }
         /* update ringbuffer index */
         qmfs->v_index -= 128;
         if (qmfs->v_index < 0) qmfs->v_index = (1280 - 128);
     }
 }
-    #endif /*SBR_LOW_POWER*/
-#endif     /*SBR_DEC*/
+#endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
 qmfa_info* NeaacDecoder::qmfa_init(uint8_t channels) {
@@ -15568,11 +15531,8 @@ void NeaacDecoder::qmfa_end(qmfa_info* qmfa) {
 #ifdef SBR_DEC
 void NeaacDecoder::sbr_qmf_analysis_32(sbr_info* sbr, qmfa_info* qmfa, const real_t* input, qmf_t X[MAX_NTSRHFG][64], uint8_t offset, uint8_t kx) {
     real_t u[64];
-    #ifndef SBR_LOW_POWER
     real_t in_real[32], in_imag[32], out_real[32], out_imag[32];
-    #else
     real_t y[32];
-    #endif
     uint32_t in = 0;
     uint8_t  l;
     /* qmf subsample l */
@@ -15598,66 +15558,66 @@ void NeaacDecoder::sbr_qmf_analysis_32(sbr_info* sbr, qmfa_info* qmfa, const rea
         qmfa->x_index -= 32;
         if (qmfa->x_index < 0) qmfa->x_index = (320 - 32);
         /* calculate 32 subband samples by introducing X */
-    #ifdef SBR_LOW_POWER
-        y[0] = u[48];
-        for (n = 1; n < 16; n++) y[n] = u[n + 48] + u[48 - n];
-        for (n = 16; n < 32; n++) y[n] = -u[n - 16] + u[48 - n];
-        DCT3_32_unscaled(u, y);
-        for (n = 0; n < 32; n++) {
-            if (n < kx) {
-        #ifdef FIXED_POINT
-                QMF_RE(X[l + offset][n]) = u[n] /*<< 1*/;
-        #else
-                QMF_RE(X[l + offset][n]) = 2. * u[n];
-        #endif
-            } else {
-                QMF_RE(X[l + offset][n]) = 0;
-            }
-        }
+        if (sbr->lowPower) {
+            y[0] = u[48];
+            for (n = 1; n < 16; n++) y[n] = u[n + 48] + u[48 - n];
+            for (n = 16; n < 32; n++) y[n] = -u[n - 16] + u[48 - n];
+            DCT3_32_unscaled(u, y);
+            for (n = 0; n < 32; n++) {
+                if (n < kx) {
+    #ifdef FIXED_POINT
+                    QMF_RE(X[l + offset][n]) = u[n] /*<< 1*/;
     #else
-        // Reordering of data moved from DCT_IV to here
-        in_imag[31] = u[1];
-        in_real[0] = u[0];
-        for (n = 1; n < 31; n++) {
-            in_imag[31 - n] = u[n + 1];
-            in_real[n] = -u[64 - n];
-        }
-        in_imag[0] = u[32];
-        in_real[31] = -u[33];
-        // dct4_kernel is DCT_IV without reordering which is done before and after FFT
-        dct4_kernel(in_real, in_imag, out_real, out_imag);
-        // Reordering of data moved from DCT_IV to here
-        for (n = 0; n < 16; n++) {
-            if (2 * n + 1 < kx) {
-        #ifdef FIXED_POINT
-                QMF_RE(X[l + offset][2 * n]) = out_real[n];
-                QMF_IM(X[l + offset][2 * n]) = out_imag[n];
-                QMF_RE(X[l + offset][2 * n + 1]) = -out_imag[31 - n];
-                QMF_IM(X[l + offset][2 * n + 1]) = -out_real[31 - n];
-        #else
-                QMF_RE(X[l + offset][2 * n]) = 2. * out_real[n];
-                QMF_IM(X[l + offset][2 * n]) = 2. * out_imag[n];
-                QMF_RE(X[l + offset][2 * n + 1]) = -2. * out_imag[31 - n];
-                QMF_IM(X[l + offset][2 * n + 1]) = -2. * out_real[31 - n];
-        #endif
-            } else {
-                if (2 * n < kx) {
-        #ifdef FIXED_POINT
+                    QMF_RE(X[l + offset][n]) = 2. * u[n];
+    #endif
+                } else {
+                    QMF_RE(X[l + offset][n]) = 0;
+                }
+            }
+        } else {
+            // Reordering of data moved from DCT_IV to here
+            in_imag[31] = u[1];
+            in_real[0] = u[0];
+            for (n = 1; n < 31; n++) {
+                in_imag[31 - n] = u[n + 1];
+                in_real[n] = -u[64 - n];
+            }
+            in_imag[0] = u[32];
+            in_real[31] = -u[33];
+            // dct4_kernel is DCT_IV without reordering which is done before and after FFT
+            dct4_kernel(in_real, in_imag, out_real, out_imag);
+            // Reordering of data moved from DCT_IV to here
+            for (n = 0; n < 16; n++) {
+                if (2 * n + 1 < kx) {
+    #ifdef FIXED_POINT
                     QMF_RE(X[l + offset][2 * n]) = out_real[n];
                     QMF_IM(X[l + offset][2 * n]) = out_imag[n];
-        #else
+                    QMF_RE(X[l + offset][2 * n + 1]) = -out_imag[31 - n];
+                    QMF_IM(X[l + offset][2 * n + 1]) = -out_real[31 - n];
+    #else
                     QMF_RE(X[l + offset][2 * n]) = 2. * out_real[n];
                     QMF_IM(X[l + offset][2 * n]) = 2. * out_imag[n];
-        #endif
+                    QMF_RE(X[l + offset][2 * n + 1]) = -2. * out_imag[31 - n];
+                    QMF_IM(X[l + offset][2 * n + 1]) = -2. * out_real[31 - n];
+    #endif
                 } else {
-                    QMF_RE(X[l + offset][2 * n]) = 0;
-                    QMF_IM(X[l + offset][2 * n]) = 0;
+                    if (2 * n < kx) {
+    #ifdef FIXED_POINT
+                        QMF_RE(X[l + offset][2 * n]) = out_real[n];
+                        QMF_IM(X[l + offset][2 * n]) = out_imag[n];
+    #else
+                        QMF_RE(X[l + offset][2 * n]) = 2. * out_real[n];
+                        QMF_IM(X[l + offset][2 * n]) = 2. * out_imag[n];
+    #endif
+                    } else {
+                        QMF_RE(X[l + offset][2 * n]) = 0;
+                        QMF_IM(X[l + offset][2 * n]) = 0;
+                    }
+                    QMF_RE(X[l + offset][2 * n + 1]) = 0;
+                    QMF_IM(X[l + offset][2 * n + 1]) = 0;
                 }
-                QMF_RE(X[l + offset][2 * n + 1]) = 0;
-                QMF_IM(X[l + offset][2 * n + 1]) = 0;
             }
         }
-    #endif
     }
 }
 #endif /*SBR_DEC*/
@@ -46,7 +46,7 @@ class NeaacDecoder {
     void                     NeAACDecClose(NeAACDecHandle hpDecoder);
     uint8_t                  NeAACDecSetConfiguration(NeAACDecHandle hpDecoder, NeAACDecConfigurationPtr config);
     char                     NeAACDecInit2(NeAACDecHandle hpDecoder, uint8_t* pBuffer, uint32_t SizeOfDecoderSpecificInfo, uint32_t* samplerate, uint8_t* channels);
-    long                     NeAACDecInit(NeAACDecHandle hpDecoder, uint8_t* buffer, uint32_t buffer_size, uint32_t* samplerate, uint8_t* channels);
+    int32_t                  NeAACDecInit(NeAACDecHandle hpDecoder, uint8_t* buffer, uint32_t buffer_size, uint32_t* samplerate, uint8_t* channels);
     void*                    NeAACDecDecode2(NeAACDecHandle hpDecoder, NeAACDecFrameInfo* hInfo, uint8_t* buffer, uint32_t buffer_size, void** sample_buffer, uint32_t sample_buffer_size);
     error_info_t             NeAACDecGetErrorMessage(const uint8_t errcode);
     uint8_t                  get_sr_index(const uint32_t samplerate);
@@ -66,6 +66,7 @@ class NeaacDecoder {
     ps_ptr<complex_t>   m_work2048;
     ps_ptr<real_t>      m_G_temp_prev[48][2][5];
     ps_ptr<real_t>      m_Q_temp_prev[48][2][5];
+    ps_ptr<real_t>      m_dct32_tmp; // DCT4_32() and DST4_32(), allocated with the first SBR element
     ps_ptr<adif_header> m_adif;
     ps_ptr<adts_header> m_adts;
     ps_ptr<bitfile>     m_ld;
@@ -144,6 +145,7 @@ class NeaacDecoder {
     real_t    find_log2_Q(sbr_info* sbr, uint8_t k, uint8_t l, uint8_t ch);
     real_t    find_log2_Qplus1(sbr_info* sbr, uint8_t k, uint8_t l, uint8_t ch);
     void      auto_correlation(sbr_info* sbr, acorr_coef* ac, qmf_t buffer[MAX_NTSRHFG][64], uint8_t bd, uint8_t len);
+    void      auto_correlation_lp(sbr_info* sbr, acorr_coef* ac, qmf_t buffer[MAX_NTSRHFG][64], uint8_t bd, uint8_t len);
     real_t    mapNewBw(uint8_t invf_mode, uint8_t invf_mode_prev);
     uint8_t   max_pred_sfb(const uint8_t sr_index);
     uint8_t   max_tns_sfb(const uint8_t sr_index, const uint8_t object_type, const uint8_t is_short);
@@ -332,6 +334,7 @@ class NeaacDecoder {
     int16_t  real_to_int16(real_t sig_in);
     uint8_t  sbr_save_prev_data(sbr_info* sbr, uint8_t ch);
     void     sbr_save_matrix(sbr_info* sbr, uint8_t ch);
+    void     sbr_power_mode(sbr_info* sbr, uint8_t lowPower);
     fb_info* ssr_filter_bank_init(uint16_t frame_len);
     void     ssr_filter_bank_end(fb_info* fb);
     void     ssr_ifilter_bank(fb_info* fb, uint8_t window_sequence, uint8_t window_shape, uint8_t window_shape_prev, real_t* freq_in, real_t* time_out, uint16_t frame_len);
@@ -354,22 +357,17 @@ class NeaacDecoder {
     uint8_t  derived_frequency_table(sbr_info* sbr, uint8_t bs_xover_band, uint8_t k2);
     void     limiter_frequency_table(sbr_info* sbr);
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
     void calc_prediction_coef_lp(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][64], complex_t* alpha_0, complex_t* alpha_1, real_t* rxx);
     void calc_aliasing_degree(sbr_info* sbr, real_t* rxx, real_t* deg);
-    #else  // SBR_LOW_POWER
     void calc_prediction_coef(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][64], complex_t* alpha_0, complex_t* alpha_1, uint8_t k);
-    #endif // SBR_LOW_POWER
     void calc_chirp_factors(sbr_info* sbr, uint8_t ch);
     void patch_construction(sbr_info* sbr);
 #endif // SBR_DEC
 #ifdef SBR_DEC
     uint8_t estimate_current_envelope(sbr_info* sbr, sbr_hfadj_info* adj, qmf_t Xsbr[MAX_NTSRHFG][64], uint8_t ch);
     void    calculate_gain(sbr_info* sbr, sbr_hfadj_info* adj, uint8_t ch);
-    #ifdef SBR_LOW_POWER
-    void calc_gain_groups(sbr_info* sbr, sbr_hfadj_info* adj, real_t* deg, uint8_t ch);
-    void aliasing_reduction(sbr_info* sbr, sbr_hfadj_info* adj, real_t* deg, uint8_t ch);
-    #endif // SBR_LOW_POWER
+    void    calc_gain_groups(sbr_info* sbr, sbr_hfadj_info* adj, real_t* deg, uint8_t ch);
+    void    aliasing_reduction(sbr_info* sbr, sbr_hfadj_info* adj, real_t* deg, uint8_t ch);
     void hf_assembly(sbr_info* sbr, sbr_hfadj_info* adj, qmf_t Xsbr[MAX_NTSRHFG][64], uint8_t ch);
 #endif // SBR_DEC
     uint8_t    get_S_mapped(sbr_info* sbr, uint8_t ch, uint8_t l, uint8_t current_band);
@@ -380,6 +378,8 @@ class NeaacDecoder {
     void       sbr_qmf_analysis_32(sbr_info* sbr, qmfa_info* qmfa, const real_t* input, qmf_t X[MAX_NTSRHFG][64], uint8_t offset, uint8_t kx);
     void       sbr_qmf_synthesis_32(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output);
     void       sbr_qmf_synthesis_64(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output);
+    void       sbr_qmf_synthesis_32_lp(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output);
+    void       sbr_qmf_synthesis_64_lp(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output);
     uint8_t    envelope_time_border_vector(sbr_info* sbr, uint8_t ch);
     void       noise_floor_time_border_vector(sbr_info* sbr, uint8_t ch);
     void       hf_generation(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][64], qmf_t Xhigh[MAX_NTSRHFG][64], real_t* deg, uint8_t ch);
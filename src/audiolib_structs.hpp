@@ -1,8 +1,13 @@
 #pragma once
 #include "psram_unique_ptr.hpp"
+#include <FS.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstdint>
 #include <deque>
 #include <stddef.h>
+#include <utility>
 
 // this file contains definitions of various structs used in Audio lib
 
@@ -123,6 +128,7 @@ struct m4aHdr_t { // used in read_M4A_Header
 struct plCh_t { // used in playChunk
     esp_err_t err;
     bool      firstCall = false;
+    size_t    processed = 0; // words at the read position of SamplesBuff that went through the DSP chain, but not to the I2S
 };
 
 struct caSa_t { // used in cacheSamples
@@ -291,8 +297,14 @@ struct rwh_t { // used in read_WAV_Header
     uint32_t sampleRate = 0;
 };
 
+struct flacSeekPoint_t { // SEEKTABLE entry
+    uint32_t sample; // first sample of the target frame
+    uint32_t offset; // byte offset of the target frame, relative to the first frame header
+};
+
 typedef struct _rflh { // used in read_FLAC_Header
-    std::vector<uint32_t> picVec{};
+    std::vector<uint32_t>        picVec{};
+    std::vector<flacSeekPoint_t> seekTable{}; // sorted by sample, placeholders removed
     size_t                headerSize{};
     size_t                retvalue{};
     bool                  f_lastMetaBlock{};
@@ -306,6 +318,8 @@ typedef struct _rflh { // used in read_FLAC_Header
     uint32_t              maxFrameSize{};
     uint32_t              maxBlockSize{};
     uint32_t              totalSamplesInStream{};
+    uint32_t              seekPoints{}; // SEEKTABLE points not read yet
+    uint32_t              seekRest{};   // SEEKTABLE bytes behind the last complete point
 
     void reset() {
         // Default-initialize alles neu (inklusive Array)
@@ -313,6 +327,88 @@ typedef struct _rflh { // used in read_FLAC_Header
     }
 } rflh_t;
 
+struct mp3fi_t { // used in mp3_seekFilePos, frame index of MP3 files without TOC
+    static constexpr uint16_t step = 32;   // every 32th frame is indexed
+    std::vector<uint32_t>     pos{};       // file position of frame i * step
+    uint32_t                  frames = 0;  // frames walked through so far
+    uint32_t                  nextPos = 0; // file position of the frame behind them, 0 = not started
+    bool                      f_complete = false;
+};
+
+struct gapless_t {             // used at the end of a file, keeps the output running into the next one
+    bool     f_carry = false;   // SamplesBuff and I2S are not flushed, the next file continues seamlessly
+    uint32_t sampleRate = 0;    // format of the carried samples, a different format drains them first
+    uint8_t  channels = 0;
+};
+
+struct next_t { // used in queueNext(), queueNextHost(), the source that follows the current one
+    static constexpr uint32_t prefill = UINT16_MAX; // bytes in the InBuff of the queued source besides its header
+    static constexpr uint32_t leadTime = 10;        // s, a queued host is connected this long before the end of the current file
+    uint8_t                   type = 0;             // 0 = nothing queued, 1 = local file, 2 = host
+    fs::FS*                   fs = nullptr;
+    ps_ptr<char>              path; // file path or URL
+    ps_ptr<char>              user;
+    ps_ptr<char>              pwd;
+    int32_t                   fileStartTime = -1;
+    bool                      f_ready = false;   // header parsed, decoder initialized, InBuff prefilled, playNext() swaps it in
+    bool                      f_failed = false; // could not be prepared (stream, playlist, error), playNext() connects it the usual way
+
+    void reset() {
+        type = 0;
+        fs = nullptr;
+        path.reset();
+        user.reset();
+        pwd.reset();
+        fileStartTime = -1;
+        f_ready = false;
+        f_failed = false;
+    }
+};
+
+struct xfade_t {               // used in cacheSamples(), playChunk(), crossfade between the end of a file and the beginning of the queued one
+    uint16_t ms = 0;             // duration, 0 = off
+    bool     f_fading = false;   // XfadeBuff holds the end of the previous file, it is mixed into the new one
+    size_t   skip = 0;           // words in SamplesBuff that still belong to the previous file
+    uint32_t pos = 0;            // frames mixed so far
+    uint32_t frames = 0;         // length of the fade in frames
+    uint32_t sampleRate = 0;     // of the frames in XfadeBuff
+
+    // equal power: the outgoing frames are weighted with cos, the incoming ones with sin of pi/2 * pos / len
+    static void mix(int32_t* in, const int32_t* out, size_t n, uint32_t pos, uint32_t len) {
+        const float dth = 1.5707963f / len;
+        const float kd = 2 * sinf(dth / 2) * sinf(dth / 2), sd = sinf(dth); // 1 - cos(dth): cosf(dth) rounds to 1.0f for long fades
+        float       c = 0, s = 0;
+        for (size_t i = 0; i < n; i++) {
+            if ((i & 31) == 0) { // restart the rotation, the float rounding drifts by about 1e-7 per frame
+                c = cosf(dth * (pos + i));
+                s = sinf(dth * (pos + i));
+            }
+            const int64_t gOut = (int64_t)(c * 2147483647.0f);
+            const int64_t gIn = (int64_t)(s * 2147483647.0f);
+            for (int ch = 0; ch < 2; ch++) {
+                int64_t v = ((int64_t)out[2 * i + ch] * gOut + (int64_t)in[2 * i + ch] * gIn) >> 31;
+                if (v > INT32_MAX) v = INT32_MAX;
+                if (v < INT32_MIN) v = INT32_MIN;
+                in[2 * i + ch] = (int32_t)v;
+            }
+            const float c1 = c - (c * kd + s * sd);
+            s = s - (s * kd - c * sd);
+            c = c1;
+        }
+    }
+};
+
+struct audioTaskStats_t {  // counted in audioTask(), see getAudioTaskStats()
+    uint32_t wakeups = 0;  // returns from the wait for the I2S DMA
+    uint32_t timeouts = 0; // wakeups without a DMA notification
+    uint32_t rounds = 0;   // performAudioTask() calls
+    uint32_t work = 0;     // work units: DMA buffers written, sample blocks cached, decoder calls
+    uint32_t inPlace = 0;  // decoded frames written straight into SamplesBuff (zero-copy)
+    uint32_t copied = 0;   // decoded frames that went through m_outBuff and cacheSamples()
+    uint64_t busyUs = 0;   // time in performAudioTask()
+    uint64_t idleUs = 0;   // time blocked
+};
+
 typedef struct _phreh { // used in parseHttpResponseHeader
     uint32_t ctime{};
     uint32_t timeout{};
@@ -346,17 +442,59 @@ struct fnsy_t { // used in findNextSync
     uint32_t swnf = 0;
 };
 
+struct eq_t { // parametric EQ of up to MAX_BANDS biquads, setEqBand() and setTone() (band 0...2), runs in dsp_t::process()
+    static constexpr uint8_t MAX_BANDS = 10;
+    static constexpr uint8_t RAMP_STEPS = 32; // new coefficients glide in over 32 blocks of dsp_t::CHUNK frames, 23 ms at 44.1 kHz
+    static constexpr int     COEFF_FRAC = 26; // fixed point coefficients Q5.26, b0 of a +24 dB shelf is up to 15.85 (the gain at Nyquist)
+    enum : uint8_t { OFF = 0, PEAK, LOWSHELF, HIGHSHELF, LOWPASS, HIGHPASS, NOTCH, BANDPASS };
+
+    struct band_t {
+        uint8_t type = OFF;
+        float   freq = 1000.0f; // Hz, center or corner frequency
+        float   q = 0.707f;     // quality, for the shelves the slope S (1 = steepest without overshoot) as in esp-dsp
+        float   gain = 0.0f;    // dB, PEAK, LOWSHELF, HIGHSHELF
+    };
+
+    band_t  band[MAX_BANDS];
+    float   target[MAX_BANDS][5];       // b0, b1, b2, a1, a2 of the settings
+    float   coeffs[MAX_BANDS][5];       // in use, glide towards target
+    float   state[MAX_BANDS][4]{};      // w1, w2 left, w1, w2 right
+    int32_t coeffs_q31[MAX_BANDS][5]{}; // coeffs in Q26, fixed point EQ (settings.IIR_Q31)
+    int64_t state_q31[MAX_BANDS][4]{};  // z1, z2 left, z1, z2 right
+    float   pre_gain = 1.0f;            // headroom for the largest boost of the whole cascade
+    float   target_pre_gain = 1.0f;
+    int32_t pre_gain_q31 = INT32_MAX;
+    uint8_t stage[MAX_BANDS]{}; // bands that are not flat (or still glide), in order, the cost is one biquad per stage
+    uint8_t stages = 0;
+    uint8_t ramp = 0; // steps until coeffs == target
+
+    eq_t() {
+        for (int b = 0; b < MAX_BANDS; b++) identity(target[b]), identity(coeffs[b]);
+    }
+    static void identity(float* c) { c[0] = 1.0f, c[1] = c[2] = c[3] = c[4] = 0.0f; }
+    static bool isIdentity(const float* c) { return c[0] == 1.0f && !c[1] && !c[2] && !c[3] && !c[4]; }
+    static bool isFlat(const band_t& b) { return b.type == OFF || (b.type <= HIGHSHELF && b.gain == 0.0f); }
+    static void toFixed(const float* c, int32_t* q) { // |b0| <= 15.85 and |a1| < 2 for gains of -24 ... +24 dB
+        for (int k = 0; k < 5; k++) q[k] = (int32_t)lrintf(std::clamp(c[k], -31.99f, 31.99f) * (float)(1 << COEFF_FRAC));
+    }
+
+    static void   biquadCoeffs(const band_t& b, float fs, float* c); // RBJ audio EQ cookbook, normalized to a0 = 1, see dsp.cpp
+    static double magnitude(const float* c, double w);               // |H(e^jw)| of one stage
+    void          update(float fs, bool glide = true);               // after a change of the bands or the sample rate
+    void          step();                                            // one block of the glide, called by the kernel before the stages run
+    void clearHistory() {
+        memset(state, 0, sizeof(state));
+        memset(state_q31, 0, sizeof(state_q31));
+    }
+};
+
 struct audioItems_t {
-    float   gain_ls_db = 0.0;  // lowshelf
-    float   gain_peq_db = 0.0; // peakingEQudio_process_i2s
-    float   gain_hs_db = 0.0;  // highshelf
-    float   pre_gain = 0.0;    // correction factor for level adjustment
-    float   coeffs[3][5] = {0};
-    float   state_biquad[3][4] = {0};
+    eq_t    eq;
     uint8_t volume = 0;
     uint8_t volume_steps = 21;
     float   cur_volume = 0.0f;
     float   limiter[2] = {0};
+    int32_t gain[2] = {0};  // Q30, the gain the DSP kernel applied last, it glides to limiter within the next block, set to limiter at the start of a stream and after a seek
     float   balance = 0.0f; // -16.0 dB left ... 0 ... -16 db right
     bool    mute = false;
 };
@@ -400,6 +538,19 @@ typedef struct _vu_items_t {
     }
 } vu_items_t;
 
+struct dsp_t { // state of the fused DSP kernel of processSamples(): VU meter, EQ, mono downmix, volume/balance, see dsp.cpp
+    enum : uint8_t { VU = 1, EQ = 2, MONO = 4, GAIN = 8, Q31 = 16 }; // Q31: fixed point EQ instead of float
+    typedef void (*kernel_t)(int32_t* buff, size_t frames, audioItems_t& a, vu_items_t& vu);
+    static constexpr size_t  CHUNK = 32;                 // frames per EQ block, held on the stack while the stages run over it
+    static constexpr int     GAIN_FRAC = 30;             // volume/balance gain Q30, 0 ... 1.0 (calculateVolumeLimits() ends at 0 dB)
+    static constexpr int32_t GAIN_ONE = 1 << GAIN_FRAC; // unity, bit exact
+
+    uint8_t  flags = 0xFF; // features of the selected kernel, 0xFF = none selected yet
+    kernel_t kernel = nullptr;
+
+    void select(uint8_t f, audioItems_t& a); // called when the enabled features change
+};
+
 typedef struct _fft_items_t {
     size_t                       count{};
     size_t                       samps_x_ms{};
@@ -436,21 +587,6 @@ struct BiquadCoeffs {
     int64_t a2;
 };
 
-struct resampler_t {
-    static constexpr size_t MAX_IN_FRAMES = 4608;
-    static constexpr size_t MAX_OUT_FRAMES = 10500;
-    uint64_t                phase = 0;
-    uint64_t                phaseStep = 0;
-    Biquad                  lpLeft;
-    Biquad                  lpRight;
-    uint32_t                outFrames = 0;
-    BiquadCoeffs            g_lpCoeffs;
-    // Condition for continuous interpolation between frames
-    int32_t lastL = 0;       // Last left sample from previous frame
-    int32_t lastR = 0;       // Last right sample from previous frame
-    bool    hasLast = false; // First frame has no “last”
-};
-
 struct InfoItem {
     ps_ptr<char>          msg;
     ps_ptr<char>          s;
@@ -0,0 +1,225 @@
+#pragma GCC optimize("Ofast") // as in Audio.h
+#include "dsp.h"
+
+// created 18.10.2026
+// fused DSP kernel of processSamples() and the coefficients of the EQ, moved out of audiolib_structs.hpp so that the
+// header keeps the state only
+
+namespace audiolib {
+namespace dsp {
+
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void biquadBlock(float* x, size_t n, const float* c, float* w) {
+    const float b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+    float       l1 = w[0], l2 = w[1], r1 = w[2], r2 = w[3];
+    for (size_t i = 0; i < n; i++) {
+        float dl = x[2 * i] - a1 * l1 - a2 * l2;
+        float dr = x[2 * i + 1] - a1 * r1 - a2 * r2;
+        x[2 * i] = b0 * dl + b1 * l1 + b2 * l2;
+        x[2 * i + 1] = b0 * dr + b1 * r1 + b2 * r2;
+        l2 = l1;
+        l1 = dl;
+        r2 = r1;
+        r1 = dr;
+    }
+    w[0] = l1, w[1] = l2, w[2] = r1, w[3] = r2;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void biquadBlockQ31(int32_t* x, size_t n, const int32_t* c, int64_t* z) {
+    const int64_t b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+    const int64_t round = 1LL << (eq_t::COEFF_FRAC - 1);
+    int64_t       l1 = z[0], l2 = z[1], r1 = z[2], r2 = z[3];
+    for (size_t i = 0; i < n; i++) {
+        int64_t xl = x[2 * i], xr = x[2 * i + 1];
+        int64_t yl = sat32((b0 * xl + l1 + round) >> eq_t::COEFF_FRAC);
+        int64_t yr = sat32((b0 * xr + r1 + round) >> eq_t::COEFF_FRAC);
+        l1 = b1 * xl - a1 * yl + l2;
+        r1 = b1 * xr - a1 * yr + r2;
+        l2 = b2 * xl - a2 * yl;
+        r2 = b2 * xr - a2 * yr;
+        x[2 * i] = (int32_t)yl;
+        x[2 * i + 1] = (int32_t)yr;
+    }
+    z[0] = l1, z[1] = l2, z[2] = r1, z[3] = r2;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// one instance per feature combination, the disabled stages are not compiled in. The VU meter sees the samples before
+// EQ and volume, the window is evaluated by the caller (frames must not exceed the rest of the window). With EQ the
+// block is split into chunks of CHUNK frames that are copied to the stack (float or Q31), every stage of the cascade
+// (eq_t, one per band that is not flat) runs over a whole chunk, PSRAM is read and written once per sample.
+// The gain goes linearly from the value of the previous block (a.gain) to limiter over the frames of this block, a
+// volume step of gain_ramp() is spread over every sample instead of a step (zipper noise). Blocks without a change take
+// an instance without the ramp, a constant 32 bit x 32 bit -> 64 bit multiply (the gain is clamped to 1.0, no compare
+// per sample for the saturation).
+template <uint8_t F> static void process(int32_t* buff, size_t frames, audioItems_t& a, vu_items_t& vu) {
+    constexpr size_t CHUNK = dsp_t::CHUNK;
+    int32_t          gainL = a.gain[0], gainR = a.gain[1], stepL = 0, stepR = 0;
+    uint64_t         sumL = vu.sumL, sumR = vu.sumR;
+    uint8_t          maxL = vu.maxLeft, maxR = vu.maxRight;
+    if constexpr (F & dsp_t::GAIN) {
+        const int32_t targetL = toGain(a.limiter[0]), targetR = toGain(a.limiter[1]);
+        stepL = (targetL - gainL) / (int32_t)std::max<size_t>(frames, 1);
+        stepR = (targetR - gainR) / (int32_t)std::max<size_t>(frames, 1);
+        a.gain[0] = targetL; // the rest of the division (< frames / 2^30) is left for the last sample
+        a.gain[1] = targetR;
+    }
+
+    auto pre = [&](int32_t l, int32_t r) {
+        if constexpr (F & dsp_t::VU) {
+            uint8_t vl = toVU(l), vr = toVU(r);
+            sumL += vl;
+            sumR += vr;
+            if (vl > maxL) maxL = vl;
+            if (vr > maxR) maxR = vr;
+        }
+    };
+    // the ramp only runs in the block of a volume change, a steady gain (the usual case) is a constant multiply
+    auto run = [&]<bool RAMP>() {
+        auto post = [&](int32_t* p, int32_t l, int32_t r, [[maybe_unused]] size_t i) { // i: frame in the block
+            if constexpr (F & dsp_t::MONO) l = r = (int32_t)(((int64_t)l + r) >> 1); // average, without overflow
+            if constexpr ((F & dsp_t::GAIN) && RAMP) {
+                const int32_t k = (int32_t)i + 1; // the last frame reaches the target
+                l = applyGain(l, gainL + stepL * k);
+                r = applyGain(r, gainR + stepR * k);
+            } else if constexpr (F & dsp_t::GAIN) {
+                l = applyGain(l, gainL);
+                r = applyGain(r, gainR);
+            }
+            p[0] = l;
+            p[1] = r;
+        };
+
+        if constexpr (!(F & dsp_t::EQ)) {
+            for (size_t i = 0; i < frames; i++) {
+                pre(buff[2 * i], buff[2 * i + 1]);
+                if constexpr (F & (dsp_t::MONO | dsp_t::GAIN)) post(buff + 2 * i, buff[2 * i], buff[2 * i + 1], i);
+            }
+        } else {
+            eq_t& eq = a.eq;
+            for (size_t pos = 0; pos < frames; pos += CHUNK) {
+                const size_t n = std::min(CHUNK, frames - pos);
+                int32_t*     p = buff + 2 * pos;
+                if (eq.ramp) eq.step(); // coefficients glide to new settings
+                if constexpr (F & dsp_t::Q31) {
+                    int32_t x[2 * CHUNK];
+                    for (size_t i = 0; i < n; i++) {
+                        pre(p[2 * i], p[2 * i + 1]);
+                        x[2 * i] = (int32_t)(((int64_t)p[2 * i] * eq.pre_gain_q31) >> 31);
+                        x[2 * i + 1] = (int32_t)(((int64_t)p[2 * i + 1] * eq.pre_gain_q31) >> 31);
+                    }
+                    for (uint8_t k = 0; k < eq.stages; k++) biquadBlockQ31(x, n, eq.coeffs_q31[eq.stage[k]], eq.state_q31[eq.stage[k]]);
+                    for (size_t i = 0; i < n; i++) post(p + 2 * i, x[2 * i], x[2 * i + 1], pos + i);
+                } else {
+                    float x[2 * CHUNK];
+                    for (size_t i = 0; i < n; i++) {
+                        pre(p[2 * i], p[2 * i + 1]);
+                        x[2 * i] = (float)(p[2 * i] * eq.pre_gain);
+                        x[2 * i + 1] = (float)(p[2 * i + 1] * eq.pre_gain);
+                    }
+                    for (uint8_t k = 0; k < eq.stages; k++) biquadBlock(x, n, eq.coeffs[eq.stage[k]], eq.state[eq.stage[k]]);
+                    for (size_t i = 0; i < n; i++) post(p + 2 * i, (int32_t)std::clamp(x[2 * i], -2147483648.0f, 2147483647.0f), (int32_t)std::clamp(x[2 * i + 1], -2147483648.0f, 2147483647.0f), pos + i);
+                }
+            }
+        }
+    };
+    if ((F & dsp_t::GAIN) && (stepL || stepR))
+        run.template operator()<(F & dsp_t::GAIN) != 0>(); // without GAIN the ramp is not instantiated
+    else
+        run.template operator()<false>();
+
+    if constexpr (F & dsp_t::VU) {
+        vu.sumL = sumL;
+        vu.sumR = sumR;
+        vu.maxLeft = maxL;
+        vu.maxRight = maxR;
+        vu.samps_count += frames;
+    }
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+template <size_t... I> static constexpr std::array<dsp_t::kernel_t, sizeof...(I)> table(std::index_sequence<I...>) { // Q31 only counts with EQ
+    return {process<((I & dsp_t::Q31) && !(I & dsp_t::EQ)) ? (I & ~dsp_t::Q31) : I>...};
+}
+
+} // namespace dsp
+
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void dsp_t::select(uint8_t f, audioItems_t& a) {
+    static constexpr std::array<kernel_t, 32> kernels = dsp::table(std::make_index_sequence<32>{});
+    if ((f & (EQ | Q31)) != (flags & (EQ | Q31))) a.eq.clearHistory(); // no history from before the EQ or its backend was off
+    flags = f;
+    kernel = kernels[f & 31];
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void eq_t::biquadCoeffs(const band_t& b, float fs, float* c) {
+    float f = std::clamp(b.freq, 10.0f, 0.49f * fs), Q = std::clamp(b.q, 0.1f, 20.0f), g = std::clamp(b.gain, -24.0f, 24.0f);
+    float A = powf(10.0f, g / 40.0f), w0 = 2.0f * (float)M_PI * f / fs, cw = cosf(w0), alpha = sinf(w0) / (2.0f * Q);
+    float b0 = 1, b1 = 0, b2 = 0, a0 = 1, a1 = 0, a2 = 0;
+    switch (b.type) {
+        case PEAK: b0 = 1 + alpha * A, b1 = -2 * cw, b2 = 1 - alpha * A, a0 = 1 + alpha / A, a1 = -2 * cw, a2 = 1 - alpha / A; break;
+        case LOWSHELF:
+        case HIGHSHELF: {
+            // Q is the shelf slope S, the same as dsps_biquad_gen_lowShelf_f32() / highShelf_f32() took it from setTone()
+            // (settings.QUALITY_SLOPE). Above S = 1 the root gets negative for large gains, it is limited to 0 there
+            alpha = sinf(w0) / 2 * sqrtf(std::max(0.0f, (A + 1 / A) * (1 / Q - 1) + 2));
+            float s = b.type == LOWSHELF ? 1.0f : -1.0f, sa = 2 * sqrtf(A) * alpha; // the high shelf mirrors the signs of cos
+            b0 = A * ((A + 1) - s * (A - 1) * cw + sa), b1 = 2 * s * A * ((A - 1) - s * (A + 1) * cw), b2 = A * ((A + 1) - s * (A - 1) * cw - sa);
+            a0 = (A + 1) + s * (A - 1) * cw + sa, a1 = -2 * s * ((A - 1) + s * (A + 1) * cw), a2 = (A + 1) + s * (A - 1) * cw - sa;
+            break;
+        }
+        case LOWPASS: b0 = (1 - cw) / 2, b1 = 1 - cw, b2 = (1 - cw) / 2, a0 = 1 + alpha, a1 = -2 * cw, a2 = 1 - alpha; break;
+        case HIGHPASS: b0 = (1 + cw) / 2, b1 = -(1 + cw), b2 = (1 + cw) / 2, a0 = 1 + alpha, a1 = -2 * cw, a2 = 1 - alpha; break;
+        case NOTCH: b0 = 1, b1 = -2 * cw, b2 = 1, a0 = 1 + alpha, a1 = -2 * cw, a2 = 1 - alpha; break;
+        case BANDPASS: b0 = alpha, b1 = 0, b2 = -alpha, a0 = 1 + alpha, a1 = -2 * cw, a2 = 1 - alpha; break;
+        default: break;
+    }
+    c[0] = b0 / a0, c[1] = b1 / a0, c[2] = b2 / a0, c[3] = a1 / a0, c[4] = a2 / a0;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+double eq_t::magnitude(const float* c, double w) {
+    double cr = cos(w), ci = -sin(w), c2r = cos(2 * w), c2i = -sin(2 * w);
+    double nr = c[0] + c[1] * cr + c[2] * c2r, ni = c[1] * ci + c[2] * c2i;
+    double dr = 1 + c[3] * cr + c[4] * c2r, di = c[3] * ci + c[4] * c2i;
+    return sqrt((nr * nr + ni * ni) / (dr * dr + di * di));
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void eq_t::update(float fs, bool glide) {
+    for (int b = 0; b < MAX_BANDS; b++) {
+        if (isFlat(band[b]))
+            identity(target[b]);
+        else
+            biquadCoeffs(band[b], fs, target[b]);
+    }
+    double peak = 1.0; // largest gain of the cascade, on a log grid from 20 Hz and at the band frequencies
+    for (int i = 0; i < 64 + MAX_BANDS; i++) {
+        double f = i < 64 ? 20.0 * pow(1000.0, i / 63.0) : band[i - 64].freq;
+        if (f >= 0.5 * fs || (i >= 64 && isFlat(band[i - 64]))) continue;
+        double m = 1.0;
+        for (int b = 0; b < MAX_BANDS; b++)
+            if (!isIdentity(target[b])) m *= magnitude(target[b], 2 * M_PI * f / fs);
+        peak = std::max(peak, m);
+    }
+    target_pre_gain = (float)(1.0 / peak);
+    ramp = glide ? RAMP_STEPS : 1;
+    step();
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void eq_t::step() {
+    if (!ramp) return;
+    for (int b = 0; b < MAX_BANDS; b++)
+        for (int k = 0; k < 5; k++) coeffs[b][k] = ramp == 1 ? target[b][k] : coeffs[b][k] + (target[b][k] - coeffs[b][k]) / ramp;
+    pre_gain = ramp == 1 ? target_pre_gain : pre_gain + (target_pre_gain - pre_gain) / ramp;
+    ramp--;
+
+    bool was[MAX_BANDS] = {};
+    for (uint8_t k = 0; k < stages; k++) was[stage[k]] = true;
+    stages = 0;
+    for (uint8_t b = 0; b < MAX_BANDS; b++) {
+        if (isIdentity(target[b]) && isIdentity(coeffs[b])) continue;
+        if (!was[b]) memset(state[b], 0, sizeof(state[b])), memset(state_q31[b], 0, sizeof(state_q31[b])); // new in the cascade
+        toFixed(coeffs[b], coeffs_q31[b]);
+        stage[stages++] = b;
+    }
+    pre_gain_q31 = (int32_t)std::min(pre_gain * 2147483648.0, 2147483647.0);
+}
+
+} // namespace audiolib
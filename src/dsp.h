@@ -0,0 +1,23 @@
+#pragma once
+#include "audiolib_structs.hpp"
+
+// sample helpers and biquad stages of the fused DSP kernel (dsp.cpp), the state is dsp_t and eq_t in audiolib_structs.hpp
+
+namespace audiolib {
+namespace dsp {
+
+inline uint8_t toVU(int32_t sample) { // magnitude 0...255
+    uint32_t mag = sample < 0 ? (uint32_t)(-(int64_t)sample) : (uint32_t)sample;
+    return std::min<uint32_t>(mag >> 23, 255);
+}
+inline int32_t sat32(int64_t x) { return x > INT32_MAX ? INT32_MAX : x < INT32_MIN ? INT32_MIN : (int32_t)x; }
+inline int32_t toGain(float g) { return (int32_t)lrintf(std::clamp(g, 0.0f, 1.0f) * (float)dsp_t::GAIN_ONE); } // saturates the gain, not the samples
+inline int32_t applyGain(int32_t x, int32_t g) { return (int32_t)(((int64_t)x * g + (1 << (dsp_t::GAIN_FRAC - 1))) >> dsp_t::GAIN_FRAC); } // rounded, |x * g| <= |x|
+
+// one biquad stage over a block of n interleaved stereo frames (both channels in one loop, two independent recursions),
+// c = {b0, b1, b2, a1, a2}
+void biquadBlock(float* x, size_t n, const float* c, float* w);             // direct form II like dsps_biquad_sf32(), w = {w1, w2} left, right
+void biquadBlockQ31(int32_t* x, size_t n, const int32_t* c, int64_t* z); // transposed direct form II, Q31 samples, Q26 coefficients, z = {z1, z2} left, right
+
+} // namespace dsp
+} // namespace audiolib
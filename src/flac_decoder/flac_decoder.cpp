@@ -10,11 +10,63 @@
  *
  */
 #include "flac_decoder.h"
+#include <array>
+#include <utility>
 
 namespace {
 constexpr uint32_t FLAC_MAX_VORBIS_VENDOR_LENGTH = 1024;
 constexpr uint32_t FLAC_MAX_VORBIS_COMMENT_ENTRY_LENGTH = 1024 * 1024;
+
+// Prediction kernels, specialized on the order and on the accumulator width. With the order known at compile time the inner
+// loop is unrolled and the coefficients stay in registers, int32_t is used whenever the sum cannot overflow.
+// T is the sample type, int32_t or int64_t (wide path for 32 bit streams)
+template <int32_t ORDER, typename ACC, typename T> void lpcKernel(T* s, const int32_t* coefs, int32_t n, uint8_t shift) {
+    int32_t c[ORDER];
+    for (int32_t j = 0; j < ORDER; j++) c[j] = coefs[j];
+    for (int32_t i = ORDER; i < n; i++) {
+        ACC sum = 0;
+        for (int32_t j = 0; j < ORDER; j++) sum += (ACC)c[j] * (ACC)s[i - 1 - j];
+        s[i] += (sum >> shift);
+    }
+}
+
+template <typename T> using lpcKernel_t = void (*)(T*, const int32_t*, int32_t, uint8_t);
+
+template <typename ACC, typename T, size_t... I> constexpr std::array<lpcKernel_t<T>, sizeof...(I)> lpcKernelTable(std::index_sequence<I...>) {
+    return {lpcKernel<(int32_t)I + 1, ACC, T>...};
+}
+constexpr auto lpcKernels32 = lpcKernelTable<int32_t, int32_t>(std::make_index_sequence<32>{}); // order 1...32
+constexpr auto lpcKernels64 = lpcKernelTable<int64_t, int32_t>(std::make_index_sequence<32>{});
+constexpr auto lpcKernelsWide = lpcKernelTable<int64_t, int64_t>(std::make_index_sequence<32>{});
+
+// fixed predictors, coefficients {1}, {2, -1}, {3, -3, 1}, {4, -6, 4, -1}
+template <int32_t ORDER, typename ACC, typename T> void fixedKernel(T* s, int32_t n) {
+    for (int32_t i = ORDER; i < n; i++) {
+        ACC p;
+        if constexpr (ORDER == 1) p = (ACC)s[i - 1];
+        if constexpr (ORDER == 2) p = 2 * (ACC)s[i - 1] - (ACC)s[i - 2];
+        if constexpr (ORDER == 3) p = 3 * ((ACC)s[i - 1] - (ACC)s[i - 2]) + (ACC)s[i - 3];
+        if constexpr (ORDER == 4) p = 4 * ((ACC)s[i - 1] + (ACC)s[i - 3]) - 6 * (ACC)s[i - 2] - (ACC)s[i - 4];
+        s[i] += p;
+    }
+}
+
+template <typename ACC, typename T> void fixedKernel(T* s, int32_t n, uint8_t order) {
+    switch (order) {
+        case 1: fixedKernel<1, ACC>(s, n); break;
+        case 2: fixedKernel<2, ACC>(s, n); break;
+        case 3: fixedKernel<3, ACC>(s, n); break;
+        case 4: fixedKernel<4, ACC>(s, n); break;
+        default: break; // order 0: the residuals are the samples
+    }
+}
+
+uint8_t ceilLog2(uint32_t v) {
+    uint8_t n = 0;
+    while ((1U << n) < v) n++;
+    return n;
 }
+} // namespace
 
 //----------------------------------------------------------------------------------------------------------------------
 //          FLAC INI SECTION
@@ -57,6 +109,8 @@ void FlacDecoder::clear() {
 
     m_samplesBuffer[0].clear();
     m_samplesBuffer[1].clear();
+    m_samplesBufferWide[0].clear();
+    m_samplesBufferWide[1].clear();
     coefs.clear();
     m_flacSegmTableVec.clear();
     m_flacStatus = DECODE_FRAME;
@@ -71,6 +125,8 @@ void FlacDecoder::reset() {
 
     m_samplesBuffer[0].reset();
     m_samplesBuffer[1].reset();
+    m_samplesBufferWide[0].reset();
+    m_samplesBufferWide[1].reset();
     coefs.clear();
     m_flacSegmTableVec.clear();
     m_flacBlockPicItem.clear();
@@ -154,6 +210,55 @@ uint32_t FlacDecoder::readUint(uint8_t nBits, int32_t* bytesLeft) {
 void FlacDecoder::alignToByte() {
     m_flacBitBufferLen -= m_flacBitBufferLen % 8;
 }
+
+// The residuals are read through a bit cache: m_flac_bitBuffer is filled up to 57...64 bits, the unary part of a Rice code is
+// counted with clz and the remainder is taken with one shift. readUint() leaves less than 8 bits in the buffer, the cache does not,
+// therefore the bytes that were fetched in advance are given back with releaseBitCache() before the frame continues.
+// The cache only reads inside the current input block (*bytesLeft > 0), the step into the next OGG page is left to readUint().
+inline void FlacDecoder::fillBitCache(int32_t* bytesLeft) {
+    while (m_flacBitBufferLen <= 56 && *bytesLeft > 0) {
+        m_flac_bitBuffer = (m_flac_bitBuffer << 8) | *(m_flacInptr + m_rIndex);
+        m_rIndex++;
+        (*bytesLeft)--;
+        m_flacBitBufferLen += 8;
+    }
+}
+
+void FlacDecoder::releaseBitCache(int32_t* bytesLeft) {
+    uint8_t nBytes = m_flacBitBufferLen / 8;
+    if (!nBytes) return;
+    m_flac_bitBuffer >>= nBytes * 8;
+    m_flacBitBufferLen -= nBytes * 8;
+    m_rIndex -= nBytes;
+    (*bytesLeft) += nBytes;
+}
+
+inline uint32_t FlacDecoder::readRiceUint(uint8_t param, int32_t* bytesLeft) {
+    uint32_t q = 0; // unary quotient
+    while (true) {
+        if (m_flacBitBufferLen < 32) fillBitCache(bytesLeft);
+        if (m_flacBitBufferLen == 0) { // end of the input block, bit by bit (OGG page change)
+            while (readUint(1, bytesLeft) == 0) {
+                q++;
+                if (m_f_bitReaderError) break;
+            }
+            return (q << param) | readUint(param, bytesLeft);
+        }
+        uint64_t v = m_flac_bitBuffer << (64 - m_flacBitBufferLen); // valid bits left aligned
+        if (v) {
+            uint8_t zeros = __builtin_clzll(v);
+            q += zeros;
+            m_flacBitBufferLen -= zeros + 1; // skip the stop bit
+            break;
+        }
+        q += m_flacBitBufferLen;
+        m_flacBitBufferLen = 0;
+    }
+    if (m_flacBitBufferLen < param) return (q << param) | readUint(param, bytesLeft);
+    m_flacBitBufferLen -= param;
+    uint32_t rem = (uint32_t)(m_flac_bitBuffer >> m_flacBitBufferLen) & (uint32_t)((1ULL << param) - 1);
+    return (q << param) | rem;
+}
 //----------------------------------------------------------------------------------------------------------------------
 //              F L A C - D E C O D E R
 //----------------------------------------------------------------------------------------------------------------------
@@ -288,7 +393,7 @@ int32_t FlacDecoder::findSyncWord(uint8_t* buf, int32_t nBytes) {
         if (blocksize_code == 0) continue;
         if (samplerate_code == 0x0F) continue;
         if (channel_assign > 10) continue;
-        if (bps_code == 0 || bps_code == 7) continue;
+        if (bps_code == 3) continue; // reserved, 0: from STREAMINFO, 7: 32 bit (RFC 9639)
 
         // 4. UTF-8 frame/sample number parsen
         uint64_t frameNum;
@@ -798,7 +903,7 @@ int32_t FlacDecoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf)
         switch (m_flacPageNr) {
             case 0:
                 ret = parseFlacFirstPacket(inbuf, segmLen);
-                if (ret == segmLen) {
+                if (ret == (int32_t)segmLen) {
                     m_flacPageNr = 1;
                     ret = FLAC_PARSE_OGG_DONE;
                     break;
@@ -806,7 +911,7 @@ int32_t FlacDecoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf)
                 if (ret < 0) { // fLaC signature not found
                     break;
                 }
-                if (ret < segmLen) {
+                if (ret < (int32_t)segmLen) {
                     segmLen -= ret;
                     *bytesLeft -= ret;
                     m_flacCurrentFilePos += ret;
@@ -862,7 +967,7 @@ int8_t FlacDecoder::decodeNative(uint8_t* inbuf, int32_t* bytesLeft, int32_t* ou
 
     if (m_flacStatus == DECODE_SUBFRAMES) {
         // Decode each channel's subframe, then skip footer
-        int32_t ret = decodeSubframes(bytesLeft);
+        int32_t ret = m_f_wideSamples ? decodeSubframes<int64_t>(bytesLeft) : decodeSubframes<int32_t>(bytesLeft);
         if (ret != 0) return ret;
         m_flacStatus = OUT_SAMPLES;
         sbl += bl - *bytesLeft;
@@ -880,52 +985,10 @@ int8_t FlacDecoder::decodeNative(uint8_t* inbuf, int32_t* bytesLeft, int32_t* ou
             m_flacValidSamples = blockSize;
         }
 
-        if (FLACMetadataBlock->numChannels == 1) {
-            const int64_t* src = m_samplesBuffer[0].get() + m_offset;
-
-            for (int32_t i = 0; i < blockSize; i++) {
-                int32_t val = *src++;
-                if (FLACMetadataBlock->bitsPerSample == 8) {
-                    val += 128;
-                    outbuf[i * 2] = (val << 24);
-                    outbuf[i * 2 + 1] = (val << 24);
-                } else if (FLACMetadataBlock->bitsPerSample == 16) {
-                    outbuf[i * 2] = (val << 16);
-                    outbuf[i * 2 + 1] = (val << 16);
-                } else if (FLACMetadataBlock->bitsPerSample == 24) {
-                    outbuf[i * 2] = (val << 8);
-                    outbuf[i * 2 + 1] = (val << 8);
-                } else if (FLACMetadataBlock->bitsPerSample == 32) {
-                    outbuf[i * 2] = (val);
-                    outbuf[i * 2 + 1] = (val);
-                }
-            }
-        }
-
-        if (FLACMetadataBlock->numChannels == 2) {
-            const int64_t* left = m_samplesBuffer[0].get() + m_offset;
-            const int64_t* right = m_samplesBuffer[1].get() + m_offset;
-
-            for (int32_t i = 0; i < blockSize; i++) {
-                int32_t l = *left++;
-                int32_t r = *right++;
-                if (FLACMetadataBlock->bitsPerSample == 8) {
-                    l += 128;
-                    r += 128;
-                    outbuf[i * 2] = (l << 24);
-                    outbuf[i * 2 + 1] = (r << 24);
-                } else if (FLACMetadataBlock->bitsPerSample == 16) {
-                    outbuf[i * 2] = l = (l << 16);
-                    outbuf[i * 2 + 1] = (r << 16);
-                } else if (FLACMetadataBlock->bitsPerSample == 24) {
-                    outbuf[i * 2] = (l << 8);
-                    outbuf[i * 2 + 1] = (r << 8);
-                } else if (FLACMetadataBlock->bitsPerSample == 32) {
-                    outbuf[i * 2] = l;
-                    outbuf[i * 2 + 1] = r;
-                }
-            }
-        }
+        if (m_f_wideSamples)
+            writeOutSamples<int64_t>(outbuf, blockSize);
+        else
+            writeOutSamples<int32_t>(outbuf, blockSize);
 
         m_offset += blockSize;
         if (sbl > 0) {
@@ -949,8 +1012,57 @@ int8_t FlacDecoder::decodeNative(uint8_t* inbuf, int32_t* bytesLeft, int32_t* ou
     return FLAC_NONE;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+template <typename T> void FlacDecoder::writeOutSamples(int32_t* outbuf, uint32_t blockSize) {
+    if (FLACMetadataBlock->numChannels == 1) {
+        const T* src = samples<T>(0) + m_offset;
+
+        for (uint32_t i = 0; i < blockSize; i++) {
+            int32_t val = *src++;
+            if (FLACMetadataBlock->bitsPerSample == 8) {
+                val += 128;
+                outbuf[i * 2] = (val << 24);
+                outbuf[i * 2 + 1] = (val << 24);
+            } else if (FLACMetadataBlock->bitsPerSample == 16) {
+                outbuf[i * 2] = (val << 16);
+                outbuf[i * 2 + 1] = (val << 16);
+            } else if (FLACMetadataBlock->bitsPerSample == 24) {
+                outbuf[i * 2] = (val << 8);
+                outbuf[i * 2 + 1] = (val << 8);
+            } else if (FLACMetadataBlock->bitsPerSample == 32) {
+                outbuf[i * 2] = (val);
+                outbuf[i * 2 + 1] = (val);
+            }
+        }
+    }
+
+    if (FLACMetadataBlock->numChannels == 2) {
+        const T* left = samples<T>(0) + m_offset;
+        const T* right = samples<T>(1) + m_offset;
+
+        for (uint32_t i = 0; i < blockSize; i++) {
+            int32_t l = *left++;
+            int32_t r = *right++;
+            if (FLACMetadataBlock->bitsPerSample == 8) {
+                l += 128;
+                r += 128;
+                outbuf[i * 2] = (l << 24);
+                outbuf[i * 2 + 1] = (r << 24);
+            } else if (FLACMetadataBlock->bitsPerSample == 16) {
+                outbuf[i * 2] = l = (l << 16);
+                outbuf[i * 2 + 1] = (r << 16);
+            } else if (FLACMetadataBlock->bitsPerSample == 24) {
+                outbuf[i * 2] = (l << 8);
+                outbuf[i * 2 + 1] = (r << 8);
+            } else if (FLACMetadataBlock->bitsPerSample == 32) {
+                outbuf[i * 2] = l;
+                outbuf[i * 2 + 1] = r;
+            }
+        }
+    }
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 int8_t FlacDecoder::decodeFrame(uint8_t* inbuf, int32_t* bytesLeft) {
-    if (specialIndexOf(inbuf, "OggS", *bytesLeft) == 0) { // async? => new sync is OggS => reset and decode (not page 0 or 1)
+    if (specialIndexOf(inbuf, "OggS", min(*bytesLeft, (int32_t)4)) == 0) { // async? => new sync is OggS => reset and decode (not page 0 or 1), only the frame start counts
         decoderReset();
         m_flacPageNr = 2;
         return FLAC_OGG_SYNC_FOUND;
@@ -1010,9 +1122,10 @@ int8_t FlacDecoder::decodeFrame(uint8_t* inbuf, int32_t* bytesLeft) {
         if (FLACFrameHeader->sampleSizeCode == 4) FLACMetadataBlock->bitsPerSample = 16;
         if (FLACFrameHeader->sampleSizeCode == 5) FLACMetadataBlock->bitsPerSample = 20;
         if (FLACFrameHeader->sampleSizeCode == 6) FLACMetadataBlock->bitsPerSample = 24;
+        if (FLACFrameHeader->sampleSizeCode == 7) FLACMetadataBlock->bitsPerSample = 32;
     }
     if (FLACMetadataBlock->bitsPerSample == 12 || FLACMetadataBlock->bitsPerSample == 20) {
-        FLAC_LOG_ERROR("Flac, bits per sample must be 8, 16 or 24, is: {}", FLACMetadataBlock->bitsPerSample);
+        FLAC_LOG_ERROR("Flac, bits per sample must be 8, 16, 24 or 32, is: {}", FLACMetadataBlock->bitsPerSample);
         return FLAC_STOP;
     }
     if (FLACMetadataBlock->bitsPerSample < 8) {
@@ -1072,19 +1185,29 @@ int8_t FlacDecoder::decodeFrame(uint8_t* inbuf, int32_t* bytesLeft) {
     else if (FLACFrameHeader->sampleRateCode == 13 || FLACFrameHeader->sampleRateCode == 14) { readUint(16, bytesLeft); }
     readUint(8, bytesLeft);
 
+    // 32 bit streams need 33 bit for the side channel, all others are stored as int32_t
+    m_f_wideSamples = (FLACMetadataBlock->bitsPerSample > 24);
     const uint8_t neededChannels = (FLACMetadataBlock->numChannels == 2) ? 2 : 1;
-    for (int32_t i = 0; i < neededChannels; i++) {
-        if (m_samplesBuffer[i].size() == m_numOfOutSamples) continue;
-        if (!m_samplesBuffer[i].calloc_array(m_numOfOutSamples, "m_samplesBuffer") || !m_samplesBuffer[i].valid()) {
-            FLAC_LOG_ERROR("not enough memory to allocate flacdecoder buffer {}, samples: {}", i, m_numOfOutSamples);
-            m_samplesBuffer[i].reset();
-            m_valid = false;
-            return FLAC_ERR;
+    auto          allocSamples = [&](auto& buffers, auto& unused) -> bool {
+        using T = std::remove_reference_t<decltype(*buffers[0].get())>;
+        for (int32_t i = 0; i < FLAC_MAX_CHANNELS; i++) {
+            if (unused[i].valid()) unused[i].reset();
+            if (i >= neededChannels) {
+                if (buffers[i].valid()) buffers[i].reset();
+                continue;
+            }
+            if (buffers[i].size() >= m_numOfOutSamples * sizeof(T)) continue; // size() is in bytes, keep the buffer as long as the block fits
+            if (!buffers[i].calloc_array(m_numOfOutSamples, "m_samplesBuffer") || !buffers[i].valid()) {
+                FLAC_LOG_ERROR("not enough memory to allocate flacdecoder buffer {}, samples: {}", i, m_numOfOutSamples);
+                buffers[i].reset();
+                return false;
+            }
         }
-    }
-
-    for (int32_t i = neededChannels; i < FLAC_MAX_CHANNELS; i++) {
-        if (m_samplesBuffer[i].valid()) { m_samplesBuffer[i].reset(); }
+        return true;
+    };
+    if (!(m_f_wideSamples ? allocSamples(m_samplesBufferWide, m_samplesBuffer) : allocSamples(m_samplesBuffer, m_samplesBufferWide))) {
+        m_valid = false;
+        return FLAC_ERR;
     }
 
     m_flacStatus = DECODE_SUBFRAMES;
@@ -1140,20 +1263,20 @@ int32_t FlacDecoder::val2() {
     return 0;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-int8_t FlacDecoder::decodeSubframes(int32_t* bytesLeft) {
+template <typename T> int8_t FlacDecoder::decodeSubframes(int32_t* bytesLeft) {
 
     if (FLACFrameHeader->chanAsgn <= 7) {
-        for (int32_t ch = 0; ch < FLACMetadataBlock->numChannels; ch++) decodeSubframe(FLACMetadataBlock->bitsPerSample, ch, bytesLeft);
+        for (int32_t ch = 0; ch < FLACMetadataBlock->numChannels; ch++) decodeSubframe<T>(FLACMetadataBlock->bitsPerSample, ch, bytesLeft);
     } else if (8 <= FLACFrameHeader->chanAsgn && FLACFrameHeader->chanAsgn <= 10) {
         if (FLACMetadataBlock->numChannels != 2) {
             FLAC_LOG_ERROR("Flac stereo channel assignment requires 2 channels, assignment: {}, channels: {}", FLACFrameHeader->chanAsgn, FLACMetadataBlock->numChannels);
             return FLAC_ERR;
         }
-        decodeSubframe(FLACMetadataBlock->bitsPerSample + (FLACFrameHeader->chanAsgn == 9 ? 1 : 0), 0, bytesLeft);
-        decodeSubframe(FLACMetadataBlock->bitsPerSample + (FLACFrameHeader->chanAsgn == 9 ? 0 : 1), 1, bytesLeft);
+        decodeSubframe<T>(FLACMetadataBlock->bitsPerSample + (FLACFrameHeader->chanAsgn == 9 ? 1 : 0), 0, bytesLeft);
+        decodeSubframe<T>(FLACMetadataBlock->bitsPerSample + (FLACFrameHeader->chanAsgn == 9 ? 0 : 1), 1, bytesLeft);
 
-        int64_t*      ch0 = m_samplesBuffer[0].get();
-        int64_t*      ch1 = m_samplesBuffer[1].get();
+        T*            ch0 = samples<T>(0);
+        T*            ch1 = samples<T>(1);
         const int32_t n = m_numOfOutSamples;
 
         switch (FLACFrameHeader->chanAsgn) { // 8, 9 or 10
@@ -1167,8 +1290,8 @@ int8_t FlacDecoder::decodeSubframes(int32_t* bytesLeft) {
 
             case 10: // mid + side → left/right
                 for (int32_t i = 0; i < n; i++) {
-                    int32_t s = ch1[i];
-                    int32_t r = ch0[i] - (s >> 1);
+                    T s = ch1[i];
+                    T r = ch0[i] - (s >> 1);
                     ch1[i] = r;
                     ch0[i] = r + s;
                 }
@@ -1184,7 +1307,8 @@ int8_t FlacDecoder::decodeSubframes(int32_t* bytesLeft) {
     return FLAC_NONE;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-int8_t FlacDecoder::decodeSubframe(uint8_t sampleDepth, uint8_t ch, int32_t* bytesLeft) {
+template <typename T> int8_t FlacDecoder::decodeSubframe(uint8_t sampleDepth, uint8_t ch, int32_t* bytesLeft) {
+    T*     smp = samples<T>(ch);
 
     int8_t ret = 0;
     readUint(1, bytesLeft);                // Zero bit padding, to prevent sync-fooling string of 1s
@@ -1205,63 +1329,50 @@ int8_t FlacDecoder::decodeSubframe(uint8_t sampleDepth, uint8_t ch, int32_t* byt
     sampleDepth -= shift;
 
     if (type == 0) {                                       // Constant coding
-        int32_t s = readSignedInt(sampleDepth, bytesLeft); // SUBFRAME_CONSTANT
-        for (int32_t i = 0; i < m_numOfOutSamples; i++) { m_samplesBuffer[ch][i] = s; }
+        T s = readSample<T>(sampleDepth, bytesLeft);      // SUBFRAME_CONSTANT
+        for (int32_t i = 0; i < m_numOfOutSamples; i++) { smp[i] = s; }
     } else if (type == 1) {                                                                                             // Verbatim coding
-        for (int32_t i = 0; i < m_numOfOutSamples; i++) m_samplesBuffer[ch][i] = readSignedInt(sampleDepth, bytesLeft); // SUBFRAME_VERBATIM
+        for (int32_t i = 0; i < m_numOfOutSamples; i++) smp[i] = readSample<T>(sampleDepth, bytesLeft); // SUBFRAME_VERBATIM
     } else if (8 <= type && type <= 12) {
-        ret = decodeFixedPredictionSubframe(type - 8, sampleDepth, ch, bytesLeft); // SUBFRAME_FIXED
+        ret = decodeFixedPredictionSubframe<T>(type - 8, sampleDepth, ch, bytesLeft); // SUBFRAME_FIXED
         if (ret) return ret;
     } else if (32 <= type && type <= 63) {
-        ret = decodeLinearPredictiveCodingSubframe(type - 31, sampleDepth, ch, bytesLeft); // SUBFRAME_LPC
+        ret = decodeLinearPredictiveCodingSubframe<T>(type - 31, sampleDepth, ch, bytesLeft); // SUBFRAME_LPC
         if (ret) return ret;
     } else {
         FLAC_LOG_ERROR("Flac unimplemented reserved subtype: {}", type);
         return FLAC_ERR;
     }
     if (shift > 0) {
-        for (int32_t i = 0; i < m_numOfOutSamples; i++) { m_samplesBuffer[ch][i] <<= shift; }
+        for (int32_t i = 0; i < m_numOfOutSamples; i++) { smp[i] <<= shift; }
     }
     return FLAC_NONE;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-int8_t FlacDecoder::decodeFixedPredictionSubframe(uint8_t predOrder, uint8_t sampleDepth, uint8_t ch, int32_t* bytesLeft) { // SUBFRAME_FIXED
+template <typename T> int8_t FlacDecoder::decodeFixedPredictionSubframe(uint8_t predOrder, uint8_t sampleDepth, uint8_t ch, int32_t* bytesLeft) { // SUBFRAME_FIXED
+    T*      smp = samples<T>(ch);
 
     uint8_t ret = 0;
-    for (uint8_t i = 0; i < predOrder; i++) m_samplesBuffer[ch][i] = readSignedInt(sampleDepth, bytesLeft); // Unencoded warm-up samples (n = frame's bits-per-sample * predictor order).
-    ret = decodeResiduals(predOrder, ch, bytesLeft);
-    if (ret) return ret;
-    coefs.clear();
-    coefs.shrink_to_fit();
-    if (predOrder == 0) coefs.resize(0);
-    if (predOrder == 1) coefs.push_back(1); // FIXED_PREDICTION_COEFFICIENTS
-    if (predOrder == 2) {
-        coefs.push_back(2);
-        coefs.push_back(-1);
-    }
-    if (predOrder == 3) {
-        coefs.push_back(3);
-        coefs.push_back(-3);
-        coefs.push_back(1);
-    }
-    if (predOrder == 4) {
-        coefs.push_back(4);
-        coefs.push_back(-6);
-        coefs.push_back(4);
-        coefs.push_back(-1);
-    }
+    for (uint8_t i = 0; i < predOrder; i++) smp[i] = readSample<T>(sampleDepth, bytesLeft); // Unencoded warm-up samples (n = frame's bits-per-sample * predictor order).
     if (predOrder > 4) {
         FLAC_LOG_ERROR("Flac preorder too big: {}", predOrder);
         return FLAC_ERR;
     } // Error: preorder > 4"
-    restoreLinearPrediction(ch, 0);
+    ret = decodeResiduals<T>(predOrder, ch, bytesLeft);
+    if (ret) return ret;
+    // |prediction| < 2^order * 2^(sampleDepth - 1)
+    if (sampleDepth + predOrder <= 32)
+        fixedKernel<int32_t>(smp, m_numOfOutSamples, predOrder);
+    else
+        fixedKernel<int64_t>(smp, m_numOfOutSamples, predOrder);
     return FLAC_NONE;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-int8_t FlacDecoder::decodeLinearPredictiveCodingSubframe(int32_t lpcOrder, int32_t sampleDepth, uint8_t ch, int32_t* bytesLeft) {
+template <typename T> int8_t FlacDecoder::decodeLinearPredictiveCodingSubframe(int32_t lpcOrder, int32_t sampleDepth, uint8_t ch, int32_t* bytesLeft) {
+    T*     smp = samples<T>(ch);
     int8_t ret = 0;
     for (int32_t i = 0; i < lpcOrder; i++) {
-        m_samplesBuffer[ch][i] = readSignedInt(sampleDepth, bytesLeft); // Unencoded warm-up samples (n = frame's bits-per-sample * lpc order).
+        smp[i] = readSample<T>(sampleDepth, bytesLeft); // Unencoded warm-up samples (n = frame's bits-per-sample * lpc order).
     }
     int32_t precision = readUint(4, bytesLeft) + 1; // (Quantized linear predictor coefficients' precision in bits)-1 (1111 = invalid).
     int32_t shift = readSignedInt(5, bytesLeft);    // Quantized linear predictor coefficient shift needed in bits (NOTE: this number is signed two's-complement).
@@ -1269,13 +1380,13 @@ int8_t FlacDecoder::decodeLinearPredictiveCodingSubframe(int32_t lpcOrder, int32
     for (uint8_t i = 0; i < lpcOrder; i++) {
         coefs.push_back(readSignedInt(precision, bytesLeft)); // Unencoded predictor coefficients (n = qlp coeff precision * lpc order) (NOTE: the coefficients are signed two's-complement).
     }
-    ret = decodeResiduals(lpcOrder, ch, bytesLeft);
+    ret = decodeResiduals<T>(lpcOrder, ch, bytesLeft);
     if (ret) return ret;
-    restoreLinearPrediction(ch, shift);
+    restoreLinearPrediction<T>(ch, shift, sampleDepth, precision);
     return FLAC_NONE;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-int8_t FlacDecoder::decodeResiduals(uint8_t warmup, uint8_t ch, int32_t* bytesLeft) {
+template <typename T> int8_t FlacDecoder::decodeResiduals(uint8_t warmup, uint8_t ch, int32_t* bytesLeft) {
     int32_t method = readUint(2, bytesLeft);
     if (method >= 2) {
         FLAC_LOG_ERROR("Flac reserved residual coding, method: {}", method);
@@ -1283,7 +1394,7 @@ int8_t FlacDecoder::decodeResiduals(uint8_t warmup, uint8_t ch, int32_t* bytesLe
     }
 
     const uint8_t paramBits = (method == 0 ? 4 : 5);
-    const int32_t escapeParam = (method == 0 ? 0xF : 0x1E);
+    const int32_t escapeParam = (method == 0 ? 0xF : 0x1F);
     const int32_t partitionOrder = readUint(4, bytesLeft);
     const int32_t numPartitions = 1 << partitionOrder;
 
@@ -1293,13 +1404,13 @@ int8_t FlacDecoder::decodeResiduals(uint8_t warmup, uint8_t ch, int32_t* bytesLe
     }
 
     const int32_t partitionSize = m_numOfOutSamples / numPartitions;
-    int64_t*      sampleBase = m_samplesBuffer[ch].get();
+    T*            sampleBase = samples<T>(ch);
 
     for (int32_t i = 0; i < numPartitions; i++) {
         const int32_t start = i * partitionSize + ((i == 0) ? warmup : 0);
         const int32_t end = (i + 1) * partitionSize;
-        int64_t*      dst = sampleBase + start;
-        int64_t*      dstEnd = sampleBase + end;
+        T*            dst = sampleBase + start;
+        T*            dstEnd = sampleBase + end;
 
         const int32_t param = readUint(paramBits, bytesLeft);
 
@@ -1307,34 +1418,31 @@ int8_t FlacDecoder::decodeResiduals(uint8_t warmup, uint8_t ch, int32_t* bytesLe
             // Rice-coded partition
             while (dst < dstEnd) {
                 if (m_f_bitReaderError) break;
-
-                uint32_t val = 0;
-                // Inline Rice unary prefix
-                while (readUint(1, bytesLeft) == 0) {
-                    val++;
-                    if (m_f_bitReaderError) { break; }
-                }
-
-                // Append remainder bits
-                val = (val << param) | readUint(param, bytesLeft);
-
-                // Convert to signed
-                int64_t signedVal = (val >> 1) ^ -(val & 1);
-                *dst++ = (int32_t)signedVal;
+                uint32_t val = readRiceUint(param, bytesLeft);
+                *dst++ = (int32_t)((val >> 1) ^ -(val & 1)); // zigzag to signed
             }
         } else {
             // Escape partition (raw signed integers)
             const int32_t numBits = readUint(5, bytesLeft);
+            if (numBits == 0) {
+                while (dst < dstEnd) *dst++ = 0;
+                continue;
+            }
             while (dst < dstEnd) {
                 if (m_f_bitReaderError) break;
-
-                uint32_t val = readUint(numBits, bytesLeft);
-                // Sign extend
-                int64_t signedVal = (int64_t)(val << (32 - numBits)) >> (32 - numBits);
-                *dst++ = (int32_t)signedVal;
+                uint32_t val;
+                if (m_flacBitBufferLen < numBits) fillBitCache(bytesLeft);
+                if (m_flacBitBufferLen >= numBits) {
+                    m_flacBitBufferLen -= numBits;
+                    val = (uint32_t)(m_flac_bitBuffer >> m_flacBitBufferLen);
+                } else {
+                    val = readUint(numBits, bytesLeft);
+                }
+                *dst++ = (int32_t)(val << (32 - numBits)) >> (32 - numBits); // sign extend
             }
         }
     }
+    releaseBitCache(bytesLeft);
 
     if (m_f_bitReaderError) {
         FLAC_LOG_ERROR("Flac bitreader underflow");
@@ -1343,13 +1451,16 @@ int8_t FlacDecoder::decodeResiduals(uint8_t warmup, uint8_t ch, int32_t* bytesLe
     return FLAC_NONE;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-void FlacDecoder::restoreLinearPrediction(uint8_t ch, uint8_t shift) {
-
-    for (int32_t i = coefs.size(); i < m_numOfOutSamples; i++) {
-        int64_t sum = 0;
-        for (int32_t j = 0; j < coefs.size(); j++) { sum += m_samplesBuffer[ch][i - 1 - j] * coefs[j]; }
-        m_samplesBuffer[ch][i] += (sum >> shift);
-    }
+template <typename T> void FlacDecoder::restoreLinearPrediction(uint8_t ch, uint8_t shift, uint8_t sampleDepth, uint8_t precision) {
+    // kernel selected once per subframe, same bound as libFLAC: |sum| < order * 2^(precision - 1) * 2^(sampleDepth - 1)
+    const int32_t order = coefs.size();
+    if (order < 1 || order > 32) return;
+    if constexpr (sizeof(T) == sizeof(int64_t))
+        lpcKernelsWide[order - 1](samples<T>(ch), coefs.data(), m_numOfOutSamples, shift);
+    else if (sampleDepth + precision + ceilLog2(order) <= 32)
+        lpcKernels32[order - 1](samples<T>(ch), coefs.data(), m_numOfOutSamples, shift);
+    else
+        lpcKernels64[order - 1](samples<T>(ch), coefs.data(), m_numOfOutSamples, shift);
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 int32_t FlacDecoder::specialIndexOf(uint8_t* base, const char* str, int32_t baselen, bool exact) {
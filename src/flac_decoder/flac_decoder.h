@@ -218,7 +218,9 @@ class FlacDecoder : public Decoder {
     bool            m_continued_page = false;
     bool            m_f_first_flac_frame = false;
     uint8_t         m_flacPageNr = 0;
-    ps_ptr<int64_t> m_samplesBuffer[2];
+    ps_ptr<int32_t> m_samplesBuffer[2];     // 8...24 bit streams, the side channel needs at most 25 bit
+    ps_ptr<int64_t> m_samplesBufferWide[2]; // 32 bit streams, the side channel needs 33 bit
+    bool            m_f_wideSamples = false;
     uint16_t        m_maxBlocksize = FLAC_MAX_BLOCKSIZE;
     int32_t         m_nBytes = 0;
 
@@ -233,19 +235,39 @@ class FlacDecoder : public Decoder {
     uint64_t getTotoalSamplesInStream();
     uint32_t readUint(uint8_t nBits, int32_t* bytesLeft);
     void     alignToByte();
-    int8_t   decodeSubframes(int32_t* bytesLeft);
-    int8_t   decodeSubframe(uint8_t sampleDepth, uint8_t ch, int32_t* bytesLeft);
-    int8_t   decodeFixedPredictionSubframe(uint8_t predOrder, uint8_t sampleDepth, uint8_t ch, int32_t* bytesLeft);
-    int8_t   decodeLinearPredictiveCodingSubframe(int32_t lpcOrder, int32_t sampleDepth, uint8_t ch, int32_t* bytesLeft);
-    int8_t   decodeResiduals(uint8_t warmup, uint8_t ch, int32_t* bytesLeft);
-    void     restoreLinearPrediction(uint8_t ch, uint8_t shift);
+    void     fillBitCache(int32_t* bytesLeft);
+    void     releaseBitCache(int32_t* bytesLeft);
+    uint32_t readRiceUint(uint8_t param, int32_t* bytesLeft);
+    template <typename T> int8_t decodeSubframes(int32_t* bytesLeft);
+    template <typename T> int8_t decodeSubframe(uint8_t sampleDepth, uint8_t ch, int32_t* bytesLeft);
+    template <typename T> int8_t decodeFixedPredictionSubframe(uint8_t predOrder, uint8_t sampleDepth, uint8_t ch, int32_t* bytesLeft);
+    template <typename T> int8_t decodeLinearPredictiveCodingSubframe(int32_t lpcOrder, int32_t sampleDepth, uint8_t ch, int32_t* bytesLeft);
+    template <typename T> int8_t decodeResiduals(uint8_t warmup, uint8_t ch, int32_t* bytesLeft);
+    template <typename T> void   restoreLinearPrediction(uint8_t ch, uint8_t shift, uint8_t sampleDepth, uint8_t precision);
+    template <typename T> void   writeOutSamples(int32_t* outbuf, uint32_t blockSize);
     int32_t  specialIndexOf(uint8_t* base, const char* str, int32_t baselen, bool exact = false);
 
+    template <typename T> T* samples(uint8_t ch) {
+        if constexpr (sizeof(T) == sizeof(int64_t))
+            return m_samplesBufferWide[ch].get();
+        else
+            return m_samplesBuffer[ch].get();
+    }
+
     inline int32_t readSignedInt(int32_t nBits, int32_t* bytesLeft) {
         int32_t temp = readUint(nBits, bytesLeft) << (32 - nBits);
         temp = temp >> (32 - nBits); // The C++ compiler uses the sign bit to fill vacated bit positions
         return temp;
     }
+    template <typename T> inline T readSample(int32_t nBits, int32_t* bytesLeft) { // the side channel of 32 bit streams has 33 bit
+        if constexpr (sizeof(T) == sizeof(int64_t)) {
+            if (nBits > 32) {
+                int64_t hi = readSignedInt(nBits - 32, bytesLeft);
+                return (int64_t)((uint64_t)hi << 32 | readUint(32, bytesLeft));
+            }
+        }
+        return readSignedInt(nBits, bytesLeft);
+    }
 
     // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
     // Macro for comfortable calls
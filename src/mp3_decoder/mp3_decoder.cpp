@@ -3,40 +3,51 @@
  * libhelix_HMP3DECODER
  *
  *  Created on: 26.10.2018
- *  Updated on: 16.07.2026
+ *  Updated on: 18.10.2026
  */
 #include "mp3_decoder.h"
 
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 
 bool MP3Decoder::init() {
+    const bool pipeline = audio.settings.MP3_PIPELINE && portNUM_PROCESSORS > 1;
+    stopPipeline();
     m_MP3DecInfo.alloc("m_MP3DecInfo");
     m_FrameHeader.alloc("m_FrameHeader");
     m_SideInfo.alloc("m_SideInfo");
     m_ScaleFactorJS.alloc("m_ScaleFactorJS");
-    m_HuffmanInfo.alloc("m_HuffmanInfo");
+    m_jobs.calloc(pipeline ? MP3_PIPE_JOBS : 1, "m_jobs");
+    if (pipeline) m_pipePcm.calloc(2 * MAX_NGRAN * MAX_NSAMP * 2, "m_pipePcm");
     m_DequantInfo.alloc("m_DequantInfo");
     m_IMDCTInfo.alloc("m_IMDCTInfo");
     m_SubbandInfo.alloc("m_SubbandInfo");
     m_MP3FrameInfo.alloc("m_MP3FrameInfo");
 
-    if (!m_MP3DecInfo.valid() || !m_FrameHeader.valid() || !m_SideInfo.valid() || !m_ScaleFactorJS.valid() || !m_HuffmanInfo.valid() || !m_DequantInfo.valid() || !m_IMDCTInfo.valid() ||
-        !m_SubbandInfo.valid() || !m_MP3FrameInfo.valid()) {
+    if (!m_MP3DecInfo.valid() || !m_FrameHeader.valid() || !m_SideInfo.valid() || !m_ScaleFactorJS.valid() || !m_jobs.valid() || !m_DequantInfo.valid() || !m_IMDCTInfo.valid() ||
+        !m_SubbandInfo.valid() || !m_MP3FrameInfo.valid() || (pipeline && !m_pipePcm.valid())) {
         reset();
         MP3_LOG_ERROR("not enough memory to allocate mp3decoder buffers");
         return false;
     }
     clear();
+    memset(&m_vbrHeader, 0, sizeof(MP3VBRHeader_t));
+    m_f_q31 = audio.settings.MP3_Q31;
+    m_synth = audio.settings.MP3_SYNTH | (audio.getForceMono() ? Audio::MP3_SYNTH_MONO : 0);
+    m_HuffmanInfo = &m_jobs->hi;
+    if (pipeline && !startPipeline()) MP3_LOG_WARN("no task for the MP3 pipeline, decoding on one core");
     return true;
 }
 
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void MP3Decoder::reset() {
+    stopPipeline();
     m_MP3DecInfo.reset();
     m_FrameHeader.reset();
     m_SideInfo.reset();
     m_ScaleFactorJS.reset();
-    m_HuffmanInfo.reset();
+    m_jobs.reset();
+    m_HuffmanInfo = nullptr;
+    m_pipePcm.reset();
     m_DequantInfo.reset();
     m_IMDCTInfo.reset();
     m_SubbandInfo.reset();
@@ -46,11 +57,13 @@ void MP3Decoder::reset() {
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void MP3Decoder::clear() {
     /* important to do this - DSP primitives assume a bunch of state variables are 0 on first use */
+    if (m_pipeTask) pipeWait(m_pipeHead.load(std::memory_order_relaxed)); // the task is idle, the pending frame is dropped
+    m_f_pipePending = false;
     m_MP3DecInfo.clear();
     m_FrameHeader.clear();
     m_SideInfo.clear();
     m_ScaleFactorJS.clear();
-    m_HuffmanInfo.clear();
+    m_jobs.clear();
     m_DequantInfo.clear();
     m_IMDCTInfo.clear();
     m_SubbandInfo.clear();
@@ -60,11 +73,13 @@ void MP3Decoder::clear() {
     memset(&m_ScaleFactorInfoSub, 0, sizeof(ScaleFactorInfoSub_t) * (MAX_NGRAN * MAX_NCHAN)); // Clear ScaleFactorInfo
     memset(&m_CriticalBandInfo, 0, sizeof(CriticalBandInfo_t) * MAX_NCHAN);                   // Clear CriticalBandInfo
     memset(&m_SideInfoSub, 0, sizeof(SideInfoSub_t) * (MAX_NGRAN * MAX_NCHAN));               // Clear SideInfoSub
+    m_samplePos = -1;                                                                         // known again at the header frame
+    m_f_mixedSpectrum = false;                                                                // overBuf is zero
     return;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 bool MP3Decoder::isValid() {
-    if (!m_MP3DecInfo.valid() || !m_FrameHeader.valid() || !m_SideInfo.valid() || !m_ScaleFactorJS.valid() || !m_HuffmanInfo.valid() || !m_DequantInfo.valid() || !m_IMDCTInfo.valid() ||
+    if (!m_MP3DecInfo.valid() || !m_FrameHeader.valid() || !m_SideInfo.valid() || !m_ScaleFactorJS.valid() || !m_jobs.valid() || !m_DequantInfo.valid() || !m_IMDCTInfo.valid() ||
         !m_SubbandInfo.valid() || !m_MP3FrameInfo.valid()) {
         return false;
     }
@@ -777,7 +792,7 @@ int32_t MP3Decoder::findSyncWord(uint8_t* buf, int32_t nBytes) {
         Mp3FrameHeader_sync_t header;
         if (parseMp3Header(&buf[current_pos], &header)) {
             // This is where the crucial step comes: Check the next frame
-            if (current_pos + header.frame_length + mp3FHsize <= current_pos + nBytes) {
+            if (current_pos + header.frame_length + mp3FHsize <= current_pos + (uint32_t)nBytes) {
                 // Check whether there is a syncword at the expected next frame start and a valid header is (optional but very robust)
                 Mp3FrameHeader_sync_t next_header;
                 if (((buf[current_pos + header.frame_length] == SYNCWORDH) && ((buf[current_pos + header.frame_length + 1] & SYNCWORDL) == SYNCWORDL)) &&
@@ -883,6 +898,7 @@ int32_t MP3Decoder::MP3FindFreeSync(uint8_t* buf, uint8_t firstFH[4], int32_t nB
  * Return:      none
  *
  * Notes:       call this right after calling MP3Decode
+ *              channels, sample rate and samples are those of the output (MP3_SYNTH_MONO, MP3_SYNTH_HALF_RATE)
  */
 void MP3Decoder::MP3GetLastFrameInfo() {
     if (m_MP3DecInfo->layer != 3) {
@@ -895,10 +911,10 @@ void MP3Decoder::MP3GetLastFrameInfo() {
         m_MP3FrameInfo->version = 0;
     } else {
         m_MP3FrameInfo->bitrate = m_MP3DecInfo->bitrate;
-        m_MP3FrameInfo->nChans = m_MP3DecInfo->nChans;
-        m_MP3FrameInfo->samprate = m_MP3DecInfo->samprate;
+        m_MP3FrameInfo->nChans = synthChans();
+        m_MP3FrameInfo->samprate = m_MP3DecInfo->samprate >> getRateShift();
         m_MP3FrameInfo->bitsPerSample = 16;
-        m_MP3FrameInfo->outputSamps = (int32_t)samplesPerFrameTab[m_MPEGVersion][m_MP3DecInfo->layer - 1];
+        m_MP3FrameInfo->outputSamps = (int32_t)samplesPerFrameTab[m_MPEGVersion][m_MP3DecInfo->layer - 1] >> getRateShift();
         m_MP3FrameInfo->layer = m_MP3DecInfo->layer;
         m_MP3FrameInfo->version = m_MPEGVersion;
     }
@@ -935,7 +951,8 @@ uint32_t MP3Decoder::getAudioDataStart() {
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 uint32_t MP3Decoder::getAudioFileDuration() {
-    return 0; // nothing todo
+    if (!m_vbrHeader.sampleRate) return 0;
+    return getTotalSamples() / (m_vbrHeader.sampleRate >> getRateShift()); // 0 without Xing/VBRI header
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 const char* MP3Decoder::getStreamTitle() {
@@ -947,6 +964,11 @@ const char* MP3Decoder::whoIsIt() {
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void MP3Decoder::setRawBlockParams(uint8_t channels, uint32_t sampleRate, uint8_t BPS, uint32_t tsis, uint32_t AuDaLength) {
+    (void)channels;
+    (void)sampleRate;
+    (void)BPS;
+    (void)tsis;
+    (void)AuDaLength;
     return; // nothing todo
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -966,6 +988,176 @@ int32_t MP3Decoder::val2() {
     return 0; // nothing todo
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+/*
+ * Function:    findVBRTag
+ *
+ * Description: position of a Xing/Info or VBRI tag inside a frame
+ *
+ * Inputs:      pointer to the frame (sync word), number of valid bytes
+ *
+ * Return:      offset of the tag, -1 if there is none
+ *
+ * Notes:       Xing/Info follows the side info (offset 13, 21 or 36), VBRI is always at offset 36
+ */
+int32_t MP3Decoder::findVBRTag(const uint8_t* frame, int32_t len) {
+    if (len < 4 || frame[0] != 0xFF || (frame[1] & 0xE0) != 0xE0) return -1;
+    int32_t frameLen = min(len, calcFrameLength(frame));
+    if (frameLen < 0) return -1; // not layer III
+
+    int32_t verIdx = (frame[1] >> 3) & 0x03;
+    bool    mono = ((frame[3] >> 6) & 0x03) == Mono;
+    int32_t xingPos = 4 + ((verIdx == 3) ? (mono ? SIBYTES_MPEG1_MONO : SIBYTES_MPEG1_STEREO) : (mono ? SIBYTES_MPEG2_MONO : SIBYTES_MPEG2_STEREO));
+    if (xingPos + 8 <= frameLen && (memcmp(frame + xingPos, "Xing", 4) == 0 || memcmp(frame + xingPos, "Info", 4) == 0)) return xingPos;
+    if (36 + 26 <= frameLen && memcmp(frame + 36, "VBRI", 4) == 0) return 36;
+    return -1;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+/*
+ * Function:    parseVBRHeader
+ *
+ * Description: looks for a Xing/Info or VBRI header in the first frame of a file
+ *
+ * Inputs:      pointer to the first frame (sync word), number of valid bytes
+ *
+ * Outputs:     m_vbrHeader, a VBRI table is converted into a Xing compatible TOC
+ *
+ * Return:      true if a header was found
+ *
+ * Notes:       the header frame itself contains no audio, the LAME tag behind a Xing/Info header gives
+ *              the encoder delay and padding for gapless playback
+ */
+bool MP3Decoder::parseVBRHeader(const uint8_t* frame, int32_t len) {
+    memset(&m_vbrHeader, 0, sizeof(MP3VBRHeader_t));
+    int32_t tagPos = findVBRTag(frame, len);
+    if (tagPos < 0) return false;
+
+    int32_t verIdx = (frame[1] >> 3) & 0x03;
+    if (verIdx == 1) return false; // reserved, not a valid frame header
+
+    MPEGVersion_t ver = (MPEGVersion_t)(verIdx == 0 ? MPEG25 : (verIdx == 3 ? MPEG1 : MPEG2));
+    int32_t       frameLen = min(len, calcFrameLength(frame));
+
+    auto be32 = [](const uint8_t* p) -> uint32_t { return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3]; };
+    auto be16 = [](const uint8_t* p) -> uint16_t { return ((uint16_t)p[0] << 8) | p[1]; };
+
+    m_vbrHeader.samplesPerFrame = samplesPerFrameTab[ver][2];
+    m_vbrHeader.sampleRate = samplerateTab[ver][(frame[2] >> 2) & 0x03];
+
+    const uint8_t* p = frame + tagPos;
+    if (memcmp(p, "VBRI", 4) != 0) { // Xing or Info
+        const uint8_t* end = frame + frameLen;
+        uint32_t       flags = be32(p + 4);
+        m_vbrHeader.type = (p[0] == 'X') ? 1 : 2;
+        p += 8;
+        if ((flags & 0x01) && p + 4 <= end) {
+            m_vbrHeader.frames = be32(p);
+            p += 4;
+        }
+        if ((flags & 0x02) && p + 4 <= end) {
+            m_vbrHeader.bytes = be32(p);
+            p += 4;
+        }
+        if (flags & 0x04) {
+            if (p + 100 <= end) {
+                memcpy(m_vbrHeader.toc, p, 100);
+                m_vbrHeader.hasToc = m_vbrHeader.bytes > 0;
+            }
+            p += 100;
+        }
+        if (flags & 0x08) p += 4; // quality indicator
+        if (p + 24 <= end && (memcmp(p, "LAME", 4) == 0 || memcmp(p, "Lavc", 4) == 0 || memcmp(p, "Lavf", 4) == 0)) {
+            m_vbrHeader.encDelay = ((uint16_t)p[21] << 4) | (p[22] >> 4); // 12 bit each
+            m_vbrHeader.encPadding = ((uint16_t)(p[22] & 0x0F) << 8) | p[23];
+        }
+        MP3_LOG_DEBUG("{} header: frames {}, bytes {}, toc {}, delay {}, padding {}", m_vbrHeader.type == 1 ? "Xing" : "Info", m_vbrHeader.frames, m_vbrHeader.bytes, m_vbrHeader.hasToc,
+                      m_vbrHeader.encDelay, m_vbrHeader.encPadding);
+        return true;
+    }
+
+    // VBRI
+    m_vbrHeader.type = 3;
+    m_vbrHeader.bytes = be32(p + 10);
+    m_vbrHeader.frames = be32(p + 14);
+    uint16_t entries = be16(p + 18);
+    uint16_t scale = be16(p + 20);
+    uint16_t entrySize = be16(p + 22);
+    uint16_t framesPerEntry = be16(p + 24);
+    p += 26;
+    auto entry = [&](uint16_t k) -> uint64_t { // size of section k in bytes
+        uint32_t v = 0;
+        for (int b = 0; b < entrySize; b++) v = (v << 8) | p[k * entrySize + b];
+        return (uint64_t)v * scale;
+    };
+    if (entries && entrySize >= 1 && entrySize <= 4 && framesPerEntry && 36 + 26 + entries * entrySize <= frameLen && m_vbrHeader.bytes && m_vbrHeader.frames) {
+        // the table holds the size of every section of framesPerEntry frames, build the byte position at i percent
+        uint64_t sectionStart = 0; // bytes in front of section k
+        uint16_t k = 0;
+        for (int i = 0; i < 100; i++) {
+            uint64_t f = (uint64_t)m_vbrHeader.frames * i / 100;
+            while (k < entries && (uint64_t)(k + 1) * framesPerEntry <= f) sectionStart += entry(k++);
+            uint64_t pos = sectionStart;
+            if (k < entries) pos += entry(k) * (f - (uint64_t)k * framesPerEntry) / framesPerEntry;
+            m_vbrHeader.toc[i] = min<uint64_t>(255, pos * 256 / m_vbrHeader.bytes);
+        }
+        m_vbrHeader.hasToc = true;
+    }
+    MP3_LOG_DEBUG("VBRI header: frames {}, bytes {}, toc entries {}", m_vbrHeader.frames, m_vbrHeader.bytes, entries);
+    return true;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+uint32_t MP3Decoder::getTotalFrames() {
+    return m_vbrHeader.frames;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+uint32_t MP3Decoder::getTotalBytes() {
+    return m_vbrHeader.bytes;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+uint64_t MP3Decoder::getTotalSamples() {
+    return ((uint64_t)m_vbrHeader.frames * m_vbrHeader.samplesPerFrame) >> getRateShift(); // output samples
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+uint8_t MP3Decoder::getRateShift() {
+    return (m_synth & Audio::MP3_SYNTH_HALF_RATE) ? 1 : 0;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+uint32_t MP3Decoder::getSamplesPerFrame() { // 1152 (MPEG-1) or 576 (MPEG-2/2.5), not trimmed (gapless) and also while the pipeline holds a frame
+    if (!m_MP3DecInfo.valid() || m_MP3DecInfo->layer != 3) return 0;
+    return samplesPerFrameTab[m_MPEGVersion][2] >> getRateShift();
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+const uint8_t* MP3Decoder::getTOC() {
+    return m_vbrHeader.hasToc ? m_vbrHeader.toc : nullptr;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int32_t MP3Decoder::getSeekOffset(uint64_t sample) {
+    // linear interpolation between two TOC entries, the same way as the Xing reference code
+    uint64_t total = getTotalSamples();
+    if (!m_vbrHeader.hasToc || !total) return -1;
+    float percent = min(100.0f, (float)sample * 100.0f / (float)total);
+    int   a = min(99, (int)percent);
+    float fa = m_vbrHeader.toc[a];
+    float fb = (a < 99) ? m_vbrHeader.toc[a + 1] : 256.0f;
+    float fx = fa + (fb - fa) * (percent - a);
+    return (int32_t)(fx * (1.0f / 256.0f) * m_vbrHeader.bytes);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+uint64_t MP3Decoder::getSeekSample(uint32_t offset) {
+    // the inverse of getSeekOffset(), the TOC only knows the sample of a byte position approximately. Rounded down to
+    // the start of a frame, 0 without TOC
+    uint64_t total = getTotalSamples();
+    if (!m_vbrHeader.hasToc || !total || !m_vbrHeader.bytes) return 0;
+    float fx = min(256.0f, (float)offset * 256.0f / (float)m_vbrHeader.bytes);
+    int   a = 0;
+    while (a < 99 && m_vbrHeader.toc[a + 1] < fx) a++; // the first entry of a run of equal entries
+    float    fa = m_vbrHeader.toc[a];
+    float    fb = (a < 99) ? m_vbrHeader.toc[a + 1] : 256.0f;
+    float    percent = (fb > fa) ? a + (fx - fa) / (fb - fa) : a;
+    uint32_t spf = m_vbrHeader.samplesPerFrame >> getRateShift();
+    uint64_t sample = min<uint64_t>(total, (uint64_t)(percent * (float)total / 100.0f));
+    return spf ? sample - sample % spf : sample;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 /*
  * Function:    MP3GetNextFrameInfo
  *
@@ -1001,59 +1193,66 @@ int32_t MP3Decoder::MP3GetNextFrameInfo(uint8_t* buf) {
  *
  * Return:      none
  */
-void MP3Decoder::MP3ClearBadFrame(int16_t* outbuf) {
-    int32_t i;
-    for (i = 0; i < m_MP3DecInfo->nGrans * m_MP3DecInfo->nGranSamps * m_MP3DecInfo->nChans; i++) outbuf[i] = 0;
+void MP3Decoder::MP3ClearBadFrame(int32_t* outbuf) {
+    int32_t frames = m_MP3DecInfo->nGrans * m_MP3DecInfo->nGranSamps;
+    memset(outbuf, 0, m_f_q31 ? frames * 2 * sizeof(int32_t) : frames * m_MP3DecInfo->nChans * sizeof(int16_t));
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 /*
- * Function:    IsLikelyRealFrame
+ * Function:    calcFrameLength
  *
- * Description: Detection of valid MP3 frames
+ * Description: length of a layer III frame, taken from the 4 byte frame header
  *
- * Return:      true, if valid
- *              false if ID3 padding fragments, LAME Info, Xing Header, VBRI Header, Repeater-Frames, Encoder Delay Blocks
- * LAME Info
+ * Return:      frame length in bytes (padding included), -1 if the header is not layer III or has a bad index
  */
-int32_t MP3Decoder::IsLikelyRealFrame(const uint8_t* p, int32_t bytesLeft) {
-
-    auto CalcFrameLength = [](const uint8_t* h) -> int {
-        static const int bitrateTable[2][16] = {
-            {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0},    // MPEG2/2.5
-            {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0} // MPEG1
-        };
+int32_t MP3Decoder::calcFrameLength(const uint8_t* h) {
+    static const int bitrateTable[2][16] = {
+        {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0},    // MPEG2/2.5
+        {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0} // MPEG1
+    };
 
-        static const int samplerateTable[3][3] = {
-            {11025, 12000, 8000},  // MPEG 2.5
-            {22050, 24000, 16000}, // MPEG 2
-            {44100, 48000, 32000}  // MPEG 1
-        };
+    static const int samplerateTable[3][3] = {
+        {11025, 12000, 8000},  // MPEG 2.5
+        {22050, 24000, 16000}, // MPEG 2
+        {44100, 48000, 32000}  // MPEG 1
+    };
 
-        uint8_t verID = (h[1] >> 3) & 0x03;
-        uint8_t layer = (h[1] >> 1) & 0x03;
-        uint8_t brIdx = (h[2] >> 4) & 0x0F;
-        uint8_t srIdx = (h[2] >> 2) & 0x03;
-        uint8_t padding = (h[2] >> 1) & 0x01;
+    uint8_t verID = (h[1] >> 3) & 0x03;
+    uint8_t layer = (h[1] >> 1) & 0x03;
+    uint8_t brIdx = (h[2] >> 4) & 0x0F;
+    uint8_t srIdx = (h[2] >> 2) & 0x03;
+    uint8_t padding = (h[2] >> 1) & 0x01;
 
-        if (layer != 1) return -1;
-        if (srIdx == 3) return -1;
-        if (brIdx == 0 || brIdx == 15) return -1;
+    if (layer != 1) return -1;
+    if (srIdx == 3) return -1;
+    if (brIdx == 0 || brIdx == 15) return -1;
 
-        int verGroup = (verID == 3) ? 2 : (verID == 2 ? 1 : 0);
-        int samplerate = samplerateTable[verGroup][srIdx];
-        if (samplerate == 0) return -1;
+    int verGroup = (verID == 3) ? 2 : (verID == 2 ? 1 : 0);
+    int samplerate = samplerateTable[verGroup][srIdx];
+    if (samplerate == 0) return -1;
 
-        int br = bitrateTable[(verID == 3)][brIdx] * 1000;
+    int br = bitrateTable[(verID == 3)][brIdx] * 1000;
 
-        int frameLength = (verID == 3) ? (144 * br / samplerate + padding) : (72 * br / samplerate + padding);
+    int frameLength = (verID == 3) ? (144 * br / samplerate + padding) : (72 * br / samplerate + padding);
 
-        return frameLength;
-    };
+    return frameLength;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+/*
+ * Function:    IsLikelyRealFrame
+ *
+ * Description: Detection of valid MP3 frames
+ *
+ * Return:      true, if valid
+ *              false if ID3 padding fragments, LAME Info, Xing Header, VBRI Header, Repeater-Frames, Encoder Delay Blocks
+ * LAME Info
+ */
+int32_t MP3Decoder::IsLikelyRealFrame(const uint8_t* p, int32_t bytesLeft) {
 
     // 1) Sync?
     if (p[0] != 0xFF || (p[1] & 0xE0) != 0xE0) return 0; // no header
 
-    int frameLen = CalcFrameLength(p);
+    int frameLen = calcFrameLength(p);
     if (frameLen <= 0 || frameLen > bytesLeft) return -frameLen; // Fake frame
 
     // 2) Hard limits
@@ -1091,7 +1290,7 @@ int32_t MP3Decoder::IsLikelyRealFrame(const uint8_t* p, int32_t bytesLeft) {
  */
 
 int32_t MP3Decoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf) {
-    int16_t* pcm16 = (int16_t*)outbuf;
+    int16_t* pcm16 = (int16_t*)outbuf; // 16 bit synthesis, widened at the end
 
     // Skip fake frames
     int frameLen = IsLikelyRealFrame(inbuf, *bytesLeft);
@@ -1137,6 +1336,13 @@ int32_t MP3Decoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf)
         return MP3_ERR;
     }
 
+    if (findVBRTag(inbuf, frameLen) >= 0) { // Xing/Info/VBRI frame, contains no audio
+        if (!m_vbrHeader.type) parseVBRHeader(inbuf, frameLen);
+        m_samplePos = 0;
+        *bytesLeft -= frameLen;
+        return MP3_NEXT_FRAME;
+    }
+
     int32_t        offset, bitOffset, mainBits, gr, ch, fhBytes, siBytes, freeFrameBytes;
     int32_t        prevBitOffset, sfBlockBits, huffBlockBits;
     uint8_t*       mainPtr;
@@ -1151,7 +1357,7 @@ int32_t MP3Decoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf)
     /* unpack side info */
     siBytes = UnpackSideInfo(inbuf);
     if (siBytes < 0) {
-        MP3ClearBadFrame(pcm16);
+        MP3ClearBadFrame(outbuf);
         MP3_LOG_ERROR("MP3 invalid sideinfo");
         return MP3_ERR;
     }
@@ -1165,7 +1371,7 @@ int32_t MP3Decoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf)
             m_MP3DecInfo->freeBitrateFlag = 1;
             m_MP3DecInfo->freeBitrateSlots = MP3FindFreeSync(inbuf, inbuf - fhBytes - siBytes, *bytesLeft);
             if (m_MP3DecInfo->freeBitrateSlots < 0) {
-                MP3ClearBadFrame(pcm16);
+                MP3ClearBadFrame(outbuf);
                 m_MP3DecInfo->freeBitrateFlag = 0;
                 MP3_LOG_ERROR("MP3, ca'nt find free bitrate slot");
                 return MP3_ERR;
@@ -1177,7 +1383,7 @@ int32_t MP3Decoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf)
     }
 
     if (m_MP3DecInfo->nSlots > *bytesLeft) {
-        MP3ClearBadFrame(pcm16);
+        MP3ClearBadFrame(outbuf);
         MP3_LOG_DEBUG("MP3, indata underflow");
         return MP3_MAIN_DATA_UNDERFLOW;
     }
@@ -1201,7 +1407,7 @@ int32_t MP3Decoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf)
         inbuf += m_MP3DecInfo->nSlots;
         *bytesLeft -= (m_MP3DecInfo->nSlots);
         if (underflowCounter < 4) { return MP3_NONE; }
-        MP3ClearBadFrame(pcm16);
+        MP3ClearBadFrame(outbuf);
         MP3_LOG_DEBUG("MP3, maindata underflow");
         return MP3_NONE;
     }
@@ -1210,7 +1416,16 @@ int32_t MP3Decoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf)
     mainBits = m_MP3DecInfo->mainDataBytes * 8;
 
     /* decode one complete frame */
+    int32_t  granSamps = m_MP3DecInfo->nGranSamps >> getRateShift();
+    int32_t* pcm = m_pipeTask ? m_pipePcm.get() + m_pipeSlot * MAX_NGRAN * MAX_NSAMP * 2 : outbuf;
     for (gr = 0; gr < m_MP3DecInfo->nGrans; gr++) {
+        GranuleJob_t* job = m_jobs.get();
+        if (m_pipeTask) { /* a free job, the task may still use the one before */
+            uint32_t head = m_pipeHead.load(std::memory_order_relaxed);
+            pipeWait(head + 1 - MP3_PIPE_JOBS);
+            job += head % MP3_PIPE_JOBS;
+        }
+        m_HuffmanInfo = &job->hi;
         for (ch = 0; ch < m_MP3DecInfo->nChans; ch++) {
             /* unpack scale factors and compute size of scale factor block */
             prevBitOffset = bitOffset;
@@ -1221,7 +1436,7 @@ int32_t MP3Decoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf)
             mainBits -= sfBlockBits;
 
             if (offset < 0 || mainBits < huffBlockBits) {
-                MP3ClearBadFrame(pcm16);
+                MP3ClearBadFrame(outbuf);
                 MP3_LOG_ERROR("MP3, invalid scalefact");
                 return MP3_ERR;
             }
@@ -1229,7 +1444,7 @@ int32_t MP3Decoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf)
             prevBitOffset = bitOffset;
             offset = DecodeHuffman(mainPtr, &bitOffset, huffBlockBits, gr, ch);
             if (offset < 0) {
-                MP3ClearBadFrame(pcm16);
+                MP3ClearBadFrame(outbuf);
                 MP3_LOG_ERROR("MP3, invalid Huffman code words");
                 return MP3_ERR;
             }
@@ -1238,28 +1453,61 @@ int32_t MP3Decoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf)
         }
         /* dequantize coefficients, decode stereo, reorder int16_t blocks */
         if (MP3Dequantize(gr) < 0) {
-            MP3ClearBadFrame(pcm16);
+            MP3ClearBadFrame(outbuf);
             MP3_LOG_ERROR("MP3, invalid dequantize coefficients");
             return MP3_ERR;
         }
 
-        /* alias reduction, inverse MDCT, overlap-add, frequency inversion */
-        for (ch = 0; ch < m_MP3DecInfo->nChans; ch++) {
-            if (IMDCT(gr, ch) < 0) {
-                MP3ClearBadFrame(pcm16);
-                MP3_LOG_ERROR("MP3, invalid inverse MDCT");
-                return MP3_ERR;
-            }
-        }
-        /* subband transform - if stereo, interleaves pcm LRLRLR */
-        if (Subband(pcm16 + gr * m_MP3DecInfo->nGranSamps * m_MP3DecInfo->nChans) < 0) {
-            MP3ClearBadFrame(pcm16);
-            MP3_LOG_ERROR("MP3, invalid subband");
+        memcpy(job->sis, m_SideInfoSub[gr], sizeof(job->sis));
+        job->nChans = m_MP3DecInfo->nChans;
+        job->blockCutoff = m_SFBandTable.l[(m_MPEGVersion == MPEG1 ? 8 : 6)] / 18; /* same as 3* num short sfb's in spec */
+        job->pcm = m_f_q31 ? (void*)(pcm + gr * granSamps * 2) : (void*)((int16_t*)pcm + gr * granSamps * synthChans());
+        if (m_pipeTask) { /* IMDCT and subband transform on the other core */
+            m_pipeHead.store(m_pipeHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            xSemaphoreGive(m_pipeWake);
+        } else if (SynthesizeGranule(job) < 0) {
+            MP3ClearBadFrame(outbuf);
+            MP3_LOG_ERROR("MP3, invalid synthesis");
             return MP3_ERR;
         }
     }
     MP3GetLastFrameInfo();
 
+    if (m_pipeTask) { /* return the frame before, this one is synthesized meanwhile */
+        MP3FrameInfo_t info = *m_MP3FrameInfo;
+        if (m_f_pipePending) {
+            *m_MP3FrameInfo = m_pipeInfo;
+            pipeWait(m_pipePendingEnd);
+            int32_t* prev = m_pipePcm.get() + (m_pipeSlot ^ 1) * MAX_NGRAN * MAX_NSAMP * 2;
+            if (m_f_q31) memcpy(outbuf, prev, m_MP3FrameInfo->outputSamps * 2 * sizeof(int32_t));
+            outputFrame(m_f_q31 ? nullptr : (int16_t*)prev, outbuf);
+        } else {
+            m_MP3FrameInfo->outputSamps = 0;
+        }
+        m_pipeInfo = info;
+        m_f_pipePending = true;
+        m_pipePendingEnd = m_pipeHead.load(std::memory_order_relaxed);
+        m_pipeSlot ^= 1;
+        return MP3_NONE;
+    }
+    outputFrame(m_f_q31 ? nullptr : pcm16, outbuf);
+    return MP3_NONE;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+/*
+ * Function:    outputFrame
+ *
+ * Description: int32_t LRLR... of the frame in outbuf, gapless trimming
+ *
+ * Inputs:      the 16 bit synthesis (may be outbuf, widened from the end), nullptr if outbuf holds the Q31 synthesis
+ *
+ * Outputs:     m_MP3FrameInfo->outputSamps samples per channel in outbuf
+ */
+void MP3Decoder::outputFrame(int16_t* pcm16, int32_t* outbuf) {
+    if (!pcm16) { // already int32_t LRLR...
+        trimGapless(outbuf);
+        return;
+    }
     if (m_MP3FrameInfo->nChans == 1) {
         for (int i = m_MP3FrameInfo->outputSamps - 1; i >= 0; i--) {
             int32_t sample = ((int32_t)pcm16[i]) << 16;
@@ -1273,57 +1521,258 @@ int32_t MP3Decoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf)
             outbuf[i] = ((int32_t)pcm16[i]) << 16;
         }
     }
-
-    return MP3_NONE;
+    trimGapless(outbuf);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int32_t MP3Decoder::flush(int32_t* outbuf) {
+    if (!m_f_pipePending) return 0;
+    m_f_pipePending = false;
+    *m_MP3FrameInfo = m_pipeInfo;
+    pipeWait(m_pipePendingEnd);
+    int32_t* prev = m_pipePcm.get() + (m_pipeSlot ^ 1) * MAX_NGRAN * MAX_NSAMP * 2;
+    if (m_f_q31) memcpy(outbuf, prev, m_MP3FrameInfo->outputSamps * 2 * sizeof(int32_t));
+    outputFrame(m_f_q31 ? nullptr : (int16_t*)prev, outbuf);
+    return m_MP3FrameInfo->outputSamps;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+/*
+ * P I P E L I N E
+ *
+ * settings.MP3_PIPELINE: decode() unpacks, Huffman decodes and dequantizes a granule and queues it as a GranuleJob_t,
+ * pipeTask() on the other core does the IMDCT and the subband transform in the order of the queue (m_jobs is a ring
+ * of MP3_PIPE_JOBS, m_pipeHead and m_pipeTail count the jobs). The output of a frame is returned with the next frame
+ * (or by flush()), one frame of latency. Stage 2 keeps its state (overlap, vbuf) to itself, so the samples are the
+ * same as without the pipeline.
+ */
+bool MP3Decoder::startPipeline() {
+    m_pipeWake = xSemaphoreCreateBinary();
+    m_pipeDone = xSemaphoreCreateBinary();
+    m_f_pipeRun = true;
+    m_f_pipeEnded = false;
+    if (!m_pipeWake || !m_pipeDone ||
+        xTaskCreatePinnedToCore(&MP3Decoder::pipeTask, "mp3pipe", 4096, this, 2, &m_pipeTask, xPortGetCoreID() ? 0 : 1) != pdPASS) {
+        stopPipeline();
+        return false;
+    }
+    return true;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void MP3Decoder::stopPipeline() {
+    if (m_pipeTask) {
+        m_f_pipeRun = false;
+        xSemaphoreGive(m_pipeWake);
+        while (!m_f_pipeEnded) xSemaphoreTake(m_pipeDone, pdMS_TO_TICKS(10));
+    }
+    if (m_pipeWake) vSemaphoreDelete(m_pipeWake);
+    if (m_pipeDone) vSemaphoreDelete(m_pipeDone);
+    m_pipeWake = m_pipeDone = nullptr;
+    m_pipeTask = nullptr;
+    m_f_pipePending = false;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void MP3Decoder::pipeWait(uint32_t jobs) { // until the task has finished the job jobs - 1
+    while ((int32_t)(m_pipeTail.load(std::memory_order_acquire) - jobs) < 0) xSemaphoreTake(m_pipeDone, portMAX_DELAY);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void MP3Decoder::pipeTask(void* param) {
+    MP3Decoder* d = static_cast<MP3Decoder*>(param);
+    while (d->m_f_pipeRun) {
+        uint32_t tail = d->m_pipeTail.load(std::memory_order_relaxed);
+        if (tail == d->m_pipeHead.load(std::memory_order_acquire)) {
+            xSemaphoreTake(d->m_pipeWake, portMAX_DELAY);
+            continue;
+        }
+        d->SynthesizeGranule(d->m_jobs.get() + tail % MP3_PIPE_JOBS);
+        d->m_pipeTail.store(tail + 1, std::memory_order_release);
+        xSemaphoreGive(d->m_pipeDone);
+    }
+    xSemaphoreGive(d->m_pipeDone);
+    d->m_f_pipeEnded = true; // d may be gone from here on
+    vTaskDelete(NULL);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+/*
+ * Function:    trimGapless
+ *
+ * Description: drops the encoder delay and padding given in the LAME tag
+ *
+ * Inputs:      interleaved output of the current frame, m_MP3FrameInfo->outputSamps samples per channel
+ *
+ * Outputs:     the remaining samples moved to the front of outbuf, reduced outputSamps
+ *
+ * Notes:       the synthesis filterbank delays the output by another 529 samples (ISO reference decoder),
+ *              the padding ends 529 samples later. After a seek the position is unknown and nothing is trimmed.
+ */
+void MP3Decoder::trimGapless(int32_t* outbuf) {
+    if (m_samplePos < 0) return;
+    int32_t n = m_MP3FrameInfo->outputSamps;
+    int64_t pos = m_samplePos;
+    m_samplePos += n;
+    if (!m_vbrHeader.encDelay && !m_vbrHeader.encPadding) return;
+
+    const int32_t rs = getRateShift(); // delay and padding count samples of the source
+    const int64_t first = ((int64_t)m_vbrHeader.encDelay + 529) >> rs;                                                                  // first valid sample
+    const int64_t last = m_vbrHeader.frames ? (int64_t)getTotalSamples() - (((int64_t)m_vbrHeader.encPadding - 529) >> rs) : INT64_MAX; // behind the last valid sample
+    int32_t       skip = (int32_t)std::clamp<int64_t>(first - pos, 0, n);
+    int32_t       keep = (int32_t)std::clamp<int64_t>(last - pos, skip, n);
+    if (skip && keep > skip) memmove(outbuf, outbuf + skip * 2, (keep - skip) * 2 * sizeof(int32_t));
+    m_MP3FrameInfo->outputSamps = keep - skip;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 /*
  * H U F F M A N N
  */
 
+/*
+ * first level lookup tables of the pair tables, generated from huffTable at compile time
+ *
+ * huffTable: a subtable is indexed with the next maxBits bits (low 4 bits of its first word), an entry is a code
+ * (len << 12 | y << 8 | x << 4, len counts from the start of the subtable) or, with len = 0, the offset of the next
+ * subtable. The walk costs a lookup per subtable and the sign bits a shift each. huffLUT is indexed with the next
+ * min(HUFF_LUT_BITS, bits of the deepest walk) bits of every tree (huffTable + huffTabOffset[tabIdx], the tables
+ * 16...23 and 24...31 share theirs) and holds
+ *   len << 12 | y << 8 | x << 4 | 8 | sign x << 1 | sign y   code and sign bits within the index (len counts them), no
+ *                                                           linbits, the common case: one lookup per pair
+ *   len << 12 | y << 8 | x << 4                              code within the index, signs / linbits follow
+ *   offset                                                   (len = 0) the few longer codes: skip the root subtable
+ *                                                           (maxBits in the first word of the tree) and walk on from
+ *                                                           the subtable at tree + offset
+ */
+static constexpr int32_t HUFF_LUT_BITS = 9;
+
+static constexpr bool huffTabIsTree(int32_t tabIdx) {
+    int32_t type = huffTabLookup[tabIdx].tabType;
+    return type == oneShot || type == loopNoLinbits || type == loopLinbits;
+}
+static constexpr int32_t huffWalkBits(int32_t t) { // bits of the deepest walk from the subtable at t
+    int32_t maxBits = huffTable[t] & 0x000f, deepest = 0;
+    for (int32_t i = 0; i < (1 << maxBits); i++) {
+        uint16_t cw = huffTable[t + 1 + i];
+        if (!(cw >> 12)) deepest = std::max(deepest, huffWalkBits(t + cw));
+    }
+    return maxBits + deepest;
+}
+static constexpr bool    huffTreeHasLinbits(int32_t t) { // the trees of the tables 16...31 are not shared with others
+    for (int32_t tabIdx = 0; tabIdx < HUFF_PAIRTABS; tabIdx++)
+        if (huffTabOffset[tabIdx] == t && huffTabLookup[tabIdx].tabType == loopLinbits) return true;
+    return false;
+}
+static constexpr int32_t huffLUTBits(int32_t tabIdx) { return std::min(HUFF_LUT_BITS, huffWalkBits(huffTabOffset[tabIdx])); }
+static constexpr bool    huffLUTOwner(int32_t tabIdx) { // the first table of a tree
+    for (int32_t j = 0; j < tabIdx; j++)
+        if (huffTabIsTree(j) && huffTabOffset[j] == huffTabOffset[tabIdx]) return false;
+    return huffTabIsTree(tabIdx);
+}
+static constexpr int32_t huffLUTSize() {
+    int32_t n = 0;
+    for (int32_t tabIdx = 0; tabIdx < HUFF_PAIRTABS; tabIdx++)
+        if (huffLUTOwner(tabIdx)) n += 1 << huffLUTBits(tabIdx);
+    return n;
+}
+static constexpr uint16_t huffLUTEntry(int32_t base, int32_t bits, uint32_t idx) {
+    int32_t t = base, used = 0, first = 0;
+    while (true) {
+        int32_t maxBits = huffTable[t] & 0x000f;
+        if (used + maxBits > bits) return first - base; // longer code
+        uint16_t cw = huffTable[t + 1 + ((idx >> (bits - used - maxBits)) & ((1 << maxBits) - 1))];
+        if (cw >> 12) {
+            int32_t  len = used + (cw >> 12), x = (cw >> 4) & 0x000f, y = (cw >> 8) & 0x000f;
+            uint32_t signs = 0;
+            if (huffTreeHasLinbits(base) && (x == 15 || y == 15)) return (len << 12) | (cw & 0x0ff0);
+            if (len + (x != 0) + (y != 0) > bits) return (len << 12) | (cw & 0x0ff0);
+            if (x) signs |= ((idx >> (bits - ++len)) & 1) << 1;
+            if (y) signs |= (idx >> (bits - ++len)) & 1;
+            return (len << 12) | (cw & 0x0ff0) | 0x0008 | signs;
+        }
+        used += maxBits;
+        t += cw;
+        if (!first) first = t;
+    }
+}
+
+struct HuffLUT_t {
+    uint16_t entry[huffLUTSize()];
+    uint16_t offset[HUFF_PAIRTABS]; // first entry of the table
+    uint8_t  bits[HUFF_PAIRTABS];   // index bits
+};
+static constexpr HuffLUT_t makeHuffLUT() {
+    HuffLUT_t lut{};
+    int32_t   n = 0;
+    for (int32_t tabIdx = 0; tabIdx < HUFF_PAIRTABS; tabIdx++) {
+        if (!huffTabIsTree(tabIdx)) continue;
+        int32_t bits = huffLUTBits(tabIdx);
+        lut.bits[tabIdx] = bits;
+        if (!huffLUTOwner(tabIdx)) {
+            for (int32_t j = 0; j < tabIdx; j++)
+                if (huffTabOffset[j] == huffTabOffset[tabIdx]) lut.offset[tabIdx] = lut.offset[j];
+            continue;
+        }
+        lut.offset[tabIdx] = n;
+        for (int32_t idx = 0; idx < (1 << bits); idx++) lut.entry[n++] = huffLUTEntry(huffTabOffset[tabIdx], bits, idx);
+    }
+    return lut;
+}
+static constexpr HuffLUT_t huffLUT = makeHuffLUT();
+static_assert(HUFF_LUT_BITS >= 9 && HUFF_LUT_BITS <= 15, "the root subtables have up to 9 bits, len has 4");
+
+/*
+ * the quad tables indexed with the code (quadTabMaxBits) and the 4 bits that follow, they hold the signs too:
+ * len << 8 | sign v << 7 | sign w << 6 | sign x << 5 | sign y << 4 | v << 3 | w << 2 | x << 1 | y (len counts the signs)
+ */
+static constexpr int32_t quadLUTBits[2] = {quadTabMaxBits[0] + 4, quadTabMaxBits[1] + 4};
+static constexpr int32_t quadLUTOffset[2] = {0, 1 << quadLUTBits[0]};
+
+struct QuadLUT_t {
+    uint16_t entry[(1 << quadLUTBits[0]) + (1 << quadLUTBits[1])];
+};
+static constexpr QuadLUT_t makeQuadLUT() {
+    QuadLUT_t lut{};
+    for (int32_t tabIdx = 0; tabIdx < 2; tabIdx++) {
+        int32_t maxBits = quadTabMaxBits[tabIdx], bits = quadLUTBits[tabIdx];
+        for (int32_t idx = 0; idx < (1 << bits); idx++) {
+            uint8_t  cw = quadTable[quadTabOffset[tabIdx] + (idx >> (bits - maxBits))];
+            int32_t  len = cw >> 4;
+            uint32_t signs = 0;
+            for (int32_t k = 3; k >= 0; k--)
+                if ((cw >> k) & 1) signs |= ((idx >> (bits - ++len)) & 1) << (k + 4);
+            lut.entry[quadLUTOffset[tabIdx] + idx] = (len << 8) | signs | (cw & 0x0f);
+        }
+    }
+    return lut;
+}
+static constexpr QuadLUT_t quadLUT = makeQuadLUT();
+
 /*
  * Function:    DecodeHuffmanPairs
  *
  * Description: decode 2-way vector Huffman codes in the "bigValues" region of spectrum
  *
- * Inputs:      valid BitStreamInfo struct, pointing to start of pair-wise codes
- *              pointer to xy buffer to received decoded values
+ * Inputs:      pointer to xy buffer to received decoded values
  *              number of codewords to decode
  *              index of Huffman table to use
  *              number of bits remaining in bitstream
+ *              pointer to the first byte and bit offset (0-7) of the pair-wise codes
  *
- * Outputs:     pairs of decoded coefficients in vwxy
- *              updated BitStreamInfo struct
+ * Outputs:     pairs of decoded coefficients in xy
  *
  * Return:      number of bits used, or -1 if out of bits
  *
  * Notes:       assumes that nVals is an even number
- *              si_huff.bit tests every Huffman codeword in every table (though not
- *                necessarily all linBits outputs for x,y > 15)
+ *              one lookup in huffLUT per pair for all but the longest codes, HuffBits_t holds the longest pair (19 bits
+ *                code, 2 * 13 linbits, 2 signs) and is refilled when it has less
  */
-// no improvement with section=data
-
 int32_t MP3Decoder::DecodeHuffmanPairs(int32_t* xy, int32_t nVals, int32_t tabIdx, int32_t bitsLeft, uint8_t* buf, int32_t bitOffset) {
-    int32_t       i, x, y;
-    int32_t       cachedBits, padBits, len, startBits, linBits, maxBits, minBits;
-    HuffTabType_t tabType;
-    uint16_t      cw, *tBase, *tCurr;
-    uint32_t      cache;
+    int32_t         i, x, y, startBits, linBits, lutBits, minBits, maxBits;
+    HuffTabType_t   tabType;
+    uint32_t        cw;
+    const uint16_t *lut, *tBase, *tCurr;
+    HuffBits_t      hb;
 
     if (nVals <= 0) return 0;
 
     if (bitsLeft < 0) return -1;
     startBits = bitsLeft;
 
-    tBase = (uint16_t*)(huffTable + huffTabOffset[tabIdx]);
-    linBits = huffTabLookup[tabIdx].linBits;
-    tabType = (HuffTabType_t)huffTabLookup[tabIdx].tabType;
-
-    //    assert(!(nVals & 0x01));
-    //    assert(tabIdx < m_HUFF_PAIRTABS);
-    //    assert(tabIdx >= 0);
-    //    assert(tabType != invalidTab);
-
     if ((nVals & 0x01)) {
         MP3_LOG_DEBUG("assert(!(nVals & 0x01))");
         return -1;
@@ -1336,17 +1785,12 @@ int32_t MP3Decoder::DecodeHuffmanPairs(int32_t* xy, int32_t nVals, int32_t tabId
         MP3_LOG_DEBUG("(tabIdx >= 0)");
         return -1;
     }
+    tabType = (HuffTabType_t)huffTabLookup[tabIdx].tabType;
     if (!(tabType != invalidTab)) {
         MP3_LOG_DEBUG("(tabType != invalidTab)");
         return -1;
     }
 
-    /* initially fill cache with any partial byte */
-    cache = 0;
-    cachedBits = (8 - bitOffset) & 0x07;
-    if (cachedBits) cache = (uint32_t)(*buf++) << (32 - cachedBits);
-    bitsLeft -= cachedBits;
-
     if (tabType == noBits) {
         /* table 0, no data, x = y = 0 */
         for (i = 0; i < nVals; i += 2) {
@@ -1354,177 +1798,62 @@ int32_t MP3Decoder::DecodeHuffmanPairs(int32_t* xy, int32_t nVals, int32_t tabId
             xy[i + 1] = 0;
         }
         return 0;
-    } else if (tabType == oneShot) {
-        /* single lookup, no escapes */
-
-        maxBits = (int32_t)((((uint16_t)(pgm_read_word(&tBase[0])) >> 0) & 0x000f));
-        tBase++;
-        padBits = 0;
-        while (nVals > 0) {
-            /* refill cache - assumes cachedBits <= 16 */
-            if (bitsLeft >= 16) {
-                /* load 2 new bytes into left-justified cache */
-                cache |= (uint32_t)(*buf++) << (24 - cachedBits);
-                cache |= (uint32_t)(*buf++) << (16 - cachedBits);
-                cachedBits += 16;
-                bitsLeft -= 16;
-            } else {
-                /* last time through, pad cache with zeros and drain cache */
-                if (cachedBits + bitsLeft <= 0) { return -1; }
-                if (bitsLeft > 0) cache |= (uint32_t)(*buf++) << (24 - cachedBits);
-                if (bitsLeft > 8) cache |= (uint32_t)(*buf++) << (16 - cachedBits);
-                cachedBits += bitsLeft;
-                bitsLeft = 0;
-
-                cache &= (int32_t)0x80000000 >> (cachedBits - 1);
-                padBits = 11;
-                cachedBits += padBits; /* okay if this is > 32 (0's automatically shifted in from right) */
-            }
-
-            /* largest maxBits = 9, plus 2 for sign bits, so make sure cache has at least 11 bits */
-            while (nVals > 0 && cachedBits >= 11) {
-                cw = pgm_read_word(&tBase[cache >> (32 - maxBits)]);
-
-                len = (int32_t)((((uint16_t)(cw)) >> 12) & 0x000f);
-                cachedBits -= len;
-                cache <<= len;
-
-                x = (int32_t)((((uint16_t)(cw)) >> 4) & 0x000f);
-                if (x) {
-                    (x) |= ((cache) & 0x80000000);
-                    cache <<= 1;
-                    cachedBits--;
-                }
-
-                y = (int32_t)((((uint16_t)(cw)) >> 8) & 0x000f);
-                if (y) {
-                    (y) |= ((cache) & 0x80000000);
-                    cache <<= 1;
-                    cachedBits--;
-                }
-
-                /* ran out of bits - should never have consumed padBits */
-                if (cachedBits < padBits) {
-                    MP3_LOG_ERROR("MP3, error - overran end of bitstream"); // https://bestof80s.stream.laut.fm/best_of_80s (after advertising)
-                    return MP3_ERR;
-                }
+    }
 
-                *xy++ = x;
-                *xy++ = y;
-                nVals -= 2;
-            }
+    tBase = huffTable + huffTabOffset[tabIdx];
+    lut = huffLUT.entry + huffLUT.offset[tabIdx];
+    lutBits = huffLUT.bits[tabIdx];
+    linBits = tabType == loopLinbits ? huffTabLookup[tabIdx].linBits : 0;
+    minBits = 19 + 2 + 2 * linBits; /* longest code, sign bits, linbits */
+    hb.start(buf, bitOffset, bitsLeft);
+
+    while (nVals > 0) {
+        if (hb.cachedBits < minBits) hb.refill();
+        cw = pgm_read_word(&lut[hb.cache >> (64 - lutBits)]);
+        if ((cw & 0x0008) && (cw >> 12)) { /* code and sign bits */
+            hb.skip(cw >> 12);
+            *xy++ = (int32_t)(((cw >> 4) & 0x000f) | (cw & 0x0002) << 30);
+            *xy++ = (int32_t)(((cw >> 8) & 0x000f) | (cw & 0x0001) << 31);
+            nVals -= 2;
+            continue;
         }
-        bitsLeft += (cachedBits - padBits);
-        return (startBits - bitsLeft);
-    } else if (tabType == loopLinbits || tabType == loopNoLinbits) {
-        tCurr = tBase;
-        padBits = 0;
-        while (nVals > 0) {
-            /* refill cache - assumes cachedBits <= 16 */
-            if (bitsLeft >= 16) {
-                /* load 2 new bytes into left-justified cache */
-                cache |= (uint32_t)(*buf++) << (24 - cachedBits);
-                cache |= (uint32_t)(*buf++) << (16 - cachedBits);
-                cachedBits += 16;
-                bitsLeft -= 16;
-            } else {
-                /* last time through, pad cache with zeros and drain cache */
-                if (cachedBits + bitsLeft <= 0) { return -1; }
-                if (bitsLeft > 0) cache |= (uint32_t)(*buf++) << (24 - cachedBits);
-                if (bitsLeft > 8) cache |= (uint32_t)(*buf++) << (16 - cachedBits);
-                cachedBits += bitsLeft;
-                bitsLeft = 0;
-
-                cache &= (int32_t)0x80000000 >> (cachedBits - 1);
-                padBits = 11;
-                cachedBits += padBits; /* okay if this is > 32 (0's automatically shifted in from right) */
+        if (!(cw >> 12)) {
+            /* longer code, walk on from the second subtable */
+            hb.skip(pgm_read_word(&tBase[0]) & 0x000f);
+            tCurr = tBase + cw;
+            while (true) {
+                maxBits = pgm_read_word(&tCurr[0]) & 0x000f;
+                cw = pgm_read_word(&tCurr[(hb.cache >> (64 - maxBits)) + 1]);
+                if (cw >> 12) break;
+                hb.skip(maxBits);
+                tCurr += cw;
             }
+        }
+        hb.skip(cw >> 12);
 
-            /* largest maxBits = 9, plus 2 for sign bits, so make sure cache has at least 11 bits */
-            while (nVals > 0 && cachedBits >= 11) {
-                maxBits = (int32_t)((((uint16_t)(pgm_read_word(&tCurr[0]))) >> 0) & 0x000f);
-                cw = pgm_read_word(&tCurr[(cache >> (32 - maxBits)) + 1]);
-                len = (int32_t)((((uint16_t)(cw)) >> 12) & 0x000f);
-                if (!len) {
-                    cachedBits -= maxBits;
-                    cache <<= maxBits;
-                    tCurr += cw;
-                    continue;
-                }
-                cachedBits -= len;
-                cache <<= len;
-
-                x = (int32_t)((((uint16_t)(cw)) >> 4) & 0x000f);
-                y = (int32_t)((((uint16_t)(cw)) >> 8) & 0x000f);
-
-                if (x == 15 && tabType == loopLinbits) {
-                    minBits = linBits + 1 + (y ? 1 : 0);
-                    if (cachedBits + bitsLeft < minBits) return -1;
-                    while (cachedBits < minBits) {
-                        cache |= (uint32_t)(*buf++) << (24 - cachedBits);
-                        cachedBits += 8;
-                        bitsLeft -= 8;
-                    }
-                    if (bitsLeft < 0) {
-                        cachedBits += bitsLeft;
-                        bitsLeft = 0;
-                        cache &= (int32_t)0x80000000 >> (cachedBits - 1);
-                    }
-                    x += (int32_t)(cache >> (32 - linBits));
-                    cachedBits -= linBits;
-                    cache <<= linBits;
-                }
-                if (x) {
-                    (x) |= ((cache) & 0x80000000);
-                    cache <<= 1;
-                    cachedBits--;
-                }
-
-                if (y == 15 && tabType == loopLinbits) {
-                    minBits = linBits + 1;
-                    if (cachedBits + bitsLeft < minBits) {
-                        MP3_LOG_ERROR("MP3, error - overran end of bitstream"); // https://bestof80s.stream.laut.fm/best_of_80s (after advertising)
-                        return MP3_ERR;
-                    }
-                    // return -1;
-                    while (cachedBits < minBits) {
-                        cache |= (uint32_t)(*buf++) << (24 - cachedBits);
-                        cachedBits += 8;
-                        bitsLeft -= 8;
-                    }
-                    if (bitsLeft < 0) {
-                        cachedBits += bitsLeft;
-                        bitsLeft = 0;
-                        cache &= (int32_t)0x80000000 >> (cachedBits - 1);
-                    }
-                    y += (int32_t)(cache >> (32 - linBits));
-                    cachedBits -= linBits;
-                    cache <<= linBits;
-                }
-                if (y) {
-                    (y) |= ((cache) & 0x80000000);
-                    cache <<= 1;
-                    cachedBits--;
-                }
-
-                /* ran out of bits - should never have consumed padBits */
-                if (cachedBits < padBits) {
-                    break; // https://bestof80s.stream.laut.fm/best_of_80s (after advertising)
-                    // return -1;
-                }
+        x = (cw >> 4) & 0x000f;
+        y = (cw >> 8) & 0x000f;
+        if (x == 15 && linBits) {
+            x += (int32_t)(hb.cache >> (64 - linBits));
+            hb.skip(linBits);
+        }
+        if (x) x |= hb.sign();
+        if (y == 15 && linBits) {
+            y += (int32_t)(hb.cache >> (64 - linBits));
+            hb.skip(linBits);
+        }
+        if (y) y |= hb.sign();
 
-                *xy++ = x;
-                *xy++ = y;
-                nVals -= 2;
-                tCurr = tBase;
-            }
+        /* ran out of bits */
+        if (hb.cachedBits < 0) {
+            MP3_LOG_DEBUG("MP3, error - overran end of bitstream"); // https://bestof80s.stream.laut.fm/best_of_80s (after advertising)
+            return -1;
         }
-        bitsLeft += (cachedBits - padBits);
-        return (startBits - bitsLeft);
+        *xy++ = x;
+        *xy++ = y;
+        nVals -= 2;
     }
-
-    /* error in bitstream - trying to access unused Huffman table */
-    return -1;
+    return startBits - hb.bitsLeft - hb.cachedBits;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 /*
@@ -1532,103 +1861,46 @@ int32_t MP3Decoder::DecodeHuffmanPairs(int32_t* xy, int32_t nVals, int32_t tabId
  *
  * Description: decode 4-way vector Huffman codes in the "count1" region of spectrum
  *
- * Inputs:      valid BitStreamInfo struct, pointing to start of quadword codes
- *              pointer to vwxy buffer to received decoded values
+ * Inputs:      pointer to vwxy buffer to received decoded values
  *              maximum number of codewords to decode
  *              index of quadword table (0 = table A, 1 = table B)
  *              number of bits remaining in bitstream
+ *              pointer to the first byte and bit offset (0-7) of the quadword codes
  *
  * Outputs:     quadruples of decoded coefficients in vwxy
- *              updated BitStreamInfo struct
  *
  * Return:      index of the first "zero_part" value (index of the first sample
  *                of the quad word after which all samples are 0)
  *
  * Notes:        si_huff.bit tests every vwxy output in both quad tables
  */
-// no improvement with section=data
 int32_t MP3Decoder::DecodeHuffmanQuads(int32_t* vwxy, int32_t nVals, int32_t tabIdx, int32_t bitsLeft, uint8_t* buf, int32_t bitOffset) {
-    int32_t  i, v, w, x, y;
-    int32_t  len, maxBits, cachedBits, padBits;
-    uint32_t cache;
-    uint8_t  cw, *tBase;
+    int32_t         i, bits;
+    uint32_t        cw;
+    const uint16_t* lut;
+    HuffBits_t      hb;
 
     if (bitsLeft <= 0) return 0;
 
-    tBase = (uint8_t*)quadTable + quadTabOffset[tabIdx];
-    maxBits = quadTabMaxBits[tabIdx];
+    lut = quadLUT.entry + quadLUTOffset[tabIdx];
+    bits = quadLUTBits[tabIdx];
+    hb.start(buf, bitOffset, bitsLeft);
 
-    /* initially fill cache with any partial byte */
-    cache = 0;
-    cachedBits = (8 - bitOffset) & 0x07;
-    if (cachedBits) cache = (uint32_t)(*buf++) << (32 - cachedBits);
-    bitsLeft -= cachedBits;
-
-    i = padBits = 0;
+    i = 0;
     while (i < (nVals - 3)) {
-        /* refill cache - assumes cachedBits <= 16 */
-        if (bitsLeft >= 16) {
-            /* load 2 new bytes into left-justified cache */
-            cache |= (uint32_t)(*buf++) << (24 - cachedBits);
-            cache |= (uint32_t)(*buf++) << (16 - cachedBits);
-            cachedBits += 16;
-            bitsLeft -= 16;
-        } else {
-            /* last time through, pad cache with zeros and drain cache */
-            if (cachedBits + bitsLeft <= 0) return i;
-            if (bitsLeft > 0) cache |= (uint32_t)(*buf++) << (24 - cachedBits);
-            if (bitsLeft > 8) cache |= (uint32_t)(*buf++) << (16 - cachedBits);
-            cachedBits += bitsLeft;
-            bitsLeft = 0;
-
-            cache &= (int32_t)0x80000000 >> (cachedBits - 1);
-            padBits = 10;
-            cachedBits += padBits; /* okay if this is > 32 (0's automatically shifted in from right) */
-        }
-
-        /* largest maxBits = 6, plus 4 for sign bits, so make sure cache has at least 10 bits */
-        while (i < (nVals - 3) && cachedBits >= 10) {
-            cw = pgm_read_byte(&tBase[cache >> (32 - maxBits)]);
-            len = (int32_t)((((uint8_t)(cw)) >> 4) & 0x0f);
-            cachedBits -= len;
-            cache <<= len;
-
-            v = (int32_t)((((uint8_t)(cw)) >> 3) & 0x01);
-            if (v) {
-                (v) |= ((cache) & 0x80000000);
-                cache <<= 1;
-                cachedBits--;
-            }
-            w = (int32_t)((((uint8_t)(cw)) >> 2) & 0x01);
-            if (w) {
-                (w) |= ((cache) & 0x80000000);
-                cache <<= 1;
-                cachedBits--;
-            }
-
-            x = (int32_t)((((uint8_t)(cw)) >> 1) & 0x01);
-            if (x) {
-                (x) |= ((cache) & 0x80000000);
-                cache <<= 1;
-                cachedBits--;
-            }
-
-            y = (int32_t)((((uint8_t)(cw)) >> 0) & 0x01);
-            if (y) {
-                (y) |= ((cache) & 0x80000000);
-                cache <<= 1;
-                cachedBits--;
-            }
-
-            /* ran out of bits - okay (means we're done) */
-            if (cachedBits < padBits) return i;
-
-            *vwxy++ = v;
-            *vwxy++ = w;
-            *vwxy++ = x;
-            *vwxy++ = y;
-            i += 4;
-        }
+        /* largest maxBits = 6, plus 4 for sign bits */
+        if (hb.cachedBits < 10) hb.refill();
+        cw = pgm_read_word(&lut[hb.cache >> (64 - bits)]);
+        hb.skip(cw >> 8);
+
+        /* ran out of bits - okay (means we're done) */
+        if (hb.cachedBits < 0) return i;
+
+        *vwxy++ = (int32_t)(((cw >> 3) & 0x01) | (cw & 0x80) << 24);
+        *vwxy++ = (int32_t)(((cw >> 2) & 0x01) | (cw & 0x40) << 25);
+        *vwxy++ = (int32_t)(((cw >> 1) & 0x01) | (cw & 0x20) << 26);
+        *vwxy++ = (int32_t)(((cw >> 0) & 0x01) | (cw & 0x10) << 27);
+        i += 4;
     }
 
     /* decoded max number of quad values */
@@ -3012,15 +3284,37 @@ int32_t MP3Decoder::HybridTransform(int32_t* xCurr, int32_t* xPrev, int32_t y[BL
     return nBlocksOut;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+/*
+ * Function:    SynthesizeGranule
+ *
+ * Description: alias reduction, inverse MDCT, overlap-add, frequency inversion and subband transform of one granule,
+ *              called by decode() or, with settings.MP3_PIPELINE, by pipeTask()
+ *
+ * Inputs:      granule job filled by decode()
+ *
+ * Outputs:     PCM samples at job->pcm, interleaved LRLRLR... if stereo
+ *
+ * Return:      0 on success, -1 on error
+ *
+ * Notes:       uses only the job and the state of the synthesis (m_IMDCTInfo, m_SubbandInfo, m_f_mixedSpectrum)
+ */
+int32_t MP3Decoder::SynthesizeGranule(GranuleJob_t* job) {
+    int32_t nChans = synthChans(job->nChans);
+    for (int32_t ch = 0; ch < nChans; ch++) {
+        if ((nChans < job->nChans ? IMDCTMono(job) : IMDCT(job, ch)) < 0) return -1;
+    }
+    /* subband transform - if stereo, interleaves pcm LRLRLR */
+    return m_f_q31 ? Subband((int32_t*)job->pcm, nChans) : Subband((int16_t*)job->pcm, nChans);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 /*
  * Function:    IMDCT
  *
  * Description: do alias reduction, inverse MDCT, overlap-add, and frequency inversion
  *
- * Inputs:      MP3DecInfo structure filled by UnpackFrameHeader(), UnpackSideInfo(),
- *                UnpackScaleFactors(), and DecodeHuffman() (for this granule, channel)
+ * Inputs:      granule job filled by decode() (dequantized coefficients, side info of this granule)
  *                includes PCM samples in overBuf (from last call to IMDCT) for OLA
- *              index of current granule and channel
+ *              index of current channel
  *
  * Outputs:     PCM samples in outBuf, for input to subband transform
  *              PCM samples in overBuf, for OLA next time
@@ -3030,9 +3324,11 @@ int32_t MP3Decoder::HybridTransform(int32_t* xCurr, int32_t* xPrev, int32_t y[BL
  */
 // a bit faster in RAM
 /*__attribute__ ((section (".data")))*/
-int32_t MP3Decoder::IMDCT(int32_t gr, int32_t ch) {
-    int32_t      nBfly, blockCutoff;
-    BlockCount_t bc;
+int32_t MP3Decoder::IMDCT(GranuleJob_t* job, int32_t ch) {
+    int32_t        nBfly, blockCutoff;
+    BlockCount_t   bc;
+    HuffmanInfo_t* hi = &job->hi;
+    SideInfoSub_t* sis = &job->sis[ch];
 
     /* m_SideInfo is an array of up to 4 structs, stored as gr0ch0, gr0ch1, gr1ch0, gr1ch1 */
     /* anti-aliasing done on whole long blocks only
@@ -3040,14 +3336,16 @@ int32_t MP3Decoder::IMDCT(int32_t gr, int32_t ch) {
      *   nLongBlocks = number of blocks with (possibly) non-zero power
      *   nBfly = number of butterflies to do (nLongBlocks - 1, unless no long blocks)
      */
-    blockCutoff = m_SFBandTable.l[(m_MPEGVersion == MPEG1 ? 8 : 6)] / 18; /* same as 3* num short sfb's in spec */
-    if (m_SideInfoSub[gr][ch].blockType != 2) {
+    /* MP3_SYNTH_HALF_RATE synthesizes subbands 0...15, subband 16 is needed for the alias reduction of 15 */
+    const int32_t nBlocksMax = getRateShift() ? 17 : 32;
+    blockCutoff = job->blockCutoff;
+    if (sis->blockType != 2) {
         /* all long transforms */
-        int32_t x = (m_HuffmanInfo->nonZeroBound[ch] + 7) / 18 + 1;
-        bc.nBlocksLong = (x < 32 ? x : 32);
+        int32_t x = (hi->nonZeroBound[ch] + 7) / 18 + 1;
+        bc.nBlocksLong = (x < nBlocksMax ? x : nBlocksMax);
         // bc.nBlocksLong = min((hi->nonZeroBound[ch] + 7) / 18 + 1, 32);
         nBfly = bc.nBlocksLong - 1;
-    } else if (m_SideInfoSub[gr][ch].blockType == 2 && m_SideInfoSub[gr][ch].mixedBlock) {
+    } else if (sis->blockType == 2 && sis->mixedBlock) {
         /* mixed block - long transforms until cutoff, then short transforms */
         bc.nBlocksLong = blockCutoff;
         nBfly = bc.nBlocksLong - 1;
@@ -3057,24 +3355,24 @@ int32_t MP3Decoder::IMDCT(int32_t gr, int32_t ch) {
         nBfly = 0;
     }
 
-    AntiAlias(m_HuffmanInfo->huffDecBuf[ch], nBfly);
-    int32_t x = m_HuffmanInfo->nonZeroBound[ch];
+    AntiAlias(hi->huffDecBuf[ch], nBfly);
+    int32_t x = hi->nonZeroBound[ch];
     int32_t y = nBfly * 18 + 8;
-    m_HuffmanInfo->nonZeroBound[ch] = (x > y ? x : y);
+    hi->nonZeroBound[ch] = (x > y ? x : y);
 
-    assert(m_HuffmanInfo->nonZeroBound[ch] <= MAX_NSAMP);
+    assert(hi->nonZeroBound[ch] <= MAX_NSAMP);
 
     /* for readability, use a struct instead of passing a million parameters to HybridTransform() */
-    bc.nBlocksTotal = (m_HuffmanInfo->nonZeroBound[ch] + 17) / 18;
+    bc.nBlocksTotal = min((hi->nonZeroBound[ch] + 17) / 18, nBlocksMax);
     bc.nBlocksPrev = m_IMDCTInfo->numPrevIMDCT[ch];
     bc.prevType = m_IMDCTInfo->prevType[ch];
     bc.prevWinSwitch = m_IMDCTInfo->prevWinSwitch[ch];
     /* where WINDOW switches (not nec. transform) */
-    bc.currWinSwitch = (m_SideInfoSub[gr][ch].mixedBlock ? blockCutoff : 0);
-    bc.gbIn = m_HuffmanInfo->gb[ch];
+    bc.currWinSwitch = (sis->mixedBlock ? blockCutoff : 0);
+    bc.gbIn = hi->gb[ch];
 
-    m_IMDCTInfo->numPrevIMDCT[ch] = HybridTransform(m_HuffmanInfo->huffDecBuf[ch], m_IMDCTInfo->overBuf[ch], m_IMDCTInfo->outBuf[ch], &m_SideInfoSub[gr][ch], &bc);
-    m_IMDCTInfo->prevType[ch] = m_SideInfoSub[gr][ch].blockType;
+    m_IMDCTInfo->numPrevIMDCT[ch] = HybridTransform(hi->huffDecBuf[ch], m_IMDCTInfo->overBuf[ch], m_IMDCTInfo->outBuf[ch], sis, &bc);
+    m_IMDCTInfo->prevType[ch] = sis->blockType;
     m_IMDCTInfo->prevWinSwitch[ch] = bc.currWinSwitch; /* 0 means not a mixed block (either all short or all long) */
     m_IMDCTInfo->gb[ch] = bc.gbOut;
 
@@ -3084,6 +3382,59 @@ int32_t MP3Decoder::IMDCT(int32_t gr, int32_t ch) {
     return 0;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+/*
+ * Function:    IMDCTMono
+ *
+ * Description: IMDCT of (L + R) / 2 for MP3_SYNTH_MONO, after the stereo processing of MP3Dequantize()
+ *
+ * Inputs:      granule job, L and R in huffDecBuf[0] and [1]
+ *
+ * Outputs:     the subband samples of the mix in outBuf[0]
+ *
+ * Return:      0 on success,  -1 on error
+ *
+ * Notes:       the hybrid transform is linear, as long as both channels use the same windows in this and in the
+ *              previous granule the spectra are mixed and one IMDCT runs, overBuf[0] holds the overlap of the mix
+ *              from then on. Otherwise both channels are transformed (channel 1 continues from the overlap of the
+ *              mix) and the outputs are mixed.
+ */
+int32_t MP3Decoder::IMDCTMono(GranuleJob_t* job) {
+    IMDCTInfo_t*   mi = m_IMDCTInfo.get();
+    HuffmanInfo_t* hi = &job->hi;
+    SideInfoSub_t* sis = job->sis;
+    bool           mix = sis[0].blockType == sis[1].blockType && sis[0].mixedBlock == sis[1].mixedBlock;
+
+    if (mix && !m_f_mixedSpectrum) {
+        mix = mi->prevType[0] == mi->prevType[1] && mi->prevWinSwitch[0] == mi->prevWinSwitch[1];
+        if (mix) { /* from now on one overlap */
+            for (int32_t i = 0; i < MAX_NSAMP / 2; i++) mi->overBuf[0][i] = (mi->overBuf[0][i] >> 1) + (mi->overBuf[1][i] >> 1);
+            mi->numPrevIMDCT[0] = max(mi->numPrevIMDCT[0], mi->numPrevIMDCT[1]);
+            m_f_mixedSpectrum = true;
+        }
+    }
+    if (mix) {
+        int32_t n = min(max(hi->nonZeroBound[0], hi->nonZeroBound[1]), getRateShift() ? 17 * 18 : MAX_NSAMP);
+        for (int32_t i = 0; i < n; i++) hi->huffDecBuf[0][i] = (hi->huffDecBuf[0][i] >> 1) + (hi->huffDecBuf[1][i] >> 1);
+        hi->nonZeroBound[0] = n;
+        hi->gb[0] = min(hi->gb[0], hi->gb[1]);
+        return IMDCT(job, 0);
+    }
+
+    if (m_f_mixedSpectrum) { /* back to two overlaps */
+        memcpy(mi->overBuf[1], mi->overBuf[0], sizeof(mi->overBuf[0]));
+        mi->numPrevIMDCT[1] = mi->numPrevIMDCT[0];
+        mi->prevType[1] = mi->prevType[0];
+        mi->prevWinSwitch[1] = mi->prevWinSwitch[0];
+        m_f_mixedSpectrum = false;
+    }
+    if (IMDCT(job, 0) < 0 || IMDCT(job, 1) < 0) return -1;
+    int32_t nBands = NBANDS >> getRateShift();
+    for (int32_t b = 0; b < BLOCK_SIZE; b++)
+        for (int32_t i = 0; i < nBands; i++) mi->outBuf[0][b][i] = (mi->outBuf[0][b][i] >> 1) + (mi->outBuf[1][b][i] >> 1);
+    mi->gb[0] = min(mi->gb[0], mi->gb[1]);
+    return 0;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 /*
  * S U B B A N D
  */
@@ -3093,31 +3444,40 @@ int32_t MP3Decoder::IMDCT(int32_t gr, int32_t ch) {
  *
  * Description: do subband transform on all the blocks in one granule, all channels
  *
- * Inputs:      filled MP3DecInfo structure, after calling IMDCT for all channels
+ * Inputs:      outBuf after calling IMDCT for all channels, number of synthesized channels
  *              vbuf[ch] and vindex[ch] must be preserved between calls
  *
- * Outputs:     decoded PCM data, interleaved LRLRLR... if stereo
+ * Outputs:     decoded PCM data, interleaved LRLRLR... if stereo, int32_t (Q31) always LRLRLR... (mono on both channels)
  *
  * Return:      0 on success,  -1 if null input pointers
+ *
+ * Notes:       MP3_SYNTH_MONO synthesizes outBuf[0] only (IMDCTMono() mixed the channels)
+ *              MP3_SYNTH_HALF_RATE: 16 samples per block, the even ones of the filterbank output without subbands 16...31,
+ *              IMDCT() cleared 17...31, 16 is cleared here
  */
-int32_t MP3Decoder::Subband(int16_t* pcmBuf) {
+template <typename T> int32_t MP3Decoder::Subband(T* pcmBuf, int32_t nChans) {
     int32_t b;
-    if (m_MP3DecInfo->nChans == 2) {
+    int32_t rs = getRateShift();
+    if (rs) {
+        for (int32_t ch = 0; ch < nChans; ch++)
+            for (b = 0; b < BLOCK_SIZE; b++) m_IMDCTInfo->outBuf[ch][b][16] = 0;
+    }
+    if (nChans == 2) {
         /* stereo */
         for (b = 0; b < BLOCK_SIZE; b++) {
             FDCT32(m_IMDCTInfo->outBuf[0][b], m_SubbandInfo->vbuf + 0 * 32, m_SubbandInfo->vindex, (b & 0x01), m_IMDCTInfo->gb[0]);
             FDCT32(m_IMDCTInfo->outBuf[1][b], m_SubbandInfo->vbuf + 1 * 32, m_SubbandInfo->vindex, (b & 0x01), m_IMDCTInfo->gb[1]);
-            PolyphaseStereo(pcmBuf, m_SubbandInfo->vbuf + m_SubbandInfo->vindex + VBUF_LENGTH * (b & 0x01), polyCoef);
+            PolyphaseStereo(pcmBuf, m_SubbandInfo->vbuf + m_SubbandInfo->vindex + VBUF_LENGTH * (b & 0x01), polyCoef, rs);
             m_SubbandInfo->vindex = (m_SubbandInfo->vindex - (b & 0x01)) & 7;
-            pcmBuf += (2 * NBANDS);
+            pcmBuf += (2 * NBANDS) >> rs;
         }
     } else {
         /* mono */
         for (b = 0; b < BLOCK_SIZE; b++) {
             FDCT32(m_IMDCTInfo->outBuf[0][b], m_SubbandInfo->vbuf + 0 * 32, m_SubbandInfo->vindex, (b & 0x01), m_IMDCTInfo->gb[0]);
-            PolyphaseMono(pcmBuf, m_SubbandInfo->vbuf + m_SubbandInfo->vindex + VBUF_LENGTH * (b & 0x01), polyCoef);
+            PolyphaseMono(pcmBuf, m_SubbandInfo->vbuf + m_SubbandInfo->vindex + VBUF_LENGTH * (b & 0x01), polyCoef, rs);
             m_SubbandInfo->vindex = (m_SubbandInfo->vindex - (b & 0x01)) & 7;
-            pcmBuf += NBANDS;
+            pcmBuf += (NBANDS * (sizeof(T) == 4 ? 2 : 1)) >> rs;
         }
     }
 
@@ -3356,9 +3716,7 @@ int16_t MP3Decoder::ClipToShort(int32_t x, int32_t fracBits) {
     // this is better on xtensa (fb)
     asm("clamps %0, %1, 15" : "=a"(x) : "a"(x) :);
     return x;
-#endif
-
-#if (defined CONFIG_IDF_TARGET_ESP32P4)
+#else // ESP32-P4, RISC-V targets and the host build
     int32_t sign;
 
     /* assumes you've already rounded (x += (1 << (fracBits-1))) */
@@ -3372,6 +3730,28 @@ int16_t MP3Decoder::ClipToShort(int32_t x, int32_t fracBits) {
 #endif
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// sum of the polyphase filter (Q(DQ_FRACBITS_OUT - 2 - 2 + 32 - CSHIFT)) to int32_t with 16 bit full scale in the upper half,
+// i.e. the 16 bit sample << 16 with the fraction bits that ClipToShort() drops. Assumes the rounding is in the sum.
+int32_t MP3Decoder::ClipToQ31(uint64_t sum) {
+    int64_t x = (int64_t)sum >> PCMShift<int32_t>();
+    return x > INT32_MAX ? INT32_MAX : x < INT32_MIN ? INT32_MIN : (int32_t)x;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void MP3Decoder::putMono(int16_t* pcm, int32_t i, uint64_t sum) {
+    pcm[i] = ClipToShort((int32_t)SAR64(sum, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
+}
+void MP3Decoder::putMono(int32_t* pcm, int32_t i, uint64_t sum) { // the widening pass of decode() fused in
+    pcm[i] = pcm[i + 1] = ClipToQ31(sum);
+}
+void MP3Decoder::putStereo(int16_t* pcm, int32_t i, uint64_t sumL, uint64_t sumR) {
+    pcm[i] = ClipToShort((int32_t)SAR64(sumL, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
+    pcm[i + 1] = ClipToShort((int32_t)SAR64(sumR, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
+}
+void MP3Decoder::putStereo(int32_t* pcm, int32_t i, uint64_t sumL, uint64_t sumR) {
+    pcm[i] = ClipToQ31(sumL);
+    pcm[i + 1] = ClipToQ31(sumR);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 /*
  * Function:    PolyphaseMono
  *
@@ -3385,17 +3765,19 @@ int16_t MP3Decoder::ClipToShort(int32_t x, int32_t fracBits) {
  *                (see additional scaling comments below)
  *
  * Outputs:     32 samples of one channel of decoded PCM data, (i.e. Q16.0)
+ *              16 samples with rs = 1 (the even ones, MP3_SYNTH_HALF_RATE)
  *
  * Return:      none
  */
-void MP3Decoder::PolyphaseMono(int16_t* pcm, int32_t* vbuf, const uint32_t* coefBase) {
-    int32_t         i;
+template <typename T> void MP3Decoder::PolyphaseMono(T* pcm, int32_t* vbuf, const uint32_t* coefBase, int32_t rs) {
+    constexpr int32_t S = sizeof(T) == 4 ? 2 : 1; // words per output sample, Q31 writes the sample to both channels
+    int32_t         k, step = 1 << rs;
     const uint32_t* coef;
     int32_t*        vb1;
     int32_t         vLo, vHi, c1, c2;
     uint64_t        sum1L, sum2L, rndVal;
 
-    rndVal = (uint64_t)(1ULL << ((DQ_FRACBITS_OUT - 2 - 2 - 15) - 1 + (32 - CSHIFT)));
+    rndVal = (uint64_t)(1ULL << (PCMShift<T>() - 1));
 
     /* special case, output sample 0 */
     coef = coefBase;
@@ -3411,7 +3793,7 @@ void MP3Decoder::PolyphaseMono(int16_t* pcm, int32_t* vbuf, const uint32_t* coef
         sum1L = MADD64(sum1L, vLo, c1);
         sum1L = MADD64(sum1L, vHi, -c2);
     }
-    *(pcm + 0) = ClipToShort((int32_t)SAR64(sum1L, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
+    putMono(pcm, 0, sum1L);
 
     /* special case, output sample 16 */
     coef = coefBase + 256;
@@ -3423,15 +3805,14 @@ void MP3Decoder::PolyphaseMono(int16_t* pcm, int32_t* vbuf, const uint32_t* coef
         vLo = *(vb1 + (j));
         sum1L = MADD64(sum1L, vLo, c1); // 0...7
     }
-    *(pcm + 16) = ClipToShort((int32_t)SAR64(sum1L, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
+    putMono(pcm, (16 >> rs) * S, sum1L);
 
-    /* main convolution loop: sum1L = samples 1, 2, 3, ... 15   sum2L = samples 31, 30, ... 17 */
-    coef = coefBase + 16;
-    vb1 = vbuf + 64;
-    pcm++;
+    /* main convolution loop: sum1L = samples 1, 2, 3, ... 15   sum2L = samples 31, 30, ... 17 (every step-th) */
+    coef = coefBase + 16 * step;
+    vb1 = vbuf + 64 * step;
 
     /* right now, the compiler creates bad asm from this... */
-    for (i = 15; i > 0; i--) {
+    for (k = step; k < 16; k += step) {
         sum1L = sum2L = rndVal;
         for (int32_t j = 0; j < 8; j++) {
             c1 = *coef;
@@ -3445,10 +3826,10 @@ void MP3Decoder::PolyphaseMono(int16_t* pcm, int32_t* vbuf, const uint32_t* coef
             sum1L = MADD64(sum1L, vHi, -c2);
             sum2L = MADD64(sum2L, vHi, c1);
         }
-        vb1 += 64;
-        *(pcm) = ClipToShort((int32_t)SAR64(sum1L, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
-        *(pcm + 2 * i) = ClipToShort((int32_t)SAR64(sum2L, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
-        pcm++;
+        coef += 16 * (step - 1);
+        vb1 += 64 * step;
+        putMono(pcm, (k >> rs) * S, sum1L);
+        putMono(pcm, ((32 - k) >> rs) * S, sum2L);
     }
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -3464,20 +3845,21 @@ void MP3Decoder::PolyphaseMono(int16_t* pcm, int32_t* vbuf, const uint32_t* coef
  *              no minimum number of guard bits is required for input vbuf
  *                (see additional scaling comments below)
  *
- * Outputs:     32 samples of two channels of decoded PCM data, (i.e. Q16.0)
+ * Outputs:     32 samples of two channels of decoded PCM data, (i.e. Q16.0), or Q31 (m_f_q31)
+ *              16 samples with rs = 1 (the even ones, MP3_SYNTH_HALF_RATE)
  *
  * Return:      none
  *
  * Notes:       interleaves PCM samples LRLRLR...
  */
-void MP3Decoder::PolyphaseStereo(int16_t* pcm, int32_t* vbuf, const uint32_t* coefBase) {
-    int32_t         i;
+template <typename T> void MP3Decoder::PolyphaseStereo(T* pcm, int32_t* vbuf, const uint32_t* coefBase, int32_t rs) {
+    int32_t         k, step = 1 << rs;
     const uint32_t* coef;
     int32_t*        vb1;
     int32_t         vLo, vHi, c1, c2;
     uint64_t        sum1L, sum2L, sum1R, sum2R, rndVal;
 
-    rndVal = (uint64_t)(1 << ((DQ_FRACBITS_OUT - 2 - 2 - 15) - 1 + (32 - CSHIFT)));
+    rndVal = (uint64_t)(1ULL << (PCMShift<T>() - 1));
 
     /* special case, output sample 0 */
     coef = coefBase;
@@ -3498,8 +3880,7 @@ void MP3Decoder::PolyphaseStereo(int16_t* pcm, int32_t* vbuf, const uint32_t* co
         sum1R = MADD64(sum1R, vLo, c1);
         sum1R = MADD64(sum1R, vHi, -c2);
     }
-    *(pcm + 0) = ClipToShort((int32_t)SAR64(sum1L, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
-    *(pcm + 1) = ClipToShort((int32_t)SAR64(sum1R, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
+    putStereo(pcm, 0, sum1L, sum1R);
 
     /* special case, output sample 16 */
     coef = coefBase + 256;
@@ -3514,16 +3895,14 @@ void MP3Decoder::PolyphaseStereo(int16_t* pcm, int32_t* vbuf, const uint32_t* co
         vLo = *(vb1 + 32 + (j));
         sum1R = MADD64(sum1R, vLo, c1);
     }
-    *(pcm + 2 * 16 + 0) = ClipToShort((int32_t)SAR64(sum1L, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
-    *(pcm + 2 * 16 + 1) = ClipToShort((int32_t)SAR64(sum1R, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
+    putStereo(pcm, 2 * (16 >> rs), sum1L, sum1R);
 
-    /* main convolution loop: sum1L = samples 1, 2, 3, ... 15   sum2L = samples 31, 30, ... 17 */
-    coef = coefBase + 16;
-    vb1 = vbuf + 64;
-    pcm += 2;
+    /* main convolution loop: sum1L = samples 1, 2, 3, ... 15   sum2L = samples 31, 30, ... 17 (every step-th) */
+    coef = coefBase + 16 * step;
+    vb1 = vbuf + 64 * step;
 
     /* right now, the compiler creates bad asm from this... */
-    for (i = 15; i > 0; i--) {
+    for (k = step; k < 16; k += step) {
         sum1L = sum2L = rndVal;
         sum1R = sum2R = rndVal;
 
@@ -3545,12 +3924,10 @@ void MP3Decoder::PolyphaseStereo(int16_t* pcm, int32_t* vbuf, const uint32_t* co
             sum1R = MADD64(sum1R, vHi, -c2);
             sum2R = MADD64(sum2R, vHi, c1);
         }
-        vb1 += 64;
-        *(pcm + 0) = ClipToShort((int32_t)SAR64(sum1L, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
-        *(pcm + 1) = ClipToShort((int32_t)SAR64(sum1R, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
-        *(pcm + 2 * 2 * i + 0) = ClipToShort((int32_t)SAR64(sum2L, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
-        *(pcm + 2 * 2 * i + 1) = ClipToShort((int32_t)SAR64(sum2R, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
-        pcm += 2;
+        coef += 16 * (step - 1);
+        vb1 += 64 * step;
+        putStereo(pcm, 2 * (k >> rs), sum1L, sum1R);
+        putStereo(pcm, 2 * ((32 - k) >> rs), sum2L, sum2R);
     }
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
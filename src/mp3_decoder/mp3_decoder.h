@@ -32,6 +32,23 @@ class MP3Decoder : public Decoder {
     virtual int32_t       val1() override;
     virtual int32_t       val2() override;
 
+    // Xing/Info/VBRI header, parsed from the first frame by parseVBRHeader()
+    bool           parseVBRHeader(const uint8_t* frame, int32_t len);
+    uint32_t       getTotalFrames();                  // 0 if there is no header
+    uint32_t       getTotalBytes();                   // 0 if the header does not contain it
+    uint64_t       getTotalSamples();                 // per channel, 0 if unknown
+    const uint8_t* getTOC();                          // 100 entries, nullptr without TOC
+    int32_t        getSeekOffset(uint64_t sample);    // byte offset of sample relative to the first frame, -1 without TOC
+    uint64_t       getSeekSample(uint32_t offset);    // approximate first sample of the frame at offset, 0 without TOC
+    static int32_t calcFrameLength(const uint8_t* h); // layer III frame length in bytes from the 4 byte header, -1 if invalid
+    uint8_t        getRateShift();                    // 1 with MP3_SYNTH_HALF_RATE: rates and sample counts are at samplerate / 2
+    uint32_t       getSamplesPerFrame();              // output samples of a whole frame from the last header, 0 before the first one
+    int32_t        flush(int32_t* outbuf);            // MP3_PIPELINE: the frame still in the pipeline (end of file), samples per channel
+
+    // one region of the Huffman data (no decoder state, host/mp3_bench tests them): bits used, -1 on error / index of the zero part
+    static int32_t DecodeHuffmanPairs(int32_t* xy, int32_t nVals, int32_t tabIdx, int32_t bitsLeft, uint8_t* buf, int32_t bitOffset);
+    static int32_t DecodeHuffmanQuads(int32_t* vwxy, int32_t nVals, int32_t tabIdx, int32_t bitsLeft, uint8_t* buf, int32_t bitOffset);
+
     enum {
         MP3_NONE = 0,
         MP3_ERR = -1,
@@ -55,22 +72,56 @@ class MP3Decoder : public Decoder {
     ps_ptr<FrameHeader_t>   m_FrameHeader;
     ps_ptr<SideInfo_t>      m_SideInfo;
     ps_ptr<ScaleFactorJS_t> m_ScaleFactorJS;
-    ps_ptr<HuffmanInfo_t>   m_HuffmanInfo;
+    ps_ptr<GranuleJob_t>    m_jobs;                  // 1, MP3_PIPE_JOBS with the pipeline
+    HuffmanInfo_t*          m_HuffmanInfo = nullptr; // coefficients of the granule in m_jobs that the dequantizer fills
     ps_ptr<DequantInfo_t>   m_DequantInfo;
     ps_ptr<IMDCTInfo_t>     m_IMDCTInfo;
     ps_ptr<SubbandInfo_t>   m_SubbandInfo;
     ps_ptr<MP3FrameInfo_t>  m_MP3FrameInfo;
     ps_ptr<char>            m_mpeg_version_str;
 
-    invalid_frame m_invalid_frame;
+    invalid_frame  m_invalid_frame;
+    MP3VBRHeader_t m_vbrHeader;      // file property, survives clear() after a seek
+    int64_t        m_samplePos = -1; // output samples since the header frame, (-1) is unknown, e.g. after a seek
+    bool           m_f_q31 = false;  // settings.MP3_Q31 at init(): the synthesis writes int32_t LRLR... straight into outbuf
+    uint8_t        m_synth = 0;      // settings.MP3_SYNTH at init(), MP3_SYNTH_MONO also with forceMono()
+    bool           m_f_mixedSpectrum = false; // MP3_SYNTH_MONO: overBuf[0] holds the overlap of (L+R)/2, channel 1 is not up to date
+
+    // settings.MP3_PIPELINE: the synthesis of the granules runs in a task on the other core, one frame behind
+    ps_ptr<int32_t>       m_pipePcm;                  // two frames, the pipeline writes one while the other is returned
+    TaskHandle_t          m_pipeTask = nullptr;       // nullptr: no pipeline, decode() synthesizes
+    SemaphoreHandle_t     m_pipeWake = nullptr;       // a job was queued
+    SemaphoreHandle_t     m_pipeDone = nullptr;       // a job was finished
+    std::atomic<uint32_t> m_pipeHead{0};              // jobs queued, written by decode()
+    std::atomic<uint32_t> m_pipeTail{0};              // jobs finished, written by the task
+    std::atomic<bool>     m_f_pipeRun{false};         // false: the task ends
+    std::atomic<bool>     m_f_pipeEnded{false};       // the task does not touch the decoder anymore
+    bool                  m_f_pipePending = false;    // a frame is in the pipeline
+    uint32_t              m_pipePendingEnd = 0;       // m_pipeHead behind its last granule
+    uint8_t               m_pipeSlot = 0;             // frame of m_pipePcm that decode() fills
+    MP3FrameInfo_t        m_pipeInfo;                 // MP3GetLastFrameInfo() of the pending frame
 
     // internally used
     int32_t  IsLikelyRealFrame(const uint8_t* p, int32_t bytesLeft);
+    int32_t  findVBRTag(const uint8_t* frame, int32_t len);
+    void     trimGapless(int32_t* outbuf);
+    void     outputFrame(int16_t* pcm16, int32_t* outbuf);
+    bool     startPipeline();
+    void     stopPipeline();
+    void     pipeWait(uint32_t jobs);
+    static void pipeTask(void* param);
     void     MP3GetLastFrameInfo();
     int32_t  MP3GetNextFrameInfo(uint8_t* buf);
     int      MP3_AnalyzeFrame(const uint8_t* frame_data, size_t frame_len);
-    void     PolyphaseMono(int16_t* pcm, int32_t* vbuf, const uint32_t* coefBase);
-    void     PolyphaseStereo(int16_t* pcm, int32_t* vbuf, const uint32_t* coefBase);
+    int32_t  synthChans(int32_t nChans) { return (m_synth & Audio::MP3_SYNTH_MONO) ? 1 : nChans; }
+    int32_t  synthChans() { return synthChans(m_MP3DecInfo->nChans); }
+    template <typename T> void PolyphaseMono(T* pcm, int32_t* vbuf, const uint32_t* coefBase, int32_t rs);   // T: int16_t or int32_t (Q31)
+    template <typename T> void PolyphaseStereo(T* pcm, int32_t* vbuf, const uint32_t* coefBase, int32_t rs); // rs: getRateShift()
+    template <typename T> static constexpr int32_t PCMShift() { return (32 - CSHIFT) + (DQ_FRACBITS_OUT - 2 - 2 - 15) - (sizeof(T) == 4 ? 16 : 0); } // sum -> sample
+    void     putMono(int16_t* pcm, int32_t i, uint64_t sum);
+    void     putMono(int32_t* pcm, int32_t i, uint64_t sum);
+    void     putStereo(int16_t* pcm, int32_t i, uint64_t sumL, uint64_t sumR);
+    void     putStereo(int32_t* pcm, int32_t i, uint64_t sumL, uint64_t sumR);
     void     SetBitstreamPointer(BitStreamInfo_t* bsi, int32_t nBytes, uint8_t* buf);
     uint32_t GetBits(BitStreamInfo_t* bsi, int32_t nBits);
     int32_t  CalcBitsUsed(BitStreamInfo_t* bsi, uint8_t* startBuf, int32_t startOffset);
@@ -85,17 +136,18 @@ class MP3Decoder : public Decoder {
     int32_t  UnpackSideInfo(uint8_t* buf);
     int32_t  DecodeHuffman(uint8_t* buf, int32_t* bitOffset, int32_t huffBlockBits, int32_t gr, int32_t ch);
     int32_t  MP3Dequantize(int32_t gr);
-    int32_t  IMDCT(int32_t gr, int32_t ch);
+    int32_t  SynthesizeGranule(GranuleJob_t* job);
+    int32_t  IMDCT(GranuleJob_t* job, int32_t ch);
+    int32_t  IMDCTMono(GranuleJob_t* job);
     int32_t  UnpackScaleFactors(uint8_t* buf, int32_t* bitOffset, int32_t bitsAvail, int32_t gr, int32_t ch);
-    int32_t  Subband(int16_t* pcmBuf);
+    template <typename T> int32_t Subband(T* pcmBuf, int32_t nChans);
     int16_t  ClipToShort(int32_t x, int32_t fracBits);
+    int32_t  ClipToQ31(uint64_t sum);
     void     RefillBitstreamCache(BitStreamInfo_t* bsi);
     void     UnpackSFMPEG1(BitStreamInfo_t* bsi, SideInfoSub_t* sis, ScaleFactorInfoSub_t* sfis, int32_t* scfsi, int32_t gr, ScaleFactorInfoSub_t* sfisGr0);
     void     UnpackSFMPEG2(BitStreamInfo_t* bsi, SideInfoSub_t* sis, ScaleFactorInfoSub_t* sfis, int32_t gr, int32_t ch, int32_t modeExt, ScaleFactorJS_t* sfjs);
     int32_t  MP3FindFreeSync(uint8_t* buf, uint8_t firstFH[4], int32_t nBytes);
-    void     MP3ClearBadFrame(int16_t* outbuf);
-    int32_t  DecodeHuffmanPairs(int32_t* xy, int32_t nVals, int32_t tabIdx, int32_t bitsLeft, uint8_t* buf, int32_t bitOffset);
-    int32_t  DecodeHuffmanQuads(int32_t* vwxy, int32_t nVals, int32_t tabIdx, int32_t bitsLeft, uint8_t* buf, int32_t bitOffset);
+    void     MP3ClearBadFrame(int32_t* outbuf);
     int32_t  DequantBlock(int32_t* inbuf, int32_t* outbuf, int32_t num, int32_t scale);
     void     AntiAlias(int32_t* x, int32_t nBfly);
     void     WinPrevious(int32_t* xPrev, int32_t* xPrevWin, int32_t btPrev);
@@ -27,6 +27,7 @@
 #define VBUF_LENGTH          17 * 2 * NBANDS // for double-sized vbuf FIFO
 #define MAX_SCFBD            4               // max scalefactor bands per channel
 #define MAINBUF_SIZE         1940
+#define MP3_PIPE_JOBS        4                // granules in flight with settings.MP3_PIPELINE, two frames of MPEG1
 #define MAX_NGRAN            2                // max granules
 #define MAX_NCHAN            2                // max channels
 #define MAX_NSAMP            576              // max samples per channel, per granule
@@ -79,6 +80,57 @@ typedef struct BitStreamInfo {
     int32_t  nBytes;
 } BitStreamInfo_t;
 
+typedef struct HuffBits { /* bit reservoir of the Huffman decoder, left-justified, never reads beyond bitsLeft */
+    uint64_t       cache;
+    int32_t        cachedBits; /* valid bits in cache, < 0 if the codes ran over the end of the data */
+    int32_t        bitsLeft;   /* bits behind the cache */
+    const uint8_t* buf;
+
+    void start(const uint8_t* p, int32_t bitOffset, int32_t nBits) { /* first bit: bit 7 - bitOffset of p[0] */
+        buf = p;
+        cache = 0;
+        cachedBits = (8 - bitOffset) & 0x07;
+        if (cachedBits) cache = (uint64_t)(*buf++) << (56 + bitOffset);
+        bitsLeft = nBits - cachedBits;
+        if (bitsLeft < 0) { /* the data ends in the first byte */
+            cachedBits += bitsLeft;
+            bitsLeft = 0;
+            cache = cachedBits > 0 ? cache & ~0ULL << (64 - cachedBits) : 0;
+        }
+    }
+    void refill() { /* at least 57 bits in cache unless the data ends */
+        if (bitsLeft >= 64) { /* 8 bytes, the bits of the last partial byte come again with the next refill */
+            uint64_t w = 0;
+            for (int32_t k = 0; k < 8; k++) w = w << 8 | buf[k];
+            cache |= w >> cachedBits;
+            int32_t n = (63 - cachedBits) >> 3;
+            buf += n;
+            cachedBits += n << 3;
+            bitsLeft -= n << 3;
+            return;
+        }
+        while (cachedBits <= 56 && bitsLeft >= 8) {
+            cache |= (uint64_t)(*buf++) << (56 - cachedBits);
+            cachedBits += 8;
+            bitsLeft -= 8;
+        }
+        if (cachedBits <= 56 && bitsLeft > 0) { /* last byte, the bits behind the data are 0 */
+            cache |= (uint64_t)(*buf++ & (0xff00 >> bitsLeft)) << (56 - cachedBits);
+            cachedBits += bitsLeft;
+            bitsLeft = 0;
+        }
+    }
+    void skip(int32_t n) {
+        cache <<= n;
+        cachedBits -= n;
+    }
+    int32_t sign() { /* bit 31 = the next bit, consumed */
+        int32_t s = (int32_t)(cache >> 32) & (int32_t)0x80000000;
+        skip(1);
+        return s;
+    }
+} HuffBits_t;
+
 typedef enum {                /* map these to the corresponding 2-bit values in the frame header */
                Stereo = 0x00, /* two independent channels, but L and R frames might have different # of bits */
                Joint = 0x01,  /* coupled channels - layer III: mix of M-S and intensity, Layers I/II: intensity and direct coding only */
@@ -146,6 +198,14 @@ typedef struct HuffmanInfo {
     int32_t gb[MAX_NCHAN];                    /* minimum number of guard bits in huffDecBuf[ch] */
 } HuffmanInfo_t;
 
+typedef struct GranuleJob {       /* one granule from the dequantizer to the synthesis, see MP3Decoder::SynthesizeGranule() */
+    HuffmanInfo_t hi;             /* dequantized coefficients */
+    SideInfoSub_t sis[MAX_NCHAN]; /* block types of the granule, the side info of the frame is overwritten by the next one */
+    int32_t       nChans;         /* channels of the stream */
+    int32_t       blockCutoff;    /* first short block of a mixed block */
+    void*         pcm;            /* output, int16_t or int32_t (settings.MP3_Q31) */
+} GranuleJob_t;
+
 typedef enum HuffTabType { noBits, oneShot, loopNoLinbits, loopLinbits, quadA, quadB, invalidTab } HuffTabType_t;
 
 typedef struct HuffTabLookup {
@@ -213,6 +273,18 @@ typedef struct MP3DecInfo {
     int32_t part23Length[MAX_NGRAN][MAX_NCHAN];
 } MP3DecInfo_t;
 
+typedef struct MP3VBRHeader { /* Xing/Info or VBRI header in the first frame of a file */
+    uint8_t  type;            /* 0 = none, 1 = Xing (VBR), 2 = Info (CBR), 3 = VBRI */
+    bool     hasToc;          /* toc[] is valid */
+    uint16_t samplesPerFrame; /* per channel */
+    uint32_t sampleRate;
+    uint32_t frames;          /* number of audio frames, the header frame is not included */
+    uint32_t bytes;           /* size of the audio data, the header frame is included */
+    uint16_t encDelay;        /* LAME tag: samples the encoder put in front of the audio */
+    uint16_t encPadding;      /* LAME tag: samples appended to fill the last frame */
+    uint8_t  toc[100];        /* file position at i percent of the playtime, in 1/256 of bytes (VBRI is converted) */
+} MP3VBRHeader_t;
+
 typedef struct {
     uint8_t  mpeg_version; // 0=MPEG2.5, 1=reserved, 2=MPEG2, 3=MPEG1
     uint8_t  layer;        // 0=reserved, 1=Layer III, 2=Layer II, 3=Layer I
@@ -3,7 +3,7 @@
 #include "stdint-gcc.h"
 #include "structs.h"
 
-static const uint16_t huffTable[4242] = {
+static constexpr uint16_t huffTable[4242] = {
     0xf003, 0x3112, 0x3101, 0x2011, 0x2011, 0x1000, 0x1000, 0x1000, 0x1000, 0xf006, 0x6222, 0x6201, 0x5212, 0x5212, 0x5122, 0x5122, 0x5021, 0x5021, 0x3112, 0x3112, 0x3112, 0x3112, 0x3112, 0x3112,
     0x3112, 0x3112, 0x3101, 0x3101, 0x3101, 0x3101, 0x3101, 0x3101, 0x3101, 0x3101, 0x3011, 0x3011, 0x3011, 0x3011, 0x3011, 0x3011, 0x3011, 0x3011, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000,
     0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000,
@@ -248,7 +248,7 @@ static const uint32_t fastWin36[18] = {0x42aace8b, 0xc2e92724, 0x47311c28, 0xc95
  *  A = length of codeword
  *  B = codeword
  */
-static const uint8_t quadTable[64 + 16] = {
+static constexpr uint8_t quadTable[64 + 16] = {
     /* table A */
     0x6b, 0x6f, 0x6d, 0x6e, 0x67, 0x65, 0x59, 0x59, 0x56, 0x56, 0x53, 0x53, 0x5a, 0x5a, 0x5c, 0x5c, 0x42, 0x42, 0x42, 0x42, 0x41, 0x41, 0x41, 0x41, 0x44, 0x44, 0x44,
     0x44, 0x48, 0x48, 0x48, 0x48, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
@@ -471,23 +471,23 @@ static const int32_t pow2frac[8]  = {
     0x50a28be6, 0x7fffffff, 0x6597fa94, 0x50a28be6
 };
 
-static const uint16_t m_HUFF_OFFSET_01=  0;
-static const uint16_t m_HUFF_OFFSET_02=  9 + m_HUFF_OFFSET_01;
-static const uint16_t m_HUFF_OFFSET_03= 65 + m_HUFF_OFFSET_02;
-static const uint16_t m_HUFF_OFFSET_05= 65 + m_HUFF_OFFSET_03;
-static const uint16_t m_HUFF_OFFSET_06=257 + m_HUFF_OFFSET_05;
-static const uint16_t m_HUFF_OFFSET_07=129 + m_HUFF_OFFSET_06;
-static const uint16_t m_HUFF_OFFSET_08=110 + m_HUFF_OFFSET_07;
-static const uint16_t m_HUFF_OFFSET_09=280 + m_HUFF_OFFSET_08;
-static const uint16_t m_HUFF_OFFSET_10= 93 + m_HUFF_OFFSET_09;
-static const uint16_t m_HUFF_OFFSET_11=320 + m_HUFF_OFFSET_10;
-static const uint16_t m_HUFF_OFFSET_12=296 + m_HUFF_OFFSET_11;
-static const uint16_t m_HUFF_OFFSET_13=185 + m_HUFF_OFFSET_12;
-static const uint16_t m_HUFF_OFFSET_15=497 + m_HUFF_OFFSET_13;
-static const uint16_t m_HUFF_OFFSET_16=580 + m_HUFF_OFFSET_15;
-static const uint16_t m_HUFF_OFFSET_24=651 + m_HUFF_OFFSET_16;
-
-static const int32_t huffTabOffset[HUFF_PAIRTABS] = {
+static constexpr uint16_t m_HUFF_OFFSET_01=  0;
+static constexpr uint16_t m_HUFF_OFFSET_02=  9 + m_HUFF_OFFSET_01;
+static constexpr uint16_t m_HUFF_OFFSET_03= 65 + m_HUFF_OFFSET_02;
+static constexpr uint16_t m_HUFF_OFFSET_05= 65 + m_HUFF_OFFSET_03;
+static constexpr uint16_t m_HUFF_OFFSET_06=257 + m_HUFF_OFFSET_05;
+static constexpr uint16_t m_HUFF_OFFSET_07=129 + m_HUFF_OFFSET_06;
+static constexpr uint16_t m_HUFF_OFFSET_08=110 + m_HUFF_OFFSET_07;
+static constexpr uint16_t m_HUFF_OFFSET_09=280 + m_HUFF_OFFSET_08;
+static constexpr uint16_t m_HUFF_OFFSET_10= 93 + m_HUFF_OFFSET_09;
+static constexpr uint16_t m_HUFF_OFFSET_11=320 + m_HUFF_OFFSET_10;
+static constexpr uint16_t m_HUFF_OFFSET_12=296 + m_HUFF_OFFSET_11;
+static constexpr uint16_t m_HUFF_OFFSET_13=185 + m_HUFF_OFFSET_12;
+static constexpr uint16_t m_HUFF_OFFSET_15=497 + m_HUFF_OFFSET_13;
+static constexpr uint16_t m_HUFF_OFFSET_16=580 + m_HUFF_OFFSET_15;
+static constexpr uint16_t m_HUFF_OFFSET_24=651 + m_HUFF_OFFSET_16;
+
+static constexpr int32_t huffTabOffset[HUFF_PAIRTABS] = {
     0,                   m_HUFF_OFFSET_01,    m_HUFF_OFFSET_02,    m_HUFF_OFFSET_03,
     0,                   m_HUFF_OFFSET_05,    m_HUFF_OFFSET_06,    m_HUFF_OFFSET_07,
     m_HUFF_OFFSET_08,    m_HUFF_OFFSET_09,    m_HUFF_OFFSET_10,    m_HUFF_OFFSET_11,
@@ -497,7 +497,7 @@ static const int32_t huffTabOffset[HUFF_PAIRTABS] = {
     m_HUFF_OFFSET_24,    m_HUFF_OFFSET_24,    m_HUFF_OFFSET_24,    m_HUFF_OFFSET_24,
     m_HUFF_OFFSET_24,    m_HUFF_OFFSET_24,    m_HUFF_OFFSET_24,    m_HUFF_OFFSET_24,};
 
-static const HuffTabLookup_t huffTabLookup[HUFF_PAIRTABS]  = {
+static constexpr HuffTabLookup_t huffTabLookup[HUFF_PAIRTABS]  = {
     { 0,  noBits },
     { 0,  oneShot },
     { 0,  oneShot },
@@ -532,8 +532,8 @@ static const HuffTabLookup_t huffTabLookup[HUFF_PAIRTABS]  = {
     { 13, loopLinbits }
 };
 
-static const int32_t quadTabOffset[2]  = {0, 64};
-static const int32_t quadTabMaxBits[2]  = {6, 4};
+static constexpr int32_t quadTabOffset[2]  = {0, 64};
+static constexpr int32_t quadTabMaxBits[2]  = {6, 4};
 
 /* indexing = [version][samplerate index]
  * sample rate of frame (Hz)
@@ -645,14 +645,14 @@ static const uint32_t csa[8][2]  = {
  *   see PolyphaseStereo() and PolyphaseMono()
  */
 
-static const char* mpeg_version_table[] = {
+static const char* const mpeg_version_table[] = {
     "MPEG-1",      // 0
     "MPEG-2",      // 1
     "MPEG-2.5",    // 2
     "MPEG-INVALID" // 3
 };
 
-static const char* layer_table[] = {
+static const char* const layer_table[] = {
     "Unknown",   // 0
     "Layer I",   // 1
     "Layer II",  // 2
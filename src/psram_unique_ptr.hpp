@@ -3,6 +3,7 @@
 #include "Arduino.h"
 #include <algorithm>
 #include <cstdint>
+#include <cinttypes>
 #include <cstdio>
 #include <cstring>
 #include <memory>
@@ -1705,7 +1706,7 @@ class ps_ptr {
         while (*ptr) {
             if (ptr[0] == '\\' && ptr[1] == 'u') {
                 uint32_t codepoint = 0;
-                if (sscanf(ptr + 2, "%4lx", &codepoint) == 1) {
+                if (sscanf(ptr + 2, "%4" SCNx32, &codepoint) == 1) {
                     int len = encodeCodepointToUTF8(codepoint, utf8);
                     utf8[len] = 0;
                     this->append(utf8);
@@ -2026,7 +2027,7 @@ class ps_ptr {
         uint64_t result = 0;
         for (uint8_t i = 0; i < size; ++i) { result = (result << 8) | data[i]; }
         char buffer[19]; // Max: "0x" + 16 chars for uint64_t + null terminator
-        snprintf(buffer, sizeof(buffer), "0x%llx", result);
+        snprintf(buffer, sizeof(buffer), "0x%" PRIx64, result);
         assign(buffer);
     }
     // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -2050,7 +2051,7 @@ class ps_ptr {
         uint64_t result = 0;
         for (int i = size - 1; i >= 0; --i) { result = (result << 8) | data[i]; }
         char buffer[19]; // Max: "0x" + 16 chars for uint64_t + null terminator
-        snprintf(buffer, sizeof(buffer), "0x%llx", result);
+        snprintf(buffer, sizeof(buffer), "0x%" PRIx64, result);
         assign(buffer);
     }
     // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -0,0 +1,295 @@
+#pragma GCC optimize("Ofast") // as in Audio.h
+#include "resampler.h"
+#include <numeric>
+
+// created 18.10.2026
+// resampler_t and drift_t, moved out of audiolib_structs.hpp
+
+namespace audiolib {
+
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// 📌📌📌  R E S A M P L E R  📌📌📌
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// prepares the conversion inRate -> outRate, the table is kept if the ratio, the quality and the mode did not change
+void resampler_t::setup(uint32_t inRate, uint32_t outRate, uint8_t q, bool variable) {
+    uint32_t g = std::gcd(inRate, outRate);
+    uint32_t l = outRate / g, m = inRate / g;
+    uint32_t rows = variable ? (1 << VAR_BITS) + 1 : l;
+    if (rows > MAX_PHASES || l > UINT16_MAX || m > UINT16_MAX) q = LINEAR;
+    for (; q > LINEAR; q--) {
+        if (table.valid() && q == quality && l == L && m == M && variable == f_variable) break;
+        table.reset();
+        if (!table.alloc_array(rows * tiers[q].taps, "resampler")) continue;
+        L = l;
+        M = m;
+        taps = tiers[q].taps;
+        makeTable(tiers[q], variable ? 1 << VAR_BITS : l, rows);
+        break;
+    }
+    if (q == LINEAR) {
+        table.reset();
+        L = l;
+        M = m;
+        taps = 0;
+    }
+    quality = q;
+    f_variable = variable;
+    step = M ? M / L : 0;
+    rem = M ? M % L : 0;
+    acc = 0;
+    next = taps + taps / 2 - 2; // the first output frame is the first input frame, no delay
+    memset(seam, 0, sizeof(seam));
+    phase = 0;
+    g_lpCoeffs = butterworthLPF(inRate);
+    lpLeft = {};
+    lpRight = {};
+    hasLast = false;
+    frac = 0;
+    setPpm(0);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// fine ratio of the variable mode and of LINEAR, the next output frame continues at the current position
+void resampler_t::setPpm(float p) {
+    ppm = p;
+    double r = (double)M / L * (1.0 + p * 1e-6);
+    inc = (uint64_t)llround(r * 4294967296.0);
+    phaseStep = p ? inc : ((uint64_t)M << 32) / L;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// converts frames of interleaved L/R, returns the output frames (at most frames * out / in + 1)
+uint32_t resampler_t::process(const int32_t* in, uint32_t frames, int32_t* out) {
+    switch (taps | f_variable) {
+        case 16: return polyphase<16, false>(in, frames, out);
+        case 32: return polyphase<32, false>(in, frames, out);
+        case 64: return polyphase<64, false>(in, frames, out);
+        case 17: return polyphase<16, true>(in, frames, out);
+        case 33: return polyphase<32, true>(in, frames, out);
+        case 65: return polyphase<64, true>(in, frames, out);
+        default: return linear(in, frames, out);
+    }
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+float resampler_t::besselI0(float x) {
+    float sum = 1, term = 1;
+    for (int k = 1; k < 30 && term > sum * 1e-8f; k++) {
+        term *= (x * x) / (4.0f * k * k);
+        sum += term;
+    }
+    return sum;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// phase p starts p / phases input frames after the frame taps / 2 - 1 of its window, every phase is normalized to a DC gain of 1
+void resampler_t::makeTable(const tier_t& t, uint32_t phases, uint32_t rows) {
+    const float fc = 0.5f * t.cutoff * std::min(1.0f, (float)L / M); // cycles per input frame
+    const float half = taps / 2, i0 = besselI0(t.beta);
+    float       h[MAX_TAPS];
+    for (uint32_t p = 0; p < rows; p++) {
+        float sum = 0;
+        for (uint8_t j = 0; j < taps; j++) {
+            float u = half + (float)p / phases - j; // distance of the output frame from input frame j
+            float w = 1 - (u / half) * (u / half);
+            float x = 2 * fc * u;
+            h[j] = w > 0 ? 2 * fc * (x ? sinf(M_PI * x) / (M_PI * x) : 1.0f) * besselI0(t.beta * sqrtf(w)) / i0 : 0;
+            sum += h[j];
+        }
+        for (uint8_t j = 0; j < taps; j++) table.get()[(size_t)p * taps + j] = (int32_t)lrintf(h[j] / sum * (1 << COEFF_FRAC));
+    }
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+template <int T> inline void resampler_t::dot(const int32_t* x, const int32_t* c, int64_t& l, int64_t& r) {
+    l = r = 0;
+    for (int j = 0; j < T; j++) {
+        l += (int64_t)x[2 * j] * c[j];
+        r += (int64_t)x[2 * j + 1] * c[j];
+    }
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// V: variable ratio, the position is frac and the output lies between the phases frac >> (32 - VAR_BITS) and the next one
+template <int T, bool V> uint32_t resampler_t::polyphase(const int32_t* in, uint32_t frames, int32_t* out) {
+    constexpr int H = T - 1;                           // history
+    uint32_t      head = std::min<uint32_t>(frames, H); // input frames appended to the seam
+    uint32_t      n = 0;
+    memcpy(seam + 2 * H, in, head * 2 * sizeof(int32_t));
+    for (int32_t end = H + frames; next < end; n++) {
+        const int32_t  w = next - H; // oldest frame of the window, input frame k is at H + k
+        const int32_t* x = w >= H ? in + 2 * (w - H) : seam + 2 * w;
+        int64_t        l, r;
+        if constexpr (V) {
+            const int32_t* c = table.get() + (frac >> (32 - VAR_BITS)) * T;
+            const int64_t  t = (frac >> (17 - VAR_BITS)) & 0x7FFF; // Q15 between the two phases
+            int64_t        l1, r1;
+            dot<T>(x, c, l, r);
+            dot<T>(x, c + T, l1, r1);
+            l += ((l1 - l) >> 15) * t;
+            r += ((r1 - r) >> 15) * t;
+        } else {
+            dot<T>(x, table.get() + acc * T, l, r);
+        }
+        l = (l + (1LL << (COEFF_FRAC - 1))) >> COEFF_FRAC;
+        r = (r + (1LL << (COEFF_FRAC - 1))) >> COEFF_FRAC;
+        out[2 * n] = (int32_t)std::clamp<int64_t>(l, INT32_MIN, INT32_MAX);
+        out[2 * n + 1] = (int32_t)std::clamp<int64_t>(r, INT32_MIN, INT32_MAX);
+        if constexpr (V) {
+            uint64_t f = frac + inc;
+            next += f >> 32;
+            frac = (uint32_t)f;
+        } else {
+            next += step;
+            acc += rem;
+            if (acc >= L) {
+                acc -= L;
+                next++;
+            }
+        }
+    }
+    next -= frames;
+    if (frames >= (uint32_t)H)
+        memcpy(seam, in + 2 * (frames - H), H * 2 * sizeof(int32_t));
+    else
+        memmove(seam, seam + 2 * frames, H * 2 * sizeof(int32_t));
+    return n;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+BiquadCoeffs resampler_t::butterworthLPF(float fs) { // Calculation of the biquad coefficients for the linear resampler
+
+    float fc = 0.45f * fs;
+    if (fc > 20000.0f) fc = 20000.0f; // absolute upper limit (security)
+    if (fc < 3000.0f) fc = 3000.0f;   // absolute lower limit (prevents “thin” sound)
+
+    constexpr float Q = 0.70710678f;
+
+    float w0 = 2.0f * M_PI * fc / fs;
+    float cw = cosf(w0);
+    float sw = sinf(w0);
+    float alpha = sw / (2.0f * Q);
+
+    float b0 = (1.0f - cw) * 0.5f;
+    float b1 = 1.0f - cw;
+    float b2 = (1.0f - cw) * 0.5f;
+    float a0 = 1.0f + alpha;
+    float a1 = -2.0f * cw;
+    float a2 = 1.0f - alpha;
+
+    // normalize
+    b0 /= a0;
+    b1 /= a0;
+    b2 /= a0;
+    a1 /= a0;
+    a2 /= a0;
+
+    // convert to Q31, |a1| may exceed 1
+    constexpr float Q31 = 2147483648.0f; // 2^31
+
+    BiquadCoeffs c;
+    c.b0 = llrintf(b0 * Q31);
+    c.b1 = llrintf(b1 * Q31);
+    c.b2 = llrintf(b2 * Q31);
+    c.a1 = llrintf(a1 * Q31);
+    c.a2 = llrintf(a2 * Q31);
+
+    return c;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+uint32_t resampler_t::linear(const int32_t* input, uint32_t inputSamples, int32_t* output) {
+
+    auto lerp_q32 = [&](int32_t a, int32_t b, uint32_t frac) -> int32_t { return a + (int32_t)(((int64_t)(b - a) * frac) >> 32); };
+    auto biquadProcess = [&](Biquad& s, const BiquadCoeffs& c, int32_t x) -> int32_t {
+        // Q31 signal, Q31 coeffs → Q62 acc
+        int64_t acc = (int64_t)c.b0 * x + s.z1;
+        s.z1 = (int64_t)c.b1 * x - (int64_t)c.a1 * (acc >> 31) + s.z2;
+        s.z2 = (int64_t)c.b2 * x - (int64_t)c.a2 * (acc >> 31);
+        int64_t y = acc >> 31;
+        if (y > INT32_MAX) return INT32_MAX;
+        if (y < INT32_MIN) return INT32_MIN;
+        return (int32_t)y;
+    };
+
+    uint32_t outFrames = 0;
+    uint32_t i = 0;
+
+    // If we have a "last" from the previous frame, start with that
+    if (hasLast && inputSamples > 0) {
+        int32_t l0 = lastL;
+        int32_t r0 = lastR;
+        int32_t l1 = input[0];
+        int32_t r1 = input[1];
+
+        // Continue processing with the old phase value
+        while ((phase >> 32) == 0) {
+            uint32_t frac = (uint32_t)phase;
+            int32_t  l = lerp_q32(l0, l1, frac);
+            int32_t  r = lerp_q32(r0, r1, frac);
+
+            l = biquadProcess(lpLeft, g_lpCoeffs, l);
+            r = biquadProcess(lpRight, g_lpCoeffs, r);
+
+            output[outFrames * 2] = l;
+            output[outFrames * 2 + 1] = r;
+            ++outFrames;
+
+            phase += phaseStep;
+        }
+        phase -= (1ULL << 32);
+        // i remains 0, we haven't used input[0] as "l0" yet!
+    }
+
+    // Rest of the frame as usual
+    for (; i + 1 < inputSamples; ++i) {
+        int32_t l0 = input[i * 2];
+        int32_t r0 = input[i * 2 + 1];
+        int32_t l1 = input[(i + 1) * 2];
+        int32_t r1 = input[(i + 1) * 2 + 1];
+
+        while ((phase >> 32) == 0) {
+            uint32_t frac = (uint32_t)phase;
+            int32_t  l = lerp_q32(l0, l1, frac);
+            int32_t  r = lerp_q32(r0, r1, frac);
+
+            l = biquadProcess(lpLeft, g_lpCoeffs, l);
+            r = biquadProcess(lpRight, g_lpCoeffs, r);
+
+            output[outFrames * 2] = l;
+            output[outFrames * 2 + 1] = r;
+            ++outFrames;
+
+            phase += phaseStep;
+        }
+        phase -= (1ULL << 32);
+    }
+
+    // Save last sample for next frame
+    if (inputSamples > 0) {
+        lastL = input[(inputSamples - 1) * 2];
+        lastR = input[(inputSamples - 1) * 2 + 1];
+        hasLast = true;
+    }
+
+    return outFrames;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// 📌📌📌  D R I F T   C O M P E N S A T I O N  📌📌📌
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void drift_t::start(bool active) {
+    f_active = active;
+    target = userTarget;
+    level = -1;
+    integral = 0;
+    ppm = 0;
+    time = 0;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// bytes in InBuff, byteRate of the stream, dt s of audio since the last call; returns the ppm for resampler_t::setPpm()
+float drift_t::update(uint32_t bytes, float byteRate, float dt) {
+    time += dt;
+    level = level < 0 ? bytes : level + (bytes - level) * std::min(1.0f, dt / SMOOTH);
+    if (!target) {
+        if (time < SETTLE) return ppm;
+        target = std::max(1.0f, level);
+    }
+    float e = (level - target) / byteRate; // s of audio
+    integral = std::clamp(integral + KI * e * dt, -MAX_PPM, MAX_PPM);
+    ppm = std::clamp(KP * e + integral, -MAX_PPM, MAX_PPM);
+    return ppm;
+}
+
+} // namespace audiolib
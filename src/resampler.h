@@ -0,0 +1,93 @@
+#pragma once
+#include "audiolib_structs.hpp"
+
+// sample rate conversion (resampler.cpp): polyphase FIR or linear interpolation, and the clock drift controller of web streams
+
+namespace audiolib {
+
+struct resampler_t { // used in cacheSamples() and xfadeResample(), converts the decoder output to m_output_sr
+    enum : uint8_t { LINEAR = 0, LOW, MEDIUM, HIGH }; // Audio::ResampleQuality_t
+    static constexpr size_t   MAX_IN_FRAMES = 4608;
+    static constexpr size_t   MAX_OUT_FRAMES = 10500;
+    static constexpr uint16_t MAX_PHASES = 512; // L of the reduced ratio out / in = L / M, 441 for 8 kHz -> 44.1 kHz
+    static constexpr uint8_t  MAX_TAPS = 64;
+    static constexpr uint8_t  COEFF_FRAC = 30; // coefficients in Q30, Q31 samples, int64 accumulator
+    static constexpr uint8_t  VAR_BITS = 7;    // variable ratio: 128 phases, the output is interpolated between two of them
+
+    struct tier_t {
+        uint8_t taps;   // per output frame and channel (input frames)
+        float   beta;   // Kaiser window, stopband about 20 * beta dB
+        float   cutoff; // of min(in, out) / 2
+    };
+    static constexpr tier_t tiers[4] = {{0, 0, 0}, {16, 6.0f, 0.80f}, {32, 8.0f, 0.88f}, {64, 10.0f, 0.93f}};
+
+    uint8_t quality = LINEAR; // in use, lower than requested if the table could not be allocated
+
+    // polyphase FIR (LOW, MEDIUM, HIGH): a Kaiser windowed sinc, one set of taps for each of the L output phases
+    ps_ptr<int32_t> table;                    // L * taps coefficients, the oldest input frame first
+    uint16_t        L = 0, M = 0;             // out / in
+    uint16_t        step = 0, rem = 0;        // M / L, M % L
+    uint16_t        acc = 0;                  // phase of the next output frame in 1/L input frames
+    int32_t         next = 0;                 // newest input frame of the next output, seam coordinates
+    uint8_t         taps = 0;                 //
+    int32_t         seam[4 * MAX_TAPS - 4]{}; // taps - 1 frames of the previous block, followed by taps - 1 of the current one
+
+    // variable ratio (drift compensation): M / L * (1 + ppm / 1e6), the table has 2^VAR_BITS + 1 phases
+    bool     f_variable = false;
+    float    ppm = 0;  // + consumes the input faster
+    uint32_t frac = 0; // position of the next output frame after the frame taps / 2 - 1 of its window, 0.32
+    uint64_t inc = 0;  // input frames per output frame, 32.32
+
+    // linear interpolation and a Butterworth lowpass (LINEAR), the fallback without memory for the table
+    uint64_t     phase = 0;
+    uint64_t     phaseStep = 0;
+    Biquad       lpLeft;
+    Biquad       lpRight;
+    uint32_t     outFrames = 0;
+    BiquadCoeffs g_lpCoeffs;
+    // Condition for continuous interpolation between frames
+    int32_t lastL = 0;       // Last left sample from previous frame
+    int32_t lastR = 0;       // Last right sample from previous frame
+    bool    hasLast = false; // First frame has no “last”
+
+    // prepares the conversion inRate -> outRate, the table is kept if the ratio, the quality and the mode did not change
+    void setup(uint32_t inRate, uint32_t outRate, uint8_t q, bool variable = false);
+
+    // fine ratio of the variable mode and of LINEAR, the next output frame continues at the current position
+    void setPpm(float p);
+
+    // converts frames of interleaved L/R, returns the output frames (at most frames * out / in + 1)
+    uint32_t process(const int32_t* in, uint32_t frames, int32_t* out);
+
+  private:
+    static float                      besselI0(float x);
+    void                              makeTable(const tier_t& t, uint32_t phases, uint32_t rows);
+    template <int T> static void      dot(const int32_t* x, const int32_t* c, int64_t& l, int64_t& r);
+    template <int T, bool V> uint32_t polyphase(const int32_t* in, uint32_t frames, int32_t* out);
+    static BiquadCoeffs               butterworthLPF(float fs);
+    uint32_t                          linear(const int32_t* input, uint32_t inputSamples, int32_t* output);
+};
+
+struct drift_t { // used in cacheSamples(), web streams run with the clock of the encoder: a PI controller keeps InBuff at its target level
+    static constexpr float MAX_PPM = 500; // 0.9 cent
+    static constexpr float KP = 4000;     // ppm per second of audio above the target
+    static constexpr float KI = 10;       // ppm per second and second, the loop settles in about 5 minutes
+    static constexpr float SMOOTH = 30;   // s, average of the level, the network delivers in bursts
+    static constexpr float SETTLE = 20;   // s of playback, then the average level becomes the target
+
+    bool     f_enabled = false; // setDriftCompensation()
+    bool     f_active = false;  // enabled and a web stream (not HLS), the output runs through the resampler
+    uint32_t userTarget = 0;    // bytes, 0 = the level after SETTLE
+    uint32_t target = 0;        // bytes in InBuff
+    float    level = -1;        // averaged bytes in InBuff, < 0 = no value yet
+    float    integral = 0;      // ppm
+    float    ppm = 0;           // + the input is consumed faster, the estimated clock difference of the encoder
+    float    time = 0;          // s since start()
+
+    void start(bool active);
+
+    // bytes in InBuff, byteRate of the stream, dt s of audio since the last call; returns the ppm for resampler_t::setPpm()
+    float update(uint32_t bytes, float byteRate, float dt);
+};
+
+} // namespace audiolib
@@ -0,0 +1,252 @@
+#include "Audio.h"
+
+// created 18.10.2026
+// lock-free single producer / single consumer PCM ring, moved out of Audio.cpp so that the host tools can link it
+
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// 📌📌📌  R I N G B U F F E R  📌📌📌
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+
+// RingBuffer will be allocated in PSRAM, SamplesBuff: decoder (cacheSamples) -> I2S (playChunk)
+//
+//  start            m_readPos                    m_writePos                                                     end
+//   |                  |<---------- filled ---------->|<--------------------- writeSpace ----------------------->|
+//   ▼                  ▼                              ▼                                                          ▼
+//   ---------------------------------------------------------------------------------------------------------------
+//   |                                           <--m_bufSize-->                                                   |
+//   ---------------------------------------------------------------------------------------------------------------
+//   |<---freeSpace---->|<------------filled---------->|<-----------------------freeSpace------------------------->|
+//
+// Single producer, single consumer, lock-free: the producer (write, getWritePtr, bytesWritten) only moves m_writePos,
+// the consumer (read, peek, getReadPtr, bytesRead) only moves m_readPos. A position is published with release after the
+// samples are written or read, the other side loads it with acquire. The positions run over two laps (0 ... 2 * m_bufSize - 1),
+// so a full buffer (distance m_bufSize) differs from an empty one (distance 0) without a spare word. Both positions sit in
+// cache lines of their own, so the producer core does not invalidate the line the consumer core polls and vice versa.
+// writeView() and readView() give the free or filled region as two spans (before and after the wrap), the producer may
+// fill it in place and the consumer may process it in place, bytesWritten() and bytesRead() hand it over.
+// reset() and init() are not thread safe, neither side may be active.
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+RingBuffer::RingBuffer() {}
+
+RingBuffer::~RingBuffer() {
+    m_buffer.reset();
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+void RingBuffer::setBufsize(size_t size) {
+    m_bufSize = size;
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+size_t RingBuffer::getBufsize() const {
+    return m_bufSize;
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+size_t RingBuffer::init() {
+    if (!m_buffer.alloc_array(m_bufSize, "RingBuffer")) {
+        m_init = false;
+        return 0;
+    }
+    m_log.set_name("\nRingBuffer_Log");
+    reset();
+    if (!m_highWater || m_highWater > m_bufSize) setWatermarks(m_bufSize / 4, m_bufSize * 3 / 4);
+    m_init = true;
+    return m_bufSize;
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+void RingBuffer::clear() {}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+void RingBuffer::reset() {
+    m_readPos.store(0, std::memory_order_relaxed);
+    m_writePos.store(0, std::memory_order_release);
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+size_t RingBuffer::freeSpace() const {
+    if (!m_init) return 0;
+    return m_bufSize - bufferFilled();
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+size_t RingBuffer::bufferFilled() const {
+    if (!m_init) return 0;
+    size_t readPos = m_readPos.load(std::memory_order_acquire);
+    return distance(m_writePos.load(std::memory_order_acquire), readPos);
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+size_t RingBuffer::writeSpace() const { // producer, contiguous free words behind the write position
+    if (!m_init) {
+        log_e("Buffer is not initialized");
+        return 0;
+    }
+    size_t writePos = m_writePos.load(std::memory_order_relaxed);
+    size_t free = m_bufSize - distance(writePos, m_readPos.load(std::memory_order_acquire));
+    return std::min(free, m_bufSize - index(writePos));
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+size_t RingBuffer::readSpace() const { // consumer, contiguous filled words behind the read position
+    if (!m_init) return 0;
+    size_t readPos = m_readPos.load(std::memory_order_relaxed);
+    size_t filled = distance(m_writePos.load(std::memory_order_acquire), readPos);
+    return std::min(filled, m_bufSize - index(readPos));
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+int32_t* RingBuffer::getWritePtr() {
+    if (!m_init) return nullptr;
+    return m_buffer.get() + index(m_writePos.load(std::memory_order_relaxed));
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+int32_t* RingBuffer::getReadPtr() {
+    if (!m_init) return nullptr;
+    return m_buffer.get() + index(m_readPos.load(std::memory_order_relaxed));
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+bool RingBuffer::bytesWritten(size_t words) {
+
+    if (!m_init) return false;
+
+    if (words > freeSpace()) {
+        m_log.assignf("bytesWritten({}) > freeSpace({})", words, freeSpace());
+        m_log.println();
+        return false;
+    }
+    m_writePos.store(advanceIndex(m_writePos.load(std::memory_order_relaxed), words), std::memory_order_release); // publish the samples
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+bool RingBuffer::bytesRead(size_t words) {
+
+    if (!m_init) return false;
+
+    if (words > bufferFilled()) {
+        m_log.assignf("bytesRead({}) > bufferFilled({})", words, bufferFilled());
+        m_log.println();
+        return false;
+    }
+    m_readPos.store(advanceIndex(m_readPos.load(std::memory_order_relaxed), words), std::memory_order_release); // release the space
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+RingBuffer::spans_t RingBuffer::view(size_t pos, size_t words) { // 'words' from pos, split at the end of the buffer
+    spans_t v;
+    size_t  idx = index(pos);
+    size_t  n1 = std::min(words, m_bufSize - idx);
+    v.first = std::span<int32_t>(m_buffer.get() + idx, n1);
+    v.second = std::span<int32_t>(m_buffer.get(), words - n1);
+    return v;
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+RingBuffer::spans_t RingBuffer::writeView(size_t words) { // the decoder can write into the ring without a copy
+    if (!m_init) return {};
+    return view(m_writePos.load(std::memory_order_relaxed), std::min(words, freeSpace()));
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+RingBuffer::spans_t RingBuffer::readView(size_t words) { // the DSP chain can process the samples in place
+    if (!m_init) return {};
+    return view(m_readPos.load(std::memory_order_relaxed), std::min(words, bufferFilled()));
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+size_t RingBuffer::write(const int32_t* src, size_t words) {
+
+    if (!m_init || !src || words == 0) return 0;
+
+    words = std::min(words, freeSpace());
+
+    // Stereo-Frames nicht zerreißen
+    words &= ~static_cast<size_t>(1);
+
+    size_t written = 0;
+
+    while (written < words) {
+        size_t chunk = writeSpace();
+        if (chunk == 0) {
+            m_log.assign("RingBuffer: writeSpace()==0");
+            m_log.println();
+            break;
+        }
+        chunk = std::min(chunk, words - written);
+        memcpy(getWritePtr(), src + written, chunk * sizeof(int32_t));
+        bytesWritten(chunk);
+        written += chunk;
+    }
+    return written;
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+size_t RingBuffer::read(int32_t* dst, size_t words) {
+
+    if (!m_init || !dst || words == 0) return 0;
+
+    // Nicht mehr lesen als vorhanden
+    words = std::min(words, bufferFilled());
+
+    // Stereo-Frames nicht zerreißen
+    words &= ~static_cast<size_t>(1);
+
+    size_t read = 0;
+
+    while (read < words) {
+        size_t chunk = readSpace();
+        if (chunk == 0) {
+            m_log.assign("RingBuffer: readSpace()==0");
+            m_log.println();
+            break;
+        }
+        chunk = std::min(chunk, words - read);
+        memcpy(dst + read, getReadPtr(), chunk * sizeof(int32_t));
+        bytesRead(chunk);
+        read += chunk;
+    }
+    return read;
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+size_t RingBuffer::peek(int32_t* dst, size_t words) {
+
+    if (!m_init || !dst || words == 0) return 0;
+
+    words = std::min(words, bufferFilled()); // the producer may only add samples meanwhile
+    words &= ~static_cast<size_t>(1);
+
+    size_t read = 0;
+    size_t readIndex = index(m_readPos.load(std::memory_order_relaxed)); // lokale Kopie
+
+    while (read < words) {
+        size_t chunk = std::min(m_bufSize - readIndex, words - read);
+        memcpy(dst + read, m_buffer.get() + readIndex, chunk * sizeof(int32_t));
+        read += chunk;
+        readIndex += chunk;
+        if (readIndex == m_bufSize) readIndex = 0;
+    }
+    return read;
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+void RingBuffer::setWatermarks(size_t low, size_t high) { // fill levels for the scheduling of producer and consumer
+    m_highWater = std::min(high, m_bufSize);
+    m_lowWater = std::min(low, m_highWater);
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+bool RingBuffer::isBelowLowWatermark() const {
+    return bufferFilled() < m_lowWater;
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+bool RingBuffer::isAboveHighWatermark() const {
+    return bufferFilled() > m_highWater;
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+inline size_t RingBuffer::advanceIndex(size_t pos, size_t words) const { // words <= m_bufSize
+    pos += words;
+    if (pos >= 2 * m_bufSize) pos -= 2 * m_bufSize;
+    return pos;
+}
+//----------------------------------------------------------------------------------------------------------------------------------------------------
+void RingBuffer::showStatus() {
+    size_t readPos = m_readPos.load(std::memory_order_acquire);
+    size_t writePos = m_writePos.load(std::memory_order_acquire);
+    m_log.assignf("\n"
+                  "Initialized  : {}\n"
+                  "BufferSize   : {}\n"
+                  "Used         : {}\n"
+                  "Free         : {}\n"
+                  "ReadSpace    : {}\n"
+                  "WriteSpace   : {}\n"
+                  "ReadIndex    : {}\n"
+                  "WriteIndex   : {}\n"
+                  "Watermarks   : {} / {}\n\n",
+                  m_init, m_bufSize, distance(writePos, readPos), freeSpace(), readSpace(), writeSpace(), index(readPos), index(writePos), m_lowWater, m_highWater);
+    m_log.print();
+}
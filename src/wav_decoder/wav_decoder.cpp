@@ -22,6 +22,8 @@ bool WavDecoder::isValid() {
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 int32_t WavDecoder::findSyncWord(uint8_t* buf, int32_t nBytes) {
+    (void)buf;
+    (void)nBytes;
     return 0;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -163,6 +165,8 @@ int32_t WavDecoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf)
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void WavDecoder::setRawBlockParams(uint8_t channels, uint32_t sampleRate, uint8_t BPS, uint32_t tsis, uint32_t AuDaLength) {
+    (void)tsis;
+    (void)AuDaLength;
     m_channels = channels;
     m_sampleRate = sampleRate;
     m_bits_per_sample = BPS;